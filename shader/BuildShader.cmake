@@ -4,6 +4,7 @@ set(SHADER_FILES
     animation.vert
     model.frag
     model.vert
+    model_instanced.vert
     particle.comp
     particle.frag
     particle.vert
@@ -5,9 +5,14 @@ layout (location = 0) in vec3 fragColor;
 layout (location = 1) in vec3 fragPosWorld;
 layout (location = 2) in vec3 fragNormalWorld;
 layout (location = 3) in vec2 fragTexCoord;  //
+layout (location = 4) flat in uvec3 fragObjectId;
+layout (location = 5) in float fragAo;  // 离线烘焙的顶点 AO
+layout (location = 6) flat in uint fragView;  // SceneData.views 的下标
 
 // 输出：最终颜色
 layout (location = 0) out vec4 outColor;
+// 物体 ID：model id, mesh id, primitive id, coverage（未绑定 ID 附件时被丢弃）
+layout (location = 1) out uvec4 outObjectId;
 
 // 纹理采样器
 layout(binding = 2) uniform sampler2D ambientSampler;
@@ -16,7 +21,7 @@ layout(binding = 4) uniform sampler2D specularSampler;
 
 // 光照相关的 Uniform Buffer
 struct PointLight {
-    vec4 position; // w 忽略
+    vec4 position; // w 是影响半径
     vec4 color;    // w 是强度
 };
 
@@ -32,16 +37,24 @@ struct DirLight  {
     vec4 color;    // w 是强度
 };
 
-layout(set = 0, binding = 0) uniform GlobalUbo {
+struct SceneView {
     mat4 projection;
     mat4 view;
     mat4 invView;
-    vec4 ambientLightColor; // w 是强度
+    uvec4 clusterGrid; // xyz: 簇的数量
+    vec4 clusterDepth; // x: near, y: far, 切片 = log(depth) * z + w
+    uvec4 clusterWords; // x: 簇表起始, y: 灯光索引起始（uvec4 为单位）
+};
+
+// 每帧共享的场景数据，布局与 world::SceneDataHeader 一致，所有视图共用一份
+layout(std430, set = 0, binding = 0) readonly buffer SceneData {
+    vec4 ambientLightColor; // w is intensity
     DirLight dirLight;
     SpotLight spotLight;
-    PointLight pointLights[10];
-    int numLights;
-} ubo;
+    ivec4 lightCount; // x: 点光源数量
+    SceneView views[8]; // world::MAX_SCENE_VIEWS
+    uvec4 words[]; // 点光源，之后是各视图的簇表和灯光索引
+} scene;
 
 layout(set = 0, binding = 1) uniform Material {
     vec3 ambient;
@@ -68,9 +81,26 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, v
 
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseTex, vec3 specularTex);
 
+PointLight LoadPointLight(uint index) {
+    return PointLight(uintBitsToFloat(scene.words[index * 2u]),
+                      uintBitsToFloat(scene.words[index * 2u + 1u]));
+}
+
+// 与 world::LightClusterGrid 的划分一致：屏幕按 NDC 均分，深度按指数切片
+uint ClusterIndex(SceneView sceneView, vec3 fragPos) {
+    vec4 viewPos = sceneView.view * vec4(fragPos, 1.0);
+    vec4 clip = sceneView.projection * viewPos;
+    uvec3 grid = sceneView.clusterGrid.xyz;
+    vec2 tile = (clip.xy / clip.w * 0.5 + 0.5) * vec2(grid.xy);
+    tile = clamp(tile, vec2(0.0), vec2(grid.xy) - 1.0);
+    float slice = log(max(viewPos.z, 1e-4)) * sceneView.clusterDepth.z + sceneView.clusterDepth.w;
+    slice = clamp(slice, 0.0, float(grid.z) - 1.0);
+    return uint(tile.x) + grid.x * (uint(tile.y) + grid.y * uint(slice));
+}
+
 void main() {
 
-    vec3 ambientLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
+    vec3 ambientLight = scene.ambientLightColor.xyz * scene.ambientLightColor.w;
     vec3 diffuseLight = vec3(0.0);
     vec3 specularLight = vec3(0.0);
 
@@ -80,22 +110,30 @@ void main() {
 
     vec3 surfaceNormal = normalize(fragNormalWorld);
 
-    vec3 cameraPosWorld = ubo.invView[3].xyz;
+    SceneView sceneView = scene.views[fragView];
+    vec3 cameraPosWorld = sceneView.invView[3].xyz;
     vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
 
-    for (int i = 0; i < ubo.numLights; i++) {
-         specularLight += CalcPointLight(ubo.pointLights[i], surfaceNormal,
+    // 只计算所在簇中的点光源
+    uint cluster = ClusterIndex(sceneView, fragPosWorld);
+    uvec4 rangeWord = scene.words[sceneView.clusterWords.x + cluster / 2u];
+    uvec2 range = (cluster & 1u) == 0u ? rangeWord.xy : rangeWord.zw;
+    uint indexBase = sceneView.clusterWords.y;
+    for (uint i = range.x; i < range.x + range.y; i++) {
+        uint lightIndex = scene.words[indexBase + i / 4u][i % 4u];
+        specularLight += CalcPointLight(LoadPointLight(lightIndex), surfaceNormal,
                             fragPosWorld, viewDirection, texColor, specTex);
     }
 
-    vec3 dirLight = CalcDirLight(ubo.dirLight, surfaceNormal, viewDirection, texColor, specTex);
-    vec3 ambient = ambientLight * material.ambient * texColor;
+    vec3 dirLight = CalcDirLight(scene.dirLight, surfaceNormal, viewDirection, texColor, specTex);
+    vec3 ambient = ambientLight * material.ambient * texColor * fragAo;
 
-    vec3 calcLight = CalcSpotLight(ubo.spotLight, surfaceNormal, fragPosWorld, viewDirection, texColor, specTex);
+    vec3 calcLight = CalcSpotLight(scene.spotLight, surfaceNormal, fragPosWorld, viewDirection, texColor, specTex);
     //最终颜色 = (环境 + 漫反射 + 高光) * 贴图
     vec3 finalColor = dirLight + ambient + specularLight + calcLight;
 
     outColor = vec4(finalColor, 1.0);
+    outObjectId = uvec4(fragObjectId.xy, uint(gl_PrimitiveID), fragObjectId.z);
 }
 
 // calculates the color when using a directional light.
@@ -107,17 +145,24 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffTex, vec3
     vec3 blinnLight = CalcBlinnPhongLight(light.color.xyz, light.color.w, lightDir,
         normal, viewDir, diffTex, specTex);
     // combine results
-    vec3 dirLight = lightColor * material.ambient * diffTex;
+    vec3 dirLight = lightColor * material.ambient * diffTex * fragAo;
        return dirLight + blinnLight;
 }
 
 // calculates the color when using a point light.
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffTex, vec3 specTex)
 {
+    // 半径为 0 的灯光没有影响范围，直接跳过，避免下面除零
+    if (light.position.w <= 1e-4) {
+        return vec3(0.0);
+    }
     vec3 lightToPos = light.position.xyz - fragPos;
-    float distance = length(lightToPos);
+    float distance = max(length(lightToPos), 1e-6);
     vec3 directionToLight = lightToPos / distance;
     float attenuation = 1.0 / (distance * distance + 1e-6); // 衰减
+    // 在影响半径处平滑衰减到 0，簇外的灯光不会产生可见的接缝
+    float falloff = clamp(1.0 - pow(distance / light.position.w, 4.0), 0.0, 1.0);
+    attenuation *= falloff * falloff;
 
     return CalcBlinnPhongLight(light.color.xyz, light.color.w * attenuation, directionToLight,
         normal, viewDir, diffTex, specTex);
@@ -4,25 +4,50 @@ layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 color;
 layout(location = 2) in vec3 normal;
 layout(location = 3) in vec2 uv;
+layout(location = 4) in float ao; // baked ambient occlusion
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormalWorld;
 layout(location = 3) out vec2 fragTexCoord;
+layout(location = 4) flat out uvec3 fragObjectId; // x: model id, y: mesh id, z: coverage
+layout(location = 5) out float fragAo;
+layout(location = 6) flat out uint fragView; // SceneData.views 的下标
 
 struct PointLight {
-  vec4 position; // ignore w
+  vec4 position; // w is radius
   vec4 color; // w is intensity
 };
 
-layout(set = 0, binding = 0) uniform GlobalUbo {
+struct SpotLight {
+  vec4 position; // w outerCutOff
+  vec4 color; // w is intensity
+  vec4 direction; // w cutOff
+};
+
+struct DirLight {
+  vec4 direction; // ignore w
+  vec4 color; // w is intensity
+};
+
+struct SceneView {
   mat4 projection;
   mat4 view;
   mat4 invView;
+  uvec4 clusterGrid; // xyz: 簇的数量
+  vec4 clusterDepth; // x: near, y: far, 切片 = log(depth) * z + w
+  uvec4 clusterWords; // x: 簇表起始, y: 灯光索引起始（uvec4 为单位）
+};
+
+// 每帧共享的场景数据，布局与 world::SceneDataHeader 一致，所有视图共用一份
+layout(std430, set = 0, binding = 0) readonly buffer SceneData {
   vec4 ambientLightColor; // w is intensity
-  PointLight pointLights[10];
-  int numLights;
-} ubo;
+  DirLight dirLight;
+  SpotLight spotLight;
+  ivec4 lightCount; // x: 点光源数量
+  SceneView views[8]; // world::MAX_SCENE_VIEWS
+  uvec4 words[]; // 点光源，之后是各视图的簇表和灯光索引
+} scene;
 
 layout(push_constant) uniform Push {
   mat4 modelMatrix;
@@ -30,10 +55,16 @@ layout(push_constant) uniform Push {
 } push;
 
 void main() {
+  // normalMatrix[3].w 是绘制所属的视图
+  uint viewIndex = uint(push.normalMatrix[3].w);
   vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
-  gl_Position = ubo.projection * ubo.view * positionWorld;
+  gl_Position = scene.views[viewIndex].projection * scene.views[viewIndex].view * positionWorld;
   fragNormalWorld = normalize(mat3(push.normalMatrix) * normal);
   fragPosWorld = positionWorld.xyz;
   fragColor = color;
   fragTexCoord = uv;
+  fragAo = ao;
+  // normalMatrix 只用到 mat3，第四列的 xy 存放物体 ID，z 为 0 时 ID 无效
+  fragObjectId = uvec3(push.normalMatrix[3].xyz);
+  fragView = viewIndex;
 }
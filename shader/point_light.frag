@@ -4,20 +4,6 @@ layout (location = 0) in vec2 fragOffset;
 layout (location = 1) in vec3 fragWorldPos; // ← 接收插值后的位置
 layout (location = 0) out vec4 outColor;
 
-struct PointLight {
-  vec4 position; // ignore w
-  vec4 color; // w is intensity
-};
-
-layout(set = 0, binding = 0) uniform GlobalUbo {
-  mat4 projection;
-  mat4 view;
-  mat4 invView;
-  vec4 ambientLightColor; // w is intensity
-  PointLight pointLights[10];
-  int numLights;
-} ubo;
-
 layout(push_constant) uniform Push {
   vec4 position;
   vec4 color;
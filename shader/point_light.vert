@@ -12,18 +12,39 @@ const vec2 OFFSETS[6] = vec2[](
 layout (location = 0) out vec2 fragOffset;
 layout (location = 1) out vec3 fragWorldPos;
 struct PointLight {
-  vec4 position; // ignore w
+  vec4 position; // w is radius
   vec4 color; // w is intensity
 };
 
-layout(set = 0, binding = 0) uniform GlobalUbo {
+struct SpotLight {
+  vec4 position; // w outerCutOff
+  vec4 color; // w is intensity
+  vec4 direction; // w cutOff
+};
+
+struct DirLight {
+  vec4 direction; // ignore w
+  vec4 color; // w is intensity
+};
+
+struct SceneView {
   mat4 projection;
   mat4 view;
   mat4 invView;
+  uvec4 clusterGrid; // xyz: 簇的数量
+  vec4 clusterDepth; // x: near, y: far, 切片 = log(depth) * z + w
+  uvec4 clusterWords; // x: 簇表起始, y: 灯光索引起始（uvec4 为单位）
+};
+
+// 每帧共享的场景数据，布局与 world::SceneDataHeader 一致，所有视图共用一份
+layout(std430, set = 0, binding = 0) readonly buffer SceneData {
   vec4 ambientLightColor; // w is intensity
-  PointLight pointLights[10];
-  int numLights;
-} ubo;
+  DirLight dirLight;
+  SpotLight spotLight;
+  ivec4 lightCount; // x: 点光源数量
+  SceneView views[8]; // world::MAX_SCENE_VIEWS
+  uvec4 words[]; // 点光源，之后是各视图的簇表和灯光索引
+} scene;
 
 layout(push_constant) uniform Push {
   vec4 position;
@@ -34,12 +55,14 @@ layout(push_constant) uniform Push {
 
 void main() {
   fragOffset = OFFSETS[gl_VertexIndex];
-  vec3 cameraRightWorld = {ubo.view[0][0], ubo.view[1][0], ubo.view[2][0]};
-  vec3 cameraUpWorld = {ubo.view[0][1], ubo.view[1][1], ubo.view[2][1]};
+  // 灯光的公告板只在主视图中绘制
+  mat4 view = scene.views[0].view;
+  vec3 cameraRightWorld = {view[0][0], view[1][0], view[2][0]};
+  vec3 cameraUpWorld = {view[0][1], view[1][1], view[2][1]};
 
   vec3 positionWorld = push.position.xyz
     + push.radius * fragOffset.x * cameraRightWorld
     + push.radius * fragOffset.y * cameraUpWorld;
   fragWorldPos = positionWorld;
-  gl_Position = ubo.projection * ubo.view * vec4(positionWorld, 1.0);
+  gl_Position = scene.views[0].projection * view * vec4(positionWorld, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+// 无窗口的性能测试：用 StressScene 生成确定的场景，在 NullGraphic 上逐帧执行
+// World::update 和 World::draw，输出各阶段 CPU 耗时的统计。
+// 例：stress_bench --models 20000 --lights 256 --depth 4 --frames 300 --max-frame-ms 8
+#include "core/frontend/window.hpp"
+#include "ecs/components/camera_component.hpp"
+#include "effects/stress_scene.hpp"
+#include "input/input.hpp"
+#include "render_core/null_graphic.hpp"
+#include "resource/resource.hpp"
+#include "world/world.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <print>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+class HeadlessWindow : public core::frontend::BaseWindow {
+    public:
+        HeadlessWindow(int width, int height) {
+            setWindowConfig({.fullscreen = false, .extent = {.width = width, .height = height}});
+        }
+        [[nodiscard]] auto IsShown() const -> bool override { return true; }
+        [[nodiscard]] auto IsMinimized() const -> bool override { return false; }
+        [[nodiscard]] auto shouldClose() const -> bool override { return false; }
+        void setShouldClose() override {}
+        void configGUI() override {}
+        void destroyGUI() override {}
+        void newFrame() override {}
+        [[nodiscard]] auto getActiveConfig() const -> WindowConfig override {
+            return getWindowConfig();
+        }
+        void OnFrameDisplayed() override {}
+        void pullEvents() override {}
+        void setWindowTitle(std::string_view /*title*/) override {}
+};
+
+struct Options {
+        graphics::effects::StressSceneSettings scene;
+        std::uint32_t frames{300};
+        std::uint32_t warmup{10};
+        int width{1920};
+        int height{1080};
+        double max_frame_ms{0};  // 0 表示不检查
+};
+
+template <typename T>
+auto parseValue(std::string_view text, T& value) -> bool {
+    const auto* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc{} && ptr == end;
+}
+
+auto parseOptions(int argc, char** argv) -> Options {
+    Options options;
+    auto& scene = options.scene;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string_view name{argv[i]};
+        const std::string_view value{argv[i + 1]};
+        bool ok = false;
+        if (name == "--seed") {
+            ok = parseValue(value, scene.seed);
+        } else if (name == "--models") {
+            ok = parseValue(value, scene.models);
+        } else if (name == "--lights") {
+            ok = parseValue(value, scene.lights);
+        } else if (name == "--particle-systems") {
+            ok = parseValue(value, scene.particle_systems);
+        } else if (name == "--particles") {
+            ok = parseValue(value, scene.particles_per_system);
+        } else if (name == "--depth") {
+            ok = parseValue(value, scene.hierarchy_depth);
+        } else if (name == "--variants") {
+            ok = parseValue(value, scene.mesh_variants);
+        } else if (name == "--extent") {
+            ok = parseValue(value, scene.extent);
+        } else if (name == "--frames") {
+            ok = parseValue(value, options.frames);
+        } else if (name == "--warmup") {
+            ok = parseValue(value, options.warmup);
+        } else if (name == "--width") {
+            ok = parseValue(value, options.width);
+        } else if (name == "--height") {
+            ok = parseValue(value, options.height);
+        } else if (name == "--max-frame-ms") {
+            ok = parseValue(value, options.max_frame_ms);
+        }
+        if (!ok) {
+            spdlog::warn("ignore option {} {}", name, value);
+        }
+    }
+    options.frames = std::max(options.frames, 1U);
+    return options;
+}
+
+struct Summary {
+        double mean{0};
+        double p50{0};
+        double p95{0};
+        double max{0};
+};
+
+auto summarize(std::vector<double> samples) -> Summary {
+    std::ranges::sort(samples);
+    Summary summary;
+    for (const double sample : samples) {
+        summary.mean += sample;
+    }
+    summary.mean /= static_cast<double>(samples.size());
+    const auto at = [&](double q) {
+        const auto count = static_cast<double>(samples.size());
+        const auto index = static_cast<std::size_t>(std::ceil(q * count));
+        return samples[std::clamp<std::size_t>(index, 1, samples.size()) - 1];
+    };
+    summary.p50 = at(.5);
+    summary.p95 = at(.95);
+    summary.max = samples.back();
+    return summary;
+}
+
+void printSummary(std::string_view name, const std::vector<double>& samples) {
+    const auto summary = summarize(samples);
+    std::println("{:<14}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}", name, summary.mean, summary.p50,
+                 summary.p95, summary.max);
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    const auto options = parseOptions(argc, argv);
+    try {
+        HeadlessWindow window(options.width, options.height);
+        render::NullGraphic graphic;
+        graphics::ResourceManager resource_manager(&graphic);
+        for (const auto* shader : {"model", "point_light", "particle"}) {
+            resource_manager.addGraphShader(shader);
+        }
+        resource_manager.addComputeShader("particle");
+        resource_manager.addVertexShader("model_instanced");
+
+        graphics::input::InputSystem input_system;
+        input_system.Init();
+        world::World world;
+
+        const auto setup_start = std::chrono::steady_clock::now();
+        graphics::effects::StressScene scene(options.scene, resource_manager, world,
+                                             window.getFramebufferLayout());
+        const std::chrono::duration<double, std::milli> setup =
+            std::chrono::steady_clock::now() - setup_start;
+        std::println("scene: {} models, {} lights, {} particle systems, depth {}, seed {}",
+                     scene.modelCount(), options.scene.lights, options.scene.particle_systems,
+                     options.scene.hierarchy_depth, options.scene.seed);
+        std::println("setup: {:.3f} ms", setup.count());
+
+        auto& camera = world.getEntity(world::WorldEntityType::CAMERA)
+                           .getComponent<ecs::CameraComponent>();
+        const float radius = options.scene.extent * 1.2f;
+        constexpr float FRAME_SECONDS = 1.f / 60.f;
+
+        struct Samples {
+                std::vector<double> camera_input, transforms, drawables, lights, culling, submit,
+                    frame;
+        } samples;
+        for (std::uint32_t frame = 0; frame < options.warmup + options.frames; ++frame) {
+            // 固定的时间步长，结果不受机器快慢影响
+            const float seconds = static_cast<float>(frame) * FRAME_SECONDS;
+            camera.setEye({radius * std::cos(seconds * .2f), options.scene.extent * .3f,
+                           radius * std::sin(seconds * .2f)});
+            camera.setCenter(glm::vec3{0.f});
+
+            const auto start = std::chrono::steady_clock::now();
+            scene.animate(seconds);
+            world.update(window, resource_manager, input_system);
+            world.draw(&graphic);
+            const std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+            if (frame < options.warmup) {
+                continue;
+            }
+            const auto& timings = world.phaseTimings();
+            samples.camera_input.push_back(timings.camera_input);
+            samples.transforms.push_back(timings.transforms);
+            samples.drawables.push_back(timings.drawables);
+            samples.lights.push_back(timings.lights);
+            samples.culling.push_back(timings.culling);
+            samples.submit.push_back(timings.submit);
+            samples.frame.push_back(elapsed.count());
+        }
+
+        std::println("{} frames (ms)", options.frames);
+        std::println("{:<14}{:>10}{:>10}{:>10}{:>10}", "phase", "mean", "p50", "p95", "max");
+        printSummary("camera/input", samples.camera_input);
+        printSummary("transforms", samples.transforms);
+        printSummary("drawables", samples.drawables);
+        printSummary("lights", samples.lights);
+        printSummary("culling", samples.culling);
+        printSummary("submit", samples.submit);
+        printSummary("frame", samples.frame);
+
+        const auto& stats = graphic.stats();
+        const auto frame_count = static_cast<double>(options.warmup + options.frames);
+        std::println(
+            "draws/frame: {:.1f}, batches/frame: {:.1f}, dispatches/frame: {:.1f}, live meshes: {}",
+            static_cast<double>(stats.draws) / frame_count,
+            static_cast<double>(stats.batches) / frame_count,
+            static_cast<double>(stats.dispatches) / frame_count, stats.live_meshes);
+
+        // 给 CI 使用：p95 帧时间超过阈值时返回失败
+        const auto frame_p95 = summarize(samples.frame).p95;
+        if (options.max_frame_ms > 0 && frame_p95 > options.max_frame_ms) {
+            spdlog::error("frame p95 {:.3f} ms exceeds {:.3f} ms", frame_p95,
+                          options.max_frame_ms);
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& e) {
+        spdlog::error(e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+// SpatialGrid 的范围查询与逐个测试的耗时对比，两种方式的命中数不一致时返回失败。
+// 例：spatial_grid_bench --boxes 20000 --queries 2000 --radius 5 --cell 4
+#include "system/spatial_grid.hpp"
+#include <spdlog/spdlog.h>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct Options {
+        std::size_t boxes{20000};
+        std::size_t queries{2000};
+        float radius{5.f};
+        float cell_size{4.f};
+        float range{200.f};
+        unsigned seed{3};
+};
+
+template <typename T>
+auto parseValue(std::string_view text, T& value) -> bool {
+    const auto* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc{} && ptr == end;
+}
+
+auto parseOptions(int argc, char** argv) -> Options {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string_view name{argv[i]};
+        const std::string_view value{argv[i + 1]};
+        bool ok = false;
+        if (name == "--boxes") {
+            ok = parseValue(value, options.boxes);
+        } else if (name == "--queries") {
+            ok = parseValue(value, options.queries);
+        } else if (name == "--radius") {
+            ok = parseValue(value, options.radius);
+        } else if (name == "--cell") {
+            ok = parseValue(value, options.cell_size);
+        } else if (name == "--range") {
+            ok = parseValue(value, options.range);
+        } else if (name == "--seed") {
+            ok = parseValue(value, options.seed);
+        }
+        if (!ok) {
+            spdlog::warn("ignore option {} {}", name, value);
+        }
+    }
+    return options;
+}
+
+auto sphereOverlaps(const core::AABB& box, const glm::vec3& center, float radius) -> bool {
+    const glm::vec3 delta = glm::clamp(center, box.min, box.max) - center;
+    return glm::dot(delta, delta) <= radius * radius;
+}
+
+auto randomBoxes(const Options& options) -> std::vector<core::AABB> {
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> position(-options.range, options.range);
+    std::uniform_real_distribution<float> size(0.1f, 2.f);
+    std::vector<core::AABB> boxes(options.boxes);
+    for (auto& box : boxes) {
+        const glm::vec3 min{position(rng), position(rng), position(rng)};
+        box = {.min = min, .max = min + glm::vec3{size(rng), size(rng), size(rng)}};
+    }
+    return boxes;
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    const auto options = parseOptions(argc, argv);
+    const auto boxes = randomBoxes(options);
+    graphics::SpatialGrid grid{options.cell_size};
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        grid.insert(boxes[i], static_cast<std::uint32_t>(i));
+    }
+    std::mt19937 rng(options.seed + 1);
+    std::uniform_real_distribution<float> position(-options.range, options.range);
+    std::vector<glm::vec3> centers(options.queries);
+    for (auto& center : centers) {
+        center = {position(rng), position(rng), position(rng)};
+    }
+
+    using clock = std::chrono::steady_clock;
+    std::size_t brute_hits = 0;
+    const auto brute_start = clock::now();
+    for (const auto& center : centers) {
+        for (const auto& box : boxes) {
+            brute_hits += sphereOverlaps(box, center, options.radius) ? 1 : 0;
+        }
+    }
+    const std::chrono::duration<double, std::milli> brute_time = clock::now() - brute_start;
+
+    std::vector<std::uint32_t> out;
+    std::size_t grid_hits = 0;
+    const auto grid_start = clock::now();
+    for (const auto& center : centers) {
+        out.clear();
+        grid.queryRadius(center, options.radius, out);
+        grid_hits += out.size();
+    }
+    const std::chrono::duration<double, std::milli> grid_time = clock::now() - grid_start;
+
+    std::println("{} radius queries over {} boxes: brute force {:.2f} ms, grid {:.2f} ms",
+                 options.queries, options.boxes, brute_time.count(), grid_time.count());
+    if (grid_hits != brute_hits) {
+        spdlog::error("grid hits {} != brute force hits {}", grid_hits, brute_hits);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
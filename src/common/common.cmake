@@ -7,17 +7,23 @@ set(sources
     bit_util.h
     common_funcs.hpp
     common_types.hpp
+    deferred_release.hpp
     div_ceil.hpp
     error.hpp
     error.cpp
     enum_util.hpp
     file.cpp
     file.hpp
+    handle_pool.hpp
     literals.hpp
     logger.hpp
     logger.cpp
     math_util.h
+    parallel.hpp
+    parallel.cpp
     polyfill_thread.hpp
+    radix_sort.hpp
+    radix_sort.cpp
     scope_exit.h
     settings_common.hpp
     settings_common.cpp
@@ -25,6 +31,7 @@ set(sources
     settings_enums.hpp
     settings.hpp
     settings.cpp
+    simd.hpp
     slot_vector.hpp
     swap.h
     thread_worker.hpp
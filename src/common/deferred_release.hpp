@@ -0,0 +1,39 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+#include "common_types.hpp"
+
+namespace common {
+
+/// 等待 GPU 用完后再销毁的对象。push 时记录当前提交的 tick，tick 按提交顺序单调递增，
+/// 所以只需要从队首检查：队首还没完成时后面的也不会完成。
+template <typename T>
+class DeferredReleaseQueue {
+    public:
+        void push(u64 tick, T value) { pending_.emplace_back(tick, std::move(value)); }
+
+        // 对 is_free(tick) 成立的对象按入队顺序调用 release，返回释放的数量
+        template <typename IsFree, typename Release>
+            requires std::predicate<IsFree&, u64> && std::invocable<Release&, T&>
+        auto collect(IsFree&& is_free, Release&& release) -> std::size_t {
+            std::size_t released = 0;
+            while (!pending_.empty() && is_free(pending_.front().first)) {
+                release(pending_.front().second);
+                pending_.pop_front();
+                ++released;
+            }
+            return released;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool { return pending_.empty(); }
+        [[nodiscard]] auto size() const noexcept -> std::size_t { return pending_.size(); }
+
+    private:
+        std::deque<std::pair<u64, T>> pending_;
+};
+
+}  // namespace common
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "common_types.hpp"
+
+namespace common {
+
+// 代数句柄：index 定位槽位，generation 区分同一槽位的先后两次使用
+template <typename Tag>
+struct Handle {
+        static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
+
+        constexpr auto operator<=>(const Handle&) const noexcept = default;
+
+        constexpr explicit operator bool() const noexcept { return index != INVALID_INDEX; }
+
+        u32 index = INVALID_INDEX;
+        u32 generation = 0;
+};
+
+/// 代数句柄池。槽位的 generation 为奇数表示占用、偶数表示空闲，分配和释放各加一，
+/// 释放后旧句柄的 generation 不再匹配，get 返回 nullptr。
+/// 存储按 CHUNK_SIZE 分块，扩容不移动已有元素，元素地址在释放前保持不变。
+/// allocate/release 只使用原子操作（带标记的空闲链表 + 递增的槽位计数），可以在多个线程中同时调用；
+/// 同一个元素的读写同步由调用方负责。
+template <typename T, typename Tag = T>
+class HandlePool {
+    public:
+        using handle_t = Handle<Tag>;
+        static constexpr u32 CHUNK_SIZE = 1024;
+        static constexpr u32 MAX_CHUNKS = 1024;
+
+        HandlePool() = default;
+        HandlePool(const HandlePool&) = delete;
+        auto operator=(const HandlePool&) -> HandlePool& = delete;
+        HandlePool(HandlePool&&) = delete;
+        auto operator=(HandlePool&&) -> HandlePool& = delete;
+
+        ~HandlePool() {
+            const u32 count = std::min(next_index_.load(std::memory_order_acquire),
+                                       MAX_CHUNKS * CHUNK_SIZE);
+            for (u32 index = 0; index < count; ++index) {
+                Slot& slot = slotAt(index);
+                if ((slot.generation.load(std::memory_order_relaxed) & 1U) != 0) {
+                    std::destroy_at(slot.object());
+                }
+            }
+            for (auto& chunk : chunks_) {
+                delete chunk.load(std::memory_order_relaxed);
+            }
+        }
+
+        template <typename... Args>
+        [[nodiscard]] auto allocate(Args&&... args) -> handle_t {
+            u32 index = popFree();
+            if (index == handle_t::INVALID_INDEX) {
+                index = next_index_.fetch_add(1, std::memory_order_acq_rel);
+                // release 构建同样检查，越界会写到 chunks_ 之外
+                if (index >= MAX_CHUNKS * CHUNK_SIZE) [[unlikely]] {
+                    throw std::length_error("HandlePool is full");
+                }
+                ensureChunk(index / CHUNK_SIZE);
+            }
+            Slot& slot = slotAt(index);
+            std::construct_at(slot.object(), std::forward<Args>(args)...);
+            const u32 generation = slot.generation.fetch_add(1, std::memory_order_release) + 1;
+            live_.fetch_add(1, std::memory_order_relaxed);
+            return handle_t{.index = index, .generation = generation};
+        }
+
+        // 句柄已经失效时什么也不做
+        void release(handle_t handle) {
+            Slot* slot = find(handle);
+            if (slot == nullptr) {
+                return;
+            }
+            u32 expected = handle.generation;
+            if (!slot->generation.compare_exchange_strong(expected, expected + 1,
+                                                          std::memory_order_acq_rel)) {
+                return;
+            }
+            std::destroy_at(slot->object());
+            live_.fetch_sub(1, std::memory_order_relaxed);
+            pushFree(handle.index);
+        }
+
+        [[nodiscard]] auto get(handle_t handle) noexcept -> T* {
+            Slot* slot = find(handle);
+            return slot == nullptr ? nullptr : slot->object();
+        }
+
+        [[nodiscard]] auto get(handle_t handle) const noexcept -> const T* {
+            return const_cast<HandlePool*>(this)->get(handle);  // NOLINT
+        }
+
+        [[nodiscard]] auto valid(handle_t handle) const noexcept -> bool {
+            return get(handle) != nullptr;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t {
+            return live_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Slot {
+                std::atomic<u32> generation{0};
+                std::atomic<u32> next_free{handle_t::INVALID_INDEX};
+                alignas(T) std::array<std::byte, sizeof(T)> storage;
+
+                auto object() noexcept -> T* {
+                    return std::launder(reinterpret_cast<T*>(storage.data()));  // NOLINT
+                }
+        };
+        using Chunk = std::array<Slot, CHUNK_SIZE>;
+
+        // 空闲链表头：低 32 位是槽位下标，高 32 位是每次修改递增的标记，防止 ABA
+        static constexpr auto packHead(u64 tag, u32 index) noexcept -> u64 {
+            return (tag << 32U) | index;
+        }
+        static constexpr auto headIndex(u64 head) noexcept -> u32 {
+            return static_cast<u32>(head & 0xffffffffULL);
+        }
+        static constexpr auto headTag(u64 head) noexcept -> u64 { return head >> 32U; }
+
+        auto slotAt(u32 index) noexcept -> Slot& {
+            Chunk* chunk = chunks_[index / CHUNK_SIZE].load(std::memory_order_acquire);
+            return (*chunk)[index % CHUNK_SIZE];
+        }
+
+        auto find(handle_t handle) noexcept -> Slot* {
+            if (handle.index >= MAX_CHUNKS * CHUNK_SIZE || (handle.generation & 1U) == 0) {
+                return nullptr;
+            }
+            Chunk* chunk = chunks_[handle.index / CHUNK_SIZE].load(std::memory_order_acquire);
+            if (chunk == nullptr) {
+                return nullptr;
+            }
+            Slot& slot = (*chunk)[handle.index % CHUNK_SIZE];
+            if (slot.generation.load(std::memory_order_acquire) != handle.generation) {
+                return nullptr;
+            }
+            return &slot;
+        }
+
+        void ensureChunk(u32 chunk_index) {
+            auto& chunk = chunks_[chunk_index];
+            if (chunk.load(std::memory_order_acquire) != nullptr) {
+                return;
+            }
+            auto* fresh = new Chunk();
+            Chunk* expected = nullptr;
+            if (!chunk.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+                delete fresh;
+            }
+        }
+
+        auto popFree() noexcept -> u32 {
+            u64 head = free_head_.load(std::memory_order_acquire);
+            while (headIndex(head) != handle_t::INVALID_INDEX) {
+                const u32 next = slotAt(headIndex(head)).next_free.load(std::memory_order_relaxed);
+                if (free_head_.compare_exchange_weak(head, packHead(headTag(head) + 1, next),
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+                    return headIndex(head);
+                }
+            }
+            return handle_t::INVALID_INDEX;
+        }
+
+        void pushFree(u32 index) noexcept {
+            Slot& slot = slotAt(index);
+            u64 head = free_head_.load(std::memory_order_relaxed);
+            do {
+                slot.next_free.store(headIndex(head), std::memory_order_relaxed);
+            } while (!free_head_.compare_exchange_weak(head, packHead(headTag(head) + 1, index),
+                                                       std::memory_order_release,
+                                                       std::memory_order_relaxed));
+        }
+
+        std::array<std::atomic<Chunk*>, MAX_CHUNKS> chunks_{};
+        std::atomic<u64> free_head_{packHead(0, handle_t::INVALID_INDEX)};
+        std::atomic<u32> next_index_{0};
+        std::atomic<std::size_t> live_{0};
+};
+
+}  // namespace common
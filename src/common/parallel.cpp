@@ -0,0 +1,53 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <latch>
+#include <thread>
+
+#include "common/thread_worker.hpp"
+
+namespace common {
+namespace {
+thread_local bool is_job_worker = false;  // NOLINT
+
+auto get_job_workers() -> ThreadWorker& {
+    static ThreadWorker workers{parallelWorkerCount(), "JobWorker"};
+    return workers;
+}
+}  // namespace
+
+auto parallelWorkerCount() -> std::size_t {
+    static const std::size_t count =
+        std::max<std::size_t>(1, std::thread::hardware_concurrency()) - 1;
+    return std::max<std::size_t>(count, 1);
+}
+
+void parallelFor(std::size_t count, std::size_t grain,
+                 const std::function<void(std::size_t, std::size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    const std::size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || is_job_worker) {
+        func(0, count);
+        return;
+    }
+
+    auto& workers = get_job_workers();
+    std::latch done{static_cast<std::ptrdiff_t>(chunks - 1)};
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+        const std::size_t begin = chunk * grain;
+        const std::size_t end = std::min(count, begin + grain);
+        workers.QueueWork([&func, &done, begin, end] {
+            is_job_worker = true;
+            func(begin, end);
+            done.count_down();
+        });
+    }
+    // 第一块在调用线程上执行
+    func(0, std::min(count, grain));
+    done.wait();
+}
+
+}  // namespace common
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace common {
+
+// 进程内共享的工作线程数（不含调用线程）
+auto parallelWorkerCount() -> std::size_t;
+
+/// 将 [0, count) 按 grain 切块并在共享线程池上执行 func(begin, end)，调用线程也参与执行，
+/// 函数返回时所有块都已完成。在工作线程内部再次调用时退化为串行执行，避免嵌套等待造成死锁。
+void parallelFor(std::size_t count, std::size_t grain,
+                 const std::function<void(std::size_t, std::size_t)>& func);
+
+}  // namespace common
@@ -0,0 +1,76 @@
+#include "radix_sort.hpp"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "common/parallel.hpp"
+
+namespace common {
+namespace {
+constexpr std::size_t RADIX_BITS = 8;
+constexpr std::size_t BUCKETS = std::size_t{1} << RADIX_BITS;
+constexpr std::size_t PASSES = 64 / RADIX_BITS;
+constexpr std::size_t SORT_GRAIN = 4096;
+
+using Histogram = std::array<std::size_t, BUCKETS>;
+
+// 在工作线程中 parallelFor 会退化成一次覆盖全部范围的调用，这里总是按 SORT_GRAIN 切块
+template <typename Func>
+void forEachChunk(std::size_t count, Func&& func) {
+    parallelFor(count, SORT_GRAIN, [&func, count](std::size_t begin, std::size_t end) {
+        for (std::size_t first = begin; first < end; first += SORT_GRAIN) {
+            func(first / SORT_GRAIN, first, std::min(first + SORT_GRAIN, count));
+        }
+    });
+}
+}  // namespace
+
+void radixSort(std::vector<SortPair>& items, std::vector<SortPair>& scratch) {
+    const std::size_t count = items.size();
+    if (count < 2) {
+        return;
+    }
+    scratch.resize(count);
+    std::uint64_t differing = 0;
+    for (const auto& item : items) {
+        differing |= item.key ^ items.front().key;
+    }
+
+    std::vector<Histogram> histograms((count + SORT_GRAIN - 1) / SORT_GRAIN);
+    std::vector<SortPair>* src = &items;
+    std::vector<SortPair>* dst = &scratch;
+    for (std::size_t pass = 0; pass < PASSES; ++pass) {
+        const std::size_t shift = pass * RADIX_BITS;
+        if (((differing >> shift) & (BUCKETS - 1)) == 0) {
+            continue;
+        }
+        forEachChunk(count, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+            auto& histogram = histograms[chunk];
+            histogram.fill(0);
+            for (std::size_t i = begin; i < end; ++i) {
+                ++histogram[((*src)[i].key >> shift) & (BUCKETS - 1)];
+            }
+        });
+        // 桶在前、块在后求前缀和，同一个桶内保持块的顺序，排序是稳定的
+        std::size_t offset = 0;
+        for (std::size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+            for (auto& histogram : histograms) {
+                offset += std::exchange(histogram[bucket], offset);
+            }
+        }
+        forEachChunk(count, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+            auto& cursor = histograms[chunk];
+            for (std::size_t i = begin; i < end; ++i) {
+                const auto& item = (*src)[i];
+                (*dst)[cursor[(item.key >> shift) & (BUCKETS - 1)]++] = item;
+            }
+        });
+        std::swap(src, dst);
+    }
+    if (src != &items) {
+        items.swap(scratch);
+    }
+}
+
+}  // namespace common
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace common {
+
+struct SortPair {
+        std::uint64_t key;
+        std::uint32_t value;
+};
+
+/// 按 key 升序的稳定 LSD 基数排序，每趟 8 位，所有元素都相同的字节直接跳过。
+/// 每趟先按块并行统计直方图，再按块并行分发；scratch 作为交换缓冲，大小由函数调整
+void radixSort(std::vector<SortPair>& items, std::vector<SortPair>& scratch);
+
+}  // namespace common
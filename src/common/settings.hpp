@@ -56,6 +56,13 @@ struct Values {
                                                       Category::render};
         Setting<bool, false> use_dynamic_rendering{linkage, true, "use_dynamic_rendering",
                                                    Category::render};
+        Setting<bool, false> use_object_id_buffer{linkage, false, "use_object_id_buffer",
+                                                  Category::render};
+        Setting<bool, false> bake_vertex_ao{linkage, true, "bake_vertex_ao", Category::render};
+        Setting<bool, false> use_frustum_culling{linkage, true, "use_frustum_culling",
+                                                 Category::render};
+        Setting<bool, false> use_occlusion_culling{linkage, true, "use_occlusion_culling",
+                                                   Category::render};
 
         SwitchableSetting<enums::LogLevel, true> log_level{
             linkage,       enums::LogLevel::debug,      "level",
@@ -82,6 +89,21 @@ struct Values {
                                                              "astc_recompression", Category::core,
                                                              Specialization::List};
         Setting<bool, false> use_debug_ui{linkage, true, "use_debug_ui", Category::system};
+        // 有场景快照时按相机位置分格子流式加载模型，预算单位是 MiB，距离单位是米
+        Setting<bool, false> use_scene_streaming{linkage, true, "use_scene_streaming",
+                                                 Category::core};
+        Setting<int, true> streaming_cell_size{
+            linkage, 32, 4, 1024, "streaming_cell_size", Category::core, Specialization::Scalar,
+            true};
+        Setting<int, true> streaming_load_radius{
+            linkage, 96, 8, 4096, "streaming_load_radius", Category::core, Specialization::Scalar,
+            true};
+        Setting<int, true> streaming_host_budget{
+            linkage, 2048, 64, 65536, "streaming_host_budget", Category::core,
+            Specialization::Scalar, true};
+        Setting<int, true> streaming_device_budget{
+            linkage, 2048, 64, 65536, "streaming_device_budget", Category::core,
+            Specialization::Scalar, true};
         Resolution resolution{DEFAULT_RESOLUTION};
 };
 
@@ -0,0 +1,10 @@
+#pragma once
+
+// 选择可用的 4 宽 SIMD 指令集：x86-64 的基线 SSE2，ARM 的 NEON，其他平台走标量路径
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define GRAPHICS_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define GRAPHICS_SIMD_NEON 1
+#endif
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace core {
+
+// 轴对齐包围盒
+struct AABB {
+        glm::vec3 min{0.F};
+        glm::vec3 max{0.F};
+
+        [[nodiscard]] auto center() const -> glm::vec3 { return (min + max) * 0.5F; }
+        [[nodiscard]] auto extent() const -> glm::vec3 { return (max - min) * 0.5F; }
+
+        // 变换后重新求包围盒（Arvo 方法）
+        [[nodiscard]] auto transform(const glm::mat4& m) const -> AABB {
+            glm::vec3 new_min{m[3]};
+            glm::vec3 new_max{m[3]};
+            for (int col = 0; col < 3; ++col) {
+                for (int row = 0; row < 3; ++row) {
+                    const float a = m[col][row] * min[col];
+                    const float b = m[col][row] * max[col];
+                    new_min[row] += glm::min(a, b);
+                    new_max[row] += glm::max(a, b);
+                }
+            }
+            return {.min = new_min, .max = new_max};
+        }
+};
+
+// 视锥体，平面法线指向内部：dot(n, p) + d >= 0 表示在内侧
+class Frustum {
+    public:
+        enum Plane : std::uint8_t { Left = 0, Right, Bottom, Top, Near, Far, Count };
+
+        Frustum() = default;
+        // 从 proj * view 提取平面，深度范围为 [0, 1]（GLM_FORCE_DEPTH_ZERO_TO_ONE）
+        explicit Frustum(const glm::mat4& view_proj) {
+            const glm::mat4 m = glm::transpose(view_proj);
+            planes_[Left] = m[3] + m[0];
+            planes_[Right] = m[3] - m[0];
+            planes_[Bottom] = m[3] + m[1];
+            planes_[Top] = m[3] - m[1];
+            planes_[Near] = m[2];
+            planes_[Far] = m[3] - m[2];
+            for (auto& plane : planes_) {
+                plane /= glm::length(glm::vec3(plane));
+            }
+        }
+
+        // 把世界空间的视锥变换到 model 的局部空间（平面未归一化，只用于符号测试）
+        Frustum(const Frustum& world, const glm::mat4& model) {
+            const glm::mat4 model_t = glm::transpose(model);
+            for (std::size_t i = 0; i < planes_.size(); ++i) {
+                planes_[i] = model_t * world.planes_[i];
+            }
+        }
+
+        // 取 NDC 子矩形 [x0, x1] x [y0, y1] 对应的子视锥
+        static auto fromNdcRect(const glm::mat4& view_proj, glm::vec2 ndc_min, glm::vec2 ndc_max)
+            -> Frustum {
+            const glm::vec2 size = glm::max(ndc_max - ndc_min, glm::vec2{1e-6F});
+            const glm::vec2 scale = 2.F / size;
+            const glm::vec2 offset = -(ndc_min + ndc_max) / size;
+            glm::mat4 remap{1.F};
+            remap[0][0] = scale.x;
+            remap[1][1] = scale.y;
+            remap[3][0] = offset.x;
+            remap[3][1] = offset.y;
+            return Frustum{remap * view_proj};
+        }
+
+        [[nodiscard]] auto planes() const -> const std::array<glm::vec4, Count>& { return planes_; }
+
+        [[nodiscard]] auto contains(const glm::vec3& point) const -> bool {
+            for (const auto& plane : planes_) {
+                if (glm::dot(glm::vec3(plane), point) + plane.w < 0.F) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 保守测试：完全在某个平面外侧时返回 false
+        [[nodiscard]] auto intersects(const AABB& box) const -> bool {
+            const glm::vec3 center = box.center();
+            const glm::vec3 extent = box.extent();
+            for (const auto& plane : planes_) {
+                const glm::vec3 normal{plane};
+                const float radius = glm::dot(extent, glm::abs(normal));
+                if (glm::dot(normal, center) + plane.w < -radius) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] auto intersectsSphere(const glm::vec3& center, float radius) const -> bool {
+            for (const auto& plane : planes_) {
+                if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 三角形只有三个顶点都位于同一平面外侧时才被剔除（保守）
+        [[nodiscard]] auto intersectsTriangle(const glm::vec3& a, const glm::vec3& b,
+                                              const glm::vec3& c) const -> bool {
+            for (const auto& plane : planes_) {
+                const glm::vec3 normal{plane};
+                if (glm::dot(normal, a) + plane.w < 0.F && glm::dot(normal, b) + plane.w < 0.F &&
+                    glm::dot(normal, c) + plane.w < 0.F) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        std::array<glm::vec4, Count> planes_{};
+};
+
+}  // namespace core
@@ -10,6 +10,9 @@
 #include "effects/model/multi_mesh_model.hpp"
 #include "effects/model/model.hpp"
 #include "effects/cubemap/skybox.hpp"
+#include "effects/light/point_light.hpp"
+#include "effects/scene_snapshot.hpp"
+#include "effects/scene_streamer.hpp"
 #include "graphics/gui.hpp"
 #include "resource/mesh_instance.hpp"
 #include "system/pick_system.hpp"
@@ -22,22 +25,76 @@
 #include "system/logger_system.hpp"
 #include <spdlog/spdlog.h>
 #include "common/file.hpp"
+#include <chrono>
 #include <mutex>
 // module core;
 
 namespace core {
+namespace {
+// 每帧留给 effect 的时间，超出后剩下的推迟到下一帧
+constexpr auto EFFECT_FRAME_BUDGET = std::chrono::milliseconds{2};
+}  // namespace
+
 struct System::Impl {
     private:
         std::atomic<bool> is_shut_down_;
         std::unique_ptr<render::RenderBase> render_base;
         std::unique_ptr<graphics::ResourceManager> resource_manager;
         std::unique_ptr<world::World> world_;
+        // 开启场景流式加载时由它管理快照中的模型，先于 world_ 释放
+        std::unique_ptr<graphics::effects::SceneStreamer> scene_streamer_;
+        // 分摊到多帧执行的加载工作，引用 world_ 和 resource_manager
+        graphics::effects::EffectManager effect_manager_;
 
         render::frame::FramebufferConfig frame_config_;
         render::CleanValue frameClean{};
         graphics::ui::StatusBarData statusData;
         std::mutex mutex_;
 
+        static auto streamingSettings() -> world::CellStreamer::Settings {
+            const auto& values = settings::values;
+            const auto cell_size = static_cast<float>(values.streaming_cell_size.GetValue());
+            const auto load_radius = static_cast<float>(values.streaming_load_radius.GetValue());
+            const auto mebibytes = [](int value) {
+                return static_cast<std::uint64_t>(value) << 20U;
+            };
+            // 卸载半径多留一个格子，相机在边界附近移动时不会反复加载
+            return {.cell_size = cell_size,
+                    .load_radius = load_radius,
+                    .unload_radius = load_radius + cell_size,
+                    .budget = {.host_bytes = mebibytes(values.streaming_host_budget.GetValue()),
+                               .device_bytes =
+                                   mebibytes(values.streaming_device_budget.GetValue())}};
+        }
+
+        static void add_model(world::World& world, graphics::effects::Model& model) {
+            std::visit(
+                [&world](auto& drawable) {
+                    using T = std::decay_t<decltype(drawable)>;
+                    if constexpr (std::is_same_v<std::shared_ptr<graphics::effects::LightModel>,
+                                                 T>) {
+                        world.addDrawable(drawable);
+                    } else if constexpr (std::is_same_v<
+                                             std::shared_ptr<graphics::effects::ModelForMultiMesh>,
+                                             T>) {
+                        world.addDrawable(drawable);
+                    } else {
+                        ASSERT_MSG(false, "unknown model type");  // NOLINT
+                    }
+                },
+                model);
+        }
+
+        static auto load_model_assets(graphics::ResourceManager& manager, world::World& world)
+            -> std::generator<std::monostate> {
+            auto on_loaded = [&world](graphics::effects::Model& model) { add_model(world, model); };
+            for (auto step : graphics::effects::load_model_asset_steps(manager, on_loaded)) {
+                co_yield step;
+            }
+            // 全部加载后再提交拾取场景
+            graphics::PickingSystem::commit();
+        }
+
         void load_resource() {
             std::string viking_obj_path = "backpack";
             std::string model_shader_name = "model";
@@ -51,20 +108,35 @@ struct System::Impl {
                 resourceManager->addGraphShader(shader_name);
             }
             resourceManager->addComputeShader(particle_shader);
+            resourceManager->addVertexShader(model_shader_name + "_instanced");
 
-            auto models = graphics::effects::load_model_form_asset(*resourceManager);
+            // 有场景快照时直接按快照恢复（或者流式加载），否则逐个解析 JSON 资产。
+            // JSON 资产在快照保存后改过时快照已经过期，丢弃它重新解析
+            std::vector<graphics::effects::Model> models;
+            auto snapshot =
+                graphics::effects::load_scene_snapshot(graphics::effects::scene_snapshot_path());
+            if (snapshot && snapshot->asset_hash != graphics::effects::model_asset_hash()) {
+                SPDLOG_INFO("scene snapshot is stale, reload model assets");
+                snapshot.reset();
+            }
+            if (snapshot && settings::values.use_scene_streaming.GetValue()) {
+                scene_streamer_ = std::make_unique<graphics::effects::SceneStreamer>(
+                    std::move(*snapshot), *resourceManager, *world_, streamingSettings());
+            } else if (snapshot) {
+                auto scene = graphics::effects::restore_scene_snapshot(*snapshot, *resourceManager);
+                models = std::move(scene.models);
+                for (auto& light : scene.lights) {
+                    world_->addDrawable(light);
+                }
+            } else {
+                // 没有快照时逐个解析 JSON 资产，每帧在预算内加载一部分，窗口不会卡住
+                effect_manager_.add(
+                    graphics::effects::Effect{load_model_assets(*resourceManager, *world_),
+                                              graphics::effects::EffectPriority::Low});
+            }
 
-            for(auto& model : models){
-                std::visit([world = this->world_.get()](auto& drawable){
-                    using T = std::decay_t<decltype(drawable)>;
-                    if constexpr(std::is_same_v<std::shared_ptr<graphics::effects::LightModel>, T>){
-                        world->addDrawable(drawable);
-                    } else if constexpr(std::is_same_v<std::shared_ptr<graphics::effects::ModelForMultiMesh>, T>){
-                        world->addDrawable(drawable);
-                    } else {
-                        ASSERT_MSG(false, "unknown model type");//NOLINT
-                    }
-                }, model);
+            for (auto& model : models) {
+                add_model(*world_, model);
             }
             auto sky_box = std::make_shared<graphics::effects::SkyBox>(*resourceManager);
             world_->addDrawable(sky_box);
@@ -83,6 +155,20 @@ struct System::Impl {
             if (render_base) {
                 Render()->composite(std::span{&frame_config_, 1});
             }
+            // 没加载完的资产先加载完，快照才包含所有模型
+            while (effect_manager_.size() > 0) {
+                effect_manager_.run();
+            }
+            if (world_) {
+                auto snapshot = scene_streamer_
+                                    ? scene_streamer_->capture()
+                                    : graphics::effects::capture_scene_snapshot(*world_);
+                // 运行期间新加的模型也写了 JSON，按保存时的资产计算
+                snapshot.asset_hash = graphics::effects::model_asset_hash();
+                graphics::effects::save_scene_snapshot(snapshot,
+                                                       graphics::effects::scene_snapshot_path());
+            }
+            scene_streamer_.reset();
             world_.reset();
             resource_manager.reset();
             render_base.reset();
@@ -103,6 +189,10 @@ struct System::Impl {
             frameClean.hight = frame_config_.height;
             frameClean.framebuffer.color_formats.at(0) =
                 render::surface::PixelFormat::B8G8R8A8_UNORM;
+            if (settings::values.use_object_id_buffer.GetValue()) {
+                frameClean.framebuffer.color_formats.at(render::OBJECT_ID_COLOR_ATTACHMENT) =
+                    render::surface::PixelFormat::R32G32B32A32_UINT;
+            }
             frameClean.framebuffer.depth_format = render::surface::PixelFormat::D32_FLOAT;
             frameClean.framebuffer.extent = {
                 .width = frame_config_.width, .height = frame_config_.height, .depth = 1};
@@ -120,6 +210,11 @@ struct System::Impl {
             graphics->clean(frameClean);
             input_system_->GetMouse()->setCapture(graphics::ui::IsMouseControlledByImGui());
             input_system_->GetKeyboard()->setCapture(graphics::ui::IsKeyboardControlledByImGui());
+            if (scene_streamer_) {
+                const auto camera = world_->getEntity(world::WorldEntityType::CAMERA);
+                scene_streamer_->update(camera.getComponent<ecs::CameraComponent>().eye());
+            }
+            effect_manager_.run(EFFECT_FRAME_BUDGET);
             world_->update(*window, *resource_manager, *input_system_);
 
             world_->draw(graphics);
@@ -4,10 +4,3 @@
 #include "components/camera_component.hpp"
 #include "components/render_state_component.hpp"
 #include "ecs/scene/entity.hpp"
-namespace ecs {
-struct Outliner {
-        Entity entity;
-        std::vector<Entity> children;
-};
-
-}  // namespace ecs
\ No newline at end of file
@@ -31,4 +31,11 @@ struct TransformComponent {
         // 添加平移方法
         void translate(const glm::vec3& delta) { translation += delta; }
 };
+
+// TransformHierarchy 的计算结果，只在所在子树发生变化时重写并递增 version
+struct WorldTransformComponent {
+        ::glm::mat4 world{1.F};
+        ::glm::mat4 normal{1.F};  // inverseTranspose(mat3(world))
+        unsigned int version{0};
+};
 }  // namespace ecs
\ No newline at end of file
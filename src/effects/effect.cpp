@@ -4,6 +4,10 @@
 #include "effects/model/model.hpp"
 #include "common/file.hpp"
 #include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <tracy/Tracy.hpp>
+#include <xxhash.h>
+#include <algorithm>
 #include <fstream>
 constexpr std::string_view MODEL_ASSET_PATH = "models";
 namespace graphics::effects {
@@ -64,24 +68,60 @@ auto create_model(const ModelEffectInfo& info, ResourceManager& manager) -> Mode
 }
 auto load_model_form_asset(ResourceManager& manager) -> std::vector<Model> {
     std::vector<Model> models;
+    for ([[maybe_unused]] auto step :
+         load_model_asset_steps(manager, [&models](Model& model) { models.push_back(model); })) {
+    }
+    return models;
+}
+
+auto load_model_asset_steps(ResourceManager& manager, std::function<void(Model&)> on_loaded)
+    -> std::generator<std::monostate> {
     auto asset_path = common::FS::get_module_path(common::FS::ModuleType::Asset) / MODEL_ASSET_PATH;
-    if(!std::filesystem::exists(asset_path)){
-        return models;
+    if (!std::filesystem::exists(asset_path)) {
+        co_return;
     }
+    std::vector<std::filesystem::path> paths;
     for (const auto& entry : std::filesystem::directory_iterator(asset_path)) {
-        if (entry.is_regular_file()) {
-            const auto& path = entry.path();
-            if (path.extension() == ".json") {
-                nlohmann::json json_data;
-                std::ifstream f(path);
-                f >> json_data;
-                auto info = deserialize_effect_info_from_asset(json_data);
-                models.push_back(create_model(info, manager));
-            }
+        if (entry.is_regular_file() && entry.path().extension() == ".json") {
+            paths.push_back(entry.path());
         }
     }
+    std::ranges::sort(paths);
+    for (const auto& path : paths) {
+        nlohmann::json json_data;
+        std::ifstream f(path);
+        f >> json_data;
+        auto info = deserialize_effect_info_from_asset(json_data);
+        auto model = create_model(info, manager);
+        on_loaded(model);
+        co_yield {};
+    }
+}
 
-    return models;
+auto model_asset_hash() -> std::uint64_t {
+    auto asset_path = common::FS::get_module_path(common::FS::ModuleType::Asset) / MODEL_ASSET_PATH;
+    if (!std::filesystem::exists(asset_path)) {
+        return 0;
+    }
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(asset_path)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".json") {
+            paths.push_back(entry.path());
+        }
+    }
+    if (paths.empty()) {
+        return 0;
+    }
+    // 目录遍历顺序不固定，按文件名排序后再拼接
+    std::ranges::sort(paths);
+    std::string key;
+    for (const auto& path : paths) {
+        key += path.filename().string();
+        key += '\0';
+        key += std::to_string(common::FS::file_hash(path.string()).value_or(0));
+        key += '\0';
+    }
+    return XXH3_64bits(key.data(), key.size());
 }
 
 void save_model_to_asset(const ModelEffectInfo& info) {
@@ -96,4 +136,63 @@ void save_model_to_asset(const ModelEffectInfo& info) {
     }
 }
 
-}  // namespace graphics::effects
\ No newline at end of file
+void EffectManager::run(Duration budget) {
+    ZoneScoped;
+    using clock = std::chrono::steady_clock;
+    ++frame_;
+    stats_ = {};
+    order_.resize(effects_.size());
+    for (std::size_t i = 0; i < order_.size(); ++i) {
+        order_[i] = i;
+    }
+    std::ranges::sort(order_, [this](std::size_t a, std::size_t b) {
+        const auto& lhs = effects_[a];
+        const auto& rhs = effects_[b];
+        if (lhs.priority_ != rhs.priority_) {
+            return lhs.priority_ < rhs.priority_;
+        }
+        return lhs.last_run_ != rhs.last_run_ ? lhs.last_run_ < rhs.last_run_ : a < b;
+    });
+
+    finished_.assign(effects_.size(), 0);
+    const auto start = clock::now();
+    for (const auto index : order_) {
+        if (stats_.resumed > 0 && clock::now() - start >= budget) {
+            ++stats_.deferred;
+            continue;
+        }
+        auto& effect = effects_[index];
+        const auto step_start = clock::now();
+        finished_[index] = effect.update() ? 0 : 1;
+        const auto step = clock::now() - step_start;
+        effect.last_run_ = frame_;
+        ++stats_.resumed;
+        stats_.slowest_step = std::max(stats_.slowest_step, step);
+        if (step > budget) {
+            ++stats_.overruns;
+        }
+    }
+    stats_.elapsed = clock::now() - start;
+    if (budget != UNLIMITED && stats_.elapsed > budget) {
+        ++overrun_frames_;
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        spdlog::debug("effect frame {} overrun: {} us, slowest step {} us", frame_,
+                      duration_cast<microseconds>(stats_.elapsed).count(),
+                      duration_cast<microseconds>(stats_.slowest_step).count());
+    }
+
+    // 保持其余 effect 的顺序
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < effects_.size(); ++i) {
+        if (finished_[i] == 0) {
+            if (kept != i) {
+                effects_[kept] = std::move(effects_[i]);
+            }
+            ++kept;
+        }
+    }
+    effects_.erase(effects_.begin() + static_cast<std::ptrdiff_t>(kept), effects_.end());
+}
+
+}  // namespace graphics::effects
@@ -4,10 +4,14 @@
 #include "render_core/pipeline_state.h"
 #include <string>
 #include <memory>
+#include <functional>
 #include <variant>
 #include <generator>
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdint>
 
 namespace ecs {
 class Scene;
@@ -40,14 +44,27 @@ auto create_model(const ModelEffectInfo& info, ResourceManager& manager) -> Mode
 void save_model_to_asset(const ModelEffectInfo& info);
 
 auto load_model_form_asset(ResourceManager& manager) -> std::vector<Model>;
+// 按文件名顺序逐个加载模型 JSON 资产，每创建一个交给 on_loaded 后 co_yield，由 EffectManager 分摊到多帧
+auto load_model_asset_steps(ResourceManager& manager, std::function<void(Model&)> on_loaded)
+    -> std::generator<std::monostate>;
+// 所有模型 JSON 资产的文件名和内容的哈希，没有资产时为 0。场景快照据此判断是否过期
+auto model_asset_hash() -> std::uint64_t;
 
 auto getEffectsScene() -> ecs::Scene&;
 
+// 预算不足时先执行优先级高的 effect
+enum class EffectPriority : std::uint8_t { High, Normal, Low };
+
+/// 协程形式的 effect，每次 co_yield 是一个可以让出到下一帧的位置。
+/// 耗时的工作（粒子重置、资源预热、场景切换）应该拆成多步，每步之间 co_yield
 struct Effect {
         std::generator<std::monostate> coroutine_;
         decltype(coroutine_.begin()) iter_;
-        explicit Effect(std::generator<std::monostate> coroutine)
-            : coroutine_(std::move(coroutine)), iter_(coroutine_.begin()) {}
+        EffectPriority priority_{EffectPriority::Normal};
+        std::uint64_t last_run_{0};  // 最近一次执行所在的帧，同优先级时等得久的先执行
+        explicit Effect(std::generator<std::monostate> coroutine,
+                        EffectPriority priority = EffectPriority::Normal)
+            : coroutine_(std::move(coroutine)), iter_(coroutine_.begin()), priority_(priority) {}
         auto update() -> bool {
             if (iter_ == coroutine_.end()) {
                 return false;
@@ -57,16 +74,37 @@ struct Effect {
         }
 };
 
+/// 每帧按优先级恢复 effect，每个 effect 每帧最多执行一步。
+/// 设置了时间预算时，用完预算后剩下的 effect 推迟到下一帧；每帧至少执行一步，保证总能推进
 class EffectManager {
     public:
+        using Duration = std::chrono::steady_clock::duration;
+        static constexpr Duration UNLIMITED = Duration::max();
+
+        struct FrameStats {
+                std::size_t resumed{0};
+                std::size_t deferred{0};   // 预算用完，推迟到下一帧
+                std::size_t overruns{0};   // 单步耗时超过整帧预算
+                Duration elapsed{0};
+                Duration slowest_step{0};
+        };
+
         void add(Effect effect) { effects_.emplace_back(std::move(effect)); }
 
-        void run() {
-            std::erase_if(effects_, [](Effect& effect)-> bool { return !effect.update(); });
-        }
+        void run(Duration budget = UNLIMITED);
+
+        [[nodiscard]] auto size() const -> std::size_t { return effects_.size(); }
+        [[nodiscard]] auto frameStats() const -> const FrameStats& { return stats_; }
+        // 累计超出预算的帧数
+        [[nodiscard]] auto overrunFrames() const -> std::uint64_t { return overrun_frames_; }
 
     private:
         std::vector<Effect> effects_;
+        std::vector<std::size_t> order_;
+        std::vector<std::uint8_t> finished_;
+        FrameStats stats_;
+        std::uint64_t frame_{0};
+        std::uint64_t overrun_frames_{0};
 };
 
 }  // namespace graphics::effects
\ No newline at end of file
@@ -1,6 +1,4 @@
 set(sources
-    light/light.hpp
-    light/light.cpp
     light/point_light.hpp
 
     model/model.hpp
@@ -11,4 +9,10 @@ set(sources
     particle/particle.cpp
     effect.hpp
     effect.cpp
+    scene_snapshot.hpp
+    scene_snapshot.cpp
+    scene_streamer.hpp
+    scene_streamer.cpp
+    stress_scene.hpp
+    stress_scene.cpp
 )
\ No newline at end of file
@@ -4,7 +4,6 @@
 #include "common/common_funcs.hpp"
 #include "core/frame_info.hpp"
 #include "effects/effect.hpp"
-#include "effects/light/light.hpp"
 #include "ecs/components/transform_component.hpp"
 #include "ecs/components/light_component.hpp"
 #include "world/world.hpp"
@@ -50,7 +49,6 @@ class PointLightEffect {
             default_lightComponent.range = createInfo.radius;
             entity_.addComponent<ecs::LightComponent>(default_lightComponent);
             lightComponent = &entity_.getComponent<ecs::LightComponent>();  // NOLINT
-            point_light.setUBO<LightUBO>(&light_ubo);
             point_light.setPushConstant(&push_constants);
         }
         ~PointLightEffect() = default;
@@ -77,7 +75,6 @@ class PointLightEffect {
             default_lightComponent.range = radius;
             entity_.addComponent<ecs::LightComponent>(default_lightComponent);
             lightComponent = &entity_.getComponent<ecs::LightComponent>();  // NOLINT
-            point_light.setUBO<LightUBO>(&light_ubo);
             point_light.setPushConstant(&push_constants);
         }
 
@@ -94,8 +91,6 @@ class PointLightEffect {
             glm::vec4 localOffset(transform->translation, 1.f);
 
             transform->translation = glm::vec3(rotation * localOffset);
-            light_ubo.projection = frameInfo.camera->getProjection();
-            light_ubo.view = frameInfo.camera->getView();
 
             world.addLight({.id = id, .light = lightComponent, .transform = transform});
         }
@@ -116,8 +111,7 @@ class PointLightEffect {
 
     private:
         using PointLightInstance =
-            MeshInstance<PointLightPushConstants, render::PrimitiveTopology::Triangles, LightUBO>;
-        LightUBO light_ubo;
+            MeshInstance<PointLightPushConstants, render::PrimitiveTopology::Triangles>;
         PointLightPushConstants push_constants;
         PointLightInstance point_light;
         ecs::RenderStateComponent* render_state{};
@@ -1,5 +1,6 @@
 #include "model.hpp"
 
+#include "common/settings.hpp"
 #include "system/pick_system.hpp"
 #include "resource/obj/model_mesh.hpp"
 #include "effects/effect.hpp"
@@ -18,45 +19,117 @@ auto uploadMeshMaterialResource(graphics::ResourceManager& manager, const SubMes
         materialResource.ambientTextures =
             manager.addKtxTexture(subMesh.material.ambientTextures[0]);
     } else {
-        materialResource.ambientTextures =
-            manager.getTexture(std::string(DEFAULT_1X1_WRITE_TEXTURE));
+        materialResource.ambientTextures = manager.getDefaultTexture();
     }
 
     if (!subMesh.material.diffuseTextures.empty()) {
         materialResource.diffuseTextures =
             manager.addKtxTexture(subMesh.material.diffuseTextures[0]);
     } else {
-        materialResource.diffuseTextures =
-            manager.getTexture(std::string(DEFAULT_1X1_WRITE_TEXTURE));
+        materialResource.diffuseTextures = manager.getDefaultTexture();
     }
 
     if (!subMesh.material.specularTextures.empty()) {
         materialResource.specularTextures =
             manager.addKtxTexture(subMesh.material.specularTextures[0]);
     } else {
-        materialResource.specularTextures =
-            manager.getTexture(std::string(DEFAULT_1X1_WRITE_TEXTURE));
+        materialResource.specularTextures = manager.getDefaultTexture();
     }
     if (!subMesh.material.normalTextures.empty()) {
         materialResource.normalTextures = manager.addKtxTexture(subMesh.material.normalTextures[0]);
     } else {
-        materialResource.normalTextures =
-            manager.getTexture(std::string(DEFAULT_1X1_WRITE_TEXTURE));
+        materialResource.normalTextures = manager.getDefaultTexture();
     }
     return {materialResource, materialUBO};
 }
 
+void ModelResourceRefs::acquire(ResourceManager& manager, render::MeshId mesh,
+                                const MeshMaterialResource& material) {
+    manager.acquireMesh(mesh);
+    meshes_.push_back(mesh);
+    for (const auto texture : {material.ambientTextures, material.diffuseTextures,
+                               material.specularTextures, material.normalTextures}) {
+        manager.acquireTexture(texture);
+        textures_.push_back(texture);
+    }
+}
+
+void ModelResourceRefs::release(ResourceManager& manager) {
+    for (const auto mesh : meshes_) {
+        manager.releaseMesh(mesh);
+    }
+    for (const auto texture : textures_) {
+        manager.releaseTexture(texture);
+    }
+    meshes_.clear();
+    textures_.clear();
+}
+
+void MeshDraws::registerDraws(world::RenderRegistry& registry, id_t owner,
+                              std::span<const ModelMeshInstance> meshes,
+                              std::span<const MaterialUBO> materials,
+                              const MeshVisibility& visibility) {
+    registry_ = &registry;
+    entities_.clear();
+    entities_.reserve(meshes.size());
+    for (std::size_t i = 0; i < meshes.size(); ++i) {
+        const auto& mesh = meshes[i];
+        world::DrawMaterial material;
+        material.shaders[static_cast<uint32_t>(shader::Stage::Vertex)] = mesh.vertexShaderHash();
+        material.shaders[static_cast<uint32_t>(shader::Stage::Fragment)] =
+            mesh.fragmentShaderHash();
+        material.instanced_vertex_shader = mesh.instancedVertexShaderHash();
+        material.topology = mesh.getPrimitiveTopology();
+        material.pipeline_state = mesh.pipelineState();
+        std::ranges::copy(mesh.getMaterialIds(), material.textures.begin());
+        material.setUniform(materials[i].as_byte_span());
+        const world::DrawMesh draw_mesh{.mesh = mesh.getMeshId(),
+                                        .index_offset = mesh.getRenderCommand().indexOffset,
+                                        .index_count = mesh.getRenderCommand().indexCount};
+        const world::DrawVisibility draw_visibility{.proxy = visibility.proxy(i),
+                                                    .visible = mesh.render_state->visible};
+        entities_.push_back(
+            registry.addMeshDraw(owner, {}, draw_mesh, material, draw_visibility));
+    }
+}
+
+void MeshDraws::setVisible(std::span<const ModelMeshInstance> meshes, bool model_visible) {
+    if (registry_ == nullptr) {
+        return;
+    }
+    for (std::size_t i = 0; i < entities_.size(); ++i) {
+        registry_->meshDraw<world::DrawVisibility>(entities_[i]).visible =
+            model_visible && meshes[i].render_state->visible;
+    }
+}
+
+void MeshDraws::setTransform(std::span<const ModelMeshInstance> meshes, id_t owner,
+                             const ecs::WorldTransformComponent& transform) {
+    if (registry_ == nullptr) {
+        return;
+    }
+    for (std::size_t i = 0; i < entities_.size(); ++i) {
+        auto& draw_transform = registry_->meshDraw<world::DrawTransform>(entities_[i]);
+        draw_transform.modelMatrix = transform.world;
+        draw_transform.normalMatrix = transform.normal;
+        draw_transform.setObjectId(owner, meshes[i].getId());
+    }
+}
+
 LightModel::LightModel(graphics::ResourceManager& manager, const ModelResourceName& names,
                        const std::string& name)
-    : id(getCurrentId()) {
+    : names_(names), id(getCurrentId()) {
     auto shader_hash = manager.getShaderHash<ShaderHash>(names.shader_name);
 
-    auto mesh_id = manager.addModel(names.mesh_name);
+    // 同一个模型文件只解析一次，场景流式加载时也会预先放入 ResourceManager
+    const auto mesh_handle = manager.findMesh(names.mesh_name);
+    auto mesh_id = mesh_handle ? manager.getMesh(mesh_handle) : manager.addModel(names.mesh_name);
     auto sub_mesh = manager.getModelSubMesh(mesh_id);
     materials.reserve(sub_mesh.size());
     meshes.reserve(sub_mesh.size());
     for (const auto& mesh : sub_mesh) {
         auto [materialResource, materialUBO] = uploadMeshMaterialResource(manager, mesh);
+        resources.acquire(manager, mesh_id, materialResource);
         materials.push_back(materialUBO);
         meshes.emplace_back(
             render::RenderCommand{
@@ -65,11 +138,10 @@ LightModel::LightModel(graphics::ResourceManager& manager, const ModelResourceNa
             },
             shader_hash, name + "mesh", mesh_id, materialResource);
         meshes.back().setUBO(&materials.back());
-        meshes.back().setUBO(&light_ubo);
-        meshes.back().setPushConstant(&push_constant);
         auto vertex = manager.getMeshVertex(mesh_id);
         auto indics = manager.getMeshIndics(mesh_id);
         PickingSystem::upload_vertex(id, meshes.back().getId(), vertex, indics);
+        visibility.addMesh(vertex, indics.subspan(mesh.indexOffset, mesh.indexCount));
         mesh_ids.insert(meshes.back().getId());
     }
 
@@ -78,14 +150,81 @@ LightModel::LightModel(graphics::ResourceManager& manager, const ModelResourceNa
     entity_.addComponent<ecs::TransformComponent>();
     render_state = &entity_.getComponent<ecs::RenderStateComponent>();  // NOLINT
     transform = &entity_.getComponent<ecs::TransformComponent>();       // NOLINT
+    entity_.addComponent<ecs::WorldTransformComponent>();
+    world_transform = &entity_.getComponent<ecs::WorldTransformComponent>();  // NOLINT
+}
+
+void LightModel::update(const core::FrameInfo& /*frameInfo*/, world::World& world) {
+    draws.setVisible(meshes, render_state->visible);
+    // 世界矩阵由 TransformHierarchy 计算，没有变化时跳过变换组件和拾取场景的更新
+    if (world_transform->version == transform_version) {
+        return;
+    }
+    transform_version = world_transform->version;
+    draws.setTransform(meshes, id, *world_transform);
+    for (const auto& mesh : meshes) {
+        // 拾取场景按 mesh id 建立几何体
+        world.updatePickTransform(mesh.getId(), world_transform->world);
+    }
+    visibility.setTransform(world_transform->world);
 }
 
-void LightModel::update(const core::FrameInfo& frameInfo, world::World& world) {
-    updateLightUBO(frameInfo, light_ubo, world);
+void LightModel::releasePicking() {
+    for (const auto mesh_id : mesh_ids) {
+        PickingSystem::remove_mesh(mesh_id);
+    }
+}
 
-    push_constant.modelMatrix = transform->mat4();
-    push_constant.normalMatrix = transform->normalMatrix();
-    PickingSystem::update_transform(id, *transform);
+void MeshVisibility::addMesh(std::span<const glm::vec3> vertices,
+                             std::span<const std::uint32_t> indices) {
+    sources_.push_back({.vertices = vertices, .indices = indices});
+}
+
+void MeshVisibility::registerCulling(CullingBvh& bvh, OcclusionBuffer& occlusion) {
+    culling_ = &bvh;
+    proxies_.clear();
+    occluders_.clear();
+    if (bounds_.size() != sources_.size()) {
+        bounds_.clear();
+        for (const auto& source : sources_) {
+            bounds_.push_back(computeBounds(source.vertices, source.indices));
+        }
+    }
+    for (std::size_t i = 0; const auto& source : sources_) {
+        proxies_.push_back(bvh.add(bounds_[i++]));
+        occluders_.push_back(settings::values.use_occlusion_culling.GetValue()
+                                 ? occlusion.addOccluder(source.vertices, source.indices)
+                                 : OcclusionBuffer::INVALID_OCCLUDER);
+    }
+    occlusion_ = &occlusion;
+}
+
+void MeshVisibility::unregisterCulling() {
+    if (culling_ == nullptr) {
+        return;
+    }
+    for (std::size_t i = 0; i < proxies_.size(); ++i) {
+        culling_->remove(proxies_[i]);
+        if (occluders_[i] != OcclusionBuffer::INVALID_OCCLUDER) {
+            occlusion_->removeOccluder(occluders_[i]);
+        }
+    }
+    proxies_.clear();
+    occluders_.clear();
+    culling_ = nullptr;
+    occlusion_ = nullptr;
+}
+
+void MeshVisibility::setTransform(const glm::mat4& world) {
+    if (culling_ == nullptr) {
+        return;
+    }
+    for (std::size_t i = 0; i < proxies_.size(); ++i) {
+        culling_->setTransform(proxies_[i], world);
+        if (occluders_[i] != OcclusionBuffer::INVALID_OCCLUDER) {
+            occlusion_->setTransform(occluders_[i], world);
+        }
+    }
 }
 
 }  // namespace graphics::effects
\ No newline at end of file
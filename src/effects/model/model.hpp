@@ -1,10 +1,11 @@
 #pragma once
+#include "common/common_funcs.hpp"
 #include "ecs/components/transform_component.hpp"
 #include "resource/instance.hpp"
 #include "resource/mesh_instance.hpp"
 #include "world/world.hpp"
 #include "render_core/graphic.hpp"
-#include "effects/light/light.hpp"
+#include <limits>
 #include <tuple>
 #include <unordered_set>
 namespace graphics::effects {
@@ -20,10 +21,75 @@ struct MaterialUBO {
 auto uploadMeshMaterialResource(graphics::ResourceManager& manager, const SubMesh& subMesh)
     -> std::tuple<MeshMaterialResource, MaterialUBO>;
 
-struct ModelPushConstantData {
-        glm::mat4 modelMatrix{1.f};
-        glm::mat4 normalMatrix{1.f};
-        AS_BYTE_SPAN
+// push constant 即 RenderRegistry 中子网格的变换组件
+using ModelPushConstantData = world::DrawTransform;
+using ModelMeshInstance =
+    MeshInstance<ModelPushConstantData, render::PrimitiveTopology::Triangles, MaterialUBO>;
+
+// 模型持有的网格和纹理引用，每个子网格一份，构造时 acquire，从 World 删除后 release
+class ModelResourceRefs {
+    public:
+        void acquire(ResourceManager& manager, render::MeshId mesh,
+                     const MeshMaterialResource& material);
+        void release(ResourceManager& manager);
+
+    private:
+        std::vector<render::MeshId> meshes_;
+        std::vector<render::TextureId> textures_;
+};
+
+// 子网格的剔除状态：视锥剔除的 proxy 和可选的遮挡体，在 World::addDrawable 时注册
+class MeshVisibility {
+    public:
+        // 按 mesh 顺序添加，indices 只包含这个子网格的三角形
+        void addMesh(std::span<const glm::vec3> vertices, std::span<const std::uint32_t> indices);
+        void registerCulling(CullingBvh& bvh, OcclusionBuffer& occlusion);
+        // World::removeDrawable 时移除 proxy 和遮挡体
+        void unregisterCulling();
+        // 场景快照中保存的局部包围盒，与 mesh 一一对应，registerCulling 时不再遍历顶点计算
+        void setLocalBounds(std::span<const core::AABB> bounds) {
+            if (bounds.size() == sources_.size()) {
+                bounds_.assign(bounds.begin(), bounds.end());
+            }
+        }
+        [[nodiscard]] auto localBounds() const -> std::span<const core::AABB> { return bounds_; }
+        // 并行 update 中调用，每个模型只写自己的 proxy
+        void setTransform(const glm::mat4& world);
+        // 子网格的剔除 proxy，没有注册剔除时为 DrawVisibility::NO_PROXY
+        [[nodiscard]] auto proxy(std::size_t mesh) const -> std::uint32_t {
+            return culling_ == nullptr ? world::DrawVisibility::NO_PROXY : proxies_[mesh];
+        }
+
+    private:
+        struct MeshSource {
+                std::span<const glm::vec3> vertices;
+                std::span<const std::uint32_t> indices;
+        };
+        std::vector<MeshSource> sources_;  // 指向 ResourceManager 中的顶点，模型持有网格的引用
+        std::vector<core::AABB> bounds_;
+        std::vector<CullingBvh::proxy_t> proxies_;
+        std::vector<OcclusionBuffer::occluder_t> occluders_;
+        CullingBvh* culling_{nullptr};
+        OcclusionBuffer* occlusion_{nullptr};
+};
+
+// 子网格在 RenderRegistry 中的绘制实体，World::addDrawable 时创建，随模型从 World 删除。
+// 模型的 update 只同步变换和显示开关，剔除和绘制由 RenderRegistry 遍历组件完成
+class MeshDraws {
+    public:
+        void registerDraws(world::RenderRegistry& registry, id_t owner,
+                           std::span<const ModelMeshInstance> meshes,
+                           std::span<const MaterialUBO> materials,
+                           const MeshVisibility& visibility);
+        // 每帧同步大纲面板中模型和子网格的显示开关
+        void setVisible(std::span<const ModelMeshInstance> meshes, bool model_visible);
+        // 并行 update 中调用，只写自己的组件
+        void setTransform(std::span<const ModelMeshInstance> meshes, id_t owner,
+                          const ecs::WorldTransformComponent& transform);
+
+    private:
+        world::RenderRegistry* registry_{nullptr};
+        std::vector<entt::entity> entities_;  // 与 mesh 一一对应
 };
 
 class LightModel {
@@ -33,15 +99,22 @@ class LightModel {
 
         void update(const core::FrameInfo& frameInfo, world::World& world);
 
-        void draw(render::Graphic* graphic) {
-            if (render_state->visible) {
-                for (auto& mesh : meshes) {
-                    if (mesh.render_state->visible) {
-                        graphic->draw(mesh);
-                    }
-                }
-            }
+        void registerDraws(world::RenderRegistry& registry) {
+            draws.registerDraws(registry, id, meshes, materials, visibility);
+            transform_version = ~0U;
+        }
+        void registerCulling(CullingBvh& bvh, OcclusionBuffer& occlusion) {
+            visibility.registerCulling(bvh, occlusion);
+        }
+        void unregisterCulling() { visibility.unregisterCulling(); }
+        // 从拾取场景中移除全部子网格
+        void releasePicking();
+        // World::removeDrawable 之后调用，归还网格和纹理的引用
+        void releaseResources(ResourceManager& manager) { resources.release(manager); }
+        [[nodiscard]] auto getVisibility(this auto&& self) -> decltype(auto) {
+            return (self.visibility);
         }
+        [[nodiscard]] auto getResourceName() const -> const ModelResourceName& { return names_; }
 
         [[nodiscard]] auto getChildEntitys() const -> std::vector<ecs::Entity> {
             std::vector<ecs::Entity> entity;
@@ -57,17 +130,18 @@ class LightModel {
         ecs::Entity entity_;
 
     private:
-        using LightMeshInstance =
-            MeshInstance<ModelPushConstantData, render::PrimitiveTopology::Triangles, LightUBO,
-                         MaterialUBO>;
-        std::vector<LightMeshInstance> meshes;
-        LightUBO light_ubo{};
+        std::vector<ModelMeshInstance> meshes;
+        ModelResourceName names_;
         std::vector<MaterialUBO> materials;
-        ModelPushConstantData push_constant;
         ecs::RenderStateComponent* render_state;
         ecs::TransformComponent* transform;
+        ecs::WorldTransformComponent* world_transform;
+        unsigned int transform_version{~0U};  // 上次同步到变换组件的 version
         id_t id;
         std::unordered_set<id_t> mesh_ids;
+        MeshVisibility visibility;
+        MeshDraws draws;
+        ModelResourceRefs resources;
         // 用于鼠标移动
         float out_initialWorldZ{};
 };
@@ -3,21 +3,39 @@
 #include "resource/obj/model_mesh.hpp"
 #include "effects/effect.hpp"
 namespace graphics::effects {
+namespace {
+auto loadMultiMesh(ResourceManager& manager, const ModelResourceName& names) -> MultiMeshModel {
+    auto model_config = manager.getModelConfig(names.mesh_name);
+    return {model_config.path, model_config.hash, model_config.flip_uv};
+}
+}  // namespace
+
 ModelForMultiMesh::ModelForMultiMesh(ResourceManager& manager, const ModelResourceName& names,
                                      const std::string& name)
-    : id(getCurrentId()) {
+    : ModelForMultiMesh(manager, names, name, loadMultiMesh(manager, names)) {}
+
+ModelForMultiMesh::ModelForMultiMesh(ResourceManager& manager, const ModelResourceName& names,
+                                     const std::string& name, const MultiMeshModel& model)
+    : names_(names), id(getCurrentId()) {
     auto shader_hash = manager.getShaderHash<ShaderHash>(names.shader_name);
-    auto model_config = manager.getModelConfig(names.mesh_name);
-    MultiMeshModel model(model_config.path, model_config.hash, model_config.flip_uv);
+    // 加载了实例化变体时，相同模型的多个副本由渲染器合并成实例化绘制
+    const auto instanced_vertex_shader =
+        manager.getVertexShaderHash(names.shader_name + "_instanced");
     auto sub_meshes = model.getMeshes();
     materials.reserve(sub_meshes.size());
     child_entitys_.reserve(sub_meshes.size());
     for (uint32_t i = 0; const auto& mesh : sub_meshes) {
-        auto mesh_id = manager.addMesh(names.mesh_name + "mesh: " + std::to_string(i++), mesh);
-        manager.addMeshVertex(mesh_id, mesh.only_vertex, mesh.indices_);
+        // 同一个模型的副本共享网格，才能合并成实例化绘制
+        const auto mesh_name = names.mesh_name + "mesh: " + std::to_string(i++);
+        auto mesh_id = manager.getMesh(manager.findMesh(mesh_name));
+        if (!mesh_id) {
+            mesh_id = manager.addMesh(mesh_name, mesh);
+            manager.addMeshVertex(mesh_id, mesh.only_vertex, mesh.indices_);
+        }
 
         SubMesh sub_mesh{.material = mesh.material};
         auto [materialResource, materialUBO] = uploadMeshMaterialResource(manager, sub_mesh);
+        resources.acquire(manager, mesh_id, materialResource);
         materials.push_back(materialUBO);
         meshes.emplace_back(
             render::RenderCommand{
@@ -26,9 +44,9 @@ ModelForMultiMesh::ModelForMultiMesh(ResourceManager& manager, const ModelResour
             },
             shader_hash, sub_mesh.material.name, mesh_id, materialResource);
         meshes.back().setUBO(&materials.back());
-        meshes.back().setUBO(&light_ubo);
-        meshes.back().setPushConstant(&push_constant);
+        meshes.back().setInstancedVertexShaderHash(instanced_vertex_shader);
         PickingSystem::upload_vertex(id, meshes.back().getId(), mesh.only_vertex, mesh.indices_);
+        visibility.addMesh(manager.getMeshVertex(mesh_id), manager.getMeshIndics(mesh_id));
         mesh_ids.insert(meshes.back().getId());
         child_entitys_.push_back(meshes.back().entity_);
     }
@@ -37,16 +55,27 @@ ModelForMultiMesh::ModelForMultiMesh(ResourceManager& manager, const ModelResour
     render_state = &entity_.getComponent<ecs::RenderStateComponent>();
     entity_.addComponent<ecs::TransformComponent>();
     transform = &entity_.getComponent<ecs::TransformComponent>();
+    entity_.addComponent<ecs::WorldTransformComponent>();
+    world_transform = &entity_.getComponent<ecs::WorldTransformComponent>();
 }
 
-void ModelForMultiMesh::update(const core::FrameInfo& frameInfo, world::World& world) {
+void ModelForMultiMesh::releasePicking() {
+    for (const auto mesh_id : mesh_ids) {
+        PickingSystem::remove_mesh(mesh_id);
+    }
+}
 
-    updateLightUBO(frameInfo, light_ubo, world);
-    push_constant.modelMatrix = transform->mat4();
-    push_constant.normalMatrix = glm::inverseTranspose(glm::mat3(push_constant.modelMatrix));
-    for (auto& mesh : meshes) {
-        PickingSystem::update_transform(mesh.getId(), *transform);
+void ModelForMultiMesh::update(const core::FrameInfo& /*frameInfo*/, world::World& world) {
+    draws.setVisible(meshes, render_state->visible);
+    if (world_transform->version == transform_version) {
+        return;
+    }
+    transform_version = world_transform->version;
+    draws.setTransform(meshes, id, *world_transform);
+    for (const auto& mesh : meshes) {
+        world.updatePickTransform(mesh.getId(), world_transform->world);
     }
+    visibility.setTransform(world_transform->world);
 }
 
 }  // namespace graphics::effects
\ No newline at end of file
@@ -7,47 +7,51 @@ class ModelForMultiMesh {
     public:
         ModelForMultiMesh(ResourceManager& manager, const ModelResourceName& names,
                           const std::string& name);
+        // 使用已经解析好的模型文件，场景流式加载时在工作线程中解析
+        ModelForMultiMesh(ResourceManager& manager, const ModelResourceName& names,
+                          const std::string& name, const MultiMeshModel& model);
         ecs::Entity entity_;
-        void draw(render::Graphic* graphic) {
-            if (render_state->visible) {
-                for (auto& mesh : meshes) {
-                    if (mesh.render_state->visible) {
-                        auto render_cmd = build_render_command(mesh);
-                        if (const auto* p = std::get_if<render::DrawIndexCommand>(&render_cmd)) {
-                            graphic->draw(*p);
-                        } else {
-                            graphic->draw(mesh);
-                        }
-                    }
-                }
-            }
-        }
-
         [[nodiscard]] auto getChildEntitys() const -> std::vector<ecs::Entity> {
             return child_entitys_;
         }
 
         void update(const core::FrameInfo& frameInfo, world::World& world);
+        void registerDraws(world::RenderRegistry& registry) {
+            draws.registerDraws(registry, id, meshes, materials, visibility);
+            transform_version = ~0U;
+        }
+        void registerCulling(CullingBvh& bvh, OcclusionBuffer& occlusion) {
+            visibility.registerCulling(bvh, occlusion);
+        }
+        void unregisterCulling() { visibility.unregisterCulling(); }
+        void releasePicking();
+        // World::removeDrawable 之后调用，归还网格和纹理的引用
+        void releaseResources(ResourceManager& manager) { resources.release(manager); }
+        [[nodiscard]] auto getVisibility(this auto&& self) -> decltype(auto) {
+            return (self.visibility);
+        }
+        [[nodiscard]] auto getResourceName() const -> const ModelResourceName& { return names_; }
         [[nodiscard]] auto getId() const -> id_t { return id; }
 
     private:
-        using MeshInstance =
-            MeshInstance<ModelPushConstantData, render::PrimitiveTopology::Triangles, LightUBO,
-                         MaterialUBO>;
-        std::vector<MeshInstance> meshes;
+        std::vector<ModelMeshInstance> meshes;
+        ModelResourceName names_;
         id_t id;
 
-        LightUBO light_ubo{};
         std::vector<MaterialUBO> materials;
         // TODO 主要修复第一次按下鼠标左键无法拾取的问题，等找到修复方案再修复
         bool pending_pick_ = false;
         // 用于鼠标移动
         glm::vec3 out_dragStartWorldPos{};
         float out_initialWorldZ{};
-        ModelPushConstantData push_constant;
         std::unordered_set<id_t> mesh_ids;
         ecs::RenderStateComponent* render_state{nullptr};
         ecs::TransformComponent* transform{nullptr};
+        ecs::WorldTransformComponent* world_transform{nullptr};
+        unsigned int transform_version{~0U};
+        MeshVisibility visibility;
+        MeshDraws draws;
+        ModelResourceRefs resources;
         std::vector<ecs::Entity> child_entitys_;
 };
 }  // namespace graphics::effects
\ No newline at end of file
@@ -77,6 +77,7 @@ class Particle : public render::IComputeInstance {
             }
         }
 
+        [[nodiscard]] auto getId() const -> id_t { return id; }
         auto getUniforBuffer() -> UBO& { return u; }
         auto getChildEntitys() -> std::vector<ecs::Entity> {
             return std::vector{in.entity_, out.entity_};
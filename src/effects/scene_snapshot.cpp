@@ -0,0 +1,355 @@
+#include "effects/scene_snapshot.hpp"
+#include "effects/light/point_light.hpp"
+#include "effects/model/model.hpp"
+#include "effects/model/multi_mesh_model.hpp"
+#include "common/file.hpp"
+#include "common/parallel.hpp"
+#include "resource/obj/model_mesh.hpp"
+#include "world/world.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace graphics::effects {
+namespace {
+constexpr std::string_view SNAPSHOT_FILE = "scene.snapshot";
+constexpr std::size_t SECTION_ALIGNMENT = 16;
+constexpr std::size_t VALIDATE_GRAIN = 256;
+
+static_assert(std::is_trivially_copyable_v<SceneSnapshot::ModelRecord>);
+static_assert(std::is_trivially_copyable_v<SceneSnapshot::LightRecord>);
+static_assert(std::is_trivially_copyable_v<core::AABB>);
+
+struct SnapshotHeader {
+        std::uint32_t magic{SceneSnapshot::MAGIC};
+        std::uint32_t version{SceneSnapshot::VERSION};
+        std::uint32_t model_count{0};
+        std::uint32_t bounds_count{0};
+        std::uint32_t light_count{0};
+        std::uint32_t string_bytes{0};
+        std::uint64_t asset_hash{0};
+};
+
+// 各段在文件中的起始偏移，段之间按 SECTION_ALIGNMENT 对齐
+struct SnapshotLayout {
+        std::uint64_t models{0};
+        std::uint64_t bounds{0};
+        std::uint64_t lights{0};
+        std::uint64_t strings{0};
+        std::uint64_t total{0};
+};
+
+auto alignUp(std::uint64_t value) -> std::uint64_t {
+    return (value + SECTION_ALIGNMENT - 1) & ~std::uint64_t{SECTION_ALIGNMENT - 1};
+}
+
+auto layoutOf(const SnapshotHeader& header) -> SnapshotLayout {
+    SnapshotLayout layout;
+    layout.models = alignUp(sizeof(SnapshotHeader));
+    layout.bounds =
+        alignUp(layout.models + (std::uint64_t{header.model_count} *
+                                 sizeof(SceneSnapshot::ModelRecord)));
+    layout.lights =
+        alignUp(layout.bounds + (std::uint64_t{header.bounds_count} * sizeof(core::AABB)));
+    layout.strings =
+        alignUp(layout.lights + (std::uint64_t{header.light_count} *
+                                 sizeof(SceneSnapshot::LightRecord)));
+    layout.total = layout.strings + header.string_bytes;
+    return layout;
+}
+
+struct Section {
+        void* data;
+        std::uint64_t offset;
+        std::size_t bytes;
+};
+
+auto sectionsOf(SceneSnapshot& snapshot, const SnapshotLayout& layout) -> std::array<Section, 4> {
+    return {
+        Section{snapshot.models.data(), layout.models,
+                snapshot.models.size() * sizeof(SceneSnapshot::ModelRecord)},
+        Section{snapshot.bounds.data(), layout.bounds, snapshot.bounds.size() * sizeof(core::AABB)},
+        Section{snapshot.lights.data(), layout.lights,
+                snapshot.lights.size() * sizeof(SceneSnapshot::LightRecord)},
+        Section{snapshot.strings.data(), layout.strings, snapshot.strings.size()},
+    };
+}
+
+auto validRecord(const SceneSnapshot& snapshot, const SceneSnapshot::ModelRecord& record) -> bool {
+    const auto in_range = [](std::uint64_t offset, std::uint64_t size, std::size_t limit) {
+        return offset + size <= limit;
+    };
+    return in_range(record.model_name_offset, record.model_name_size, snapshot.strings.size()) &&
+           in_range(record.shader_name_offset, record.shader_name_size,
+                    snapshot.strings.size()) &&
+           in_range(record.first_bounds, record.bounds_count, snapshot.bounds.size()) &&
+           record.model_name_size > 0 && record.split_mesh <= 1;
+}
+
+template <typename T>
+void captureModel(SceneSnapshot& snapshot, T& model, bool split_mesh) {
+    SceneSnapshot::ModelRecord record;
+    const auto& names = model.getResourceName();
+    std::tie(record.model_name_offset, record.model_name_size) =
+        snapshot.addString(names.mesh_name);
+    std::tie(record.shader_name_offset, record.shader_name_size) =
+        snapshot.addString(names.shader_name);
+    const auto bounds = model.getVisibility().localBounds();
+    record.first_bounds = static_cast<std::uint32_t>(snapshot.bounds.size());
+    record.bounds_count = static_cast<std::uint32_t>(bounds.size());
+    snapshot.bounds.insert(snapshot.bounds.end(), bounds.begin(), bounds.end());
+    record.split_mesh = split_mesh ? 1 : 0;
+    record.visible = model.entity_.template getComponent<ecs::RenderStateComponent>().visible;
+    const auto& transform = model.entity_.template getComponent<ecs::TransformComponent>();
+    record.translation = transform.translation;
+    record.scale = transform.scale;
+    record.rotation = transform.rotation;
+    snapshot.models.push_back(record);
+}
+
+// 同一个模型文件只解析一次，多条记录共享结果
+struct MeshParseJob {
+        std::string name;
+        std::optional<ModelConfig> config;  // 拆分子网格的模型
+        bool parse_mesh{false};             // LightModel 的网格还没有加载
+        std::optional<graphics::Model> mesh;
+        std::optional<MultiMeshModel> multi_mesh;
+        bool failed{false};
+};
+}  // namespace
+
+auto SceneSnapshot::addString(std::string_view str) -> std::pair<std::uint32_t, std::uint32_t> {
+    const auto offset = static_cast<std::uint32_t>(strings.size());
+    strings.insert(strings.end(), str.begin(), str.end());
+    return {offset, static_cast<std::uint32_t>(str.size())};
+}
+
+auto save_scene_snapshot(const SceneSnapshot& snapshot, const std::filesystem::path& path)
+    -> bool {
+    SnapshotHeader header;
+    header.model_count = static_cast<std::uint32_t>(snapshot.models.size());
+    header.bounds_count = static_cast<std::uint32_t>(snapshot.bounds.size());
+    header.light_count = static_cast<std::uint32_t>(snapshot.lights.size());
+    header.string_bytes = static_cast<std::uint32_t>(snapshot.strings.size());
+    header.asset_hash = snapshot.asset_hash;
+    const auto layout = layoutOf(header);
+
+    std::vector<std::byte> data(layout.total);
+    std::memcpy(data.data(), &header, sizeof(header));
+    const auto write = [&data](std::uint64_t offset, const auto& items) {
+        std::ranges::copy(std::as_bytes(std::span(items)), data.begin() + offset);
+    };
+    write(layout.models, snapshot.models);
+    write(layout.bounds, snapshot.bounds);
+    write(layout.lights, snapshot.lights);
+    write(layout.strings, snapshot.strings);
+
+    // 先写临时文件再替换，中途退出不会留下半个快照
+    common::FS::create_dir(path.parent_path());
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()),  // NOLINT
+                   static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    return !error;
+}
+
+auto load_scene_snapshot(const std::filesystem::path& path) -> std::optional<SceneSnapshot> {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    const auto file_size = static_cast<std::uint64_t>(file.tellg());
+    if (file_size < sizeof(SnapshotHeader)) {
+        return std::nullopt;
+    }
+    std::vector<std::byte> data(file_size);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()),  // NOLINT
+                   static_cast<std::streamsize>(file_size))) {
+        return std::nullopt;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != SceneSnapshot::MAGIC || header.version != SceneSnapshot::VERSION) {
+        return std::nullopt;
+    }
+    const auto layout = layoutOf(header);
+    if (layout.total > file_size) {
+        return std::nullopt;
+    }
+
+    SceneSnapshot snapshot;
+    snapshot.asset_hash = header.asset_hash;
+    snapshot.models.resize(header.model_count);
+    snapshot.bounds.resize(header.bounds_count);
+    snapshot.lights.resize(header.light_count);
+    snapshot.strings.resize(header.string_bytes);
+    const auto sections = sectionsOf(snapshot, layout);
+    common::parallelFor(sections.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (sections[i].bytes > 0) {
+                std::memcpy(sections[i].data, data.data() + sections[i].offset, sections[i].bytes);
+            }
+        }
+    });
+
+    std::atomic<bool> valid{true};
+    common::parallelFor(
+        snapshot.models.size(), VALIDATE_GRAIN, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end && valid.load(std::memory_order_relaxed); ++i) {
+                if (!validRecord(snapshot, snapshot.models[i])) {
+                    valid.store(false, std::memory_order_relaxed);
+                }
+            }
+        });
+    if (!valid.load()) {
+        return std::nullopt;
+    }
+    return snapshot;
+}
+
+auto scene_snapshot_path() -> std::filesystem::path {
+    return common::FS::get_module_path(common::FS::ModuleType::Asset) / SNAPSHOT_FILE;
+}
+
+auto capture_scene_snapshot(world::World& world) -> SceneSnapshot {
+    SceneSnapshot snapshot;
+    world.eachDrawable<std::shared_ptr<LightModel>>(
+        [&](const auto& model) { captureModel(snapshot, *model, false); });
+    world.eachDrawable<std::shared_ptr<ModelForMultiMesh>>(
+        [&](const auto& model) { captureModel(snapshot, *model, true); });
+    world.eachDrawable<std::shared_ptr<PointLightEffect>>([&](const auto& light) {
+        auto& entity = light->entity_;
+        snapshot.lights.push_back({
+            .light = entity.template getComponent<ecs::LightComponent>(),
+            .translation = entity.template getComponent<ecs::TransformComponent>().translation,
+            .visible = entity.template getComponent<ecs::RenderStateComponent>().visible ? 1U
+                                                                                         : 0U,
+        });
+    });
+    return snapshot;
+}
+
+auto restore_scene_snapshot(const SceneSnapshot& snapshot, ResourceManager& manager)
+    -> RestoredScene {
+    // 读取配置和查询已加载的网格要访问 ResourceManager，在主线程完成
+    std::vector<MeshParseJob> jobs;
+    std::vector<std::size_t> record_jobs;
+    record_jobs.reserve(snapshot.models.size());
+    std::map<std::pair<std::string_view, bool>, std::size_t> job_index;
+    for (const auto& record : snapshot.models) {
+        const auto name = snapshot.string(record.model_name_offset, record.model_name_size);
+        const bool split_mesh = record.split_mesh != 0;
+        auto [it, inserted] = job_index.try_emplace({name, split_mesh}, jobs.size());
+        if (inserted) {
+            auto& job = jobs.emplace_back();
+            job.name = name;
+            if (split_mesh) {
+                job.config = manager.getModelConfig(job.name);
+            } else {
+                job.parse_mesh = !manager.hasMesh(job.name);
+            }
+        }
+        record_jobs.push_back(it->second);
+    }
+
+    common::parallelFor(jobs.size(), 1, [&jobs](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            auto& job = jobs[i];
+            try {
+                if (job.config) {
+                    job.multi_mesh.emplace(job.config->path, job.config->hash,
+                                           job.config->flip_uv);
+                } else if (job.parse_mesh) {
+                    job.mesh = ResourceManager::parseModel(job.name);
+                }
+            } catch (const std::exception& e) {
+                SPDLOG_ERROR("restore scene model {} failed: {}", job.name, e.what());
+                job.failed = true;
+            }
+        }
+    });
+
+    // 上传网格和创建实体在主线程
+    for (auto& job : jobs) {
+        if (job.mesh && !manager.hasMesh(job.name)) {
+            manager.addModel(job.name, *job.mesh);
+            job.mesh.reset();
+        }
+    }
+    RestoredScene scene;
+    scene.models.reserve(snapshot.models.size());
+    for (std::size_t i = 0; i < snapshot.models.size(); ++i) {
+        const auto& record = snapshot.models[i];
+        const auto& job = jobs[record_jobs[i]];
+        if (job.failed) {
+            continue;
+        }
+        const ModelResourceName names{
+            .shader_name =
+                std::string(snapshot.string(record.shader_name_offset, record.shader_name_size)),
+            .mesh_name = job.name,
+        };
+        Model model;
+        if (job.multi_mesh) {
+            model = std::make_shared<ModelForMultiMesh>(manager, names, job.name, *job.multi_mesh);
+        } else {
+            model = std::make_shared<LightModel>(manager, names, job.name);
+        }
+        apply_model_record(snapshot, record, model);
+        scene.models.push_back(std::move(model));
+    }
+    scene.lights = restore_scene_lights(snapshot, manager);
+    return scene;
+}
+
+auto restore_scene_lights(const SceneSnapshot& snapshot, ResourceManager& manager)
+    -> std::vector<std::shared_ptr<PointLightEffect>> {
+    std::vector<std::shared_ptr<PointLightEffect>> lights;
+    lights.reserve(snapshot.lights.size());
+    for (const auto& record : snapshot.lights) {
+        auto light = std::make_shared<PointLightEffect>(manager, record.light.intensity,
+                                                        record.light.range, record.light.color);
+        auto& entity = light->entity_;
+        entity.getComponent<ecs::LightComponent>() = record.light;
+        entity.getComponent<ecs::TransformComponent>().translation = record.translation;
+        entity.getComponent<ecs::RenderStateComponent>().visible = record.visible != 0;
+        lights.push_back(std::move(light));
+    }
+    return lights;
+}
+
+void apply_model_record(const SceneSnapshot& snapshot, const SceneSnapshot::ModelRecord& record,
+                        Model& model) {
+    std::visit(
+        [&](auto& drawable) {
+            drawable->getVisibility().setLocalBounds(snapshot.modelBounds(record));
+            auto& entity = drawable->entity_;
+            entity.template getComponent<ecs::TransformComponent>() =
+                ecs::TransformComponent{record.translation, record.scale, record.rotation};
+            entity.template getComponent<ecs::RenderStateComponent>().visible =
+                record.visible != 0;
+        },
+        model);
+}
+
+}  // namespace graphics::effects
@@ -0,0 +1,93 @@
+#pragma once
+#include "core/camera/frustum.hpp"
+#include "ecs/components/light_component.hpp"
+#include "effects/effect.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace world {
+class World;
+}
+
+namespace graphics::effects {
+
+class PointLightEffect;
+
+/// 场景的二进制快照：模型的资源引用、变换、可见性，每个子网格的局部包围盒（剔除用），以及点光源。
+/// 所有记录都是定长 POD，按段连续存放，读取时整个文件一次读入再按段 memcpy，不需要逐字段解析。
+/// 字符串统一放在字符串表里，记录中只保存偏移和长度。
+struct SceneSnapshot {
+        static constexpr std::uint32_t MAGIC = 0x504E5347;  // "GSNP"
+        static constexpr std::uint32_t VERSION = 2;
+
+        struct ModelRecord {
+                std::uint32_t model_name_offset{0};
+                std::uint32_t model_name_size{0};
+                std::uint32_t shader_name_offset{0};
+                std::uint32_t shader_name_size{0};
+                std::uint32_t first_bounds{0};  // bounds 中的范围，与子网格一一对应
+                std::uint32_t bounds_count{0};
+                std::uint32_t split_mesh{0};
+                std::uint32_t visible{1};
+                glm::vec3 translation{0.f};
+                glm::vec3 scale{1.f};
+                glm::vec3 rotation{0.f};
+        };
+
+        struct LightRecord {
+                ecs::LightComponent light;
+                glm::vec3 translation{0.f};
+                std::uint32_t visible{1};
+        };
+
+        // 保存时 model_asset_hash() 的值，与当前资产不一致说明 JSON 改过，快照已经过期
+        std::uint64_t asset_hash{0};
+        std::vector<ModelRecord> models;
+        std::vector<core::AABB> bounds;
+        std::vector<LightRecord> lights;
+        std::vector<char> strings;
+
+        // 返回字符串表中的 {offset, size}
+        auto addString(std::string_view str) -> std::pair<std::uint32_t, std::uint32_t>;
+        [[nodiscard]] auto string(std::uint32_t offset, std::uint32_t size) const
+            -> std::string_view {
+            return {strings.data() + offset, size};
+        }
+        [[nodiscard]] auto modelBounds(const ModelRecord& record) const
+            -> std::span<const core::AABB> {
+            return std::span(bounds).subspan(record.first_bounds, record.bounds_count);
+        }
+};
+
+auto save_scene_snapshot(const SceneSnapshot& snapshot, const std::filesystem::path& path) -> bool;
+// 文件不存在、版本不匹配或内容损坏时返回空
+auto load_scene_snapshot(const std::filesystem::path& path) -> std::optional<SceneSnapshot>;
+
+// 默认快照位置：Asset 目录下的 scene.snapshot
+auto scene_snapshot_path() -> std::filesystem::path;
+
+// 从 World 中收集模型和点光源
+auto capture_scene_snapshot(world::World& world) -> SceneSnapshot;
+
+struct RestoredScene {
+        std::vector<Model> models;
+        std::vector<std::shared_ptr<PointLightEffect>> lights;
+};
+
+// 按快照重建模型和点光源。每个模型文件只解析一次，解析在工作线程上并行完成，
+// 主线程只上传和创建实体；模型直接使用快照中的包围盒，不再遍历顶点计算
+auto restore_scene_snapshot(const SceneSnapshot& snapshot, ResourceManager& manager)
+    -> RestoredScene;
+auto restore_scene_lights(const SceneSnapshot& snapshot, ResourceManager& manager)
+    -> std::vector<std::shared_ptr<PointLightEffect>>;
+// 把记录中的包围盒、变换和可见性设置到刚创建的模型上
+void apply_model_record(const SceneSnapshot& snapshot, const SceneSnapshot::ModelRecord& record,
+                        Model& model);
+
+}  // namespace graphics::effects
@@ -0,0 +1,209 @@
+#include "effects/scene_streamer.hpp"
+#include "effects/light/point_light.hpp"
+#include "effects/model/model.hpp"
+#include "effects/model/multi_mesh_model.hpp"
+#include "system/pick_system.hpp"
+#include "world/world.hpp"
+#include <spdlog/spdlog.h>
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <exception>
+#include <tuple>
+
+namespace graphics::effects {
+namespace {
+// 加载前不知道网格大小，每个子网格按这个估计，加载后换成实际开销
+constexpr world::StreamingCost ESTIMATED_SUBMESH_COST{.host_bytes = 1ULL << 20U,
+                                                      .device_bytes = 2ULL << 20U};
+
+// 内存中保留顶点位置和索引（拾取、剔除），显存中是完整的顶点和索引
+auto meshCost(std::size_t vertices, std::size_t indices) -> world::StreamingCost {
+    return {.host_bytes = (vertices * sizeof(glm::vec3)) + (indices * sizeof(std::uint32_t)),
+            .device_bytes = (vertices * sizeof(Vertex)) + (indices * sizeof(std::uint32_t))};
+}
+
+auto recordBounds(const SceneSnapshot& snapshot, const SceneSnapshot::ModelRecord& record)
+    -> core::AABB {
+    const auto transform =
+        ecs::TransformComponent{record.translation, record.scale, record.rotation}.mat4();
+    const auto local = snapshot.modelBounds(record);
+    if (local.empty()) {
+        return {.min = record.translation, .max = record.translation};
+    }
+    core::AABB bounds = local.front();
+    for (const auto& mesh : local.subspan(1)) {
+        bounds.min = glm::min(bounds.min, mesh.min);
+        bounds.max = glm::max(bounds.max, mesh.max);
+    }
+    return bounds.transform(transform);
+}
+
+// 卸载前把编辑过的变换和可见性写回记录
+void refreshRecord(SceneSnapshot::ModelRecord& record, Model& model) {
+    std::visit(
+        [&](auto& drawable) {
+            const auto& entity = drawable->entity_;
+            const auto& transform = entity.template getComponent<ecs::TransformComponent>();
+            record.translation = transform.translation;
+            record.scale = transform.scale;
+            record.rotation = transform.rotation;
+            record.visible =
+                entity.template getComponent<ecs::RenderStateComponent>().visible ? 1U : 0U;
+        },
+        model);
+}
+}  // namespace
+
+SceneStreamer::SceneStreamer(SceneSnapshot snapshot, ResourceManager& manager, world::World& world,
+                             const world::CellStreamer::Settings& settings)
+    : snapshot_(std::move(snapshot)), manager_(manager), world_(world), cells_(settings) {
+    for (const auto& record : snapshot_.models) {
+        world::StreamingCost estimate;
+        for (std::uint32_t i = 0; i < std::max(record.bounds_count, 1U); ++i) {
+            estimate += ESTIMATED_SUBMESH_COST;
+        }
+        cells_.addItem(recordBounds(snapshot_, record), estimate);
+    }
+    resident_.resize(cells_.cellCount());
+    for (auto& light : restore_scene_lights(snapshot_, manager_)) {
+        world_.addDrawable(light);
+    }
+}
+
+void SceneStreamer::update(const glm::vec3& camera) {
+    ZoneScoped;
+    std::vector<ParsedCell> finished;
+    {
+        std::scoped_lock lock(finished_mutex_);
+        finished.swap(finished_);
+    }
+    bool changed = !finished.empty();
+    for (auto& parsed : finished) {
+        finishCell(parsed);
+    }
+
+    const auto& actions = cells_.update(camera);
+    for (const auto cell : actions.unload) {
+        unloadCell(cell);
+    }
+    for (const auto cell : actions.load) {
+        requestCell(cell);
+    }
+    changed = changed || !actions.unload.empty();
+    if (changed) {
+        PickingSystem::commit();
+    }
+}
+
+void SceneStreamer::requestCell(cell_t cell) {
+    // 读取配置和查询已加载的网格要访问 ResourceManager，在主线程完成
+    std::vector<ParseRequest> requests;
+    for (const auto item : cells_.items(cell)) {
+        const auto& record = snapshot_.models[item];
+        ParseRequest request{.record = item};
+        request.name = snapshot_.string(record.model_name_offset, record.model_name_size);
+        if (record.split_mesh != 0) {
+            request.config = manager_.getModelConfig(request.name);
+        } else {
+            request.parse_mesh = !manager_.hasMesh(request.name);
+        }
+        requests.push_back(std::move(request));
+    }
+    worker_.QueueWork([this, cell, requests = std::move(requests)] {
+        ParsedCell parsed{.cell = cell};
+        try {
+            for (const auto& request : requests) {
+                auto& model = parsed.models.emplace_back();
+                model.record = request.record;
+                if (request.config) {
+                    model.multi_mesh.emplace(request.config->path, request.config->hash,
+                                             request.config->flip_uv);
+                } else if (request.parse_mesh) {
+                    model.mesh = ResourceManager::parseModel(request.name);
+                }
+            }
+        } catch (const std::exception& e) {
+            SPDLOG_ERROR("stream scene cell {} failed: {}", cell, e.what());
+            parsed.failed = true;
+        }
+        std::scoped_lock lock(finished_mutex_);
+        finished_.push_back(std::move(parsed));
+    });
+}
+
+void SceneStreamer::finishCell(ParsedCell& parsed) {
+    if (parsed.failed) {
+        cells_.markFailed(parsed.cell);
+        return;
+    }
+    world::StreamingCost cost;
+    auto& models = resident_[parsed.cell];
+    for (auto& parsed_model : parsed.models) {
+        const auto& record = snapshot_.models[parsed_model.record];
+        const std::string name(snapshot_.string(record.model_name_offset, record.model_name_size));
+        const ModelResourceName names{
+            .shader_name =
+                std::string(snapshot_.string(record.shader_name_offset, record.shader_name_size)),
+            .mesh_name = name,
+        };
+        Model model;
+        if (parsed_model.multi_mesh) {
+            model = std::make_shared<ModelForMultiMesh>(manager_, names, name,
+                                                        *parsed_model.multi_mesh);
+            for (const auto& mesh : parsed_model.multi_mesh->getMeshes()) {
+                cost += meshCost(mesh.only_vertex.size(), mesh.indices_.size());
+            }
+        } else {
+            // 其它格子可能已经加载了同一个网格
+            if (parsed_model.mesh && !manager_.hasMesh(name)) {
+                manager_.addModel(name, *parsed_model.mesh);
+            }
+            model = std::make_shared<LightModel>(manager_, names, name);
+            const auto mesh_id = manager_.getMesh(name);
+            cost += meshCost(manager_.getMeshVertex(mesh_id).size(),
+                             manager_.getMeshIndics(mesh_id).size());
+        }
+        apply_model_record(snapshot_, record, model);
+        std::visit([&](auto& drawable) { world_.addDrawable(drawable); }, model);
+        models.emplace_back(parsed_model.record, std::move(model));
+    }
+    cells_.markLoaded(parsed.cell, cost);
+}
+
+void SceneStreamer::unloadCell(cell_t cell) {
+    for (auto& [record, model] : resident_[cell]) {
+        refreshRecord(snapshot_.models[record], model);
+        std::visit(
+            [&](auto& drawable) {
+                world_.removeDrawable(drawable);
+                // 没有其它格子使用的网格和纹理在 GPU 用完后销毁
+                drawable->releaseResources(manager_);
+            },
+            model);
+    }
+    resident_[cell].clear();
+}
+
+auto SceneStreamer::capture() -> SceneSnapshot {
+    auto result = capture_scene_snapshot(world_);
+    for (cell_t cell = 0; cell < cells_.cellCount(); ++cell) {
+        if (cells_.state(cell) == world::CellStreamer::CellState::Resident) {
+            continue;
+        }
+        for (const auto item : cells_.items(cell)) {
+            auto record = snapshot_.models[item];
+            const auto& source = snapshot_.models[item];
+            std::tie(record.model_name_offset, record.model_name_size) = result.addString(
+                snapshot_.string(source.model_name_offset, source.model_name_size));
+            std::tie(record.shader_name_offset, record.shader_name_size) = result.addString(
+                snapshot_.string(source.shader_name_offset, source.shader_name_size));
+            const auto bounds = snapshot_.modelBounds(source);
+            record.first_bounds = static_cast<std::uint32_t>(result.bounds.size());
+            result.bounds.insert(result.bounds.end(), bounds.begin(), bounds.end());
+            result.models.push_back(record);
+        }
+    }
+    return result;
+}
+
+}  // namespace graphics::effects
@@ -0,0 +1,71 @@
+#pragma once
+#include "effects/scene_snapshot.hpp"
+#include "common/thread_worker.hpp"
+#include "resource/obj/model_mesh.hpp"
+#include "resource/resource.hpp"
+#include "world/cell_streamer.hpp"
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graphics::effects {
+
+/// 按相机位置流式加载场景快照中的模型。模型按世界包围盒归入 CellStreamer 的格子，
+/// 格子的模型文件在工作线程中解析，主线程在 update 中创建模型（上传网格、纹理）并加入 World；
+/// 卸载的格子把模型的当前状态写回记录后从 World 中删除。点光源开销很小，开始时全部加入。
+class SceneStreamer {
+    public:
+        SceneStreamer(SceneSnapshot snapshot, ResourceManager& manager, world::World& world,
+                      const world::CellStreamer::Settings& settings);
+        ~SceneStreamer() = default;
+        SceneStreamer(const SceneStreamer&) = delete;
+        SceneStreamer(SceneStreamer&&) = delete;
+        auto operator=(const SceneStreamer&) -> SceneStreamer& = delete;
+        auto operator=(SceneStreamer&&) -> SceneStreamer& = delete;
+
+        // 每帧在 World::update 之前调用
+        void update(const glm::vec3& camera);
+        // World 中的模型和点光源按当前状态记录，未加载的模型沿用快照中的记录
+        auto capture() -> SceneSnapshot;
+
+        [[nodiscard]] auto cells() const -> const world::CellStreamer& { return cells_; }
+
+    private:
+        using cell_t = world::CellStreamer::cell_t;
+
+        struct ParseRequest {
+                std::uint32_t record{0};
+                std::string name;
+                std::optional<ModelConfig> config;  // 拆分子网格的模型
+                bool parse_mesh{false};             // LightModel 的网格还没有加载
+        };
+        struct ParsedModel {
+                std::uint32_t record{0};
+                std::optional<graphics::Model> mesh;
+                std::optional<MultiMeshModel> multi_mesh;
+        };
+        struct ParsedCell {
+                cell_t cell{0};
+                std::vector<ParsedModel> models;
+                bool failed{false};
+        };
+
+        void requestCell(cell_t cell);
+        void finishCell(ParsedCell& parsed);
+        void unloadCell(cell_t cell);
+
+        SceneSnapshot snapshot_;
+        ResourceManager& manager_;
+        world::World& world_;
+        world::CellStreamer cells_;
+        // 每个格子中已加入 World 的模型和它们的记录
+        std::vector<std::vector<std::pair<std::uint32_t, Model>>> resident_;
+        std::mutex finished_mutex_;
+        std::vector<ParsedCell> finished_;
+        // 最后声明，析构时先等待正在执行的解析任务
+        common::ThreadWorker worker_{1, "SceneStreamer"};
+};
+
+}  // namespace graphics::effects
@@ -0,0 +1,169 @@
+#include "effects/stress_scene.hpp"
+#include "effects/light/point_light.hpp"
+#include "effects/model/model.hpp"
+#include "effects/particle/particle.hpp"
+#include "system/pick_system.hpp"
+#include "world/world.hpp"
+#include <glm/gtc/constants.hpp>
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <array>
+#include <string>
+
+namespace graphics::effects {
+namespace {
+constexpr std::string_view STRESS_MESH_PREFIX{"__stress_box_"};
+
+// SplitMix64。标准库的分布在不同实现上结果不同，这里自己从整数换算
+class Random {
+    public:
+        explicit Random(std::uint64_t seed) : state_(seed) {}
+
+        auto next() -> std::uint64_t {
+            std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31U);
+        }
+        // [0, 1)
+        auto unit() -> float { return static_cast<float>(next() >> 40U) * 0x1p-24F; }
+        auto range(float min, float max) -> float { return min + ((max - min) * unit()); }
+        auto below(std::uint32_t n) -> std::uint32_t {
+            return static_cast<std::uint32_t>(next() % n);
+        }
+
+    private:
+        std::uint64_t state_;
+};
+
+auto meshName(std::uint32_t mesh) -> std::string {
+    return std::string(STRESS_MESH_PREFIX) + std::to_string(mesh);
+}
+
+// 每个面 4 个顶点，法线和纹理坐标各自独立
+auto makeBox(const glm::vec3& half) -> Model {
+    constexpr std::array<glm::vec3, 6> NORMALS{{{1.f, 0.f, 0.f},
+                                                {-1.f, 0.f, 0.f},
+                                                {0.f, 1.f, 0.f},
+                                                {0.f, -1.f, 0.f},
+                                                {0.f, 0.f, 1.f},
+                                                {0.f, 0.f, -1.f}}};
+    constexpr std::array<glm::vec2, 4> CORNERS{
+        {{-1.f, -1.f}, {1.f, -1.f}, {1.f, 1.f}, {-1.f, 1.f}}};
+    Model model;
+    for (const auto& normal : NORMALS) {
+        // 面内的两个切线方向，与法线构成右手系，保证三角形朝外
+        const glm::vec3 u = glm::abs(normal.y) > 0.f ? glm::vec3{normal.y, 0.f, 0.f}
+                                                     : glm::vec3{-normal.z, 0.f, normal.x};
+        const glm::vec3 v = glm::cross(normal, u);
+        const auto first = static_cast<std::uint32_t>(model.vertices_.size());
+        for (const auto& corner : CORNERS) {
+            const glm::vec3 position = (normal + (u * corner.x) + (v * corner.y)) * half;
+            model.vertices_.push_back({.position = position,
+                                       .color = glm::vec3{1.f},
+                                       .normal = normal,
+                                       .texCoord = (corner + 1.f) * .5f});
+            model.only_vertex.push_back(position);
+        }
+        for (const std::uint32_t index : {0U, 1U, 2U, 0U, 2U, 3U}) {
+            model.indices_.push_back(first + index);
+        }
+    }
+    model.subMeshes.push_back(
+        {.indexOffset = 0, .indexCount = static_cast<std::uint32_t>(model.indices_.size())});
+    return model;
+}
+}  // namespace
+
+auto make_stress_layout(const StressSceneSettings& settings) -> StressLayout {
+    StressLayout layout;
+    Random random(settings.seed);
+    const std::uint32_t variants = std::max(settings.mesh_variants, 1U);
+    const std::uint32_t depth = std::max(settings.hierarchy_depth, 1U);
+    layout.mesh_extents.reserve(variants);
+    for (std::uint32_t i = 0; i < variants; ++i) {
+        layout.mesh_extents.emplace_back(random.range(.3f, 1.5f), random.range(.3f, 2.f),
+                                         random.range(.3f, 1.5f));
+    }
+
+    layout.models.reserve(settings.models);
+    for (std::uint32_t i = 0; i < settings.models; ++i) {
+        StressLayout::Node node{.mesh = random.below(variants)};
+        if (i % depth == 0) {
+            node.translation = {random.range(-settings.extent, settings.extent), 0.f,
+                                random.range(-settings.extent, settings.extent)};
+            node.rotation.y = random.range(0.f, glm::two_pi<float>());
+        } else {
+            // 链上的下一个节点叠在父节点上方，深层节点的位置依赖整条链
+            node.parent = i - 1;
+            node.translation = {random.range(-.5f, .5f), 2.f, random.range(-.5f, .5f)};
+            node.rotation.y = random.range(-.5f, .5f);
+            node.scale = glm::vec3{.95f};
+        }
+        layout.models.push_back(node);
+    }
+
+    layout.lights.reserve(settings.lights);
+    for (std::uint32_t i = 0; i < settings.lights; ++i) {
+        layout.lights.push_back(
+            {.position = {random.range(-settings.extent, settings.extent), random.range(1.f, 10.f),
+                          random.range(-settings.extent, settings.extent)},
+             .color = {random.range(.2f, 1.f), random.range(.2f, 1.f), random.range(.2f, 1.f)},
+             .intensity = random.range(1.f, 10.f),
+             .range = random.range(5.f, 20.f)});
+    }
+    return layout;
+}
+
+StressScene::StressScene(const StressSceneSettings& settings, ResourceManager& manager,
+                         world::World& world, const layout::FrameBufferLayout& frame_layout)
+    : layout_(make_stress_layout(settings)) {
+    ZoneScoped;
+    for (std::uint32_t mesh = 0; mesh < layout_.mesh_extents.size(); ++mesh) {
+        if (!manager.hasMesh(meshName(mesh))) {
+            manager.addModel(meshName(mesh), makeBox(layout_.mesh_extents[mesh]));
+        }
+    }
+
+    models_.reserve(layout_.models.size());
+    for (std::uint32_t i = 0; i < layout_.models.size(); ++i) {
+        const auto& node = layout_.models[i];
+        auto model = std::make_shared<LightModel>(
+            manager, ModelResourceName{.shader_name = "model", .mesh_name = meshName(node.mesh)},
+            "stress" + std::to_string(i));
+        auto& transform = model->entity_.getComponent<ecs::TransformComponent>();
+        transform.translation = node.translation;
+        transform.rotation = node.rotation;
+        transform.scale = node.scale;
+        if (node.parent == StressLayout::NO_PARENT) {
+            roots_.push_back(i);
+            world.addDrawable(model);
+        } else {
+            world.addDrawable(model, models_[node.parent]->getId());
+        }
+        models_.push_back(std::move(model));
+    }
+
+    for (const auto& light : layout_.lights) {
+        auto effect =
+            std::make_shared<PointLightEffect>(manager, light.intensity, light.range, light.color);
+        effect->entity_.getComponent<ecs::TransformComponent>().translation = light.position;
+        world.addDrawable(effect);
+    }
+
+    for (std::uint32_t i = 0; i < settings.particle_systems; ++i) {
+        world.addDrawable(
+            std::make_shared<DeltaParticle>(manager, frame_layout, settings.particles_per_system));
+    }
+    PickingSystem::commit();
+}
+
+void StressScene::animate(float seconds) {
+    for (std::size_t i = 0; i < roots_.size(); i += ANIMATED_ROOT_STRIDE) {
+        const auto root = roots_[i];
+        models_[root]->entity_.getComponent<ecs::TransformComponent>().rotation.y =
+            layout_.models[root].rotation.y + (seconds * .5f);
+    }
+}
+
+}  // namespace graphics::effects
@@ -0,0 +1,78 @@
+#pragma once
+#include "core/frontend/framebuffer_layout.hpp"
+#include "effects/effect.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace world {
+class World;
+}
+
+namespace graphics::effects {
+class LightModel;
+
+struct StressSceneSettings {
+        std::uint64_t seed{1};
+        std::uint32_t models{1000};
+        std::uint32_t lights{64};
+        std::uint32_t particle_systems{0};
+        std::uint32_t particles_per_system{4096};
+        // 每条变换链上的模型数，1 表示全部是根节点
+        std::uint32_t hierarchy_depth{1};
+        // 不同网格的数量，同一网格的模型可以合并成实例化绘制
+        std::uint32_t mesh_variants{8};
+        float extent{200.f};  // 根节点分布在 XZ 平面 [-extent, extent] 内
+};
+
+/// 只由设置决定的场景布局，相同的设置（包括种子）在任何平台上都生成相同的结果。
+/// 模型按链排列，父节点总在子节点之前
+struct StressLayout {
+        static constexpr std::uint32_t NO_PARENT = std::numeric_limits<std::uint32_t>::max();
+
+        struct Node {
+                std::uint32_t parent{NO_PARENT};  // models 中的下标
+                std::uint32_t mesh{0};
+                glm::vec3 translation{0.f};  // 相对于父节点
+                glm::vec3 rotation{0.f};
+                glm::vec3 scale{1.f};
+        };
+        struct Light {
+                glm::vec3 position{0.f};
+                glm::vec3 color{1.f};
+                float intensity{1.f};
+                float range{1.f};
+        };
+
+        std::vector<Node> models;
+        std::vector<Light> lights;
+        std::vector<glm::vec3> mesh_extents;  // 每种网格（长方体）的半边长
+};
+
+auto make_stress_layout(const StressSceneSettings& settings) -> StressLayout;
+
+/// 按 StressLayout 直接在 World 中创建模型、点光源和粒子，用于性能测试。
+/// 网格是程序生成的长方体，不读取模型文件；shader 需要事先加载（model、point_light、particle）
+class StressScene {
+    public:
+        StressScene(const StressSceneSettings& settings, ResourceManager& manager,
+                    world::World& world, const layout::FrameBufferLayout& frame_layout);
+
+        // 按时间转动根节点，整条链的世界矩阵都要重算
+        void animate(float seconds);
+
+        [[nodiscard]] auto layout() const -> const StressLayout& { return layout_; }
+        [[nodiscard]] auto modelCount() const -> std::size_t { return models_.size(); }
+
+    private:
+        StressLayout layout_;
+        // 点光源和粒子由 World 持有
+        std::vector<std::shared_ptr<LightModel>> models_;
+        std::vector<std::uint32_t> roots_;
+        // 每隔这么多个根节点转动一个，其余保持静止
+        static constexpr std::uint32_t ANIMATED_ROOT_STRIDE = 4;
+};
+
+}  // namespace graphics::effects
@@ -15,6 +15,7 @@
 #include "ecs/ui/lightUI.hpp"
 #include "effects/light/point_light.hpp"
 #include "effects/cubemap/skybox.hpp"
+#include <array>
 #include <string>
 
 #include <glm/gtc/quaternion.hpp>
@@ -288,18 +289,24 @@ void DrawModelTreeNode(ecs::Entity entity) {
     ImGui::PopID();
 }
 
-void DrawOutlinerTree(const ecs::Outliner& outliner, int id) {
-    auto& tag = outliner.entity.getComponent<ecs::TagComponent>();
-    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
-    ImGui::PushID(id);  // 使用 entity 的唯一 id
+// 大纲视图的一个节点行。子实体是后面独立的行，这里不 TreePush，展开状态记录在 OutlinerModel 中
+void DrawOutlinerNode(world::OutlinerModel& outliner, const world::OutlinerModel::Row& row) {
+    auto entity = outliner.entity(row);
+    auto& tag = entity.getComponent<ecs::TagComponent>();
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth |
+                               ImGuiTreeNodeFlags_NoTreePushOnOpen;
+    if (outliner.childCount(row.node) == 0) {
+        flags |= ImGuiTreeNodeFlags_Leaf;
+    }
+    ImGui::PushID(static_cast<int>(row.node));  // 槽位在节点删除前不变
     static uint32_t select_id = std::numeric_limits<unsigned int>::max();
-    auto find_detail_child = std::ranges::find(outliner.children.begin(), outliner.children.end(),
-                                               detail_entity) != outliner.children.end();
+    const bool find_detail_child = detail_entity && outliner.isChild(row.node, detail_entity);
 
+    ImGui::SetNextItemOpen(row.expanded);
     bool open{};
     // 判断点击事件
-    if (outliner.entity.hasComponent<ecs::RenderStateComponent>()) {
-        auto& render_state = outliner.entity.getComponent<ecs::RenderStateComponent>();
+    if (entity.hasComponent<ecs::RenderStateComponent>()) {
+        auto& render_state = entity.getComponent<ecs::RenderStateComponent>();
         if (find_detail_child) {
             select_id = render_state.id;
         }
@@ -315,11 +322,11 @@ void DrawOutlinerTree(const ecs::Outliner& outliner, int id) {
         ImGui::Checkbox(("##vis" + tag.tag).c_str(), &render_state.visible);
         ImGui::PopItemFlag();
         ImGui::SameLine();
-        open = ImGui::TreeNodeEx(&outliner.entity, flags, "%s", tag.tag.c_str());
+        open = ImGui::TreeNodeEx(&tag, flags, "%s", tag.tag.c_str());
         auto popup_tag = std::string("##tag_context_menu") + std::to_string(render_state.id);
         if (ImGui::BeginPopupContextItem(popup_tag.c_str(), ImGuiPopupFlags_MouseButtonRight)) {
             if (ImGui::MenuItem("编辑")) {
-                detail_entity = outliner.entity;
+                detail_entity = entity;
                 select_id = render_state.id;
             }
             if (ImGui::MenuItem("删除")) {
@@ -339,21 +346,35 @@ void DrawOutlinerTree(const ecs::Outliner& outliner, int id) {
         }
         render_state.select_id = select_id;
     } else {
-        open = ImGui::TreeNodeEx(&outliner.entity, flags, "%s", tag.tag.c_str());
+        open = ImGui::TreeNodeEx(&tag, flags, "%s", tag.tag.c_str());
     }
+    // 下一帧 rows() 重建后生效，不影响本帧正在遍历的行
+    if (open != row.expanded) {
+        outliner.setOpen(row.node, open);
+    }
+    ImGui::PopID();
+}
 
-    if (open) {
-        if (!outliner.children.empty()) {
-            // children with indent
-            ImGui::Indent();
-            for (const auto& childEntity : outliner.children) {
-                DrawModelTreeNode(childEntity);
+// 只绘制滚动区域内可见的行，行数再多每帧的开销也只与窗口高度有关
+void DrawOutlinerRows(world::OutlinerModel& outliner) {
+    static std::array<char, 128> filter{};
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    if (ImGui::InputTextWithHint("##outliner_filter", "搜索", filter.data(), filter.size())) {
+        outliner.setFilter(filter.data());
+    }
+    const auto rows = outliner.rows();
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rows.size()));
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            const auto& row = rows[static_cast<std::size_t>(i)];
+            if (row.entry == 0) {
+                DrawOutlinerNode(outliner, row);
+            } else {
+                DrawModelTreeNode(outliner.entity(row));
             }
-            ImGui::Unindent();
         }
-        ImGui::TreePop();
     }
-    ImGui::PopID();
 }
 
 void add_point_light(world::World& world, ResourceManager& resourceManager, bool* open) {
@@ -435,11 +456,7 @@ void showOutliner(world::World& world, ResourceManager& resourceManager, setting
         ImGui::SetNextWindowSize(window_size);
         ImGui::SetNextWindowPos(panelPos);
         ImGui::Begin("Outliner", &data.show_out_liner, window_flags);
-        static int push_id = 0;
-        world.processOutlineres([&](ecs::Outliner&& outliner) {
-            ecs::Outliner local = std::move(outliner);
-            DrawOutlinerTree(local, push_id++);
-        });
+        DrawOutlinerRows(world.outliner());
         draw_detail(settings::values.menu_data, detail_entity);
         if (ImGui::BeginPopupContextWindow(
                 "Outliner", ImGuiPopupFlags_MouseButtonRight | ImGuiPopupFlags_NoOpenOverItems)) {
@@ -459,7 +476,6 @@ void showOutliner(world::World& world, ResourceManager& resourceManager, setting
             ImGui::EndPopup();
         }
         ImGui::End();
-        push_id = 0;
     }
 
     if (outLinerMenuData.add_point_light_window) {
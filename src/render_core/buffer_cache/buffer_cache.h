@@ -28,6 +28,13 @@ auto BufferCache<P>::addIndexBuffer(const void* data, u32 size) -> BufferId {
     return buffer_id;
 }
 
+template <class P>
+void BufferCache<P>::DeleteBuffer(BufferId id) {
+    if (id) {
+        slot_buffers.erase(id);
+    }
+}
+
 template <class P>
 void BufferCache<P>::BindIndexBuffer(IndexFormat format, BufferId id) {
     runtime.BindIndexBuffer(format, slot_buffers[id]);
@@ -93,6 +100,32 @@ template <class P>
 void BufferCache<P>::UploadGraphicUniformBuffer(std::span<std::span<const std::byte>> data) {
     graphic_uniform_buffers = data;
 }
+template <class P>
+void BufferCache<P>::UploadGraphicStorageBuffer(std::span<const std::byte> data) {
+    if (data.empty()) {
+        return;
+    }
+    runtime.UploadSceneStorageBuffer(data);
+}
+
+template <class P>
+void BufferCache<P>::BindGraphicStorageBuffer() {
+    runtime.BindSceneStorageBuffer();
+}
+
+template <class P>
+void BufferCache<P>::UploadGraphicInstanceBuffer(std::span<const std::byte> data) {
+    if (data.empty()) {
+        return;
+    }
+    runtime.UploadInstanceStorageBuffer(data);
+}
+
+template <class P>
+void BufferCache<P>::BindGraphicInstanceBuffer() {
+    runtime.BindInstanceStorageBuffer();
+}
+
 template <class P>
 void BufferCache<P>::UploadComputeUniformBuffer(std::vector<std::span<const std::byte>> data) {
     compute_uniform_buffers = std::move(data);
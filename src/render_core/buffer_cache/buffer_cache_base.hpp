@@ -88,10 +88,18 @@ class BufferCache : public BufferCacheInfo {
         void TickFrame();
         auto addVertexBuffer(const void* data, u32 size) -> BufferId;
         auto addIndexBuffer(const void* data, u32 size) -> BufferId;
+        // 调用方保证 GPU 已经不再使用这个缓冲
+        void DeleteBuffer(BufferId id);
         void BindIndexBuffer(IndexFormat format, BufferId id);
         void BindVertexBuffers(BufferId id, u32 size, u64 stride);
         void BindGraphicUniformBuffer();
         void UploadGraphicUniformBuffer(std::span<std::span<const std::byte>> data);
+        // 每帧一份的场景数据只拷贝一次，绘制时绑定同一块内存
+        void UploadGraphicStorageBuffer(std::span<const std::byte> data);
+        void BindGraphicStorageBuffer();
+        // 实例化绘制在 set 0 的第二个 storage buffer 读取逐实例数据
+        void UploadGraphicInstanceBuffer(std::span<const std::byte> data);
+        void BindGraphicInstanceBuffer();
 
         void bindComputeStorageBuffers(BufferId id);
         void UploadComputeUniformBuffer(std::vector<std::span<const std::byte>> data);
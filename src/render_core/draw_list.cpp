@@ -0,0 +1,253 @@
+#include "render_core/draw_list.hpp"
+#include "render_core/mesh.hpp"
+#include "shader_tools/stage.h"
+#include <tracy/Tracy.hpp>
+#include <xxhash.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace render {
+namespace {
+constexpr std::uint64_t MESH_MASK = (std::uint64_t{1} << 14) - 1;
+
+auto fold16(std::uint64_t hash) -> std::uint16_t {
+    return static_cast<std::uint16_t>(hash ^ (hash >> 16) ^ (hash >> 32) ^ (hash >> 48));
+}
+
+auto pipelineHash(const std::array<ShaderHash, MAX_DRAW_SHADER_STAGE>& shaders,
+                  PrimitiveTopology topology) -> std::uint16_t {
+    struct {
+            ShaderHash vertex;
+            ShaderHash fragment;
+            std::uint64_t topology;
+    } const key{shaders[static_cast<std::uint32_t>(shader::Stage::Vertex)],
+                shaders[static_cast<std::uint32_t>(shader::Stage::Fragment)],
+                static_cast<std::uint64_t>(topology)};
+    return fold16(XXH64(&key, sizeof(key), 0));
+}
+
+auto materialHash(std::span<const TextureId> textures) -> std::uint16_t {
+    return fold16(XXH64(textures.data(), textures.size_bytes(), 0));
+}
+
+auto samePipelineState(const DynamicPipelineState& a, const DynamicPipelineState& b) -> bool {
+    return a.flags == b.flags && a.viewport == b.viewport && a.scissors == b.scissors &&
+           a.blendColor == b.blendColor && a.frontStencilOp == b.frontStencilOp &&
+           a.backStencilOp == b.backStencilOp &&
+           a.stencilFrontProperties == b.stencilFrontProperties &&
+           a.stencilBackProperties == b.stencilBackProperties &&
+           a.depthComparison == b.depthComparison && a.cullFace == b.cullFace;
+}
+}  // namespace
+
+auto drawPass(const DynamicPipelineState& state) -> DrawPass {
+    return state.depthWriteEnable != 0 ? DrawPass::Opaque : DrawPass::Transparent;
+}
+
+auto quantizeSortDepth(float depth) -> std::uint16_t {
+    if (std::isnan(depth)) {
+        return std::numeric_limits<std::uint16_t>::max();
+    }
+    if (!(depth > 0.f)) {
+        return 0;
+    }
+    return static_cast<std::uint16_t>(std::bit_cast<std::uint32_t>(depth) >> 15);
+}
+
+auto makeDrawSortKey(DrawPass pass, std::uint16_t pipeline, std::uint16_t material,
+                     std::uint32_t mesh, float depth) -> std::uint64_t {
+    const std::uint64_t depth_bits = quantizeSortDepth(depth);
+    const std::uint64_t state = (std::uint64_t{pipeline} << 30) |
+                                (std::uint64_t{material} << 14) | (mesh & MESH_MASK);
+    const std::uint64_t key = pass == DrawPass::Opaque
+                                  ? (state << 16) | depth_bits
+                                  : ((0xffffULL - depth_bits) << 46) | state;
+    return (static_cast<std::uint64_t>(pass) << 62) | key;
+}
+
+auto DrawList::copyBytes(std::span<const std::byte> data) -> ByteRange {
+    const ByteRange range{.offset = static_cast<std::uint32_t>(bytes_.size()),
+                          .size = static_cast<std::uint32_t>(data.size())};
+    bytes_.insert(bytes_.end(), data.begin(), data.end());
+    return range;
+}
+
+void DrawList::push(const DrawIndexCommand& command, std::uint32_t vertex_count, bool indexed) {
+    DrawItem item{.shaders = command.shaders,
+                  .topology = command.topology,
+                  .pipeline_state = command.pipelineState,
+                  .mesh = command.mesh,
+                  .index_offset = command.index_offset,
+                  .index_count = command.index_count,
+                  .instance_count = command.instance_count,
+                  .vertex_count = vertex_count,
+                  .indexed = indexed,
+                  .instanced_vertex_shader = command.instanced_vertex_shader};
+    copyResources(item, command.ubos, command.push_constants, command.textures);
+    addItem(item, command.textures, command.sort_depth);
+}
+
+void DrawList::push(const DrawInstanceCommand& command) {
+    if (command.instanceCount == 0 || command.instance_data.size() < command.instanceCount) {
+        return;
+    }
+    DrawItem item{.shaders = command.shaders,
+                  .topology = command.topology,
+                  .pipeline_state = command.pipelineState,
+                  .mesh = command.mesh,
+                  .index_offset = command.index_offset,
+                  .index_count = command.index_count,
+                  .instance_count = command.instanceCount,
+                  .indexed = true};
+    copyResources(item, command.ubos, command.push_constants, command.textures);
+    const auto instances = copyBytes(command.instance_data);
+    item.instance_offset = instances.offset;
+    item.instance_stride = instances.size / command.instanceCount;
+    addItem(item, command.textures, command.sort_depth);
+}
+
+void DrawList::push(const IMeshInstance& instance) {
+    DrawIndexCommand command;
+    command.shaders[static_cast<std::uint32_t>(shader::Stage::Vertex)] =
+        instance.vertexShaderHash();
+    command.shaders[static_cast<std::uint32_t>(shader::Stage::Fragment)] =
+        instance.fragmentShaderHash();
+    command.topology = instance.getPrimitiveTopology();
+    command.pipelineState = instance.getPipelineState();
+    command.ubos = instance.getUBOs();
+    command.push_constants = instance.getPushConstants();
+    command.textures = instance.getMaterialIds();
+    command.index_offset = instance.getRenderCommand().indexOffset;
+    command.index_count = instance.getRenderCommand().indexCount;
+    command.mesh = instance.getMeshId();
+    command.sort_depth = instance.getSortDepth();
+    command.instanced_vertex_shader = instance.instancedVertexShaderHash();
+    const auto vertex_count = static_cast<std::uint32_t>(std::max(instance.getVertexCount(), 0));
+    push(command, vertex_count, command.index_count > 0);
+}
+
+void DrawList::copyResources(DrawItem& item, std::span<std::span<const std::byte>> ubos,
+                             std::span<const std::byte> push_constants,
+                             std::span<const TextureId> textures) {
+    item.ubo_first = static_cast<std::uint32_t>(ubo_ranges_.size());
+    item.ubo_count = static_cast<std::uint32_t>(ubos.size());
+    for (const auto& ubo : ubos) {
+        ubo_ranges_.push_back(copyBytes(ubo));
+    }
+    const auto push_range = copyBytes(push_constants);
+    item.push_offset = push_range.offset;
+    item.push_size = push_range.size;
+    item.texture_first = static_cast<std::uint32_t>(textures_.size());
+    item.texture_count = static_cast<std::uint32_t>(textures.size());
+    textures_.insert(textures_.end(), textures.begin(), textures.end());
+}
+
+void DrawList::addItem(const DrawItem& item, std::span<const TextureId> textures,
+                       float sort_depth) {
+    const auto key = makeDrawSortKey(drawPass(item.pipeline_state),
+                                     pipelineHash(item.shaders, item.topology),
+                                     materialHash(textures), item.mesh.index, sort_depth);
+    order_.push_back({.key = key, .value = static_cast<std::uint32_t>(items_.size())});
+    items_.push_back(item);
+}
+
+auto DrawList::sameMaterial(const DrawItem& a, const DrawItem& b) const -> bool {
+    if (!std::ranges::equal(textures(a), textures(b)) || a.ubo_count != b.ubo_count) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < a.ubo_count; ++i) {
+        const auto lhs = ubo_ranges_[a.ubo_first + i];
+        const auto rhs = ubo_ranges_[b.ubo_first + i];
+        if (lhs.size != rhs.size ||
+            (lhs.size != 0 &&
+             std::memcmp(bytes_.data() + lhs.offset, bytes_.data() + rhs.offset, lhs.size) != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto DrawList::canInstance(const DrawItem& a, const DrawItem& b) const -> bool {
+    return a.instanced_vertex_shader != 0 &&
+           a.instanced_vertex_shader == b.instanced_vertex_shader && a.instance_stride == 0 &&
+           b.instance_stride == 0 && a.instance_count == 1 && b.instance_count == 1 &&
+           a.indexed && b.indexed && a.shaders == b.shaders && a.topology == b.topology &&
+           a.mesh == b.mesh && a.index_offset == b.index_offset &&
+           a.index_count == b.index_count && a.push_size != 0 && a.push_size == b.push_size &&
+           samePipelineState(a.pipeline_state, b.pipeline_state) && sameMaterial(a, b);
+}
+
+auto DrawList::appendInstances(std::span<const std::byte> data, std::uint32_t stride)
+    -> std::uint32_t {
+    // gl_InstanceIndex 按 stride 索引，起点对齐到 stride 的整数倍
+    const std::size_t first = (instance_bytes_.size() + stride - 1) / stride;
+    instance_bytes_.resize(first * stride);
+    instance_bytes_.insert(instance_bytes_.end(), data.begin(), data.end());
+    return static_cast<std::uint32_t>(first);
+}
+
+void DrawList::buildBatches() {
+    batches_.clear();
+    instance_bytes_.clear();
+    for (std::size_t i = 0; i < items_.size();) {
+        const DrawItem& head = item(i);
+        DrawBatch batch{.first = static_cast<std::uint32_t>(i),
+                        .vertex_shader =
+                            head.shaders[static_cast<std::uint32_t>(shader::Stage::Vertex)],
+                        .instance_count = head.instance_count};
+        if (head.instance_stride != 0) {
+            batch.instanced = true;
+            batch.first_instance = appendInstances(
+                std::span(bytes_).subspan(head.instance_offset,
+                                          static_cast<std::size_t>(head.instance_stride) *
+                                              head.instance_count),
+                head.instance_stride);
+        } else {
+            std::size_t end = i + 1;
+            while (end < items_.size() && canInstance(head, item(end))) {
+                ++end;
+            }
+            const auto count = static_cast<std::uint32_t>(end - i);
+            if (count >= MIN_INSTANCE_BATCH) {
+                batch.count = count;
+                batch.instance_count = count;
+                batch.vertex_shader = head.instanced_vertex_shader;
+                batch.instanced = true;
+                batch.first_instance = appendInstances(pushConstants(head), head.push_size);
+                for (std::size_t j = i + 1; j < end; ++j) {
+                    const auto data = pushConstants(item(j));
+                    instance_bytes_.insert(instance_bytes_.end(), data.begin(), data.end());
+                }
+            }
+        }
+        i += batch.count;
+        batches_.push_back(batch);
+    }
+}
+
+void DrawList::sort() {
+    ZoneScoped;
+    ubo_views_.clear();
+    ubo_views_.reserve(ubo_ranges_.size());
+    for (const auto& range : ubo_ranges_) {
+        ubo_views_.emplace_back(bytes_.data() + range.offset, range.size);
+    }
+    common::radixSort(order_, scratch_);
+    buildBatches();
+}
+
+void DrawList::clear() {
+    items_.clear();
+    order_.clear();
+    bytes_.clear();
+    ubo_ranges_.clear();
+    ubo_views_.clear();
+    textures_.clear();
+    batches_.clear();
+    instance_bytes_.clear();
+}
+
+}  // namespace render
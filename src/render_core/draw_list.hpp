@@ -0,0 +1,132 @@
+#pragma once
+#include "render_core/render_command.hpp"
+#include "common/radix_sort.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace render {
+class IMeshInstance;
+
+/// 写深度的物体为不透明，按状态分组、组内由近到远；不写深度的（天空盒、透明物体）放在之后由远到近。
+/// colorBlendEnable 默认开启，不能用来区分透明物体
+enum class DrawPass : std::uint8_t { Opaque = 0, Transparent = 1 };
+
+[[nodiscard]] auto drawPass(const DynamicPipelineState& state) -> DrawPass;
+// 非负浮点数的位模式单调，取高 16 位；负数记为 0，NaN 记为最远
+[[nodiscard]] auto quantizeSortDepth(float depth) -> std::uint16_t;
+
+/**
+ * @brief 64 位排序 key，从高到低：
+ * 不透明：pass 2 | pipeline 16 | material 16 | mesh 14 | depth 16
+ * 透明：  pass 2 | 反转 depth 16 | pipeline 16 | material 16 | mesh 14
+ */
+[[nodiscard]] auto makeDrawSortKey(DrawPass pass, std::uint16_t pipeline, std::uint16_t material,
+                                   std::uint32_t mesh, float depth) -> std::uint64_t;
+
+struct DrawItem {
+        std::array<ShaderHash, MAX_DRAW_SHADER_STAGE> shaders{};
+        PrimitiveTopology topology{};
+        DynamicPipelineState pipeline_state;
+        MeshId mesh;
+        std::uint32_t index_offset{};
+        std::uint32_t index_count{};
+        std::uint32_t instance_count{1};
+        std::uint32_t vertex_count{};
+        bool indexed{true};
+        // DrawList 内部数组中的范围
+        std::uint32_t ubo_first{};
+        std::uint32_t ubo_count{};
+        std::uint32_t push_offset{};
+        std::uint32_t push_size{};
+        std::uint32_t texture_first{};
+        std::uint32_t texture_count{};
+        ShaderHash instanced_vertex_shader{};
+        // DrawInstanceCommand 的逐实例数据，stride 为 0 表示普通绘制
+        std::uint32_t instance_offset{};
+        std::uint32_t instance_stride{};
+};
+
+/// 排序后连续的一段绘制，instanced 时逐实例数据在 instanceData() 中从 first_instance 开始
+struct DrawBatch {
+        std::uint32_t first{};  // 排序后的下标
+        std::uint32_t count{1};
+        ShaderHash vertex_shader{};
+        std::uint32_t instance_count{1};
+        std::uint32_t first_instance{};
+        bool instanced{false};
+};
+
+/// 一帧内的绘制先记录到这里，flush 时按 key 排序再执行，相邻的绘制尽量共享管线、纹理和网格。
+/// 排序后相邻且只有 push constant 不同的绘制合并成一批实例化绘制，push constant 作为逐实例数据。
+/// push 时复制 UBO、push constant 和纹理 ID，调用方的数据不需要保持到 flush
+class DrawList {
+    public:
+        // 少于这个数量的相同绘制不值得切换到实例化着色器
+        static constexpr std::uint32_t MIN_INSTANCE_BATCH = 2;
+
+        // indexed 为 false 时用 vertex_count 做非索引绘制
+        void push(const DrawIndexCommand& command, std::uint32_t vertex_count, bool indexed);
+        void push(const DrawInstanceCommand& command);
+        // 网格实例没有设置顶点数时按 0 处理，index_count 为 0 时做非索引绘制
+        void push(const IMeshInstance& instance);
+        // 排序并生成 batches() 和 instanceData()
+        void sort();
+        void clear();
+
+        [[nodiscard]] auto batches() const -> std::span<const DrawBatch> { return batches_; }
+        // 本次 flush 所有实例化绘制的数据，按 batch 的 first_instance 排列
+        [[nodiscard]] auto instanceData() const -> std::span<const std::byte> {
+            return instance_bytes_;
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t { return items_.size(); }
+        [[nodiscard]] auto empty() const -> bool { return items_.empty(); }
+        // sort 之后按 key 的顺序访问
+        [[nodiscard]] auto item(std::size_t i) const -> const DrawItem& {
+            return items_[order_[i].value];
+        }
+        [[nodiscard]] auto key(std::size_t i) const -> std::uint64_t { return order_[i].key; }
+
+        [[nodiscard]] auto ubos(const DrawItem& item) -> std::span<std::span<const std::byte>> {
+            return std::span(ubo_views_).subspan(item.ubo_first, item.ubo_count);
+        }
+        [[nodiscard]] auto pushConstants(const DrawItem& item) const -> std::span<const std::byte> {
+            return std::span(bytes_).subspan(item.push_offset, item.push_size);
+        }
+        [[nodiscard]] auto textures(const DrawItem& item) const -> std::span<const TextureId> {
+            return std::span(textures_).subspan(item.texture_first, item.texture_count);
+        }
+        // 纹理和 UBO 内容都相同时可以沿用上一次绘制的描述符
+        [[nodiscard]] auto sameMaterial(const DrawItem& a, const DrawItem& b) const -> bool;
+        // 只有 push constant 不同，可以合并到同一次实例化绘制
+        [[nodiscard]] auto canInstance(const DrawItem& a, const DrawItem& b) const -> bool;
+
+    private:
+        struct ByteRange {
+                std::uint32_t offset{};
+                std::uint32_t size{};
+        };
+        auto copyBytes(std::span<const std::byte> data) -> ByteRange;
+        void copyResources(DrawItem& item, std::span<std::span<const std::byte>> ubos,
+                           std::span<const std::byte> push_constants,
+                           std::span<const TextureId> textures);
+        void addItem(const DrawItem& item, std::span<const TextureId> textures, float sort_depth);
+        void buildBatches();
+        auto appendInstances(std::span<const std::byte> data, std::uint32_t stride)
+            -> std::uint32_t;
+
+        std::vector<DrawItem> items_;
+        std::vector<common::SortPair> order_;
+        std::vector<common::SortPair> scratch_;
+        std::vector<std::byte> bytes_;
+        std::vector<ByteRange> ubo_ranges_;
+        // bytes_ 在 push 时可能重新分配，sort 时才生成视图
+        std::vector<std::span<const std::byte>> ubo_views_;
+        std::vector<TextureId> textures_;
+        std::vector<DrawBatch> batches_;
+        std::vector<std::byte> instance_bytes_;
+};
+
+}  // namespace render
@@ -5,7 +5,9 @@
 #include "render_core/texture/types.hpp"
 #include "render_core/render_command.hpp"
 #include "render_core/mesh.hpp"
+#include "render_core/object_id.hpp"
 #include <ktx.h>
+#include <optional>
 namespace render {
 using GraphicsId = common::SlotId;
 
@@ -33,8 +35,15 @@ class Graphic {
         virtual auto uploadModel(const IMeshData& instance) -> MeshId = 0;
         virtual auto uploadTexture(const ITexture& texture) -> TextureId = 0;
         virtual auto uploadTexture(ktxTexture* ktxTexture) -> TextureId = 0;
+        /// 资源的最后一个引用释放后调用，之后不能再使用这个 id。
+        /// 已经提交的命令可能还在使用它，实现要等 GPU 执行完这些命令再销毁缓冲和图像
+        virtual void releaseModel(MeshId id) = 0;
+        virtual void releaseTexture(TextureId id) = 0;
         virtual void draw(const IMeshInstance& instance) = 0;
         virtual void draw(const DrawIndexCommand& command) = 0;
+        virtual void draw(const DrawInstanceCommand& command) = 0;
+        /// draw 只记录到本帧的绘制列表，这里排序后统一提交，减少管线和描述符的切换
+        virtual void flushDraws() = 0;
 
         /**
          * @brief 添加shader，返回shader的hash，同过设置IModelInstance设置shader hash
@@ -47,6 +56,20 @@ class Graphic {
         virtual auto addShader(std::span<const u32> data, ShaderType type) -> u64 = 0;
         virtual void dispatchCompute(const IComputeInstance& instance) = 0;
         virtual void clean(const CleanValue& cleanValue) = 0;
+
+        /**
+         * @brief 每帧上传一次的场景数据（相机、灯光），之后的绘制共享同一份 storage buffer。
+         * 使用它的 shader 在顶点阶段声明 set 0 binding 0 的 storage buffer
+         */
+        virtual void uploadSceneStorageBuffer(std::span<const std::byte> data) = 0;
+
+        /**
+         * @brief 请求回读物体 ID 渲染目标的一小块区域，在下一帧开始时拷贝，不会等待 GPU
+         * 需要 CleanValue 中 color_formats[1] 为 R32G32B32A32_UINT
+         */
+        virtual void requestObjectIdReadback(const ObjectIdRequest& request) = 0;
+        /// GPU 完成拷贝后返回结果，否则返回 std::nullopt
+        virtual auto tryGetObjectIdReadback() -> std::optional<ObjectIdReadback> = 0;
         Graphic() = default;
         Graphic(const Graphic&) = default;
         Graphic(Graphic&&) noexcept = default;
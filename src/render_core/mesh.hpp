@@ -3,6 +3,7 @@
 #include "render_core/types.hpp"
 #include "render_core/pipeline_state.h"
 #include "common/assert.hpp"
+#include <limits>
 #include <span>
 
 namespace render {
@@ -53,6 +54,16 @@ class IMeshInstance {
         [[nodiscard]] auto getRenderCommand() const -> render::RenderCommand {
             return render_command;
         }
+        // 到近平面的距离，Graphic 据此对绘制排序
+        void setSortDepth(float depth) { sort_depth = depth; }
+        [[nodiscard]] auto getSortDepth() const -> float { return sort_depth; }
+        // 从 storage buffer 读取 push constant 的顶点着色器，渲染器据此合并相同的绘制
+        void setInstancedVertexShaderHash(std::uint64_t hash) {
+            instanced_vertex_shader_hash = hash;
+        }
+        [[nodiscard]] auto instancedVertexShaderHash() const -> std::uint64_t {
+            return instanced_vertex_shader_hash;
+        }
         template <typename T>
         void setUBO(uint32_t binding, const T& data) {
             static_assert(std::is_trivially_copyable_v<T>, "UBO must be trivially copyable");
@@ -71,7 +82,9 @@ class IMeshInstance {
         render::MeshId meshId;
         std::uint64_t vertex_shader_hash{0};
         std::uint64_t fragment_shader_hash{0};
+        std::uint64_t instanced_vertex_shader_hash{0};
         std::int32_t vertex_count{-1};
+        float sort_depth{std::numeric_limits<float>::infinity()};
         std::vector<std::vector<std::byte>> ubo_buffers_;
 };
 
@@ -0,0 +1,54 @@
+#include "render_core/null_graphic.hpp"
+
+namespace render {
+
+auto NullGraphic::uploadModel(const IMeshData& /*instance*/) -> MeshId {
+    ++stats_.live_meshes;
+    return MeshId{next_mesh_++};
+}
+
+auto NullGraphic::uploadTexture(const ITexture& /*texture*/) -> TextureId {
+    ++stats_.live_textures;
+    return TextureId{next_texture_++};
+}
+
+auto NullGraphic::uploadTexture(ktxTexture* /*ktxTexture*/) -> TextureId {
+    ++stats_.live_textures;
+    return TextureId{next_texture_++};
+}
+
+void NullGraphic::releaseModel(MeshId /*id*/) { --stats_.live_meshes; }
+
+void NullGraphic::releaseTexture(TextureId /*id*/) { --stats_.live_textures; }
+
+void NullGraphic::draw(const IMeshInstance& instance) {
+    ++stats_.draws;
+    draw_list_.push(instance);
+}
+
+void NullGraphic::draw(const DrawIndexCommand& command) {
+    ++stats_.draws;
+    draw_list_.push(command, 0, true);
+}
+
+void NullGraphic::draw(const DrawInstanceCommand& command) {
+    ++stats_.draws;
+    draw_list_.push(command);
+}
+
+void NullGraphic::flushDraws() {
+    ++stats_.flushes;
+    if (draw_list_.empty()) {
+        return;
+    }
+    draw_list_.sort();
+    stats_.batches += draw_list_.batches().size();
+    draw_list_.clear();
+}
+
+auto NullGraphic::addShader(std::span<const u32> /*data*/, ShaderType /*type*/) -> u64 {
+    // 0 表示没有 shader，从 1 开始
+    return ++next_shader_;
+}
+
+}  // namespace render
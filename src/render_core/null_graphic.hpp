@@ -0,0 +1,50 @@
+#pragma once
+#include "render_core/graphic.hpp"
+#include "render_core/draw_list.hpp"
+
+namespace render {
+
+/// 不创建任何 GPU 资源的 Graphic，只分配 id 并统计调用次数。
+/// 绘制和 VulkanGraphics 一样记录到 DrawList，flush 时排序、合批后丢弃，
+/// 无窗口的性能测试用它驱动 World 的 update/draw，测量的是 CPU 侧的开销
+class NullGraphic : public Graphic {
+    public:
+        struct Stats {
+                std::uint64_t draws{0};
+                std::uint64_t dispatches{0};
+                std::uint64_t flushes{0};
+                std::uint64_t batches{0};  // 排序合批后的绘制次数
+                std::uint32_t live_meshes{0};
+                std::uint32_t live_textures{0};
+        };
+
+        auto getDrawImage() -> unsigned long long override { return 0; }
+        auto uploadModel(const IMeshData& instance) -> MeshId override;
+        auto uploadTexture(const ITexture& texture) -> TextureId override;
+        auto uploadTexture(ktxTexture* ktxTexture) -> TextureId override;
+        void releaseModel(MeshId id) override;
+        void releaseTexture(TextureId id) override;
+        void draw(const IMeshInstance& instance) override;
+        void draw(const DrawIndexCommand& command) override;
+        void draw(const DrawInstanceCommand& command) override;
+        void flushDraws() override;
+        auto addShader(std::span<const u32> data, ShaderType type) -> u64 override;
+        void dispatchCompute(const IComputeInstance& /*instance*/) override { ++stats_.dispatches; }
+        void clean(const CleanValue& /*cleanValue*/) override {}
+        void uploadSceneStorageBuffer(std::span<const std::byte> /*data*/) override {}
+        void requestObjectIdReadback(const ObjectIdRequest& /*request*/) override {}
+        auto tryGetObjectIdReadback() -> std::optional<ObjectIdReadback> override {
+            return std::nullopt;
+        }
+
+        [[nodiscard]] auto stats() const -> const Stats& { return stats_; }
+
+    private:
+        Stats stats_;
+        DrawList draw_list_;
+        u32 next_mesh_{0};
+        u32 next_texture_{0};
+        u64 next_shader_{0};
+};
+
+}  // namespace render
@@ -0,0 +1,61 @@
+#include "render_core/object_id.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace render {
+
+auto makeObjectIdReadback(const ObjectIdRequest& request, std::uint32_t width,
+                          std::uint32_t height) -> ObjectIdReadback {
+    if (width == 0 || height == 0) {
+        return {};
+    }
+    const auto max_x = static_cast<std::int64_t>(width) - 1;
+    const auto max_y = static_cast<std::int64_t>(height) - 1;
+    const auto center_x =
+        std::clamp(static_cast<std::int64_t>(std::floor(request.u * static_cast<float>(width))),
+                   std::int64_t{0}, max_x);
+    const auto center_y =
+        std::clamp(static_cast<std::int64_t>(std::floor(request.v * static_cast<float>(height))),
+                   std::int64_t{0}, max_y);
+    const auto radius = static_cast<std::int64_t>(request.radius);
+    const auto x0 = std::max<std::int64_t>(0, center_x - radius);
+    const auto y0 = std::max<std::int64_t>(0, center_y - radius);
+    const auto x1 = std::min<std::int64_t>(max_x, center_x + radius);
+    const auto y1 = std::min<std::int64_t>(max_y, center_y + radius);
+    return {.region = {.x = static_cast<std::int32_t>(x0),
+                       .y = static_cast<std::int32_t>(y0),
+                       .width = static_cast<std::uint32_t>(x1 - x0 + 1),
+                       .height = static_cast<std::uint32_t>(y1 - y0 + 1)},
+            .center_x = static_cast<std::uint32_t>(center_x),
+            .center_y = static_cast<std::uint32_t>(center_y),
+            .ids = {}};
+}
+
+auto resolveObjectId(const ObjectIdReadback& readback) -> std::optional<ObjectId> {
+    const auto& region = readback.region;
+    if (readback.ids.size() < static_cast<std::size_t>(region.width) * region.height) {
+        return std::nullopt;
+    }
+    std::optional<ObjectId> best;
+    auto best_distance = std::numeric_limits<std::int64_t>::max();
+    for (std::uint32_t row = 0; row < region.height; ++row) {
+        for (std::uint32_t col = 0; col < region.width; ++col) {
+            const auto& id = readback.ids[(static_cast<std::size_t>(row) * region.width) + col];
+            if (id.coverage == 0) {
+                continue;
+            }
+            const auto dx = static_cast<std::int64_t>(region.x) + col - readback.center_x;
+            const auto dy = static_cast<std::int64_t>(region.y) + row - readback.center_y;
+            const auto distance = (dx * dx) + (dy * dy);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = id;
+            }
+        }
+    }
+    return best;
+}
+
+}  // namespace render
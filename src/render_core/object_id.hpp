@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace render {
+
+// 物体 ID 写入的颜色附件下标，对应 fragment shader 中 layout(location = 1)
+constexpr std::uint32_t OBJECT_ID_COLOR_ATTACHMENT = 1;
+
+// 物体 ID 渲染目标的格式：R32G32B32A32_UINT，每个像素 (model, mesh, primitive, coverage)
+struct ObjectId {
+        std::uint32_t model_id{};
+        std::uint32_t mesh_id{};
+        std::uint32_t primitive_id{};
+        std::uint32_t coverage{};  // 0 表示该像素没有被任何模型覆盖
+};
+static_assert(sizeof(ObjectId) == 16);
+
+// 拾取请求，u v 为归一化的屏幕坐标，radius 为读取的像素半径
+struct ObjectIdRequest {
+        float u{};
+        float v{};
+        std::uint32_t radius{2};
+};
+
+struct ObjectIdRegion {
+        std::int32_t x{};
+        std::int32_t y{};
+        std::uint32_t width{};
+        std::uint32_t height{};
+};
+
+struct ObjectIdReadback {
+        ObjectIdRegion region;
+        std::uint32_t center_x{};
+        std::uint32_t center_y{};
+        std::vector<ObjectId> ids;  // region.width * region.height，行优先
+};
+
+// ID 通过 push constant 中的 float 传给 shader，2^24 以内可以精确表示
+constexpr std::uint32_t MAX_ENCODABLE_OBJECT_ID = 1U << 24U;
+[[nodiscard]] constexpr auto encodeObjectId(std::uint32_t id) -> float {
+    return static_cast<float>(id);
+}
+
+// 把请求映射为渲染目标上被裁剪过的像素区域，ids 由回读填充
+auto makeObjectIdReadback(const ObjectIdRequest& request, std::uint32_t width,
+                          std::uint32_t height) -> ObjectIdReadback;
+
+// 选出区域内距离中心最近的有效像素
+auto resolveObjectId(const ObjectIdReadback& readback) -> std::optional<ObjectId>;
+
+}  // namespace render
@@ -2,6 +2,7 @@
 #include "render_core/types.hpp"
 #include "render_core/pipeline_state.h"
 #include <boost/container/small_vector.hpp>
+#include <limits>
 #include <variant>
 #include <span>
 
@@ -20,6 +21,11 @@ struct DrawIndexCommand {
         std::uint32_t index_count{};
         std::uint32_t instance_count{1};
         MeshId mesh;
+        // 到近平面的距离，用于绘制排序；未知时为最远
+        float sort_depth{std::numeric_limits<float>::infinity()};
+        // 非 0 时可以和网格、材质都相同的绘制合并为一次实例化绘制，
+        // 这个顶点着色器从 set 0 的第二个 storage buffer 按 gl_InstanceIndex 读取原来的 push constant
+        ShaderHash instanced_vertex_shader{};
 };
 
 struct DrawInstanceCommand {
@@ -32,6 +38,11 @@ struct DrawInstanceCommand {
         std::span<const render::TextureId> textures;
         DynamicPipelineState pipelineState;
         uint32_t instanceCount{};
+        // instanceCount 个大小相同的元素，顶点着色器从 set 0 的第二个 storage buffer 读取
+        std::span<const std::byte> instance_data;
+        std::uint32_t index_offset{};
+        std::uint32_t index_count{};
+        float sort_depth{std::numeric_limits<float>::infinity()};
 };
 
 struct DrawCountCommand {
@@ -1,5 +1,7 @@
 set(sources
     compute_instance.hpp
+    draw_list.hpp
+    draw_list.cpp
     pipeline_dynamic_state.hpp
     pipeline_state.cpp
     pipeline_state.h
@@ -8,6 +10,10 @@ set(sources
     fsr.cpp
     fsr.h
     graphic.hpp
+    null_graphic.hpp
+    null_graphic.cpp
+    object_id.hpp
+    object_id.cpp
     render_base.cpp
     render_base.hpp
     render_thread.hpp
@@ -153,7 +153,11 @@ auto BufferCacheRuntime::GetStorageBufferAlignment() const -> u32 {
     return static_cast<u32>(device.GetStorageBufferAlignment());
 }
 
-void BufferCacheRuntime::TickFrame() noexcept { uniform_ring.BeginFrame(); }
+void BufferCacheRuntime::TickFrame() noexcept {
+    uniform_ring.BeginFrame();
+    // 上一帧的场景数据所在的流式缓冲区域随后会被复用
+    scene_storage = {};
+}
 
 void BufferCacheRuntime::Finish() { scheduler.finish(); }
 
@@ -389,7 +393,8 @@ auto BufferCacheRuntime::CreateNullBuffer() -> Buffer {
         .flags = 0,
         .size = 4,
         .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
-                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
         .queueFamilyIndexCount = 0,
         .pQueueFamilyIndices = nullptr,
@@ -113,6 +113,19 @@ class BufferCacheRuntime {
             BindBuffer(buffer, offset, size);
         }
 
+        void UploadSceneStorageBuffer(std::span<const std::byte> data) {
+            UploadStorage(scene_storage, data);
+        }
+
+        // 还没有上传时绑定空 buffer，保证描述符数量与 pipeline layout 一致
+        void BindSceneStorageBuffer() { BindStorage(scene_storage); }
+
+        // 实例化绘制的逐实例数据，每次 flush 绘制列表时上传一次
+        void UploadInstanceStorageBuffer(std::span<const std::byte> data) {
+            UploadStorage(instance_storage, data);
+        }
+        void BindInstanceStorageBuffer() { BindStorage(instance_storage); }
+
         void BindTextureBuffer(BaseBufferCache& buffer, u32 offset, u32 size,
                                surface::PixelFormat format) {
             guest_descriptor_queue.AddTexelBuffer(buffer.View(offset, size, format));
@@ -144,6 +157,29 @@ class BufferCacheRuntime {
         };
         UniformRing uniform_ring;
 
+        struct SceneStorage {
+                vk::Buffer buffer{};
+                u32 offset{};
+                u32 size{};
+        };
+        void UploadStorage(SceneStorage& storage, std::span<const std::byte> data) {
+            const auto size = static_cast<u32>(data.size());
+            const StagingBufferRef ref = staging_pool.Request(size, MemoryUsage::Upload);
+            std::memcpy(ref.mapped_span.data(), data.data(), size);
+            storage = SceneStorage{
+                .buffer = ref.buffer, .offset = static_cast<u32>(ref.offset), .size = size};
+        }
+        void BindStorage(const SceneStorage& storage) {
+            if (storage.buffer == VK_NULL_HANDLE) {
+                ReserveNullBuffer();
+                guest_descriptor_queue.AddBuffer(*null_buffer, 0, VK_WHOLE_SIZE);
+                return;
+            }
+            BindBuffer(storage.buffer, storage.offset, storage.size);
+        }
+        SceneStorage scene_storage;
+        SceneStorage instance_storage;
+
         const Device& device;
         MemoryAllocator& memory_allocator;
         scheduler::Scheduler& scheduler;
@@ -183,6 +183,23 @@ GraphicsPipeline::GraphicsPipeline(
             push_constant_size = info->push_constants.size;
         }
     }
+    const auto& vertex_info = stage_infos.at(static_cast<size_t>(shader::Stage::Vertex));
+    uses_scene_storage = !vertex_info.storage_buffers_descriptors.empty();
+    uses_instance_storage = vertex_info.storage_buffers_descriptors.size() > 1;
+    if (dynamic.has_extended_dynamic_state && dynamic.has_extended_dynamic_state_3_blend) {
+        const u32 fragment_outputs =
+            stage_infos.at(static_cast<size_t>(shader::Stage::Fragment)).output_location_mask;
+        for (size_t index = 1; index < NumAttachments(key_.state); ++index) {
+            const bool written = ((fragment_outputs >> index) & 1U) != 0;
+            extra_blend_enables.push_back(
+                surface::IsPixelFormatInteger(key_.state.color_formats.at(index)) ? VK_FALSE
+                                                                                  : VK_TRUE);
+            extra_write_masks.push_back(
+                written ? vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                              vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
+                        : vk::ColorComponentFlags{});
+        }
+    }
     auto func{[this, shader_notify, &render_pass_cache, &descriptor_pool,
                push_constant_size] -> void {
         pipeline::DescriptorLayoutBuilder builder{MakeBuilder(device_, stage_infos)};
@@ -221,8 +238,19 @@ void GraphicsPipeline::AddTransition(GraphicsPipeline* transition) {
     transitions.push_back(transition);
 }
 
-void GraphicsPipeline::Configure() {
+void GraphicsPipeline::Configure(bool reuse_descriptors) {
+    if (reuse_descriptors) {
+        RequestRenderTarget();
+        PushConstants();
+        return;
+    }
     guest_descriptor_queue_.Acquire();
+    if (uses_scene_storage) {
+        buffer_cache.BindGraphicStorageBuffer();
+    }
+    if (uses_instance_storage) {
+        buffer_cache.BindGraphicInstanceBuffer();
+    }
     buffer_cache.BindGraphicUniformBuffer();
     auto textures = texture_cache.getCurrentTextures();
     auto* sample = texture_cache.getSampler(SamplerPreset::Linear);
@@ -234,12 +262,33 @@ void GraphicsPipeline::Configure() {
     ConfigureDraw();
 }
 
-void GraphicsPipeline::ConfigureDraw() {
+auto GraphicsPipeline::IsBound() const noexcept -> bool {
+    return IsBuilt() && scheduler_.isGraphicsPipelineBound(*pipeline);
+}
+
+void GraphicsPipeline::RequestRenderTarget() {
     if (use_dynamic_render) {
         scheduler_.requestRender(texture_cache.getFramebuffer()->getRenderingRequest());
     } else {
         scheduler_.requestRender(texture_cache.getFramebuffer()->getRenderPassRequest());
     }
+}
+
+void GraphicsPipeline::PushConstants() {
+    const auto data = buffer_cache.GetPushConstants();
+    if (data.empty()) {
+        return;
+    }
+    // 命令在工作线程上录制，调用方的数据不一定还在，按值捕获
+    boost::container::small_vector<std::byte, 128> push(data.begin(), data.end());
+    scheduler_.record([this, push = std::move(push)](vk::CommandBuffer cmdbuf) {
+        cmdbuf.pushConstants(*pipeline_layout, vk::ShaderStageFlagBits::eAllGraphics, 0,
+                             static_cast<u32>(push.size()), push.data());
+    });
+}
+
+void GraphicsPipeline::ConfigureDraw() {
+    RequestRenderTarget();
 
     if (!is_built.load(std::memory_order::relaxed)) {
         // Wait for the pipeline to be built
@@ -250,16 +299,17 @@ void GraphicsPipeline::ConfigureDraw() {
     }
     const bool bind_pipeline{scheduler_.updateGraphicsPipeline(*pipeline)};
     const void* const descriptor_data{guest_descriptor_queue_.UpdateData()};
-    const auto push = buffer_cache.GetPushConstants();
-    scheduler_.record([this, push, descriptor_data, bind_pipeline](vk::CommandBuffer cmdbuf) {
-        if (bind_pipeline) {
+    if (bind_pipeline) {
+        scheduler_.record([this](vk::CommandBuffer cmdbuf) {
             cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
-        }
-        if (!push.empty()) {
-            cmdbuf.pushConstants(*pipeline_layout, vk::ShaderStageFlagBits::eAllGraphics, 0,
-                                 push.size(), push.data());
-        }
-
+            if (!extra_blend_enables.empty()) {
+                cmdbuf.setColorBlendEnableEXT(1, extra_blend_enables);
+                cmdbuf.setColorWriteMaskEXT(1, extra_write_masks);
+            }
+        });
+    }
+    PushConstants();
+    scheduler_.record([this, descriptor_data](vk::CommandBuffer cmdbuf) {
         if (!descriptor_set_layout) {
             return;
         }
@@ -378,6 +428,8 @@ void GraphicsPipeline::makePipeline(vk::RenderPass render_pass) {
     }
     static_vector<vk::PipelineColorBlendAttachmentState, 8> cb_attachments;
     const size_t num_attachments{NumAttachments(key_.state)};
+    const u32 fragment_outputs =
+        stage_infos.at(static_cast<size_t>(shader::Stage::Fragment)).output_location_mask;
     for (size_t index = 0; index < num_attachments; ++index) {
         static constexpr std::array mask_table{
             vk::ColorComponentFlagBits::eR,
@@ -387,11 +439,17 @@ void GraphicsPipeline::makePipeline(vk::RenderPass render_pass) {
 
         };
         vk::ColorComponentFlags write_mask{};
-        for (auto i : mask_table) {
-            write_mask |= i;
+        // 附件 0 保持原行为；其余附件（如物体 ID）只有着色器写出时才写入
+        if (index == 0 || ((fragment_outputs >> index) & 1U) != 0) {
+            for (auto i : mask_table) {
+                write_mask |= i;
+            }
         }
+        // 整数格式不支持混合
+        const bool blend_enable =
+            !surface::IsPixelFormatInteger(key_.state.color_formats.at(index));
         cb_attachments.push_back(vk::PipelineColorBlendAttachmentState()
-                                     .setBlendEnable(VK_TRUE)
+                                     .setBlendEnable(blend_enable ? VK_TRUE : VK_FALSE)
                                      .setSrcColorBlendFactor(vk::BlendFactor::eSrcAlpha)
                                      .setDstColorBlendFactor(vk::BlendFactor::eOneMinusSrcAlpha)
                                      .setColorBlendOp(vk::BlendOp::eAdd)
@@ -82,7 +82,9 @@ class GraphicsPipeline {
         auto operator=(const GraphicsPipeline&) -> GraphicsPipeline& = delete;
         auto operator=(GraphicsPipeline&&) noexcept -> GraphicsPipeline& = delete;
         void AddTransition(GraphicsPipeline* transition);
-        void Configure();
+        // reuse_descriptors 为 true 时只更新 push constant，沿用上一次绘制的描述符，
+        // 调用方需先用 IsBound 确认管线仍然绑定在当前命令缓冲上
+        void Configure(bool reuse_descriptors = false);
         auto HasDynamicVertexInput() const noexcept -> bool {
             return key_.state.dynamic_vertex_input;
         }
@@ -100,11 +102,15 @@ class GraphicsPipeline {
         [[nodiscard]] auto IsBuilt() const noexcept -> bool {
             return is_built.load(std::memory_order::relaxed);
         }
+        // 自上次绑定后没有切换管线也没有提交，命令缓冲上的描述符和顶点缓冲仍然有效
+        [[nodiscard]] auto IsBound() const noexcept -> bool;
         ~GraphicsPipeline();
 
     private:
         void makePipeline(vk::RenderPass render_pass);
         void ConfigureDraw();
+        void RequestRenderTarget();
+        void PushConstants();
         void validate();
 
         const GraphicsPipelineCacheKey key_;
@@ -122,6 +128,9 @@ class GraphicsPipeline {
 
         std::array<shader::Info, NUM_STAGES> stage_infos;
         u32 num_textures{};
+        // 顶点阶段声明了 storage buffer：按约定是每帧共享的场景数据，排在描述符的最前面
+        bool uses_scene_storage{false};
+        bool uses_instance_storage{false};
         DynamicFeatures dynamic;
         DescriptorSetLayout descriptor_set_layout;
         resource::DescriptorAllocator descriptor_allocator;
@@ -135,6 +144,10 @@ class GraphicsPipeline {
         std::atomic_bool is_built{false};
         bool uses_push_descriptor{false};
 
+        // 动态混合状态下附件 1..N 的设置（附件 0 由 VulkanGraphics::UpdateBlending 负责）
+        boost::container::static_vector<vk::Bool32, 8> extra_blend_enables;
+        boost::container::static_vector<vk::ColorComponentFlags, 8> extra_write_masks;
+
         bool use_dynamic_render;
 };
 
@@ -72,10 +72,20 @@ PipelineCache::PipelineCache(const Device& device, scheduler::Scheduler& schedul
         .has_extended_dynamic_state_3_enables = device.IsExtExtendedDynamicState3EnablesSupported(),
         .has_dynamic_vertex_input = device.IsExtVertexInputDynamicStateSupported(),
     };
+    std::array<surface::PixelFormat, 8> color_formats{};
+    color_formats.fill(surface::PixelFormat::Invalid);
+    color_formats[0] = surface::PixelFormat::B8G8R8A8_UNORM;
+    setRenderTargetFormats(color_formats, surface::PixelFormat::D32_FLOAT);
 
     loadPipelineCacheFromDisk();
 }
 
+void PipelineCache::setRenderTargetFormats(
+    const std::array<surface::PixelFormat, 8>& color_formats, surface::PixelFormat depth_format) {
+    graphics_key.state.color_formats = color_formats;
+    graphics_key.state.depth_format = depth_format;
+}
+
 void PipelineCache::loadPipelineCacheFromDisk() {
     if (use_vulkan_pipeline_cache) {
         auto pipeline_cache_dir = common::FS::get_module_path(common::FS::ModuleType::Cache) /= PIPELINE_CACHE_PATH;
@@ -280,12 +290,6 @@ auto PipelineCache::createGraphicsPipeline(const GraphicsPipelineCacheKey& key,
 }
 
 auto PipelineCache::createGraphicsPipeline() -> std::unique_ptr<GraphicsPipeline> {
-    graphics_key.state.color_formats[0] = surface::PixelFormat::B8G8R8A8_UNORM;
-    for (size_t i = 1; i < graphics_key.state.color_formats.size(); i++) {
-        graphics_key.state.color_formats.at(i) = surface::PixelFormat::Invalid;
-    }
-    graphics_key.state.depth_format = surface::PixelFormat::D32_FLOAT;
-
     graphics_key.state.depth_enabled.Assign(1);
     return createGraphicsPipeline(graphics_key, false);
 }
@@ -72,6 +72,9 @@ class PipelineCache : public ShaderCache {
         [[nodiscard]] auto currentGraphicsPipeline(PrimitiveTopology topology) -> GraphicsPipeline*;
         [[nodiscard]] auto currentComputePipeline(const std::array<u32, 3>& workgroupSize)
             -> ComputePipeline*;
+        // 图形管线的颜色/深度附件格式跟随当前渲染目标
+        void setRenderTargetFormats(const std::array<surface::PixelFormat, 8>& color_formats,
+                                    surface::PixelFormat depth_format);
 
     private:
         auto createGraphicsPipeline() -> std::unique_ptr<GraphicsPipeline>;
@@ -95,6 +95,10 @@ class Scheduler {
 
         // Update the pipeline to the current execution context.
         auto updateGraphicsPipeline(vk::Pipeline pipeline) -> bool;
+        // 提交后 invalidateState 会清空，返回 true 说明命令缓冲上的绑定仍然有效
+        [[nodiscard]] auto isGraphicsPipelineBound(vk::Pipeline pipeline) const -> bool {
+            return state_.graphics_pipeline_ == pipeline;
+        }
 
         void requestRender(const RequestRenderPass& render);
         void requestRender(const RequestsRending& render);
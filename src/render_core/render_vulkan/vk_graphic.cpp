@@ -6,6 +6,8 @@
 #include <tracy/Tracy.hpp>
 #include "common/settings.hpp"
 #include "shader_tools/stage.h"
+#include <algorithm>
+#include <cstring>
 #ifdef MemoryBarrier
 #undef MemoryBarrier
 #endif
@@ -78,17 +80,21 @@ VulkanGraphics::VulkanGraphics(core::frontend::BaseWindow* emu_window_, const De
 VulkanGraphics::~VulkanGraphics() = default;
 
 void VulkanGraphics::clean(const CleanValue& cleanValue) {
+    flushDraws();
     std::scoped_lock lock{texture_cache.mutex};
     texture::FramebufferKey key;
     key.size = cleanValue.framebuffer.extent;
     key.depth_format = cleanValue.framebuffer.depth_format;
     key.color_formats = cleanValue.framebuffer.color_formats;
     texture_cache.UpdateRenderTarget(key);
+    pipeline_cache.setRenderTargetFormats(key.color_formats, key.depth_format);
     auto* framebuffer = texture_cache.getFramebuffer();
     if (!framebuffer->HasAspectColorBit(0) && !framebuffer->HasAspectDepthBit() &&
         !framebuffer->HasAspectStencilBit()) {
         return;
     }
+    // 上一帧的 ID 图像在清除前拷贝
+    recordObjectIdReadback();
     if (use_dynamic_render) {
         scheduler.requestRender(framebuffer->getRenderingRequest());
     } else {
@@ -118,6 +124,18 @@ void VulkanGraphics::clean(const CleanValue& cleanValue) {
         });
     }
 
+    if (framebuffer->NumColorBuffers() > OBJECT_ID_COLOR_ATTACHMENT) {
+        const vk::ClearAttachment id_attachment =
+            vk::ClearAttachment()
+                .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                .setColorAttachment(OBJECT_ID_COLOR_ATTACHMENT)
+                .setClearValue(vk::ClearValue().setColor(
+                    vk::ClearColorValue().setUint32({0U, 0U, 0U, 0U})));
+        scheduler.record([id_attachment, clear_rect](vk::CommandBuffer cmdbuf) {
+            cmdbuf.clearAttachments(id_attachment, {clear_rect});
+        });
+    }
+
     if (framebuffer->HasAspectDepthBit()) {
         auto clear_depth =
             vk::ClearDepthStencilValue().setDepth(cleanValue.clear_depth).setStencil(0);
@@ -135,6 +153,8 @@ void VulkanGraphics::clean(const CleanValue& cleanValue) {
 }
 
 void VulkanGraphics::dispatchCompute(const IComputeInstance& instance) {
+    // 计算结果可能被之后的绘制读取，也可能覆盖之前绘制读取的缓冲，先提交已记录的绘制
+    flushDraws();
     pipeline_cache.setCurrentShader(instance.getShaderHash());
     FlushWork();
     auto work = instance.getWorkgroupSize();
@@ -167,6 +187,7 @@ void VulkanGraphics::dispatchCompute(const IComputeInstance& instance) {
 }
 
 auto VulkanGraphics::getDrawImage() -> unsigned long long {
+    flushDraws();
     // 将 Vulkan 纹理绑定到 ImGui
     const auto& image_view = texture_cache.TryFindFramebufferImageView();
     if (!sampler) {
@@ -202,7 +223,8 @@ auto VulkanGraphics::getDrawImage() -> unsigned long long {
     return imguiTextureID_;
 }
 
-void VulkanGraphics::UpdateDynamicStates() {
+void VulkanGraphics::UpdateDynamicStates(const GraphicsPipeline& pipeline,
+                                         bool vertex_input_bound) {
     UpdateViewportsState();
     UpdateScissorsState();
     UpdateDepthBias();
@@ -232,11 +254,9 @@ void VulkanGraphics::UpdateDynamicStates() {
         }
     }
 
-    if (device.IsExtVertexInputDynamicStateSupported()) {
-        auto* pipeline = pipeline_cache.currentGraphicsPipeline(current_primitive_topology);
-        if (pipeline && pipeline->HasDynamicVertexInput()) {
-            UpdateVertexInput();
-        }
+    if (device.IsExtVertexInputDynamicStateSupported() && pipeline.HasDynamicVertexInput() &&
+        (is_begin_frame || !vertex_input_bound)) {
+        UpdateVertexInput();
     }
 }
 // 用于启用或禁用 图元重启（Primitive
@@ -527,6 +547,7 @@ void VulkanGraphics::UpdateScissorsState() {
 
 auto VulkanGraphics::AccelerateDisplay(const frame::FramebufferConfig& config, u32 pixel_stride)
     -> std::optional<present::FramebufferTextureInfo> {
+    flushDraws();
     std::scoped_lock lock{texture_cache.mutex};
     const auto& image_view = texture_cache.TryFindFramebufferImageView();
 
@@ -669,82 +690,223 @@ auto VulkanGraphics::uploadTexture(ktxTexture* ktxTexture) -> TextureId {
     return texture_cache.addTexture(ktxTexture);
 }
 
-void VulkanGraphics::draw(const IMeshInstance& instance) {
+void VulkanGraphics::releaseModel(MeshId id) {
+    // 当前 tick 的命令缓冲还没有提交，GPU 完成这个 tick 后才能销毁
+    released_models.push(scheduler.currentTick(), modelResource[id]);
+    modelResource.erase(id);
+}
 
-    update_pipeline_state(instance.getPipelineState());
-    pipeline_cache.setCurrentShader(instance.vertexShaderHash(), instance.fragmentShaderHash());
-    current_modelId = instance.getMeshId();
-    texture_cache.setCurrentTextures(instance.getMaterialIds());
-    if (!instance.getUBOs().empty()) {
-        buffer_cache.UploadGraphicUniformBuffer(instance.getUBOs());
+void VulkanGraphics::releaseTexture(TextureId id) {
+    released_textures.push(scheduler.currentTick(), id);
+}
+
+void VulkanGraphics::draw(const IMeshInstance& instance) { draw_list.push(instance); }
+
+void VulkanGraphics::draw(const DrawIndexCommand& command) { draw_list.push(command, 0, true); }
+
+void VulkanGraphics::draw(const DrawInstanceCommand& command) { draw_list.push(command); }
+
+void VulkanGraphics::flushDraws() {
+    if (draw_list.empty()) {
+        return;
+    }
+    ZoneScoped;
+    draw_list.sort();
+    if (!draw_list.instanceData().empty()) {
+        std::scoped_lock lock{buffer_cache.mutex};
+        buffer_cache.UploadGraphicInstanceBuffer(draw_list.instanceData());
+    }
+    last_draw = nullptr;
+    last_draw_pipeline = nullptr;
+    for (const auto& batch : draw_list.batches()) {
+        executeDraw(batch);
+    }
+    last_draw = nullptr;
+    last_draw_pipeline = nullptr;
+    draw_list.clear();
+}
+
+void VulkanGraphics::executeDraw(const DrawBatch& batch) {
+    const DrawItem& item = draw_list.item(batch.first);
+    auto shaders = item.shaders;
+    shaders[static_cast<uint32_t>(shader::Stage::Vertex)] = batch.vertex_shader;
+    update_pipeline_state(item.pipeline_state);
+    current_primitive_topology = item.topology;
+    GraphicsPipeline* pipeline = last_draw_pipeline;
+    if (last_draw == nullptr || last_draw_shaders != shaders ||
+        last_draw->topology != item.topology) {
+        pipeline_cache.setCurrentShader(batch.vertex_shader,
+                                        shaders[static_cast<uint32_t>(shader::Stage::Fragment)]);
+        pipeline = pipeline_cache.currentGraphicsPipeline(item.topology);
     }
-    if (!instance.getPushConstants().empty()) {
-        buffer_cache.UploadPushConstants(instance.getPushConstants());
+    if (!pipeline) {
+        // 管线还在异步编译，之后的绘制不能沿用它的状态
+        last_draw = nullptr;
+        last_draw_pipeline = nullptr;
+        return;
     }
 
-    current_primitive_topology = instance.getPrimitiveTopology();
-    int instance_vertex_count = 0;
-    if (instance.getVertexCount() > 0) {
-        instance_vertex_count = instance.getVertexCount();
+    // 上一个管线仍然绑定说明中间没有提交，命令缓冲上的顶点缓冲和描述符都还有效
+    const bool state_bound = last_draw_pipeline != nullptr && last_draw_pipeline->IsBound();
+    const bool same_pipeline = state_bound && pipeline == last_draw_pipeline;
+    const bool mesh_bound = state_bound && last_draw->mesh == item.mesh;
+    const bool reuse_descriptors = same_pipeline && draw_list.sameMaterial(*last_draw, item);
+
+    current_modelId = item.mesh;
+    if (!reuse_descriptors) {
+        texture_cache.setCurrentTextures(draw_list.textures(item));
+        if (item.ubo_count > 0) {
+            buffer_cache.UploadGraphicUniformBuffer(draw_list.ubos(item));
+        }
+    }
+    // 自动合并的实例化绘制把 push constant 放在实例数据里
+    const bool merged = batch.instanced && item.instance_stride == 0;
+    if (item.push_size > 0 && !merged) {
+        buffer_cache.UploadPushConstants(draw_list.pushConstants(item));
     }
 
-    auto render_command = instance.getRenderCommand();
-    PrepareDraw([instance_vertex_count, render_command, this] -> void {
-        uint32_t vertexCount = instance_vertex_count;
+    std::scoped_lock lock{buffer_cache.mutex, texture_cache.mutex};
+    pipeline->Configure(reuse_descriptors);
+    UpdateDynamicStates(*pipeline, same_pipeline && mesh_bound);
+    is_begin_frame = false;
 
-        if (current_modelId) {
-            const auto resource = modelResource[current_modelId];
+    u32 vertex_count = item.vertex_count;
+    if (current_modelId) {
+        const auto resource = modelResource[current_modelId];
+        if (!mesh_bound) {
             auto bindings = vertex_bindings[resource.vertex_binding_id];
             buffer_cache.BindVertexBuffers(resource.vertex_buffer_id, resource.vertex_size,
                                            bindings[0].stride);
             if (resource.indices_buffer_id) {
                 buffer_cache.BindIndexBuffer(IndexFormat::UnsignedInt, resource.indices_buffer_id);
             }
-            vertexCount = resource.vertex_count;
         }
-
-        scheduler.record([render_command, vertexCount](vk::CommandBuffer cmdbuf) -> void {
-            if (render_command.indexCount > 0) {
-                cmdbuf.drawIndexed(render_command.indexCount, 1, render_command.indexOffset, 0, 0);
-            } else {
-                cmdbuf.draw(vertexCount, 1, 0, 0);
-            }
+        vertex_count = resource.vertex_count;
+    }
+    const u32 instance_count = batch.instance_count;
+    const u32 first_instance = batch.first_instance;
+    if (item.indexed) {
+        scheduler.record([index_count = item.index_count, index_offset = item.index_offset,
+                          instance_count, first_instance](vk::CommandBuffer cmdbuf) -> void {
+            cmdbuf.drawIndexed(index_count, instance_count, index_offset, 0, first_instance);
         });
-    });
+    } else {
+        scheduler.record(
+            [vertex_count, instance_count, first_instance](vk::CommandBuffer cmdbuf) -> void {
+                cmdbuf.draw(vertex_count, instance_count, 0, first_instance);
+            });
+    }
+    last_draw = &item;
+    last_draw_shaders = shaders;
+    last_draw_pipeline = pipeline;
+    FlushWork();
 }
 
-void VulkanGraphics::draw(const DrawIndexCommand& command) {
-    update_pipeline_state(command.pipelineState);
-    auto vertex_shader = command.shaders[static_cast<uint32_t>(shader::Stage::Vertex)];
-    auto fragment_shader = command.shaders[static_cast<uint32_t>(shader::Stage::Fragment)];
-    pipeline_cache.setCurrentShader(vertex_shader, fragment_shader);
-    current_modelId = command.mesh;
-    texture_cache.setCurrentTextures(command.textures);
-    if (!command.ubos.empty()) {
-        buffer_cache.UploadGraphicUniformBuffer(command.ubos);
+void VulkanGraphics::uploadSceneStorageBuffer(std::span<const std::byte> data) {
+    std::scoped_lock lock{buffer_cache.mutex};
+    buffer_cache.UploadGraphicStorageBuffer(data);
+}
+
+void VulkanGraphics::requestObjectIdReadback(const ObjectIdRequest& request) {
+    object_id_request = request;
+}
+
+auto VulkanGraphics::tryGetObjectIdReadback() -> std::optional<ObjectIdReadback> {
+    if (!object_id_readback || !scheduler.isFree(object_id_readback->tick)) {
+        return std::nullopt;
     }
-    if (!command.push_constants.empty()) {
-        buffer_cache.UploadPushConstants(command.push_constants);
+    auto& pending = *object_id_readback;
+    if (pending.staging) {
+        auto& ids = pending.readback.ids;
+        ids.resize(static_cast<size_t>(pending.readback.region.width) *
+                   pending.readback.region.height);
+        std::memcpy(ids.data(), pending.staging->mapped_span.data(),
+                    ids.size() * sizeof(ObjectId));
+        staging_pool.FreeDeferred(*pending.staging);
     }
+    auto result = std::move(pending.readback);
+    object_id_readback.reset();
+    return result;
+}
 
-    current_primitive_topology = command.topology;
-    const auto index_count = command.index_count;
-    const auto instance_count = command.instance_count;
-    const auto index_offset = command.index_offset;
-
-    PrepareDraw([index_count, instance_count, index_offset, this] -> void {
-        if (current_modelId) {
-            const auto resource = modelResource[current_modelId];
-            auto bindings = vertex_bindings[resource.vertex_binding_id];
-            buffer_cache.BindVertexBuffers(resource.vertex_buffer_id, resource.vertex_size,
-                                           bindings[0].stride);
-            buffer_cache.BindIndexBuffer(IndexFormat::UnsignedInt, resource.indices_buffer_id);
-        }
-        scheduler.record(
-            [index_count, instance_count, index_offset](vk::CommandBuffer cmdbuf) -> void {
-                cmdbuf.drawIndexed(index_count, instance_count, index_offset, 0, 0);
-            });
+void VulkanGraphics::recordObjectIdReadback() {
+    // 同一时间只保留一个在途的回读
+    if (!object_id_request || object_id_readback) {
+        return;
+    }
+    const auto request = *object_id_request;
+    object_id_request.reset();
+    // 没有 ID 目标或区域为空时也要返回一个空结果，调用方据此结束等待
+    auto* image_view = texture_cache.getRenderTargetImageView(OBJECT_ID_COLOR_ATTACHMENT);
+    if (!image_view || image_view->format != surface::PixelFormat::R32G32B32A32_UINT) {
+        object_id_readback = PendingObjectIdReadback{.tick = scheduler.currentTick()};
+        return;
+    }
+    auto readback = makeObjectIdReadback(request, image_view->size.width, image_view->size.height);
+    const auto region = readback.region;
+    if (region.width == 0 || region.height == 0) {
+        object_id_readback = PendingObjectIdReadback{.readback = std::move(readback),
+                                                     .tick = scheduler.currentTick()};
+        return;
+    }
+    const size_t size = static_cast<size_t>(region.width) * region.height * sizeof(ObjectId);
+    auto staging = staging_pool.Request(size, MemoryUsage::Download, true);
+
+    const vk::Image image = image_view->ImageHandle();
+    const vk::Buffer buffer = staging.buffer;
+    const auto copy =
+        vk::BufferImageCopy()
+            .setBufferOffset(staging.offset)
+            .setBufferRowLength(0)
+            .setBufferImageHeight(0)
+            .setImageSubresource(vk::ImageSubresourceLayers()
+                                     .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                                     .setMipLevel(0)
+                                     .setBaseArrayLayer(0)
+                                     .setLayerCount(1))
+            .setImageOffset(vk::Offset3D{region.x, region.y, 0})
+            .setImageExtent(vk::Extent3D{region.width, region.height, 1});
+    scheduler.requestOutsideRenderOperationContext();
+    scheduler.record([image, buffer, copy](vk::CommandBuffer cmdbuf) {
+        const auto range = vk::ImageSubresourceRange()
+                               .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                               .setBaseMipLevel(0)
+                               .setLevelCount(1)
+                               .setBaseArrayLayer(0)
+                               .setLayerCount(1);
+        const auto pre_barrier = vk::ImageMemoryBarrier()
+                                     .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
+                                     .setDstAccessMask(vk::AccessFlagBits::eTransferRead)
+                                     .setOldLayout(vk::ImageLayout::eGeneral)
+                                     .setNewLayout(vk::ImageLayout::eGeneral)
+                                     .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                                     .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                                     .setImage(image)
+                                     .setSubresourceRange(range);
+        const auto post_barrier = vk::ImageMemoryBarrier()
+                                      .setSrcAccessMask(vk::AccessFlagBits::eTransferRead)
+                                      .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
+                                      .setOldLayout(vk::ImageLayout::eGeneral)
+                                      .setNewLayout(vk::ImageLayout::eGeneral)
+                                      .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                                      .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                                      .setImage(image)
+                                      .setSubresourceRange(range);
+        static constexpr vk::MemoryBarrier HOST_READ_BARRIER =
+            vk::MemoryBarrier()
+                .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eHostRead);
+        cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                               vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, pre_barrier);
+        cmdbuf.copyImageToBuffer(image, vk::ImageLayout::eGeneral, buffer, copy);
+        cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                               vk::PipelineStageFlagBits::eHost, {}, HOST_READ_BARRIER, {}, {});
+        cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {}, {},
+                               post_barrier);
     });
+    object_id_readback = PendingObjectIdReadback{
+        .readback = std::move(readback), .staging = staging, .tick = scheduler.currentTick()};
 }
 
 void VulkanGraphics::update_pipeline_state(const DynamicPipelineState& state){
@@ -757,36 +919,28 @@ void VulkanGraphics::update_pipeline_state(const DynamicPipelineState& state){
 }
 
 void VulkanGraphics::TickFrame() {
+    flushDraws();
     guest_descriptor_queue.TickFrame();
     staging_pool.TickFrame();
+    const auto is_free = [this](u64 tick) { return scheduler.isFree(tick); };
     {
         std::scoped_lock lock{texture_cache.mutex};
+        released_textures.collect(is_free, [&](TextureId id) { texture_cache.removeTexture(id); });
         texture_cache.TickFrame();
     }
     {
         std::scoped_lock lock{buffer_cache.mutex};
+        released_models.collect(is_free, [&](const ModelResource& model) {
+            buffer_cache.DeleteBuffer(model.vertex_buffer_id);
+            buffer_cache.DeleteBuffer(model.indices_buffer_id);
+            vertex_attributes.erase(model.vertex_attribute_id);
+            vertex_bindings.erase(model.vertex_binding_id);
+        });
         buffer_cache.TickFrame();
     }
     is_begin_frame = true;
 }
 
-template <typename Func>
-void VulkanGraphics::PrepareDraw(Func&& draw_func) {
-    GraphicsPipeline* const pipeline{
-        pipeline_cache.currentGraphicsPipeline(current_primitive_topology)};
-    if (!pipeline) {
-        return;
-    }
-    std::scoped_lock lock{buffer_cache.mutex, texture_cache.mutex};
-    pipeline->Configure();
-    UpdateDynamicStates();
-    if (is_begin_frame) {
-        is_begin_frame = false;
-    }
-    draw_func();
-    FlushWork();
-}
-
 void VulkanGraphics::FlushWork() {
     static constexpr u32 DRAWS_TO_DISPATCH = 4096;
 
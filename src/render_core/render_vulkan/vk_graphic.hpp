@@ -1,4 +1,5 @@
 #pragma once
+#include "common/deferred_release.hpp"
 #include "render_core/vulkan_common/memory_allocator.hpp"
 #include "render_core/render_vulkan/pipeline_cache.hpp"
 #include "render_core/render_vulkan/scheduler.hpp"
@@ -9,6 +10,7 @@
 #include "render_core/render_vulkan/buffer_cache.h"
 #include "render_core/render_vulkan/vk_imgui.hpp"
 #include "render_core/graphic.hpp"
+#include "render_core/draw_list.hpp"
 #include "core/frontend/window.hpp"
 #include "render_core/framebuffer_config.hpp"
 #include "render_core/render_vulkan/present/present_frame.hpp"
@@ -44,8 +46,15 @@ class VulkanGraphics : public render::Graphic {
         auto uploadModel(const IMeshData& instance) -> MeshId override;
         auto uploadTexture(const ITexture& texture) -> TextureId override;
         auto uploadTexture(ktxTexture* ktxTexture) -> TextureId override;
+        void releaseModel(MeshId id) override;
+        void releaseTexture(TextureId id) override;
         void draw(const IMeshInstance& instance) override;
         void draw(const DrawIndexCommand& command) override;
+        void draw(const DrawInstanceCommand& command) override;
+        void flushDraws() override;
+        void uploadSceneStorageBuffer(std::span<const std::byte> data) override;
+        void requestObjectIdReadback(const ObjectIdRequest& request) override;
+        auto tryGetObjectIdReadback() -> std::optional<ObjectIdReadback> override;
         auto getDrawImage() -> unsigned long long override;
         auto addShader(std::span<const u32> data, ShaderType type) -> u64 override {
             return pipeline_cache.addShader(data, type);
@@ -57,10 +66,10 @@ class VulkanGraphics : public render::Graphic {
         void TickFrame();
 
     private:
-        template <typename Func>
-        void PrepareDraw(Func&&);
+        void executeDraw(const DrawBatch& batch);
         void FlushWork();
-        void UpdateDynamicStates();
+        // vertex_input_bound 为 true 时命令缓冲上已经是这个网格的顶点输入
+        void UpdateDynamicStates(const GraphicsPipeline& pipeline, bool vertex_input_bound);
         void UpdatePrimitiveRestartEnable();
         void UpdateRasterizerDiscardEnable();
         void UpdateDepthBiasEnable();
@@ -86,6 +95,7 @@ class VulkanGraphics : public render::Graphic {
         void UpdateLineWidth();
 
         void update_pipeline_state(const DynamicPipelineState& state);
+        void recordObjectIdReadback();
         const Device& device;
         MemoryAllocator& memory_allocator;
         scheduler::Scheduler& scheduler;
@@ -106,6 +116,9 @@ class VulkanGraphics : public render::Graphic {
         u32 draw_counter = 0;
         ModelId current_modelId;
         common::SlotVector<ModelResource> modelResource;
+        // 按释放时的 tick 排队，TickFrame 中销毁 GPU 已经用完的网格和纹理
+        common::DeferredReleaseQueue<ModelResource> released_models;
+        common::DeferredReleaseQueue<TextureId> released_textures;
         common::SlotVector<
             boost::container::static_vector<vk::VertexInputAttributeDescription2EXT, 32>>
             vertex_attributes;
@@ -118,6 +131,21 @@ class VulkanGraphics : public render::Graphic {
         DynamicPipelineState current_pipeline_state;
         PrimitiveTopology current_primitive_topology;
 
+        DrawList draw_list;
+        // flushDraws 中上一个执行的绘制，用于跳过重复的管线、描述符和顶点缓冲绑定
+        const DrawItem* last_draw{nullptr};
+        std::array<ShaderHash, MAX_DRAW_SHADER_STAGE> last_draw_shaders{};
+        GraphicsPipeline* last_draw_pipeline{nullptr};
+
+        // 物体 ID 回读：请求在下一次 clean 时拷贝，GPU 完成该 tick 后才读取
+        struct PendingObjectIdReadback {
+                ObjectIdReadback readback;
+                std::optional<StagingBufferRef> staging;  // 区域为空时没有拷贝，直接返回空结果
+                u64 tick{};
+        };
+        std::optional<ObjectIdRequest> object_id_request;
+        std::optional<PendingObjectIdReadback> object_id_readback;
+
         bool is_begin_frame{true};
         bool use_dynamic_render;
 };
@@ -107,6 +107,17 @@ auto TextureCache<P>::addTexture(ktxTexture* ktxTexture) -> ImageViewId {
     return image_view_id;
 }
 
+template <class P>
+void TextureCache<P>::removeTexture(ImageViewId id) {
+    // 0 号是空资源
+    if (!id || id.index == 0) {
+        return;
+    }
+    const ImageId image_id = slot_image_views[id].image_id;
+    slot_image_views.erase(id);
+    slot_images.erase(image_id);
+}
+
 template <class P>
 auto TextureCache<P>::getSampler(SamplerPreset preset) -> typename P::Sampler* {
     auto& samplerId = sampler_presets[static_cast<uint8_t>(preset)];
@@ -156,6 +167,7 @@ template <class P>
 void TextureCache<P>::UpdateRenderTarget(const FramebufferKey& key) {
     if (frameRenderTarget.contains(key)) {
         render_targets = frameRenderTarget.find(key)->second;
+        current_frame_buffer = &slot_framebuffers[framebuffers.at(render_targets)];
         return;
     }
     RenderTargets target;
@@ -173,7 +185,7 @@ void TextureCache<P>::UpdateRenderTarget(const FramebufferKey& key) {
             throw std::runtime_error("颜色格式错误");
         }
         info.format = format;
-        target.color_buffer_ids.at(index) = createImageAndView(info);
+        target.color_buffer_ids.at(index++) = createImageAndView(info);
     }
     if (surface::GetFormatType(key.depth_format) == SurfaceType::Depth) {
         info.format = key.depth_format;
@@ -208,4 +220,13 @@ auto TextureCache<P>::TryFindFramebufferImageView() -> std::pair<typename P::Ima
     return std::make_pair(&slot_image_views[render_targets.color_buffer_ids.at(0)], false);
 }
 
+template <class P>
+auto TextureCache<P>::getRenderTargetImageView(std::size_t index) -> typename P::ImageView* {
+    if (index >= render_targets.color_buffer_ids.size()) {
+        return nullptr;
+    }
+    const ImageViewId id = render_targets.color_buffer_ids.at(index);
+    return id ? &slot_image_views[id] : nullptr;
+}
+
 }  // namespace render::texture
\ No newline at end of file
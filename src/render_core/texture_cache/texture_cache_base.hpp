@@ -99,12 +99,16 @@ class TextureCache {
             -> ImageViewId;
 
         auto addTexture(ktxTexture* ktxTexture) -> ImageViewId;
+        // 删除 addTexture 创建的视图和图像，调用方保证 GPU 已经不再使用它们
+        void removeTexture(ImageViewId id);
         auto getSampler(SamplerPreset preset) -> typename P::Sampler*;
 
         void setCurrentTextures(const std::span<const ImageViewId>& textures);
         auto getCurrentTextures() -> std::span<ImageView*>;
         void UpdateRenderTarget(const FramebufferKey& key);
         auto TryFindFramebufferImageView() -> std::pair<typename P::ImageView*, bool>;
+        // 当前渲染目标的第 index 个颜色附件，不存在时返回 nullptr
+        auto getRenderTargetImageView(std::size_t index) -> typename P::ImageView*;
         auto getFramebuffer() -> Framebuffer*;
         std::recursive_mutex mutex;
 
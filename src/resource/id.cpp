@@ -1,7 +1,9 @@
 #include "id.hpp"
+#include <atomic>
 namespace graphics {
+// 加载线程和主线程都会创建对象，计数器需要原子递增
 auto getCurrentId() -> id_t {
-    static id_t id = 1;
-    return id++;
+    static std::atomic<id_t> id{1};
+    return id.fetch_add(1, std::memory_order_relaxed);
 }
-}  // namespace graphics
\ No newline at end of file
+}  // namespace graphics
@@ -58,6 +58,10 @@ class MeshInstance : public render::IMeshInstance {
         [[nodiscard]] auto getPipelineState() const -> render::DynamicPipelineState override {
             return *pipeline_state;
         }
+        // 界面逐网格编辑的管线状态，RenderRegistry 的材质组件保存这个指针
+        [[nodiscard]] auto pipelineState() const -> const render::DynamicPipelineState* {
+            return pipeline_state;
+        }
         [[nodiscard]] auto getMaterialIds() const -> std::span<const render::TextureId> override {
             return materials;
         }
@@ -134,6 +138,8 @@ inline auto build_render_command(const render::IMeshInstance& instance) -> rende
     command.index_count = instance.getRenderCommand().indexCount;
     command.index_offset = instance.getRenderCommand().indexOffset;
     command.mesh = instance.getMeshId();
+    command.sort_depth = instance.getSortDepth();
+    command.instanced_vertex_shader = instance.instancedVertexShaderHash();
     return command;
 }
 
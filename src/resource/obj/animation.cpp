@@ -1,76 +1,227 @@
 #include "resource/obj/animation.hpp"
+#include "common/file.hpp"
 #include "resource/obj/assimp_glm_helpers.hpp"
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <cassert>
+#include <fstream>
 #include <stdexcept>
-#include <stack>
+namespace {
+// 和网格缓存放在同一个目录下
+constexpr const char* animation_cache_path = "data/cache/animation/";
+constexpr const char* animation_cache_extend = ".anim";
+constexpr uint32_t ANIMATION_CACHE_MAGIC = 0x414E494D;  // 'ANIM'
+constexpr uint32_t ANIMATION_CACHE_VERSION = 1;
+constexpr uint32_t MAX_NAME_LENGTH = 1U << 16U;
+
+struct AnimationCacheHeader {
+        uint32_t magic = ANIMATION_CACHE_MAGIC;
+        uint32_t version = ANIMATION_CACHE_VERSION;
+        uint64_t fileHash = 0;
+        uint32_t jointCount = 0;
+        uint32_t channelCount = 0;
+};
+
+auto cacheFilePath(uint64_t file_hash) -> std::string {
+    return std::string(animation_cache_path) + std::to_string(file_hash) + animation_cache_extend;
+}
+
+void writeNames(std::ostream& os, const std::vector<std::string>& names) {
+    for (const auto& name : names) {
+        const auto length = static_cast<uint32_t>(name.size());
+        os.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        os.write(name.data(), length);
+    }
+}
+
+auto readNames(std::istream& is, uint32_t count, std::vector<std::string>& names) -> bool {
+    names.resize(count);
+    for (auto& name : names) {
+        uint32_t length = 0;
+        if (!is.read(reinterpret_cast<char*>(&length), sizeof(length)) ||
+            length > MAX_NAME_LENGTH) {
+            return false;
+        }
+        name.resize(length);
+        if (!is.read(name.data(), length)) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
 namespace graphics::animation {
 Animation::Animation(std::string_view animationPath, Model* model) {
+    const auto file_hash = common::FS::file_hash(std::string(animationPath)).value_or(0);
+    std::vector<std::string> channels;
+    if (file_hash == 0 || !loadFromCache(file_hash, channels)) {
+        channels = importAnimation(animationPath);
+        // 导入时就压缩，缓存命中和重新导入得到相同的片段
+        const auto compressed = compressClip(clip_);
+        clip_ = decompressClip(compressed);
+        if (file_hash != 0) {
+            saveToCache(file_hash, channels, compressed);
+        }
+    }
+    duration_ = clip_.duration;
+    ticks_per_second = static_cast<int>(clip_.ticks_per_second);
+    readMissingBones(channels, *model);
+    bindBones();
+}
+
+auto Animation::importAnimation(std::string_view path) -> std::vector<std::string> {
     Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(animationPath.data(), aiProcess_Triangulate);
+    const aiScene* scene = importer.ReadFile(path.data(), aiProcess_Triangulate);
     if (!scene || !scene->HasMeshes() || !scene->mRootNode ||
         scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) {
         throw std::runtime_error("load model fail: " + std::string(importer.GetErrorString()));
     }
     auto* animation = scene->mAnimations[0];
-    duration_ = static_cast<float>(animation->mDuration);
-    ticks_per_second = static_cast<int>(animation->mTicksPerSecond);
-    aiMatrix4x4 globalTransformation = scene->mRootNode->mTransformation;
-    globalTransformation = globalTransformation.Inverse();
-    readHierarchyData(root_node_, scene->mRootNode);
-    readMissingBones(animation, *model);
+    clip_.duration = static_cast<float>(animation->mDuration);
+    clip_.ticks_per_second = animation->mTicksPerSecond > 0.0
+                                 ? static_cast<float>(animation->mTicksPerSecond)
+                                 : clip_.ticks_per_second;
+    readHierarchyData(scene->mRootNode);
+    readClip(animation);
+    std::vector<std::string> channels;
+    channels.reserve(animation->mNumChannels);
+    for (unsigned int i = 0; i < animation->mNumChannels; ++i) {
+        channels.emplace_back(animation->mChannels[i]->mNodeName.C_Str());
+    }
+    return channels;
 }
 
-void Animation::readMissingBones(const aiAnimation* animation, Model& model) {
-    unsigned int size = animation->mNumChannels;
+auto Animation::loadFromCache(std::uint64_t file_hash, std::vector<std::string>& channels)
+    -> bool {
+    std::ifstream file(cacheFilePath(file_hash), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    AnimationCacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != ANIMATION_CACHE_MAGIC || header.version != ANIMATION_CACHE_VERSION ||
+        header.fileHash != file_hash) {
+        return false;
+    }
+    std::vector<std::string> names;
+    if (!readNames(file, header.jointCount, names) ||
+        !readNames(file, header.channelCount, channels)) {
+        return false;
+    }
+    auto skeleton = readSkeleton(file);
+    if (!skeleton || skeleton->jointCount() != names.size()) {
+        return false;
+    }
+    auto clip = readCompressedClip(file);
+    if (!clip) {
+        return false;
+    }
+    skeleton_ = std::move(*skeleton);
+    joint_names_ = std::move(names);
+    for (std::size_t joint = 0; joint < joint_names_.size(); ++joint) {
+        joint_index_.try_emplace(joint_names_[joint], joint);
+    }
+    clip_ = decompressClip(*clip);
+    return true;
+}
+
+void Animation::saveToCache(std::uint64_t file_hash, const std::vector<std::string>& channels,
+                            const CompressedClip& clip) const {
+    common::FS::create_dir(animation_cache_path);
+    std::ofstream file(cacheFilePath(file_hash), std::ios::binary);
+    if (!file) {
+        return;
+    }
+    AnimationCacheHeader header{};
+    header.fileHash = file_hash;
+    header.jointCount = static_cast<uint32_t>(joint_names_.size());
+    header.channelCount = static_cast<uint32_t>(channels.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeNames(file, joint_names_);
+    writeNames(file, channels);
+    writeSkeleton(file, skeleton_);
+    writeCompressedClip(file, clip);
+}
+
+void Animation::readMissingBones(const std::vector<std::string>& channels, Model& model) {
     auto& bone_info_map = model.getBoneInfoMap();
     auto& bone_count = model.getBoneCount();
-    for (unsigned int i = 0; i < size; i++) {
-        auto* channel = animation->mChannels[i];
-        std::string boneName = channel->mNodeName.C_Str();
+    for (const auto& boneName : channels) {
         if (auto bone_info = bone_info_map.find(boneName); bone_info != bone_info_map.end()) {
             bone_info->second.id = bone_count;
             bone_count++;
+        } else {
+            bone_info_map[boneName] = {};
         }
-        bones_.emplace_back(channel->mNodeName.C_Str(),
-                            bone_info_map[channel->mNodeName.C_Str()].id, channel);
     }
     boneInfoMap_ = bone_info_map;
 }
-void Animation::readHierarchyData(AssimpNodeData& rootDest, const aiNode* rootSrc) {
-    assert(rootSrc);
-
-    // 映射关系：srcNode -> destNode 指针
-    struct NodePair {
-            AssimpNodeData* dest;
-            const aiNode* src;
-    };
 
-    rootDest.name = rootSrc->mName.C_Str();
-    rootDest.transformation = AssimpGLMHelpers::convert(rootSrc->mTransformation);
-    rootDest.childrenCount = static_cast<int>(rootSrc->mNumChildren);
-
-    std::stack<NodePair> stack;
-    stack.push({.dest=&rootDest, .src=rootSrc});
-
-    while (!stack.empty()) {
-        NodePair current = stack.top();
-        stack.pop();
+void Animation::readHierarchyData(const aiNode* root) {
+    assert(root);
+    flattenHierarchy(
+        root,
+        [](const aiNode* node) {
+            return std::span<aiNode* const>{node->mChildren, node->mNumChildren};
+        },
+        [this](const aiNode* node, std::int32_t parent) -> std::int32_t {
+            aiVector3D scale;
+            aiQuaternion rotation;
+            aiVector3D position;
+            node->mTransformation.Decompose(scale, rotation, position);
+            const auto joint = skeleton_.addJoint(parent, glm::mat4{1.f},
+                                                  AssimpGLMHelpers::convert(position),
+                                                  AssimpGLMHelpers::convert(rotation),
+                                                  AssimpGLMHelpers::convert(scale));
+            // 重名时使用先序中的第一个
+            joint_names_.emplace_back(node->mName.C_Str());
+            joint_index_.try_emplace(joint_names_.back(), static_cast<std::size_t>(joint));
+            return joint;
+        });
+}
 
-        AssimpNodeData* dest = current.dest;
-        const aiNode* src = current.src;
-        dest->childrenCount = static_cast<int>(src->mNumChildren);
-        dest->children.reserve(dest->childrenCount);
+void Animation::readClip(const aiAnimation* animation) {
+    std::vector<float> times;
+    std::vector<glm::vec3> vectors;
+    std::vector<glm::quat> rotations;
+    // 把一种键转换成连续的时间和值
+    const auto convertKeys = [&times](const auto* keys, unsigned int count, auto& values) {
+        times.resize(count);
+        values.resize(count);
+        for (unsigned int i = 0; i < count; ++i) {
+            times[i] = static_cast<float>(keys[i].mTime);
+            values[i] = AssimpGLMHelpers::convert(keys[i].mValue);
+        }
+    };
+    for (unsigned int i = 0; i < animation->mNumChannels; ++i) {
+        const auto* channel = animation->mChannels[i];
+        const auto joint = jointIndex(channel->mNodeName.C_Str());
+        if (!joint) {
+            continue;
+        }
+        convertKeys(channel->mPositionKeys, channel->mNumPositionKeys, vectors);
+        clip_.translations.set(*joint, times, vectors);
+        convertKeys(channel->mRotationKeys, channel->mNumRotationKeys, rotations);
+        clip_.rotations.set(*joint, times, rotations);
+        convertKeys(channel->mScalingKeys, channel->mNumScalingKeys, vectors);
+        clip_.scales.set(*joint, times, vectors);
+    }
+}
 
-        for (unsigned int i = 0; i < src->mNumChildren; ++i) {
-            const aiNode* childSrc = src->mChildren[i];
-            AssimpNodeData childDest;
-            childDest.name = childSrc->mName.C_Str();
-            childDest.transformation = AssimpGLMHelpers::convert(childSrc->mTransformation);
-            dest->children.push_back(std::move(childDest));
-            stack.push({&dest->children.back(), childSrc});
+void Animation::bindBones() {
+    for (const auto& [name, info] : boneInfoMap_) {
+        const auto joint = jointIndex(name);
+        if (!joint || info.id < 0) {
+            continue;
+        }
+        skeleton_.inverse_bind[*joint] = info.offset;
+        const auto id = static_cast<std::size_t>(info.id);
+        if (bone_joints_.size() <= id) {
+            bone_joints_.resize(id + 1, Skeleton::NO_PARENT);
         }
+        bone_joints_[id] = static_cast<std::int32_t>(*joint);
     }
 }
 }  // namespace graphics::animation
\ No newline at end of file
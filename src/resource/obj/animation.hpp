@@ -1,21 +1,21 @@
 #pragma once
 #include "resource/obj/bone_info.hpp"
 #include "resource/obj/animation_model.hpp"
-#include <algorithm>
+#include "resource/obj/animation_clip.hpp"
+#include "resource/obj/animation_compression.hpp"
+#include <assimp/scene.h>
 #include <glm/glm.hpp>
-#include <resource/obj/bone.hpp>
+#include <cstdint>
+#include <span>
+#include <string>
 #include <string_view>
 #include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace graphics::animation {
 
-struct AssimpNodeData {
-        glm::mat4 transformation;
-        std::string name;
-        int childrenCount;
-        std::vector<AssimpNodeData> children;
-};
-
 class Animation {
     public:
         Animation() = default;
@@ -25,30 +25,53 @@ class Animation {
         auto operator=(const Animation&) -> Animation& = delete;
         auto operator=(Animation&&) noexcept -> Animation& = delete;
         Animation(std::string_view path, Model* model);
-        auto findBone(const std::string_view name) -> Bone* {
-            auto iter =
-                std::ranges::find_if(bones_, [&](const Bone& bone) { return bone.Name() == name; });
-            if (iter == bones_.end()) {
-                return nullptr;
-            }
-            return &(*iter);
-        }
-
         [[nodiscard]] inline auto getTicksPerSecond() const -> float {
             return static_cast<float>(ticks_per_second);
         }
-        inline auto getRootNode() -> const AssimpNodeData& { return root_node_; }
+        // 节点树展开后的骨架，关节按先序排列，包括不是骨骼的中间节点
+        [[nodiscard]] auto skeleton() const -> const Skeleton& { return skeleton_; }
+        // 轨道按关节下标存放
+        [[nodiscard]] auto clip() const -> const AnimationClip& { return clip_; }
+        [[nodiscard]] auto jointIndex(std::string_view name) const -> std::optional<std::size_t> {
+            if (auto iter = joint_index_.find(name); iter != joint_index_.end()) {
+                return iter->second;
+            }
+            return std::nullopt;
+        }
+        // 下标是 BoneInfo::id，值是关节，不在节点树中的骨骼为 -1。
+        // 蒙皮矩阵按 palette[boneJoints()[id]] 取
+        [[nodiscard]] auto boneJoints() const -> std::span<const std::int32_t> {
+            return bone_joints_;
+        }
         inline auto GetBoneIDMap() -> const std::map<std::string, BoneInfo>& {
             return boneInfoMap_;
         }
 
     private:
-        void readMissingBones(const aiAnimation* animation, Model& model);
-        void readHierarchyData(AssimpNodeData& rootDest, const aiNode* rootSrc);
+        // 用 string_view 查找时不构造 std::string
+        struct NameHash {
+                using is_transparent = void;
+                auto operator()(std::string_view name) const -> std::size_t {
+                    return std::hash<std::string_view>{}(name);
+                }
+        };
+
+        // 用 Assimp 导入，返回通道对应的节点名
+        auto importAnimation(std::string_view path) -> std::vector<std::string>;
+        auto loadFromCache(std::uint64_t file_hash, std::vector<std::string>& channels) -> bool;
+        void saveToCache(std::uint64_t file_hash, const std::vector<std::string>& channels,
+                         const CompressedClip& clip) const;
+        void readMissingBones(const std::vector<std::string>& channels, Model& model);
+        void readHierarchyData(const aiNode* root);
+        void readClip(const aiAnimation* animation);
+        void bindBones();
         float duration_{};
         int ticks_per_second{};
-        std::vector<Bone> bones_;
-        AssimpNodeData root_node_;
+        std::vector<std::string> joint_names_;
+        std::unordered_map<std::string, std::size_t, NameHash, std::equal_to<>> joint_index_;
+        Skeleton skeleton_;
+        AnimationClip clip_;
+        std::vector<std::int32_t> bone_joints_;
         std::map<std::string, BoneInfo> boneInfoMap_;
 };
 
@@ -0,0 +1,139 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace graphics::animation {
+
+/// 运行时骨架。关节按拓扑序排列，父关节的下标总是更小，一次正序遍历即可得到模型空间矩阵
+struct Skeleton {
+        static constexpr std::int32_t NO_PARENT = -1;
+
+        std::vector<std::int32_t> parents;
+        std::vector<glm::mat4> inverse_bind;  // 模型空间到骨骼空间，即 BoneInfo::offset
+        // 片段中没有对应轨道时使用的局部变换
+        std::vector<glm::vec3> rest_translations;
+        std::vector<glm::quat> rest_rotations;
+        std::vector<glm::vec3> rest_scales;
+
+        // parent 必须是已经加入的关节
+        auto addJoint(std::int32_t parent, const glm::mat4& inverse_bind_matrix,
+                      const glm::vec3& translation = glm::vec3{0.f},
+                      const glm::quat& rotation = glm::quat{1.f, 0.f, 0.f, 0.f},
+                      const glm::vec3& scale = glm::vec3{1.f}) -> std::int32_t {
+            const auto joint = static_cast<std::int32_t>(parents.size());
+            parents.push_back(parent < joint ? parent : NO_PARENT);
+            inverse_bind.push_back(inverse_bind_matrix);
+            rest_translations.push_back(translation);
+            rest_rotations.push_back(rotation);
+            rest_scales.push_back(scale);
+            return joint;
+        }
+        [[nodiscard]] auto jointCount() const -> std::size_t { return parents.size(); }
+};
+
+/// 按先序展开一棵节点树，父节点总在子节点之前，得到的顺序可以直接用作 Skeleton 的关节顺序。
+/// children(node) 返回子节点指针的区间，visit(node, parent_joint) 加入关节并返回它的下标
+template <typename Node, typename Children, typename Visit>
+void flattenHierarchy(const Node* root, Children&& children, Visit&& visit) {
+    std::vector<std::pair<const Node*, std::int32_t>> stack{{root, Skeleton::NO_PARENT}};
+    while (!stack.empty()) {
+        const auto [node, parent] = stack.back();
+        stack.pop_back();
+        const std::int32_t joint = visit(node, parent);
+        // 逆序入栈，兄弟节点保持原来的顺序
+        auto&& nodes = children(node);
+        for (auto iter = std::rbegin(nodes); iter != std::rend(nodes); ++iter) {
+            stack.emplace_back(*iter, joint);
+        }
+    }
+}
+
+/// 在递增的键时间中找到满足 time_at(i) <= time < time_at(i + 1) 的 i，超出范围时夹到
+/// [0, count - 2]，count 至少为 2。cursor 是上一次的结果：单调播放时只需向后看几个键，
+/// 倒退、循环或跳转时退化为二分查找
+template <typename TimeAt>
+auto findKey(std::uint32_t count, float time, std::uint32_t& cursor, TimeAt&& time_at)
+    -> std::uint32_t {
+    constexpr std::uint32_t LINEAR_STEPS = 4;
+    const std::uint32_t last = count - 2;
+    if (cursor <= last && time_at(cursor) <= time) {
+        for (std::uint32_t step = 0; step < LINEAR_STEPS; ++step) {
+            if (cursor == last || time < time_at(cursor + 1)) {
+                return cursor;
+            }
+            ++cursor;
+        }
+    }
+    // 第一个大于 time 的键
+    std::uint32_t low = 1;
+    std::uint32_t high = count;
+    while (low < high) {
+        const std::uint32_t mid = low + ((high - low) / 2);
+        if (time_at(mid) <= time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    cursor = std::min(low - 1, last);
+    return cursor;
+}
+
+/// 一个动画片段。每个关节一条平移、旋转、缩放轨道，所有轨道的键时间和键值分别连续存放，
+/// 轨道只记录自己在数组中的区间。时间单位是 tick
+struct AnimationClip {
+        struct Track {
+                std::uint32_t first{0};
+                std::uint32_t count{0};  // 0 表示这个关节使用 Skeleton 的静止姿势
+                // 大于 0 时键等间距，(time - 第一个键的时间) * inv_step 直接得到下标
+                float inv_step{0.f};
+        };
+
+        template <typename T>
+        struct Channel {
+                std::vector<Track> tracks;  // 按关节
+                std::vector<float> times;   // 每条轨道内递增
+                std::vector<T> values;
+
+                void set(std::size_t joint, std::span<const float> key_times,
+                         std::span<const T> key_values) {
+                    if (tracks.size() <= joint) {
+                        tracks.resize(joint + 1);
+                    }
+                    tracks[joint] = {.first = static_cast<std::uint32_t>(times.size()),
+                                     .count = static_cast<std::uint32_t>(key_times.size())};
+                    times.insert(times.end(), key_times.begin(), key_times.end());
+                    values.insert(values.end(), key_values.begin(), key_values.end());
+                }
+                // key_times 必须等间距
+                void setUniform(std::size_t joint, std::span<const float> key_times,
+                                std::span<const T> key_values) {
+                    set(joint, key_times, key_values);
+                    if (key_times.size() > 1 && key_times.back() > key_times.front()) {
+                        tracks[joint].inv_step = static_cast<float>(key_times.size() - 1) /
+                                                 (key_times.back() - key_times.front());
+                    }
+                }
+                [[nodiscard]] auto track(std::size_t joint) const -> Track {
+                    return joint < tracks.size() ? tracks[joint] : Track{};
+                }
+        };
+
+        float duration{0.f};
+        float ticks_per_second{25.f};
+        Channel<glm::vec3> translations;
+        Channel<glm::quat> rotations;
+        Channel<glm::vec3> scales;
+
+        [[nodiscard]] auto seconds() const -> float {
+            return ticks_per_second > 0.f ? duration / ticks_per_second : 0.f;
+        }
+};
+
+}  // namespace graphics::animation
@@ -0,0 +1,334 @@
+#include "resource/obj/animation_compression.hpp"
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+namespace graphics::animation {
+namespace {
+constexpr float QUANTIZE_MAX = 65535.f;
+constexpr std::uint64_t ROTATION_COMPONENT_MAX = (1U << 15U) - 1U;
+// 最大分量之外的三个分量的绝对值不超过 1/√2
+constexpr float ROTATION_COMPONENT_RANGE = 0.70710678f;
+// 读取时用来拒绝损坏的文件，避免按错误的长度分配内存
+constexpr std::uint64_t MAX_ELEMENTS = 1ULL << 28U;
+
+auto vectorError(const glm::vec3& a, const glm::vec3& b) -> float { return glm::length(a - b); }
+
+// 单位四元数之差的长度是 2sin(θ/4)，角度很小时比 acos(dot) 精确
+auto rotationError(const glm::quat& a, const glm::quat& b) -> float {
+    const float distance = std::min(glm::length(a - b), glm::length(a + b));
+    return 4.f * std::asin(std::min(distance * .5f, 1.f));
+}
+
+auto lerpKey(const glm::vec3& a, const glm::vec3& b, float t) -> glm::vec3 {
+    return glm::mix(a, b, t);
+}
+
+auto slerpKey(const glm::quat& a, const glm::quat& b, float t) -> glm::quat {
+    return glm::normalize(glm::slerp(a, b, t));
+}
+
+// 返回需要保留的键。从上一个保留的键开始尽量向后延伸，直到中间某个键无法由两端插值得到
+template <typename T, typename Mix, typename Error>
+auto reduceKeys(std::span<const float> times, std::span<const T> values, Mix mix, Error error,
+                float tolerance) -> std::vector<std::uint32_t> {
+    const auto count = static_cast<std::uint32_t>(times.size());
+    std::vector<std::uint32_t> kept{0};
+    if (count == 1) {
+        return kept;
+    }
+    std::uint32_t anchor = 0;
+    for (std::uint32_t end = 2; end < count; ++end) {
+        const float span = times[end] - times[anchor];
+        for (std::uint32_t key = anchor + 1; key < end; ++key) {
+            const float t = span > 0.f ? (times[key] - times[anchor]) / span : 0.f;
+            if (error(mix(values[anchor], values[end], t), values[key]) > tolerance) {
+                anchor = end - 1;
+                kept.push_back(anchor);
+                break;
+            }
+        }
+    }
+    // 整条轨道是常量时只留一个键
+    if (kept.size() == 1 && error(values[0], values[count - 1]) <= tolerance) {
+        return kept;
+    }
+    kept.push_back(count - 1);
+    return kept;
+}
+
+auto quantize(float value, float min, float extent) -> std::uint16_t {
+    if (extent <= 0.f) {
+        return 0;
+    }
+    const float normalized = std::clamp((value - min) / extent, 0.f, 1.f);
+    return static_cast<std::uint16_t>(std::lround(normalized * QUANTIZE_MAX));
+}
+
+void compressVectors(const AnimationClip::Channel<glm::vec3>& source, float tolerance,
+                     CompressedClip::VectorChannel& out) {
+    for (std::size_t joint = 0; joint < source.tracks.size(); ++joint) {
+        const auto track = source.tracks[joint];
+        const std::span<const float> times{source.times.data() + track.first, track.count};
+        const std::span<const glm::vec3> values{source.values.data() + track.first, track.count};
+        const auto kept = track.count == 0
+                              ? std::vector<std::uint32_t>{}
+                              : reduceKeys(times, values, lerpKey, vectorError, tolerance);
+        glm::vec3 min{0.f};
+        glm::vec3 max{0.f};
+        if (!kept.empty()) {
+            min = max = values[kept.front()];
+        }
+        for (const auto key : kept) {
+            min = glm::min(min, values[key]);
+            max = glm::max(max, values[key]);
+        }
+        const glm::vec3 extent = max - min;
+        out.tracks.push_back({.first = static_cast<std::uint32_t>(out.times.size()),
+                              .count = static_cast<std::uint32_t>(kept.size())});
+        out.range_min.push_back(min);
+        out.range_extent.push_back(extent);
+        for (const auto key : kept) {
+            const glm::vec3& value = values[key];
+            out.times.push_back(times[key]);
+            out.values.push_back({quantize(value.x, min.x, extent.x),
+                                  quantize(value.y, min.y, extent.y),
+                                  quantize(value.z, min.z, extent.z)});
+        }
+    }
+}
+
+void compressRotations(const AnimationClip::Channel<glm::quat>& source, float tolerance,
+                       CompressedClip::RotationChannel& out) {
+    for (const auto& track : source.tracks) {
+        const std::span<const float> times{source.times.data() + track.first, track.count};
+        const std::span<const glm::quat> values{source.values.data() + track.first, track.count};
+        const auto kept = track.count == 0
+                              ? std::vector<std::uint32_t>{}
+                              : reduceKeys(times, values, slerpKey, rotationError, tolerance);
+        out.tracks.push_back({.first = static_cast<std::uint32_t>(out.times.size()),
+                              .count = static_cast<std::uint32_t>(kept.size())});
+        for (const auto key : kept) {
+            out.times.push_back(times[key]);
+            out.values.push_back(encodeRotation(values[key]));
+        }
+    }
+}
+
+template <typename T>
+void writeValue(std::ostream& os, const T& value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void writeVector(std::ostream& os, const std::vector<T>& values) {
+    writeValue(os, static_cast<std::uint64_t>(values.size()));
+    if (!values.empty()) {
+        os.write(reinterpret_cast<const char*>(values.data()),
+                 static_cast<std::streamsize>(sizeof(T) * values.size()));
+    }
+}
+
+template <typename T>
+auto readValue(std::istream& is, T& value) -> bool {
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <typename T>
+auto readVector(std::istream& is, std::vector<T>& values) -> bool {
+    std::uint64_t count = 0;
+    if (!readValue(is, count) || count > MAX_ELEMENTS) {
+        return false;
+    }
+    values.resize(count);
+    const auto bytes = static_cast<std::streamsize>(sizeof(T) * count);
+    return count == 0 || static_cast<bool>(is.read(reinterpret_cast<char*>(values.data()), bytes));
+}
+
+// 轨道必须落在键数组内
+auto tracksValid(const std::vector<AnimationClip::Track>& tracks, std::size_t times,
+                 std::size_t values) -> bool {
+    return times == values &&
+           std::ranges::all_of(tracks, [times](const AnimationClip::Track& track) {
+               return static_cast<std::size_t>(track.first) + track.count <= times;
+           });
+}
+}  // namespace
+
+auto CompressedClip::byteSize() const -> std::size_t {
+    const auto vectorBytes = [](const VectorChannel& channel) {
+        return (channel.tracks.size() * sizeof(AnimationClip::Track)) +
+               (channel.range_min.size() * sizeof(glm::vec3) * 2) +
+               (channel.times.size() * sizeof(float)) + (channel.values.size() * sizeof(Packed));
+    };
+    return vectorBytes(translations) + vectorBytes(scales) +
+           (rotations.tracks.size() * sizeof(AnimationClip::Track)) +
+           (rotations.times.size() * sizeof(float)) + (rotations.values.size() * sizeof(Packed));
+}
+
+auto encodeRotation(const glm::quat& rotation) -> CompressedClip::Packed {
+    const glm::quat q = glm::normalize(rotation);
+    const std::array<float, 4> components{q.x, q.y, q.z, q.w};
+    std::uint32_t largest = 0;
+    for (std::uint32_t i = 1; i < 4; ++i) {
+        if (std::abs(components[i]) > std::abs(components[largest])) {
+            largest = i;
+        }
+    }
+    // q 和 -q 是同一个旋转，让省略的分量为正
+    const float sign = components[largest] < 0.f ? -1.f : 1.f;
+    std::uint64_t bits = largest;
+    for (std::uint32_t i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        const float normalized = std::clamp(
+            (components[i] * sign / ROTATION_COMPONENT_RANGE * .5f) + .5f, 0.f, 1.f);
+        bits = (bits << 15U) | static_cast<std::uint64_t>(std::lround(
+                                   normalized * static_cast<float>(ROTATION_COMPONENT_MAX)));
+    }
+    return {static_cast<std::uint16_t>(bits >> 32U), static_cast<std::uint16_t>(bits >> 16U),
+            static_cast<std::uint16_t>(bits)};
+}
+
+auto decodeRotation(const CompressedClip::Packed& packed) -> glm::quat {
+    const std::uint64_t bits = (static_cast<std::uint64_t>(packed[0]) << 32U) |
+                               (static_cast<std::uint64_t>(packed[1]) << 16U) | packed[2];
+    const auto largest = static_cast<std::uint32_t>((bits >> 45U) & 3U);
+    std::array<float, 4> components{};
+    float sum = 0.f;
+    std::uint32_t shift = 45;
+    for (std::uint32_t i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        shift -= 15;
+        const auto value = static_cast<float>((bits >> shift) & ROTATION_COMPONENT_MAX) /
+                           static_cast<float>(ROTATION_COMPONENT_MAX);
+        components[i] = ((value * 2.f) - 1.f) * ROTATION_COMPONENT_RANGE;
+        sum += components[i] * components[i];
+    }
+    components[largest] = std::sqrt(std::max(1.f - sum, 0.f));
+    return glm::normalize(glm::quat{components[3], components[0], components[1], components[2]});
+}
+
+auto compressClip(const AnimationClip& clip, const CompressionSettings& settings)
+    -> CompressedClip {
+    CompressedClip result;
+    result.duration = clip.duration;
+    result.ticks_per_second = clip.ticks_per_second;
+    compressVectors(clip.translations, settings.translation_tolerance, result.translations);
+    compressRotations(clip.rotations, settings.rotation_tolerance, result.rotations);
+    compressVectors(clip.scales, settings.scale_tolerance, result.scales);
+    return result;
+}
+
+auto decompressClip(const CompressedClip& clip) -> AnimationClip {
+    AnimationClip result;
+    result.duration = clip.duration;
+    result.ticks_per_second = clip.ticks_per_second;
+    std::vector<glm::vec3> vectors;
+    std::vector<glm::quat> rotations;
+    const auto decodeVectors = [&vectors](const CompressedClip::VectorChannel& source,
+                                          AnimationClip::Channel<glm::vec3>& out) {
+        for (std::size_t joint = 0; joint < source.tracks.size(); ++joint) {
+            const auto track = source.tracks[joint];
+            const glm::vec3 min = source.range_min[joint];
+            const glm::vec3 scale = source.range_extent[joint] / QUANTIZE_MAX;
+            vectors.clear();
+            for (std::uint32_t key = 0; key < track.count; ++key) {
+                const auto& packed = source.values[track.first + key];
+                const glm::vec3 quantized{static_cast<float>(packed[0]),
+                                          static_cast<float>(packed[1]),
+                                          static_cast<float>(packed[2])};
+                vectors.push_back(min + (scale * quantized));
+            }
+            out.set(joint, std::span{source.times}.subspan(track.first, track.count), vectors);
+        }
+    };
+    decodeVectors(clip.translations, result.translations);
+    decodeVectors(clip.scales, result.scales);
+    for (std::size_t joint = 0; joint < clip.rotations.tracks.size(); ++joint) {
+        const auto track = clip.rotations.tracks[joint];
+        rotations.clear();
+        for (std::uint32_t key = 0; key < track.count; ++key) {
+            rotations.push_back(decodeRotation(clip.rotations.values[track.first + key]));
+        }
+        result.rotations.set(
+            joint, std::span{clip.rotations.times}.subspan(track.first, track.count), rotations);
+    }
+    return result;
+}
+
+void writeCompressedClip(std::ostream& os, const CompressedClip& clip) {
+    writeValue(os, clip.duration);
+    writeValue(os, clip.ticks_per_second);
+    for (const auto* channel : {&clip.translations, &clip.scales}) {
+        writeVector(os, channel->tracks);
+        writeVector(os, channel->range_min);
+        writeVector(os, channel->range_extent);
+        writeVector(os, channel->times);
+        writeVector(os, channel->values);
+    }
+    writeVector(os, clip.rotations.tracks);
+    writeVector(os, clip.rotations.times);
+    writeVector(os, clip.rotations.values);
+}
+
+auto readCompressedClip(std::istream& is) -> std::optional<CompressedClip> {
+    CompressedClip clip;
+    if (!readValue(is, clip.duration) || !readValue(is, clip.ticks_per_second)) {
+        return std::nullopt;
+    }
+    for (auto* channel : {&clip.translations, &clip.scales}) {
+        if (!readVector(is, channel->tracks) || !readVector(is, channel->range_min) ||
+            !readVector(is, channel->range_extent) || !readVector(is, channel->times) ||
+            !readVector(is, channel->values)) {
+            return std::nullopt;
+        }
+        if (channel->range_min.size() != channel->tracks.size() ||
+            channel->range_extent.size() != channel->tracks.size() ||
+            !tracksValid(channel->tracks, channel->times.size(), channel->values.size())) {
+            return std::nullopt;
+        }
+    }
+    if (!readVector(is, clip.rotations.tracks) || !readVector(is, clip.rotations.times) ||
+        !readVector(is, clip.rotations.values) ||
+        !tracksValid(clip.rotations.tracks, clip.rotations.times.size(),
+                     clip.rotations.values.size())) {
+        return std::nullopt;
+    }
+    return clip;
+}
+
+void writeSkeleton(std::ostream& os, const Skeleton& skeleton) {
+    writeVector(os, skeleton.parents);
+    writeVector(os, skeleton.inverse_bind);
+    writeVector(os, skeleton.rest_translations);
+    writeVector(os, skeleton.rest_rotations);
+    writeVector(os, skeleton.rest_scales);
+}
+
+auto readSkeleton(std::istream& is) -> std::optional<Skeleton> {
+    Skeleton skeleton;
+    if (!readVector(is, skeleton.parents) || !readVector(is, skeleton.inverse_bind) ||
+        !readVector(is, skeleton.rest_translations) || !readVector(is, skeleton.rest_rotations) ||
+        !readVector(is, skeleton.rest_scales)) {
+        return std::nullopt;
+    }
+    const std::size_t joints = skeleton.jointCount();
+    if (skeleton.inverse_bind.size() != joints || skeleton.rest_translations.size() != joints ||
+        skeleton.rest_rotations.size() != joints || skeleton.rest_scales.size() != joints) {
+        return std::nullopt;
+    }
+    for (std::size_t joint = 0; joint < joints; ++joint) {
+        const auto parent = skeleton.parents[joint];
+        if (parent != Skeleton::NO_PARENT &&
+            (parent < 0 || static_cast<std::size_t>(parent) >= joint)) {
+            return std::nullopt;
+        }
+    }
+    return skeleton;
+}
+
+}  // namespace graphics::animation
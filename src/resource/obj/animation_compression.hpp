@@ -0,0 +1,63 @@
+#pragma once
+#include "resource/obj/animation_clip.hpp"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace graphics::animation {
+
+struct CompressionSettings {
+        // 删除一个键后，插值结果与原来的键相差不超过这些值时认为它是多余的
+        float translation_tolerance{1e-4f};  // 模型单位
+        float rotation_tolerance{1e-4f};     // 弧度
+        float scale_tolerance{1e-4f};
+};
+
+/// 压缩后的片段。轨道结构和键时间与 AnimationClip 相同，键值量化为 16 位：
+/// 旋转用 smallest-three 编码为 48 位，平移和缩放按每条轨道的取值范围量化
+struct CompressedClip {
+        using Packed = std::array<std::uint16_t, 3>;
+
+        struct VectorChannel {
+                std::vector<AnimationClip::Track> tracks;
+                std::vector<glm::vec3> range_min;  // 按关节
+                std::vector<glm::vec3> range_extent;
+                std::vector<float> times;
+                std::vector<Packed> values;
+        };
+        struct RotationChannel {
+                std::vector<AnimationClip::Track> tracks;
+                std::vector<float> times;
+                std::vector<Packed> values;
+        };
+
+        float duration{0.f};
+        float ticks_per_second{25.f};
+        VectorChannel translations;
+        RotationChannel rotations;
+        VectorChannel scales;
+
+        [[nodiscard]] auto byteSize() const -> std::size_t;
+};
+
+// 最大的分量取正后省略，其余三个分量各 15 位，加上 2 位下标
+auto encodeRotation(const glm::quat& rotation) -> CompressedClip::Packed;
+auto decodeRotation(const CompressedClip::Packed& packed) -> glm::quat;
+
+// 删除误差内多余的键，再量化键值
+auto compressClip(const AnimationClip& clip, const CompressionSettings& settings = {})
+    -> CompressedClip;
+auto decompressClip(const CompressedClip& clip) -> AnimationClip;
+
+void writeCompressedClip(std::ostream& os, const CompressedClip& clip);
+auto readCompressedClip(std::istream& is) -> std::optional<CompressedClip>;
+// 骨架按原精度保存，读取时检查父关节在前
+void writeSkeleton(std::ostream& os, const Skeleton& skeleton);
+auto readSkeleton(std::istream& is) -> std::optional<Skeleton>;
+
+}  // namespace graphics::animation
@@ -0,0 +1,447 @@
+#include "resource/obj/animator.hpp"
+#include "common/parallel.hpp"
+#include "common/simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <tuple>
+#include <tracy/Tracy.hpp>
+
+namespace graphics::animation {
+namespace {
+constexpr std::size_t PARALLEL_GRAIN = 4;
+
+// 4 个 float 的 lane，没有 SSE/NEON 时按标量逐个计算
+struct Float4 {
+#if defined(GRAPHICS_SIMD_SSE)
+        __m128 v;
+#elif defined(GRAPHICS_SIMD_NEON)
+        float32x4_t v;
+#else
+        std::array<float, 4> v;
+#endif
+};
+
+auto load(const float* p) -> Float4 {
+#if defined(GRAPHICS_SIMD_SSE)
+    return {_mm_loadu_ps(p)};
+#elif defined(GRAPHICS_SIMD_NEON)
+    return {vld1q_f32(p)};
+#else
+    return {{p[0], p[1], p[2], p[3]}};
+#endif
+}
+
+void store(float* p, Float4 a) {
+#if defined(GRAPHICS_SIMD_SSE)
+    _mm_storeu_ps(p, a.v);
+#elif defined(GRAPHICS_SIMD_NEON)
+    vst1q_f32(p, a.v);
+#else
+    std::ranges::copy(a.v, p);
+#endif
+}
+
+auto splat(float s) -> Float4 {
+#if defined(GRAPHICS_SIMD_SSE)
+    return {_mm_set1_ps(s)};
+#elif defined(GRAPHICS_SIMD_NEON)
+    return {vdupq_n_f32(s)};
+#else
+    return {{s, s, s, s}};
+#endif
+}
+
+auto operator+(Float4 a, Float4 b) -> Float4 {
+#if defined(GRAPHICS_SIMD_SSE)
+    return {_mm_add_ps(a.v, b.v)};
+#elif defined(GRAPHICS_SIMD_NEON)
+    return {vaddq_f32(a.v, b.v)};
+#else
+    return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+#endif
+}
+
+auto operator-(Float4 a, Float4 b) -> Float4 {
+#if defined(GRAPHICS_SIMD_SSE)
+    return {_mm_sub_ps(a.v, b.v)};
+#elif defined(GRAPHICS_SIMD_NEON)
+    return {vsubq_f32(a.v, b.v)};
+#else
+    return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+#endif
+}
+
+auto operator*(Float4 a, Float4 b) -> Float4 {
+#if defined(GRAPHICS_SIMD_SSE)
+    return {_mm_mul_ps(a.v, b.v)};
+#elif defined(GRAPHICS_SIMD_NEON)
+    return {vmulq_f32(a.v, b.v)};
+#else
+    return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+#endif
+}
+
+// sign 小于 0 的 lane 取 -value，其余保持不变
+auto negateWhereNegative(Float4 sign, Float4 value) -> Float4 {
+#if defined(GRAPHICS_SIMD_SSE)
+    const __m128 mask = _mm_and_ps(_mm_cmplt_ps(sign.v, _mm_setzero_ps()), _mm_set1_ps(-0.f));
+    return {_mm_xor_ps(value.v, mask)};
+#elif defined(GRAPHICS_SIMD_NEON)
+    return {vbslq_f32(vcltq_f32(sign.v, vdupq_n_f32(0.f)), vnegq_f32(value.v), value.v)};
+#else
+    Float4 result = value;
+    for (std::size_t lane = 0; lane < 4; ++lane) {
+        result.v[lane] = sign.v[lane] < 0.f ? -value.v[lane] : value.v[lane];
+    }
+    return result;
+#endif
+}
+
+auto inverseSqrt(Float4 a) -> Float4 {
+#if defined(GRAPHICS_SIMD_SSE)
+    return {_mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(a.v))};
+#elif defined(GRAPHICS_SIMD_NEON)
+    // 估计值加两次牛顿迭代，32 位 ARM 上没有 vsqrtq/vdivq
+    float32x4_t estimate = vrsqrteq_f32(a.v);
+    estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a.v, estimate), estimate));
+    estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a.v, estimate), estimate));
+    return {estimate};
+#else
+    Float4 result = a;
+    for (auto& lane : result.v) {
+        lane = 1.f / std::sqrt(lane);
+    }
+    return result;
+#endif
+}
+
+// 列主序的 a * b，结果的每一列是 a 的四列按 b 对应列的分量加权求和
+auto multiply(const glm::mat4& a, const glm::mat4& b) -> glm::mat4 {
+    const float* lhs = &a[0][0];
+    const Float4 a0 = load(lhs);
+    const Float4 a1 = load(lhs + 4);
+    const Float4 a2 = load(lhs + 8);
+    const Float4 a3 = load(lhs + 12);
+    glm::mat4 result;
+    for (int column = 0; column < 4; ++column) {
+        const auto& c = b[column];
+        const Float4 value =
+            (a0 * splat(c.x)) + (a1 * splat(c.y)) + (a2 * splat(c.z)) + (a3 * splat(c.w));
+        store(&result[column][0], value);
+    }
+    return result;
+}
+
+// 在轨道上找到 time 前后的两个键并插值，轨道为空时返回 rest
+template <typename T, typename Mix>
+auto sampleTrack(const AnimationClip::Channel<T>& channel, std::size_t joint, float time,
+                 const T& rest, Mix mix, std::uint32_t* cursor) -> T {
+    const auto track = channel.track(joint);
+    if (track.count == 0) {
+        return rest;
+    }
+    const float* times = channel.times.data() + track.first;
+    const T* values = channel.values.data() + track.first;
+    if (track.count == 1 || time <= times[0]) {
+        return values[0];
+    }
+    if (time >= times[track.count - 1]) {
+        return values[track.count - 1];
+    }
+    std::uint32_t prev = 0;
+    if (track.inv_step > 0.f) {
+        prev = std::min(static_cast<std::uint32_t>((time - times[0]) * track.inv_step),
+                        track.count - 2);
+    } else {
+        std::uint32_t unused = track.count;
+        prev = findKey(track.count, time, cursor != nullptr ? *cursor : unused,
+                       [times](std::uint32_t i) -> float { return times[i]; });
+    }
+    const std::uint32_t next = prev + 1;
+    const float span = times[next] - times[prev];
+    const float factor = span > 0.f ? std::clamp((time - times[prev]) / span, 0.f, 1.f) : 0.f;
+    return mix(values[prev], values[next], factor);
+}
+
+auto lerpKey(const glm::vec3& a, const glm::vec3& b, float t) -> glm::vec3 {
+    return glm::mix(a, b, t);
+}
+
+auto slerpKey(const glm::quat& a, const glm::quat& b, float t) -> glm::quat {
+    return glm::normalize(glm::slerp(a, b, t));
+}
+
+template <typename T, typename Mix>
+void resampleChannel(const AnimationClip::Channel<T>& source, AnimationClip::Channel<T>& out,
+                     float step, Mix mix) {
+    std::vector<float> times;
+    std::vector<T> values;
+    for (std::size_t joint = 0; joint < source.tracks.size(); ++joint) {
+        const auto track = source.tracks[joint];
+        const std::span<const float> source_times{source.times.data() + track.first, track.count};
+        const std::span<const T> source_values{source.values.data() + track.first, track.count};
+        if (track.count < 2) {
+            out.set(joint, source_times, source_values);
+            continue;
+        }
+        // 首尾键保持不变，区间等分
+        const float start = source_times.front();
+        const float length = source_times.back() - start;
+        const auto intervals =
+            std::max(1U, static_cast<std::uint32_t>(std::ceil(length / step)));
+        times.clear();
+        values.clear();
+        for (std::uint32_t key = 0; key <= intervals; ++key) {
+            const float time = key == intervals ? source_times.back()
+                                                : start + (length * static_cast<float>(key) /
+                                                           static_cast<float>(intervals));
+            times.push_back(time);
+            values.push_back(sampleTrack(source, joint, time, source_values.front(), mix,
+                                         nullptr));
+        }
+        out.setUniform(joint, times, values);
+    }
+}
+}  // namespace
+
+void LocalPose::resize(std::size_t joints) {
+    if (joints == joints_) {
+        return;
+    }
+    joints_ = joints;
+    const std::size_t padded = (joints + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    for (auto* soa : {&tx, &ty, &tz, &rx, &ry, &rz}) {
+        soa->assign(padded, 0.f);
+    }
+    for (auto* soa : {&rw, &sx, &sy, &sz}) {
+        soa->assign(padded, 1.f);
+    }
+}
+
+void LocalPose::set(std::size_t joint, const glm::vec3& translation, const glm::quat& rotation,
+                    const glm::vec3& scale) {
+    tx[joint] = translation.x;
+    ty[joint] = translation.y;
+    tz[joint] = translation.z;
+    rx[joint] = rotation.x;
+    ry[joint] = rotation.y;
+    rz[joint] = rotation.z;
+    rw[joint] = rotation.w;
+    sx[joint] = scale.x;
+    sy[joint] = scale.y;
+    sz[joint] = scale.z;
+}
+
+void samplePose(const Skeleton& skeleton, const AnimationClip& clip, float time, LocalPose& out,
+                SampleCursor* cursor) {
+    const std::size_t joints = skeleton.jointCount();
+    out.resize(joints);
+    if (cursor != nullptr && cursor->translations.size() != joints) {
+        cursor->translations.assign(joints, 0);
+        cursor->rotations.assign(joints, 0);
+        cursor->scales.assign(joints, 0);
+    }
+    const auto at = [cursor](std::vector<std::uint32_t> SampleCursor::* member,
+                             std::size_t joint) -> std::uint32_t* {
+        return cursor != nullptr ? &((*cursor).*member)[joint] : nullptr;
+    };
+    for (std::size_t joint = 0; joint < joints; ++joint) {
+        out.set(joint,
+                sampleTrack(clip.translations, joint, time, skeleton.rest_translations[joint],
+                            lerpKey, at(&SampleCursor::translations, joint)),
+                sampleTrack(clip.rotations, joint, time, skeleton.rest_rotations[joint], slerpKey,
+                            at(&SampleCursor::rotations, joint)),
+                sampleTrack(clip.scales, joint, time, skeleton.rest_scales[joint], lerpKey,
+                            at(&SampleCursor::scales, joint)));
+    }
+}
+
+auto resampleUniform(const AnimationClip& clip, float samples_per_second) -> AnimationClip {
+    AnimationClip result;
+    result.duration = clip.duration;
+    result.ticks_per_second = clip.ticks_per_second;
+    const float step = clip.ticks_per_second / std::max(samples_per_second, 1e-3f);
+    resampleChannel(clip.translations, result.translations, step, lerpKey);
+    resampleChannel(clip.rotations, result.rotations, step, slerpKey);
+    resampleChannel(clip.scales, result.scales, step, lerpKey);
+    return result;
+}
+
+void blendPoses(const LocalPose& from, const LocalPose& to, float weight, LocalPose& out) {
+    out.resize(from.jointCount());
+    const Float4 w = splat(weight);
+    const std::size_t padded = from.tx.size();
+    // 平移和缩放线性插值
+    const std::array linear{std::tuple{&from.tx, &to.tx, &out.tx},
+                            std::tuple{&from.ty, &to.ty, &out.ty},
+                            std::tuple{&from.tz, &to.tz, &out.tz},
+                            std::tuple{&from.sx, &to.sx, &out.sx},
+                            std::tuple{&from.sy, &to.sy, &out.sy},
+                            std::tuple{&from.sz, &to.sz, &out.sz}};
+    for (const auto& [a, b, result] : linear) {
+        for (std::size_t i = 0; i < padded; i += LocalPose::SIMD_WIDTH) {
+            const Float4 start = load(a->data() + i);
+            store(result->data() + i, start + ((load(b->data() + i) - start) * w));
+        }
+    }
+
+    for (std::size_t i = 0; i < padded; i += LocalPose::SIMD_WIDTH) {
+        const Float4 ax = load(from.rx.data() + i);
+        const Float4 ay = load(from.ry.data() + i);
+        const Float4 az = load(from.rz.data() + i);
+        const Float4 aw = load(from.rw.data() + i);
+        Float4 bx = load(to.rx.data() + i);
+        Float4 by = load(to.ry.data() + i);
+        Float4 bz = load(to.rz.data() + i);
+        Float4 bw = load(to.rw.data() + i);
+        // q 和 -q 是同一个旋转，点积为负时翻转 b，沿最短路径插值
+        const Float4 dot = (ax * bx) + (ay * by) + (az * bz) + (aw * bw);
+        bx = negateWhereNegative(dot, bx);
+        by = negateWhereNegative(dot, by);
+        bz = negateWhereNegative(dot, bz);
+        bw = negateWhereNegative(dot, bw);
+        const Float4 x = ax + ((bx - ax) * w);
+        const Float4 y = ay + ((by - ay) * w);
+        const Float4 z = az + ((bz - az) * w);
+        const Float4 qw = aw + ((bw - aw) * w);
+        const Float4 inv_length = inverseSqrt((x * x) + (y * y) + (z * z) + (qw * qw));
+        store(out.rx.data() + i, x * inv_length);
+        store(out.ry.data() + i, y * inv_length);
+        store(out.rz.data() + i, z * inv_length);
+        store(out.rw.data() + i, qw * inv_length);
+    }
+}
+
+void buildPalette(const Skeleton& skeleton, const LocalPose& pose, std::vector<glm::mat4>& model,
+                  std::vector<glm::mat4>& palette) {
+    const std::size_t joints = skeleton.jointCount();
+    model.resize(joints);
+    palette.resize(joints);
+
+    // 局部矩阵 T * R * S，4 个关节一组从四元数展开旋转矩阵，各列乘上对应的缩放
+    const Float4 one = splat(1.f);
+    const Float4 two = splat(2.f);
+    std::array<std::array<float, LocalPose::SIMD_WIDTH>, 9> columns{};
+    for (std::size_t first = 0; first < joints; first += LocalPose::SIMD_WIDTH) {
+        const Float4 x = load(pose.rx.data() + first);
+        const Float4 y = load(pose.ry.data() + first);
+        const Float4 z = load(pose.rz.data() + first);
+        const Float4 w = load(pose.rw.data() + first);
+        const Float4 scale_x = load(pose.sx.data() + first);
+        const Float4 scale_y = load(pose.sy.data() + first);
+        const Float4 scale_z = load(pose.sz.data() + first);
+        const Float4 xx = x * x;
+        const Float4 yy = y * y;
+        const Float4 zz = z * z;
+        const Float4 xy = x * y;
+        const Float4 xz = x * z;
+        const Float4 yz = y * z;
+        const Float4 wx = w * x;
+        const Float4 wy = w * y;
+        const Float4 wz = w * z;
+        store(columns[0].data(), (one - (two * (yy + zz))) * scale_x);
+        store(columns[1].data(), (two * (xy + wz)) * scale_x);
+        store(columns[2].data(), (two * (xz - wy)) * scale_x);
+        store(columns[3].data(), (two * (xy - wz)) * scale_y);
+        store(columns[4].data(), (one - (two * (xx + zz))) * scale_y);
+        store(columns[5].data(), (two * (yz + wx)) * scale_y);
+        store(columns[6].data(), (two * (xz + wy)) * scale_z);
+        store(columns[7].data(), (two * (yz - wx)) * scale_z);
+        store(columns[8].data(), (one - (two * (xx + yy))) * scale_z);
+
+        const std::size_t lanes = std::min(LocalPose::SIMD_WIDTH, joints - first);
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            const std::size_t joint = first + lane;
+            auto& m = model[joint];
+            m[0] = glm::vec4{columns[0][lane], columns[1][lane], columns[2][lane], 0.f};
+            m[1] = glm::vec4{columns[3][lane], columns[4][lane], columns[5][lane], 0.f};
+            m[2] = glm::vec4{columns[6][lane], columns[7][lane], columns[8][lane], 0.f};
+            m[3] = glm::vec4{pose.tx[joint], pose.ty[joint], pose.tz[joint], 1.f};
+        }
+    }
+
+    // 父关节总在前面，一次正序遍历得到模型空间矩阵
+    for (std::size_t joint = 0; joint < joints; ++joint) {
+        const auto parent = skeleton.parents[joint];
+        if (parent != Skeleton::NO_PARENT) {
+            model[joint] = multiply(model[static_cast<std::size_t>(parent)], model[joint]);
+        }
+        palette[joint] = multiply(model[joint], skeleton.inverse_bind[joint]);
+    }
+}
+
+Animator::Animator(const Skeleton& skeleton) : skeleton_(&skeleton) {
+    pose_.resize(skeleton.jointCount());
+    for (std::size_t joint = 0; joint < skeleton.jointCount(); ++joint) {
+        pose_.set(joint, skeleton.rest_translations[joint], skeleton.rest_rotations[joint],
+                  skeleton.rest_scales[joint]);
+    }
+    buildPalette(skeleton, pose_, model_, palette_);
+}
+
+void Animator::play(const AnimationClip& clip, float speed) {
+    current_ = {.clip = &clip, .time = 0.f, .speed = speed};
+    previous_ = {};
+    fade_elapsed_ = 0.f;
+    fade_duration_ = 0.f;
+}
+
+void Animator::crossFade(const AnimationClip& clip, float seconds, float speed) {
+    if (current_.clip == nullptr || seconds <= 0.f) {
+        play(clip, speed);
+        return;
+    }
+    previous_ = current_;
+    current_ = {.clip = &clip, .time = 0.f, .speed = speed};
+    fade_elapsed_ = 0.f;
+    fade_duration_ = seconds;
+}
+
+void Animator::advance(Layer& layer, float delta_seconds) {
+    if (layer.clip == nullptr) {
+        return;
+    }
+    layer.time += delta_seconds * layer.speed * layer.clip->ticks_per_second;
+    // 循环播放
+    const float duration = layer.clip->duration;
+    if (duration > 0.f) {
+        layer.time = std::fmod(layer.time, duration);
+        if (layer.time < 0.f) {
+            layer.time += duration;
+        }
+    }
+}
+
+void Animator::update(float delta_seconds) {
+    if (current_.clip == nullptr) {
+        return;
+    }
+    advance(current_, delta_seconds);
+    samplePose(*skeleton_, *current_.clip, current_.time, pose_, &current_.cursor);
+    if (previous_.clip != nullptr) {
+        advance(previous_, delta_seconds);
+        fade_elapsed_ += delta_seconds;
+        if (fade_elapsed_ >= fade_duration_) {
+            previous_ = {};
+        } else {
+            samplePose(*skeleton_, *previous_.clip, previous_.time, fade_pose_,
+                       &previous_.cursor);
+            blendPoses(fade_pose_, pose_, fade_elapsed_ / fade_duration_, pose_);
+        }
+    }
+    buildPalette(*skeleton_, pose_, model_, palette_);
+}
+
+void updateAnimators(std::span<Animator> animators, float delta_seconds) {
+    ZoneScoped;
+    common::parallelFor(animators.size(), PARALLEL_GRAIN,
+                        [animators, delta_seconds](std::size_t begin, std::size_t end) {
+                            for (std::size_t i = begin; i < end; ++i) {
+                                animators[i].update(delta_seconds);
+                            }
+                        });
+}
+
+}  // namespace graphics::animation
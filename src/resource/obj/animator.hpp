@@ -0,0 +1,98 @@
+#pragma once
+#include "resource/obj/animation_clip.hpp"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace graphics::animation {
+
+/// SoA 的局部姿势，每个分量一个数组，长度补齐到 SIMD_WIDTH，补齐部分是单位变换
+class LocalPose {
+    public:
+        static constexpr std::size_t SIMD_WIDTH = 4;
+
+        void resize(std::size_t joints);
+        void set(std::size_t joint, const glm::vec3& translation, const glm::quat& rotation,
+                 const glm::vec3& scale);
+
+        [[nodiscard]] auto jointCount() const -> std::size_t { return joints_; }
+        [[nodiscard]] auto translation(std::size_t joint) const -> glm::vec3 {
+            return {tx[joint], ty[joint], tz[joint]};
+        }
+        [[nodiscard]] auto rotation(std::size_t joint) const -> glm::quat {
+            return {rw[joint], rx[joint], ry[joint], rz[joint]};
+        }
+        [[nodiscard]] auto scale(std::size_t joint) const -> glm::vec3 {
+            return {sx[joint], sy[joint], sz[joint]};
+        }
+
+        std::vector<float> tx, ty, tz;
+        std::vector<float> rx, ry, rz, rw;
+        std::vector<float> sx, sy, sz;
+
+    private:
+        std::size_t joints_{0};
+};
+
+// 每条轨道上一次采样所在的键，按关节存放，同一个片段连续播放时复用
+struct SampleCursor {
+        std::vector<std::uint32_t> translations;
+        std::vector<std::uint32_t> rotations;
+        std::vector<std::uint32_t> scales;
+};
+
+// time 是片段内的 tick，超出键的范围时取首尾键。
+// 传入 cursor 时从上一次的键开始查找，单调播放时每条轨道只需比较几次
+void samplePose(const Skeleton& skeleton, const AnimationClip& clip, float time, LocalPose& out,
+                SampleCursor* cursor = nullptr);
+// 把每条轨道重新采样为等间距的键（每秒 samples_per_second 个），采样时直接算出下标。
+// 键数可能增加，适合键很密但间距不均的动作捕捉片段
+auto resampleUniform(const AnimationClip& clip, float samples_per_second) -> AnimationClip;
+// out = mix(from, to, weight)，旋转按最短路径做 nlerp，4 个关节一组用 SSE/NEON 计算
+void blendPoses(const LocalPose& from, const LocalPose& to, float weight, LocalPose& out);
+// 局部姿势转为模型空间矩阵，再乘上 inverse_bind 得到蒙皮矩阵
+void buildPalette(const Skeleton& skeleton, const LocalPose& pose, std::vector<glm::mat4>& model,
+                  std::vector<glm::mat4>& palette);
+
+/// 一个骨骼动画实例：播放一个片段，切换时在两个片段之间淡入淡出。
+/// 骨架和片段由调用方持有，生命周期要长于 Animator
+class Animator {
+    public:
+        explicit Animator(const Skeleton& skeleton);
+
+        void play(const AnimationClip& clip, float speed = 1.f);
+        // 在 seconds 秒内从当前片段过渡到 clip
+        void crossFade(const AnimationClip& clip, float seconds, float speed = 1.f);
+        // 推进时间并重新计算蒙皮矩阵
+        void update(float delta_seconds);
+
+        [[nodiscard]] auto palette() const -> std::span<const glm::mat4> { return palette_; }
+        [[nodiscard]] auto modelMatrices() const -> std::span<const glm::mat4> { return model_; }
+        [[nodiscard]] auto pose() const -> const LocalPose& { return pose_; }
+
+    private:
+        struct Layer {
+                const AnimationClip* clip{nullptr};
+                float time{0.f};  // tick
+                float speed{1.f};
+                SampleCursor cursor;
+        };
+        static void advance(Layer& layer, float delta_seconds);
+
+        const Skeleton* skeleton_;
+        Layer current_;
+        Layer previous_;  // 淡出中的片段
+        float fade_elapsed_{0.f};
+        float fade_duration_{0.f};
+        LocalPose pose_;
+        LocalPose fade_pose_;
+        std::vector<glm::mat4> model_;
+        std::vector<glm::mat4> palette_;
+};
+
+// 多个实例之间没有依赖，在共享线程池上并行更新
+void updateAnimators(std::span<Animator> animators, float delta_seconds);
+
+}  // namespace graphics::animation
@@ -0,0 +1,198 @@
+#include "resource/obj/ao_baker.hpp"
+#include "common/parallel.hpp"
+
+#include <embree4/rtcore.h>
+#include <pmmintrin.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+
+namespace {
+constexpr std::uint32_t PACKET_SIZE = 8;
+constexpr std::size_t VERTEX_GRAIN = 64;
+
+// PCG hash，每个顶点得到不同的采样旋转，避免所有顶点共用一组方向产生条纹
+auto hashUint(std::uint32_t x) -> std::uint32_t {
+    const std::uint32_t state = (x * 747796405U) + 2891336453U;
+    const std::uint32_t word = ((state >> ((state >> 28U) + 4U)) ^ state) * 277803737U;
+    return (word >> 22U) ^ word;
+}
+
+auto toUnitFloat(std::uint32_t bits) -> float {
+    return static_cast<float>(bits >> 8U) * (1.f / static_cast<float>(1U << 24U));
+}
+
+auto radicalInverse(std::uint32_t bits) -> float {
+    bits = (bits << 16U) | (bits >> 16U);
+    bits = ((bits & 0x55555555U) << 1U) | ((bits & 0xAAAAAAAAU) >> 1U);
+    bits = ((bits & 0x33333333U) << 2U) | ((bits & 0xCCCCCCCCU) >> 2U);
+    bits = ((bits & 0x0F0F0F0FU) << 4U) | ((bits & 0xF0F0F0F0U) >> 4U);
+    bits = ((bits & 0x00FF00FFU) << 8U) | ((bits & 0xFF00FF00U) >> 8U);
+    return toUnitFloat(bits);
+}
+
+// Duff et al. 2017，由法线构造正交基
+void orthonormalBasis(const glm::vec3& n, glm::vec3& tangent, glm::vec3& bitangent) {
+    const float sign = std::copysign(1.f, n.z);
+    const float a = -1.f / (sign + n.z);
+    const float b = n.x * n.y * a;
+    tangent = {1.f + (sign * n.x * n.x * a), sign * b, -sign * n.x};
+    bitangent = {b, sign + (n.y * n.y * a), -n.y};
+}
+
+class AoScene {
+    public:
+        AoScene() : device_(rtcNewDevice(nullptr)) {
+            if (!device_) {
+                throw std::runtime_error("Failed to create Embree device");
+            }
+            scene_ = rtcNewScene(device_);
+            rtcSetSceneFlags(scene_, RTC_SCENE_FLAG_ROBUST);
+            rtcSetSceneBuildQuality(scene_, RTC_BUILD_QUALITY_HIGH);
+        }
+        ~AoScene() {
+            rtcReleaseScene(scene_);
+            rtcReleaseDevice(device_);
+        }
+        AoScene(const AoScene&) = delete;
+        AoScene(AoScene&&) = delete;
+        auto operator=(const AoScene&) -> AoScene& = delete;
+        auto operator=(AoScene&&) -> AoScene& = delete;
+
+        void addTarget(const graphics::AoBakeTarget& target) {
+            const auto triangle_count = target.indices.size() / 3;
+            if (target.vertices.empty() || triangle_count == 0) {
+                return;
+            }
+            RTCGeometry geometry = rtcNewGeometry(device_, RTC_GEOMETRY_TYPE_TRIANGLE);
+            auto* vertices_mapped = static_cast<glm::vec3*>(
+                rtcSetNewGeometryBuffer(geometry, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3,
+                                        sizeof(glm::vec3), target.vertices.size()));
+            std::ranges::transform(target.vertices, vertices_mapped,
+                                   [](const graphics::Vertex& vertex) { return vertex.position; });
+            auto* indices_mapped = static_cast<std::uint32_t*>(
+                rtcSetNewGeometryBuffer(geometry, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3,
+                                        sizeof(std::uint32_t) * 3, triangle_count));
+            std::copy_n(target.indices.begin(), triangle_count * 3, indices_mapped);
+            rtcCommitGeometry(geometry);
+            rtcAttachGeometry(scene_, geometry);
+            rtcReleaseGeometry(geometry);
+        }
+
+        [[nodiscard]] auto commit() -> RTCScene {
+            rtcCommitScene(scene_);
+            return scene_;
+        }
+
+    private:
+        RTCDevice device_;
+        RTCScene scene_{};
+};
+
+auto bakeVertex(RTCScene scene, const graphics::Vertex& vertex, std::uint32_t vertex_seed,
+                std::uint32_t sample_count, float max_distance, float bias) -> float {
+    const float length = glm::length(vertex.normal);
+    if (!(length > 0.f)) {
+        return 1.f;
+    }
+    const glm::vec3 normal = vertex.normal / length;
+    glm::vec3 tangent;
+    glm::vec3 bitangent;
+    orthonormalBasis(normal, tangent, bitangent);
+    const glm::vec3 origin = vertex.position + (normal * bias);
+    // Cranley-Patterson 旋转 Hammersley 点集
+    const float offset_u = toUnitFloat(hashUint(vertex_seed));
+    const float offset_v = toUnitFloat(hashUint(vertex_seed ^ 0x68E31DA4U));
+    const float inv_count = 1.f / static_cast<float>(sample_count);
+
+    std::uint32_t occluded = 0;
+    for (std::uint32_t first = 0; first < sample_count; first += PACKET_SIZE) {
+        alignas(32) std::array<int, PACKET_SIZE> valid{};
+        RTCRay8 rays{};
+        for (std::uint32_t lane = 0; lane < PACKET_SIZE; ++lane) {
+            const std::uint32_t sample = first + lane;
+            if (sample >= sample_count) {
+                continue;
+            }
+            valid[lane] = -1;
+            float u = ((static_cast<float>(sample) + 0.5f) * inv_count) + offset_u;
+            float v = radicalInverse(sample) + offset_v;
+            u -= std::floor(u);
+            v -= std::floor(v);
+            // 余弦加权半球采样
+            const float radius = std::sqrt(u);
+            const float phi = 2.f * std::numbers::pi_v<float> * v;
+            const glm::vec3 direction = (tangent * (radius * std::cos(phi))) +
+                                        (bitangent * (radius * std::sin(phi))) +
+                                        (normal * std::sqrt(std::max(0.f, 1.f - u)));
+            rays.org_x[lane] = origin.x;
+            rays.org_y[lane] = origin.y;
+            rays.org_z[lane] = origin.z;
+            rays.dir_x[lane] = direction.x;
+            rays.dir_y[lane] = direction.y;
+            rays.dir_z[lane] = direction.z;
+            rays.tnear[lane] = 0.f;
+            rays.tfar[lane] = max_distance;
+            rays.time[lane] = 0.f;
+            rays.mask[lane] = std::numeric_limits<unsigned int>::max();
+            rays.id[lane] = sample;
+            rays.flags[lane] = 0;
+        }
+        rtcOccluded8(valid.data(), scene, &rays, nullptr);
+        for (std::uint32_t lane = 0; lane < PACKET_SIZE; ++lane) {
+            // 被遮挡的光线 tfar 会被置为 -inf
+            if (valid[lane] != 0 && rays.tfar[lane] < 0.f) {
+                ++occluded;
+            }
+        }
+    }
+    return 1.f - (static_cast<float>(occluded) * inv_count);
+}
+}  // namespace
+
+namespace graphics {
+
+void bakeVertexAo(std::span<const AoBakeTarget> targets, const AoBakeConfig& config) {
+    glm::vec3 bounds_min{std::numeric_limits<float>::max()};
+    glm::vec3 bounds_max{std::numeric_limits<float>::lowest()};
+    for (const auto& target : targets) {
+        for (const auto& vertex : target.vertices) {
+            bounds_min = glm::min(bounds_min, vertex.position);
+            bounds_max = glm::max(bounds_max, vertex.position);
+        }
+    }
+    if (bounds_min.x > bounds_max.x || config.sample_count == 0) {
+        return;
+    }
+    const float diagonal = std::max(glm::length(bounds_max - bounds_min), 1e-6f);
+    const float max_distance = config.max_distance > 0.f ? config.max_distance : diagonal * 0.25f;
+    const float bias = config.bias * diagonal;
+    const std::uint32_t sample_count =
+        (config.sample_count + PACKET_SIZE - 1) / PACKET_SIZE * PACKET_SIZE;
+
+    AoScene ao_scene;
+    for (const auto& target : targets) {
+        ao_scene.addTarget(target);
+    }
+    RTCScene scene = ao_scene.commit();
+
+    std::uint32_t seed = config.seed;
+    for (const auto& target : targets) {
+        auto vertices = target.vertices;
+        common::parallelFor(vertices.size(), VERTEX_GRAIN, [&](std::size_t begin, std::size_t end) {
+            _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+            _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+            for (std::size_t i = begin; i < end; ++i) {
+                vertices[i].ao = bakeVertex(scene, vertices[i],
+                                            hashUint(seed + static_cast<std::uint32_t>(i)),
+                                            sample_count, max_distance, bias);
+            }
+        });
+        seed = hashUint(seed);
+    }
+}
+
+}  // namespace graphics
@@ -0,0 +1,26 @@
+#pragma once
+#include "resource/obj/mesh_vertex.hpp"
+
+#include <cstdint>
+#include <span>
+
+namespace graphics {
+
+struct AoBakeConfig {
+        std::uint32_t sample_count{64};  // 每个顶点的光线数，按 8 条一个 packet 向上取整
+        float max_distance{0.f};         // 遮挡半径，<= 0 时取包围盒对角线的 1/4
+        float bias{1e-4f};               // 起点沿法线的偏移，相对于包围盒对角线
+        std::uint32_t seed{0x9E3779B9U};
+};
+
+// 一组共用同一个顶点数组的三角形，多个 target 放进同一个场景互相遮挡
+struct AoBakeTarget {
+        std::span<Vertex> vertices;
+        std::span<const std::uint32_t> indices;  // 三角形列表
+};
+
+/// 用 Embree 对静态网格做顶点级环境光遮蔽烘焙，结果写入 Vertex::ao。
+/// 余弦加权的半球采样，8 条光线一组用 rtcOccluded8 求交，顶点在线程池上并行处理。
+void bakeVertexAo(std::span<const AoBakeTarget> targets, const AoBakeConfig& config = {});
+
+}  // namespace graphics
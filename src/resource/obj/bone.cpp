@@ -1,6 +1,7 @@
 #include "resource/obj/bone.hpp"
 #include "resource/obj/assimp_glm_helpers.hpp"
 
+#include <algorithm>
 #include <ranges>
 
 namespace graphics {
@@ -34,15 +35,16 @@ auto Bone::getScaleFactor(float lastTimeStamp, float nextTimeStamp, float animat
     float scaleFactor{};
     float_t midWayLength = animationTime - lastTimeStamp;
     float framesDiff = nextTimeStamp - lastTimeStamp;
-    scaleFactor = midWayLength / framesDiff;
-    return scaleFactor;
+    scaleFactor = framesDiff > 0.f ? midWayLength / framesDiff : 0.f;
+    // 超出首尾键时停在端点
+    return std::clamp(scaleFactor, 0.f, 1.f);
 }
 auto Bone::interpolatePosition(float animationTime) -> glm::mat4 {
     if (positions_.size() == 1) {
         return glm::translate(glm::mat4(1.f), positions_[0].position);
     }
-    int p0Index = index(animationTime, positions_);
-    int p1Index = p0Index + 1;
+    const auto p0Index = index(animationTime, positions_, position_cursor_);
+    const auto p1Index = p0Index + 1;
     float scaleFactor =
         getScaleFactor(positions_[p0Index].timeStamp, positions_[p1Index].timeStamp, animationTime);
     glm::vec3 finalPosition =
@@ -55,8 +57,8 @@ auto Bone::interpolateRotation(float animationTime) -> glm::mat4 {
         auto rotation = glm::normalize(rotations_[0].orientation);
         return glm::toMat4(rotation);
     }
-    int p0Index = index(animationTime, rotations_);
-    int p1Index = p0Index + 1;
+    const auto p0Index = index(animationTime, rotations_, rotation_cursor_);
+    const auto p1Index = p0Index + 1;
     float scaleFactor =
         getScaleFactor(rotations_[p0Index].timeStamp, rotations_[p1Index].timeStamp, animationTime);
     glm::quat finalRotation =
@@ -69,8 +71,8 @@ auto Bone::interpolateScale(float animationTime) -> glm::mat4 {
     if (scales_.size() == 1) {
         return glm::scale(glm::mat4(1.f), scales_[0].scale);
     }
-    int p0Index = index(animationTime, scales_);
-    int p1Index = p0Index + 1;
+    const auto p0Index = index(animationTime, scales_, scale_cursor_);
+    const auto p1Index = p0Index + 1;
     float scaleFactor =
         getScaleFactor(scales_[p0Index].timeStamp, scales_[p1Index].timeStamp, animationTime);
     glm::vec3 finalScale = glm::mix(scales_[p0Index].scale, scales_[p1Index].scale, scaleFactor);
@@ -1,7 +1,9 @@
 #pragma once
+#include "resource/obj/animation_clip.hpp"
 #include <assimp/scene.h>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <cstdint>
 #include <vector>
 #include <string>
 namespace graphics {
@@ -26,14 +28,13 @@ class Bone {
         [[nodiscard]] auto Name() const -> std::string_view { return name_; }
 
     private:
+        // 返回 time 前面的键，cursor 记录上一次的结果，顺序播放时不必从头查找
         template <typename Container>
-        auto index(float animationTime, const Container& keys) -> int {
-            for (unsigned int i = 0; i < keys.size() - 1; i++) {
-                if (animationTime < keys[i].timeStamp) {
-                    return static_cast<int>(i);
-                }
-            }
-            assert(0);
+        static auto index(float animationTime, const Container& keys, std::uint32_t& cursor)
+            -> std::uint32_t {
+            return animation::findKey(
+                static_cast<std::uint32_t>(keys.size()), animationTime, cursor,
+                [&keys](std::uint32_t i) -> float { return keys[i].timeStamp; });
         }
 
         auto getScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime) -> float;
@@ -50,6 +51,9 @@ class Bone {
         int num_positions_{};
         int num_rotations_{};
         int num_scalings_{};
+        std::uint32_t position_cursor_{0};
+        std::uint32_t rotation_cursor_{0};
+        std::uint32_t scale_cursor_{0};
 
         glm::mat4 local_transform_;
         std::string name_;
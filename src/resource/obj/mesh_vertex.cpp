@@ -23,6 +23,9 @@ auto Vertex::getVertexAttribute() -> std::vector<render::VertexAttribute> {
     vertex_attributes.push_back(
         make_vertex_attribute(location++, render::VertexAttribute::Type::Float,
                               offsetof(Vertex, texCoord), render::VertexAttribute::Size::R32_G32));
+    vertex_attributes.push_back(
+        make_vertex_attribute(location++, render::VertexAttribute::Type::Float,
+                              offsetof(Vertex, ao), render::VertexAttribute::Size::R32));
 
     return vertex_attributes;
 }
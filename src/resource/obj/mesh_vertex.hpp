@@ -11,6 +11,7 @@ struct Vertex {
         ::glm::vec3 color;
         ::glm::vec3 normal;
         ::glm::vec2 texCoord;
+        float ao{1.f};  // 离线烘焙的环境光遮蔽，1 表示没有遮挡
         auto operator==(const Vertex& other) const -> bool;
 
         static auto getVertexBinding() -> std::vector<render::VertexBinding>;
@@ -1,9 +1,12 @@
 #include "model_mesh.hpp"
 
 #include "common/file.hpp"
+#include "common/settings.hpp"
+#include "resource/obj/ao_baker.hpp"
 #include <assimp/postprocess.h>
 
 #include <assimp/Importer.hpp>
+#include <array>
 #include <cassert>
 #include <fstream>
 #include <stack>
@@ -26,7 +29,7 @@ struct MultiMeshCacheHeader {
         uint32_t version = graphics::MESH_CACHE_VERSION;
         uint64_t fileHash = 0;
         uint32_t meshCount = 0;
-        uint32_t padding = 0;
+        uint32_t flags = 0;  // MESH_CACHE_FLAG_*
 };
 template <typename T>
 auto as_bytes(std::span<const T> s) -> std::span<const std::byte> {
@@ -36,7 +39,11 @@ auto as_bytes(std::span<const T> s) -> std::span<const std::byte> {
     return std::span<const std::byte>(ptr, s.size() * sizeof(T));
 }
 
-void saveModelToCache(std::uint64_t file_hash, const graphics::Model& model) {
+auto requiredCacheFlags() -> uint32_t {
+    return settings::values.bake_vertex_ao.GetValue() ? graphics::MESH_CACHE_FLAG_BAKED_AO : 0U;
+}
+
+void saveModelToCache(std::uint64_t file_hash, const graphics::Model& model, uint32_t flags) {
     common::FS::create_dir(model_cache_path);
     auto cachePath = std::string(model_cache_path) + std::to_string(file_hash) + model_cache_extend;
     std::ofstream file(cachePath, std::ios::binary);
@@ -50,6 +57,7 @@ void saveModelToCache(std::uint64_t file_hash, const graphics::Model& model) {
     header.version = graphics::MESH_CACHE_VERSION;
     header.objFileHash = file_hash;
     header.subMeshCount = static_cast<uint32_t>(model.subMeshes.size());
+    header.flags = flags;
 
     file.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
@@ -98,6 +106,10 @@ auto loadModelWithCache(std::uint64_t file_hash) -> std::optional<graphics::Mode
         header.version != graphics::MESH_CACHE_VERSION || header.objFileHash != file_hash) {
         return std::nullopt;
     }
+    // 缓存里没有当前需要的烘焙数据时重新导入
+    if ((header.flags & requiredCacheFlags()) != requiredCacheFlags()) {
+        return std::nullopt;
+    }
 
     // 读取全局顶点/索引数量
     uint64_t vertexCount = 0, indexCount = 0, onlyVertexCount = 0;
@@ -222,7 +234,24 @@ auto loadModelFromAssimpScene(const aiScene* scene) -> graphics::Model {
     return model;
 }
 
-void saveMultiMeshToCache(uint64_t file_hash, const graphics::MultiMeshModel& model) {
+// 只有三角形子网格参与遮挡和烘焙，线段/点保持 ao = 1
+void bakeModelAo(graphics::Model& model) {
+    std::vector<uint32_t> triangles;
+    triangles.reserve(model.indices_.size());
+    for (const auto& sub : model.subMeshes) {
+        if (sub.primitiveTopology != render::PrimitiveTopology::Triangles) {
+            continue;
+        }
+        const auto first = model.indices_.begin() + sub.indexOffset;
+        triangles.insert(triangles.end(), first, first + (sub.indexCount / 3 * 3));
+    }
+    const std::array targets{
+        graphics::AoBakeTarget{.vertices = model.vertices_, .indices = triangles}};
+    graphics::bakeVertexAo(targets);
+}
+
+void saveMultiMeshToCache(uint64_t file_hash, const graphics::MultiMeshModel& model,
+                          uint32_t flags) {
     common::FS::create_dir(model_cache_path);
     auto cachePath =
         std::string(model_cache_path) + std::to_string(file_hash) + model_multi_mesh_cache_extend;
@@ -237,6 +266,7 @@ void saveMultiMeshToCache(uint64_t file_hash, const graphics::MultiMeshModel& mo
     header.fileHash = file_hash;
     auto meshes = model.getMeshes();
     header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.flags = flags;
 
     file.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
@@ -245,7 +275,8 @@ void saveMultiMeshToCache(uint64_t file_hash, const graphics::MultiMeshModel& mo
     }
 }
 
-auto loadMultiMeshFromCache(uint64_t file_hash) -> std::vector<graphics::MultiMeshModel::Mesh> {
+auto loadMultiMeshFromCache(uint64_t file_hash, uint32_t& flags)
+    -> std::vector<graphics::MultiMeshModel::Mesh> {
     auto cachePath =
         std::string(model_cache_path) + std::to_string(file_hash) + model_multi_mesh_cache_extend;
     std::ifstream file(cachePath, std::ios::binary);
@@ -259,6 +290,10 @@ auto loadMultiMeshFromCache(uint64_t file_hash) -> std::vector<graphics::MultiMe
         header.fileHash != file_hash) {
         return {};
     }
+    if ((header.flags & requiredCacheFlags()) != requiredCacheFlags()) {
+        return {};
+    }
+    flags = header.flags;
 
     std::vector<graphics::MultiMeshModel::Mesh> meshes;
     meshes.reserve(header.meshCount);
@@ -305,8 +340,11 @@ auto Model::createFromFile(const ::std::string& model_path, std::uint64_t obj_ha
         throw std::runtime_error("load model fail: " + std::string(importer.GetErrorString()));
     }
     Model model = loadModelFromAssimpScene(scene);
-    std::string cache_path = model_cache_path + std::to_string(obj_hash) + model_cache_extend;
-    saveModelToCache(obj_hash, model);
+    const auto flags = requiredCacheFlags();
+    if (flags & MESH_CACHE_FLAG_BAKED_AO) {
+        bakeModelAo(model);
+    }
+    saveModelToCache(obj_hash, model, flags);
 
     return model;
 }
@@ -327,7 +365,7 @@ MultiMeshModel::MultiMeshModel(std::string_view path, uint64_t file_hash_, bool
         auto model_file_hash = common::FS::file_hash(std::string(path));
         file_hash = model_file_hash ? model_file_hash.value() : 0;
     }
-    auto meshes = loadMultiMeshFromCache(file_hash);
+    auto meshes = loadMultiMeshFromCache(file_hash, cache_flags_);
     if (!meshes.empty()) {
         meshes_ = std::move(meshes);
         return;
@@ -341,6 +379,22 @@ MultiMeshModel::MultiMeshModel(std::string_view path, uint64_t file_hash_, bool
         throw std::runtime_error("load model fail: " + std::string(importer.GetErrorString()));
     }
     processNode(scene->mRootNode, scene);
+    cache_flags_ = requiredCacheFlags();
+    if (cache_flags_ & MESH_CACHE_FLAG_BAKED_AO) {
+        bakeAmbientOcclusion();
+    }
+}
+
+void MultiMeshModel::bakeAmbientOcclusion() {
+    std::vector<AoBakeTarget> targets;
+    targets.reserve(meshes_.size());
+    for (auto& mesh : meshes_) {
+        // 线段和点网格的索引数也可能是 3 的倍数，按加载时记录的图元类型判断
+        if (mesh.triangles) {
+            targets.push_back({.vertices = mesh.vertices_, .indices = mesh.indices_});
+        }
+    }
+    bakeVertexAo(targets);
 }
 
 void MultiMeshModel::processNode(aiNode* root, const aiScene* scene) {
@@ -370,6 +424,8 @@ void MultiMeshModel::processNode(aiNode* root, const aiScene* scene) {
 }
 void MultiMeshModel::processMesh(aiMesh* mesh, const aiScene* scene) {
     Mesh m;
+    // aiProcess_Triangulate 只拆分多边形，点和线段网格保持原样
+    m.triangles = mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE;
 
     // 处理顶点
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
@@ -421,6 +477,6 @@ void MultiMeshModel::processMesh(aiMesh* mesh, const aiScene* scene) {
     meshes_.push_back(std::move(m));
 }
 
-MultiMeshModel::~MultiMeshModel() { saveMultiMeshToCache(file_hash, *this); }
+MultiMeshModel::~MultiMeshModel() { saveMultiMeshToCache(file_hash, *this, cache_flags_); }
 
 }  // namespace graphics
@@ -12,8 +12,9 @@
 #include <assimp/scene.h>
 namespace graphics {
 
-constexpr const uint32_t MESH_CACHE_VERSION = 1;
+constexpr const uint32_t MESH_CACHE_VERSION = 2;  // 2: Vertex 增加 ao
 constexpr uint32_t MODEL_CACHE_MAGIC = 0x4D4F444C;  // 'MODL'
+constexpr uint32_t MESH_CACHE_FLAG_BAKED_AO = 1U << 0U;
 struct ModelCacheHeader {
         static constexpr uint32_t MAGIC = MODEL_CACHE_MAGIC;
 
@@ -21,7 +22,7 @@ struct ModelCacheHeader {
         uint32_t version = MESH_CACHE_VERSION;
         uint64_t objFileHash = 0;
         uint32_t subMeshCount = 0;
-        uint32_t padding = 0;       // 对齐
+        uint32_t flags = 0;  // MESH_CACHE_FLAG_*
 };
 
 struct SubMesh {
@@ -75,6 +76,8 @@ class MultiMeshModel {
                 std::vector<::glm::vec3> only_vertex;
                 std::vector<uint32_t> indices_;
                 MeshMaterial material;
+                // 源 aiMesh 只含三角形，只在从 assimp 加载时设置，决定是否参与 AO 烘焙
+                bool triangles{false};
                 [[nodiscard]] auto getMesh() const -> std::span<const float> override {
                     return std::span<const float>(
                         reinterpret_cast<const float*>(vertices_.data()),
@@ -163,8 +166,10 @@ class MultiMeshModel {
     private:
         void processNode(aiNode* node, const aiScene* scene);
         void processMesh(aiMesh* mesh, const aiScene* scene);
+        void bakeAmbientOcclusion();
         std::vector<Mesh> meshes_;
         uint64_t file_hash;
+        uint32_t cache_flags_{0};
 };
 
 }  // namespace graphics
@@ -8,10 +8,17 @@ set(sources
     texture/ktx_image.hpp
     texture/ktx_image.cpp
     obj/animal_vertex.hpp
+    obj/ao_baker.hpp
+    obj/ao_baker.cpp
     obj/animation_model.hpp
     obj/animation_model.cpp
     obj/animation.hpp
     obj/animation.cpp
+    obj/animation_clip.hpp
+    obj/animation_compression.hpp
+    obj/animation_compression.cpp
+    obj/animator.hpp
+    obj/animator.cpp
     obj/assimp_glm_helpers.hpp
     obj/bone.hpp
     obj/bone.cpp
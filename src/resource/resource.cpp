@@ -19,9 +19,8 @@ auto ResourceManager::addTexture(std::string_view textureName, const add_texture
     -> render::TextureId {
     ASSERT_MSG(!textureName.empty(), "textureName is null");
 
-    const auto [pair, is_new]{textures.try_emplace(std::string(textureName))};
-    if (!is_new) {
-        return pair->second;
+    if (const auto handle = findTexture(std::string(textureName))) {
+        return getTexture(handle);
     }
     resource::image::Image texture(textureName);
     render::TextureId id;
@@ -30,35 +29,33 @@ auto ResourceManager::addTexture(std::string_view textureName, const add_texture
     } else {
         id = graphic->uploadTexture(texture);
     }
-    pair->second = id;
+    addTextureRecord(std::string(textureName), id);
     return id;
 }
 
 auto ResourceManager::addKtxCubeMap(std::string name) -> render::TextureId {
     ASSERT_MSG(!name.empty(), "textureName is null");
-    const auto [pair, is_new]{textures.try_emplace(name)};
-    if (!is_new) {
-        return pair->second;
+    if (const auto handle = findTexture(name)) {
+        return getTexture(handle);
     }
     resource::image::KtxImage image(texture::CUBE_MAP_PATH + name);
     auto* texture = image.getKtxTexture();
     auto id = graphic->uploadTexture(texture);
-    pair->second = id;
+    addTextureRecord(name, id);
     return id;
 }
 
 auto ResourceManager::addKtxTexture(std::string name) -> render::TextureId {
     ASSERT_MSG(!name.empty(), "textureName is null");
-    const auto [pair, is_new]{textures.try_emplace(name)};
-    if (!is_new) {
-        return pair->second;
+    if (const auto handle = findTexture(name)) {
+        return getTexture(handle);
     }
     std::filesystem::path file{name};
     file.replace_extension("ktx2");
     resource::image::KtxImage image(texture::TEXTURE_ROOT_PATH + file.string());
     auto* texture = image.getKtxTexture();
     auto id = graphic->uploadTexture(texture);
-    pair->second = id;
+    addTextureRecord(name, id);
     return id;
 }
 
@@ -86,7 +83,7 @@ auto ResourceManager::addCubeMapTexture(std::span<std::string> textureNames,
     } else {
         id = graphic->uploadTexture(uploadImage);
     }
-    textures[name] = id;
+    addTextureRecord(name, id);
     return id;
 }
 
@@ -94,11 +91,68 @@ auto ResourceManager::getTexture(std::string textureName) const -> render::Textu
     if (textureName.empty()) {
         return {};
     }
-    ASSERT_MSG(textures.contains(textureName), textureName + " texture not in catch");
-    return textures.find(textureName)->second;
+    const auto handle = findTexture(textureName);
+    ASSERT_MSG(handle, textureName + " texture not in catch");
+    return getTexture(handle);
+}
+
+auto ResourceManager::findTexture(const std::string& name) const -> TextureHandle {
+    const auto it = texture_names_.find(name);
+    return it == texture_names_.end() ? TextureHandle{} : it->second;
+}
+
+auto ResourceManager::getTexture(TextureHandle handle) const -> render::TextureId {
+    const auto* record = textures_.get(handle);
+    return record == nullptr ? render::TextureId{} : record->id;
+}
+
+auto ResourceManager::addTextureRecord(const std::string& name, render::TextureId id)
+    -> TextureHandle {
+    // 同名纹理重新上传时旧句柄失效，仍被引用的旧纹理由最后一次 release 销毁
+    auto& handle = texture_names_[name];
+    if (const auto* old = textures_.get(handle); old != nullptr && old->refs == 0) {
+        textures_.release(handle);
+    }
+    handle = textures_.allocate(TextureRecord{.id = id, .name = name});
+    if (texture_by_id_.size() <= id.index) {
+        texture_by_id_.resize(id.index + 1);
+    }
+    texture_by_id_[id.index] = handle;
+    return handle;
+}
+
+auto ResourceManager::textureRecord(render::TextureId id) -> TextureRecord* {
+    return id.index < texture_by_id_.size() ? textures_.get(texture_by_id_[id.index]) : nullptr;
+}
+
+void ResourceManager::acquireTexture(render::TextureId id) {
+    if (auto* record = textureRecord(id)) {
+        ++record->refs;
+    }
+}
+
+void ResourceManager::releaseTexture(render::TextureId id) {
+    auto* record = textureRecord(id);
+    if (record == nullptr || record->refs == 0 || --record->refs > 0) {
+        return;
+    }
+    const auto handle = texture_by_id_[id.index];
+    if (const auto it = texture_names_.find(record->name);
+        it != texture_names_.end() && it->second == handle) {
+        texture_names_.erase(it);
+    }
+    texture_by_id_[id.index] = {};
+    textures_.release(handle);
+    if (graphic) {
+        graphic->releaseTexture(id);
+    }
 }
 
 auto ResourceManager::addModel(std::string_view model_path, add_mesh_func func) -> render::MeshId {
+    return addModel(model_path, parseModel(model_path), std::move(func));
+}
+
+auto ResourceManager::parseModel(std::string_view model_path) -> Model {
     ASSERT_MSG(!model_path.empty(), "meshName is null");
     namespace fs = std::filesystem;
     fs::path file_path = common::FS::get_module_path(common::FS::ModuleType::Model)/model_path;
@@ -113,12 +167,17 @@ auto ResourceManager::addModel(std::string_view model_path, add_mesh_func func)
 
         flip_uv = j.contains("need_flip_uv") && j["need_flip_uv"].get<bool>();
     }
-    auto model_ = Model::createFromFile(model::MODEL_ROOT_PATH + model_file_path,
-                                        model_file_hash[model_file_path], flip_uv);
+    // 哈希为 0 时由 createFromFile 根据文件内容计算
+    return Model::createFromFile(model::MODEL_ROOT_PATH + model_file_path, 0, flip_uv);
+}
+
+auto ResourceManager::addModel(std::string_view model_path, const Model& model_,
+                               add_mesh_func func) -> render::MeshId {
     auto mesh_id = addMesh(std::string(model_path), model_, std::move(func));
-    mesh_vertex[mesh_id] = std::make_unique<std::vector<::glm::vec3>>(model_.only_vertex);
-    mesh_indics[mesh_id] = std::make_unique<std::vector<uint32_t>>(model_.indices_);
-    model_sub_mesh[mesh_id] = std::make_unique<std::vector<SubMesh>>(model_.subMeshes);
+    auto* record = meshRecord(mesh_id);
+    record->vertices = model_.only_vertex;
+    record->indices = model_.indices_;
+    record->sub_meshes = model_.subMeshes;
     return mesh_id;
 }
 
@@ -143,11 +202,12 @@ auto ResourceManager::getModelConfig(std::string_view name) -> ModelConfig {
 
 void ResourceManager::addMeshVertex(render::MeshId meshId, const std::vector<glm::vec3>& vertexes,
                                     const std::vector<uint32_t>& indics) {
-    if (vertexes.empty()) {
+    auto* record = meshRecord(meshId);
+    if (vertexes.empty() || record == nullptr) {
         return;
     }
-    mesh_vertex[meshId] = std::make_unique<std::vector<::glm::vec3>>(vertexes);
-    mesh_indics[meshId] = std::make_unique<std::vector<uint32_t>>(indics);
+    record->vertices = vertexes;
+    record->indices = indics;
 }
 
 auto ResourceManager::addMesh(std::string meshName, const render::IMeshData& meshData,
@@ -160,24 +220,49 @@ auto ResourceManager::addMesh(std::string meshName, const render::IMeshData& mes
     } else {
         meshId = graphic->uploadModel(meshData);
     }
-    model_mesh_id_[meshName] = meshId;
+    // 旧记录不释放：已经创建的模型还持有它的顶点 span，由最后一次 releaseMesh 释放
+    const auto handle = meshes_.allocate(MeshRecord{.id = meshId, .name = meshName});
+    mesh_names_[meshName] = handle;
+    if (mesh_by_id_.size() <= meshId.index) {
+        mesh_by_id_.resize(meshId.index + 1);
+    }
+    mesh_by_id_[meshId.index] = handle;
     return meshId;
 }
 auto ResourceManager::getMesh(const std::string& name) const -> render::MeshId {
     if (name.empty()) {
         return {};
     }
-    ASSERT_MSG(model_mesh_id_.contains(name), meshName + " mesh in catch");
-    return model_mesh_id_.find(name)->second;
+    const auto handle = findMesh(name);
+    ASSERT_MSG(handle, name + " mesh in catch");
+    return getMesh(handle);
+}
+
+auto ResourceManager::findMesh(const std::string& name) const -> MeshHandle {
+    const auto it = mesh_names_.find(name);
+    return it == mesh_names_.end() ? MeshHandle{} : it->second;
+}
+
+auto ResourceManager::getMesh(MeshHandle handle) const -> render::MeshId {
+    const auto* record = meshes_.get(handle);
+    return record == nullptr ? render::MeshId{} : record->id;
+}
+
+auto ResourceManager::meshRecord(render::MeshId id) -> MeshRecord* {
+    return id.index < mesh_by_id_.size() ? meshes_.get(mesh_by_id_[id.index]) : nullptr;
+}
+
+auto ResourceManager::meshRecord(render::MeshId id) const -> const MeshRecord* {
+    return id.index < mesh_by_id_.size() ? meshes_.get(mesh_by_id_[id.index]) : nullptr;
 }
 
 [[nodiscard]] auto ResourceManager::getModelSubMesh(render::MeshId id) const
     -> std::span<const SubMesh> {
-    if (!model_sub_mesh.contains(id)) {
+    const auto* record = meshRecord(id);
+    if (record == nullptr) {
         return {};
     }
-    const auto& sub_mesh = model_sub_mesh.find(id)->second;
-    return std::span<const SubMesh>(sub_mesh->data(), sub_mesh->size());
+    return record->sub_meshes;
 }
 
 auto ResourceManager::getShaderCode(render::ShaderType type, const std::string& name)
@@ -195,23 +280,37 @@ auto ResourceManager::getShaderCode(render::ShaderType type, const std::string&
     }
 }
 
+auto ResourceManager::shaderRecord(const std::string& name) -> ShaderRecord& {
+    auto& handle = shader_names_[name];
+    if (!shaders_.valid(handle)) {
+        handle = shaders_.allocate();
+    }
+    return *shaders_.get(handle);
+}
+
+auto ResourceManager::findShader(const std::string& name) const -> const ShaderRecord* {
+    const auto it = shader_names_.find(name);
+    return it == shader_names_.end() ? nullptr : shaders_.get(it->second);
+}
+
 template <render::ShaderType type>
 auto ResourceManager::getShaderHash(const std::string& name) const -> std::uint64_t {
+    const auto* record = findShader(name);
     if constexpr (type == render::ShaderType::Vertex) {
-        if (graphic_shader_hash.contains(name)) {
-            return graphic_shader_hash.find(name)->second.vertex;
+        if (record != nullptr && record->graphic.vertex != 0) {
+            return record->graphic.vertex;
         }
     }
 
     if constexpr (type == render::ShaderType::Fragment) {
-        if (graphic_shader_hash.contains(name)) {
-            return graphic_shader_hash.find(name)->second.fragment;
+        if (record != nullptr && record->graphic.fragment != 0) {
+            return record->graphic.fragment;
         }
     }
 
     if constexpr (type == render::ShaderType::Compute) {
-        if (compute_shader_hash.contains(name)) {
-            return compute_shader_hash.find(name)->second;
+        if (record != nullptr && record->compute != 0) {
+            return record->compute;
         }
     }
     ASSERT_MSG(false, "get shader not found");
@@ -221,14 +320,15 @@ auto ResourceManager::getShaderHash(const std::string& name) const -> std::uint6
 template <typename T>
     requires(IsUint64<T> || IsShaderHashStruct<T>)
 [[nodiscard]] auto ResourceManager::getShaderHash(const std::string& name) const -> T {
+    const auto* record = findShader(name);
     if constexpr (std::is_same_v<T, std::uint64_t>) {
-        if (compute_shader_hash.contains(name)) {
-            return compute_shader_hash.find(name)->second;
+        if (record != nullptr && record->compute != 0) {
+            return record->compute;
         }
     }
     if constexpr (std::is_same_v<T, ShaderHash>) {
-        if (graphic_shader_hash.contains(name)) {
-            return graphic_shader_hash.find(name)->second;
+        if (record != nullptr && record->graphic.vertex != 0) {
+            return record->graphic;
         }
     }
     ASSERT_MSG(false, "get shader not found or type error");
@@ -251,9 +351,21 @@ auto ResourceManager::addGraphShader(
         hash.vertex = graphic->addShader(vertex_shader_code, render::ShaderType::Vertex);
         hash.fragment = graphic->addShader(fragment_shader_code, render::ShaderType::Fragment);
     }
-    graphic_shader_hash[name] = hash;
+    shaderRecord(name).graphic = hash;
     return hash;
 }
+auto ResourceManager::addVertexShader(const std::string& name) -> std::uint64_t {
+    auto code = getShaderCode(render::ShaderType::Vertex, name);
+    auto hash = graphic->addShader(code, render::ShaderType::Vertex);
+    shaderRecord(name).vertex = hash;
+    return hash;
+}
+
+auto ResourceManager::getVertexShaderHash(const std::string& name) const -> std::uint64_t {
+    const auto* record = findShader(name);
+    return record == nullptr ? 0 : record->vertex;
+}
+
 void ResourceManager::addComputeShader(
     const std::string& name,
     const std::function<std::uint64_t(std::span<const std::uint32_t>, render::ShaderType)>&
@@ -265,22 +377,46 @@ void ResourceManager::addComputeShader(
     } else {
         hash = graphic->addShader(shader_code, render::ShaderType::Compute);
     }
-    compute_shader_hash[name] = hash;
+    shaderRecord(name).compute = hash;
 }
 
 auto ResourceManager::getMeshVertex(render::MeshId id) -> std::span<glm::vec3> {
-    if (mesh_vertex.contains(id)) {
-        auto& data = mesh_vertex.find(id)->second;
-        return std::span(data->data(), data->size());
+    auto* record = meshRecord(id);
+    if (record == nullptr) {
+        return {};
     }
-    return {};
+    return record->vertices;
 }
 auto ResourceManager::getMeshIndics(render::MeshId id) -> std::span<uint32_t> {
-    if (mesh_indics.contains(id)) {
-        auto& data = mesh_indics.find(id)->second;
-        return std::span(data->data(), data->size());
+    auto* record = meshRecord(id);
+    if (record == nullptr) {
+        return {};
+    }
+    return record->indices;
+}
+
+void ResourceManager::acquireMesh(render::MeshId id) {
+    if (auto* record = meshRecord(id)) {
+        ++record->refs;
+    }
+}
+
+void ResourceManager::releaseMesh(render::MeshId id) {
+    auto* record = meshRecord(id);
+    if (record == nullptr || record->refs == 0 || --record->refs > 0) {
+        return;
+    }
+    const auto handle = mesh_by_id_[id.index];
+    if (const auto it = mesh_names_.find(record->name);
+        it != mesh_names_.end() && it->second == handle) {
+        mesh_names_.erase(it);
+    }
+    mesh_by_id_[id.index] = {};
+    // 顶点和索引的副本随记录一起释放
+    meshes_.release(handle);
+    if (graphic) {
+        graphic->releaseModel(id);
     }
-    return {};
 }
 
 ResourceManager::ResourceManager(render::Graphic* graphic_) : graphic(graphic_) {
@@ -293,7 +429,10 @@ void ResourceManager::initializeDefaultTextures() {
     resource::image::Image white_texture(1, 1, withe, 1);
     if (graphic) {
         auto white_texture_id = graphic->uploadTexture(white_texture);
-        textures[std::string(DEFAULT_1X1_WRITE_TEXTURE)] = white_texture_id;
+        default_texture_ =
+            addTextureRecord(std::string(DEFAULT_1X1_WRITE_TEXTURE), white_texture_id);
+        // 所有模型共用，多持有一次引用，不会被释放
+        acquireTexture(white_texture_id);
     }
 }
 
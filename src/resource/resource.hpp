@@ -3,6 +3,7 @@
 #include "render_core/shader_cache.hpp"
 #include "resource/obj/model_mesh.hpp"
 #include "render_core/mesh.hpp"
+#include "common/handle_pool.hpp"
 
 #include <unordered_map>
 #include <string>
@@ -41,8 +42,18 @@ concept IsShaderHashStruct = std::same_as<T, ShaderHash>;
 template <typename T>
 concept IsUint64 = std::same_as<T, std::uint64_t>;
 
+struct TextureTag;
+struct MeshTag;
+struct ShaderTag;
+using TextureHandle = common::Handle<TextureTag>;
+using MeshHandle = common::Handle<MeshTag>;
+using ShaderHandle = common::Handle<ShaderTag>;
+
 using add_texture_func = std::function<render::TextureId(const render::ITexture&)>;
 using add_mesh_func = std::function<render::TextureId(const render::IMeshData&)>;
+/// 资源的登记、查询和引用计数都不加锁，只能在创建它的线程（持有 Graphic 的主线程）中调用，
+/// 上传 GPU 资源本来也要在这个线程完成。工作线程只能调用 parseModel，结果交回主线程用 addModel 登记。
+/// 名字只在加载时解析一次：调用方保存 findMesh / findTexture 返回的句柄，之后按句柄直接索引。
 class ResourceManager {
     public:
         ~ResourceManager() = default;
@@ -65,9 +76,18 @@ class ResourceManager {
         auto addKtxCubeMap(std::string name) -> render::TextureId;
         auto addKtxTexture(std::string name) -> render::TextureId;
         [[nodiscard]] auto getTexture(std::string textureName) const -> render::TextureId;
+        // 没有贴图的材质共用的 1x1 白色纹理，构造时保存了句柄，不需要按名字查找
+        [[nodiscard]] auto getDefaultTexture() const -> render::TextureId {
+            return getTexture(default_texture_);
+        }
         explicit ResourceManager(render::Graphic* graphic_);
 
         auto addModel(std::string_view path, add_mesh_func func = nullptr) -> render::MeshId;
+        // 只读取模型文件，不访问 ResourceManager 的状态，可以在工作线程中调用
+        static auto parseModel(std::string_view path) -> Model;
+        // 登记 parseModel 的结果，名字与 addModel(path) 相同
+        auto addModel(std::string_view path, const Model& model, add_mesh_func func = nullptr)
+            -> render::MeshId;
 
         auto getModelConfig(std::string_view name) -> ModelConfig;
         auto addMesh(std::string meshName, const render::IMeshData&, add_mesh_func func = nullptr)
@@ -79,10 +99,23 @@ class ResourceManager {
         [[nodiscard]] auto getModelSubMesh(render::MeshId id) const -> std::span<const SubMesh>;
 
         [[nodiscard]] auto getMesh(const std::string& name) const -> render::MeshId;
+        [[nodiscard]] auto hasMesh(const std::string& name) const -> bool {
+            return mesh_names_.contains(name);
+        }
+        // 名字只在加载时解析一次，之后用句柄直接索引；没有加载时返回无效句柄
+        [[nodiscard]] auto findMesh(const std::string& name) const -> MeshHandle;
+        // 句柄已经失效时返回无效的 MeshId
+        [[nodiscard]] auto getMesh(MeshHandle handle) const -> render::MeshId;
+        [[nodiscard]] auto findTexture(const std::string& name) const -> TextureHandle;
+        [[nodiscard]] auto getTexture(TextureHandle handle) const -> render::TextureId;
         auto addGraphShader(
             const std::string& name,
             const std::function<std::uint64_t(std::span<const std::uint32_t>, render::ShaderType)>&
                 upload_func = nullptr) -> ShaderHash;
+        // 只有顶点着色器的变体（例如实例化版本），与同名片段着色器组合使用
+        auto addVertexShader(const std::string& name) -> std::uint64_t;
+        // 没有加载时返回 0
+        [[nodiscard]] auto getVertexShaderHash(const std::string& name) const -> std::uint64_t;
         void addComputeShader(
             const std::string& name,
             const std::function<std::uint64_t(std::span<const std::uint32_t>, render::ShaderType)>&
@@ -103,18 +136,55 @@ class ResourceManager {
         auto getMeshVertex(render::MeshId id) -> std::span<glm::vec3>;
         auto getMeshIndics(render::MeshId id) -> std::span<uint32_t>;
 
+        // 网格和纹理的引用计数，从没有 acquire 过的资源一直保留。
+        // 最后一次 release 时删除名字和顶点副本，GPU 资源交给 Graphic 延迟销毁，之后同名资源重新加载
+        void acquireMesh(render::MeshId id);
+        void releaseMesh(render::MeshId id);
+        void acquireTexture(render::TextureId id);
+        void releaseTexture(render::TextureId id);
+
     private:
         auto getShaderCode(render::ShaderType type, const std::string& name)
             -> std::vector<std::uint32_t>;
         void initializeDefaultTextures();
-        std::unordered_map<std::string, render::TextureId> textures;
-        std::unordered_map<std::string, render::MeshId> model_mesh_id_;
-        std::unordered_map<render::MeshId, std::unique_ptr<std::vector<glm::vec3>>> mesh_vertex;
-        std::unordered_map<render::MeshId, std::unique_ptr<std::vector<std::uint32_t>>> mesh_indics;
-        std::unordered_map<std::string, std::uint64_t> compute_shader_hash;
-        std::unordered_map<std::string, ShaderHash> graphic_shader_hash;
+        // 每类资源的数据放在各自的句柄池中，名字表只负责把资源名解析成句柄
+        struct MeshRecord {
+                render::MeshId id;
+                std::string name;
+                std::uint32_t refs{0};
+                std::vector<glm::vec3> vertices;
+                std::vector<std::uint32_t> indices;
+                std::vector<SubMesh> sub_meshes;
+        };
+        struct TextureRecord {
+                render::TextureId id;
+                std::string name;
+                std::uint32_t refs{0};
+        };
+        // 同名的图形、计算和仅顶点着色器共用一条记录
+        struct ShaderRecord {
+                ShaderHash graphic{};
+                std::uint64_t compute{0};
+                std::uint64_t vertex{0};
+        };
+
+        auto addTextureRecord(const std::string& name, render::TextureId id) -> TextureHandle;
+        auto meshRecord(render::MeshId id) -> MeshRecord*;
+        [[nodiscard]] auto meshRecord(render::MeshId id) const -> const MeshRecord*;
+        auto textureRecord(render::TextureId id) -> TextureRecord*;
+        auto shaderRecord(const std::string& name) -> ShaderRecord&;
+        [[nodiscard]] auto findShader(const std::string& name) const -> const ShaderRecord*;
+
+        common::HandlePool<TextureRecord, TextureTag> textures_;
+        std::unordered_map<std::string, TextureHandle> texture_names_;
+        std::vector<TextureHandle> texture_by_id_;  // 按 TextureId::index 索引
+        TextureHandle default_texture_;
+        common::HandlePool<MeshRecord, MeshTag> meshes_;
+        std::unordered_map<std::string, MeshHandle> mesh_names_;
+        std::vector<MeshHandle> mesh_by_id_;  // 按 MeshId::index 索引
+        common::HandlePool<ShaderRecord, ShaderTag> shaders_;
+        std::unordered_map<std::string, ShaderHandle> shader_names_;
         std::unordered_map<std::string, std::uint64_t> model_file_hash;
-        std::unordered_map<render::MeshId, std::unique_ptr<std::vector<SubMesh>>> model_sub_mesh;
 
         render::Graphic* graphic;
 };
@@ -432,6 +432,9 @@ auto getShaderInfo(std::span<const uint32_t> spirv) -> Info {
         info.storage_buffers_descriptors.push_back(
             {.binding = binding, .count = count, .set = set, .is_written = false});
     }
+    // 渲染器按 binding 顺序填写 storage buffer 描述符（0 场景数据，之后是实例数据）
+    std::ranges::sort(info.storage_buffers_descriptors, {},
+                      [](const auto& descriptor) { return descriptor.binding; });
     // eCombinedImageSampler
     for (const auto& resource : resources.sampled_images) {
         uint32_t binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
@@ -586,6 +589,13 @@ auto getShaderInfo(std::span<const uint32_t> spirv) -> Info {
         info.push_constants.size = size;
     }
 
+    for (const auto& resource : resources.stage_outputs) {
+        const uint32_t location = compiler.get_decoration(resource.id, spv::DecorationLocation);
+        if (location < 32) {
+            info.output_location_mask |= 1U << location;
+        }
+    }
+
     return info;
 }
 
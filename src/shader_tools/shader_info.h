@@ -87,6 +87,7 @@ struct Info {
         TextureDescriptors texture_descriptors;
         ImageDescriptors image_descriptors;
         PushConstant push_constants;
+        uint32_t output_location_mask{};  // 着色器写出的 location，bit i 对应 location i
 };
 template <typename Descriptors>
 auto NumDescriptors(const Descriptors& descriptors) -> uint32_t {
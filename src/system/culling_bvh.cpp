@@ -0,0 +1,371 @@
+#include "system/culling_bvh.hpp"
+#include "common/parallel.hpp"
+#include "common/simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <tracy/Tracy.hpp>
+
+namespace graphics {
+namespace {
+using Planes = std::array<glm::vec4, core::Frustum::Count>;
+
+constexpr std::size_t PARALLEL_GRAIN = 16;
+constexpr std::size_t OCCLUSION_GRAIN = 64;
+
+enum class Containment : std::uint8_t { Outside, Intersect, Inside };
+
+auto surfaceArea(const core::AABB& box) -> float {
+    const glm::vec3 size = glm::max(box.max - box.min, glm::vec3{0.f});
+    return 2.f * ((size.x * size.y) + (size.y * size.z) + (size.z * size.x));
+}
+
+auto merge(const core::AABB& a, const core::AABB& b) -> core::AABB {
+    return {.min = glm::min(a.min, b.min), .max = glm::max(a.max, b.max)};
+}
+
+auto planeDistance(const glm::vec4& plane, const glm::vec3& point) -> float {
+    return (plane.x * point.x) + (plane.y * point.y) + (plane.z * point.z) + plane.w;
+}
+
+// p 顶点（沿法线最远的角）在外侧则整个盒子在外侧，n 顶点在外侧则与平面相交
+auto classify(const Planes& planes, const core::AABB& box) -> Containment {
+    bool inside = true;
+    for (const auto& plane : planes) {
+        const glm::vec3 positive{plane.x >= 0.f ? box.max.x : box.min.x,
+                                 plane.y >= 0.f ? box.max.y : box.min.y,
+                                 plane.z >= 0.f ? box.max.z : box.min.z};
+        if (planeDistance(plane, positive) < 0.f) {
+            return Containment::Outside;
+        }
+        const glm::vec3 negative{plane.x >= 0.f ? box.min.x : box.max.x,
+                                 plane.y >= 0.f ? box.min.y : box.max.y,
+                                 plane.z >= 0.f ? box.min.z : box.max.z};
+        if (planeDistance(plane, negative) < 0.f) {
+            inside = false;
+        }
+    }
+    return inside ? Containment::Inside : Containment::Intersect;
+}
+
+// 连续 4 个包围盒的 SoA 视图
+struct BoxLanes {
+        std::array<const float*, 3> min;
+        std::array<const float*, 3> max;
+};
+
+// 4 个包围盒对 6 个平面做 p 顶点测试，返回完全位于某个平面外侧的 lane 掩码。
+// 法线分量的符号对所有 lane 相同，按符号直接选 min/max 数组，循环内没有分支
+auto outsideMask(const Planes& planes, const BoxLanes& boxes) -> std::uint32_t {
+#if defined(GRAPHICS_SIMD_SSE)
+    __m128 outside = _mm_setzero_ps();
+    for (const auto& plane : planes) {
+        const __m128 px = _mm_loadu_ps(plane.x >= 0.f ? boxes.max[0] : boxes.min[0]);
+        const __m128 py = _mm_loadu_ps(plane.y >= 0.f ? boxes.max[1] : boxes.min[1]);
+        const __m128 pz = _mm_loadu_ps(plane.z >= 0.f ? boxes.max[2] : boxes.min[2]);
+        __m128 dist = _mm_mul_ps(_mm_set1_ps(plane.x), px);
+        dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.y), py));
+        dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.z), pz));
+        dist = _mm_add_ps(dist, _mm_set1_ps(plane.w));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_setzero_ps()));
+    }
+    return static_cast<std::uint32_t>(_mm_movemask_ps(outside));
+#elif defined(GRAPHICS_SIMD_NEON)
+    uint32x4_t outside = vdupq_n_u32(0);
+    for (const auto& plane : planes) {
+        const float32x4_t px = vld1q_f32(plane.x >= 0.f ? boxes.max[0] : boxes.min[0]);
+        const float32x4_t py = vld1q_f32(plane.y >= 0.f ? boxes.max[1] : boxes.min[1]);
+        const float32x4_t pz = vld1q_f32(plane.z >= 0.f ? boxes.max[2] : boxes.min[2]);
+        float32x4_t dist = vmulq_n_f32(px, plane.x);
+        dist = vaddq_f32(dist, vmulq_n_f32(py, plane.y));
+        dist = vaddq_f32(dist, vmulq_n_f32(pz, plane.z));
+        dist = vaddq_f32(dist, vdupq_n_f32(plane.w));
+        outside = vorrq_u32(outside, vcltq_f32(dist, vdupq_n_f32(0.f)));
+    }
+    std::array<std::uint32_t, 4> lanes{};
+    vst1q_u32(lanes.data(), outside);
+    std::uint32_t mask = 0;
+    for (std::uint32_t lane = 0; lane < 4; ++lane) {
+        mask |= (lanes[lane] & 1U) << lane;
+    }
+    return mask;
+#else
+    std::uint32_t mask = 0;
+    for (std::uint32_t lane = 0; lane < 4; ++lane) {
+        for (const auto& plane : planes) {
+            const glm::vec3 positive{(plane.x >= 0.f ? boxes.max[0] : boxes.min[0])[lane],
+                                     (plane.y >= 0.f ? boxes.max[1] : boxes.min[1])[lane],
+                                     (plane.z >= 0.f ? boxes.max[2] : boxes.min[2])[lane]};
+            if (planeDistance(plane, positive) < 0.f) {
+                mask |= 1U << lane;
+                break;
+            }
+        }
+    }
+    return mask;
+#endif
+}
+}  // namespace
+
+auto computeBounds(std::span<const glm::vec3> vertices, std::span<const std::uint32_t> indices)
+    -> core::AABB {
+    constexpr float max = std::numeric_limits<float>::max();
+    core::AABB bounds{.min = glm::vec3{max}, .max = glm::vec3{-max}};
+    for (const auto index : indices) {
+        if (index < vertices.size()) {
+            bounds.min = glm::min(bounds.min, vertices[index]);
+            bounds.max = glm::max(bounds.max, vertices[index]);
+        }
+    }
+    return bounds.min.x <= bounds.max.x ? bounds : core::AABB{};
+}
+
+auto CullingBvh::add(const core::AABB& local_bounds) -> proxy_t {
+    structure_dirty_ = true;
+    if (!free_.empty()) {
+        const proxy_t proxy = free_.back();
+        free_.pop_back();
+        local_[proxy] = local_bounds;
+        world_[proxy] = local_bounds;
+        moved_[proxy] = 0;
+        visible_[proxy] = ALL_VIEWS;
+        alive_[proxy] = 1;
+        return proxy;
+    }
+    const auto proxy = static_cast<proxy_t>(local_.size());
+    local_.push_back(local_bounds);
+    world_.push_back(local_bounds);
+    moved_.push_back(0);
+    visible_.push_back(ALL_VIEWS);
+    alive_.push_back(1);
+    return proxy;
+}
+
+void CullingBvh::remove(proxy_t proxy) {
+    alive_[proxy] = 0;
+    visible_[proxy] = 0;
+    free_.push_back(proxy);
+    structure_dirty_ = true;
+}
+
+void CullingBvh::setTransform(proxy_t proxy, const glm::mat4& world) {
+    world_[proxy] = local_[proxy].transform(world);
+    moved_[proxy] = 1;
+}
+
+void CullingBvh::markAllVisible() {
+    for (std::size_t proxy = 0; proxy < alive_.size(); ++proxy) {
+        visible_[proxy] = alive_[proxy] != 0 ? ALL_VIEWS : view_mask_t{0};
+    }
+}
+
+void CullingBvh::cull(const core::Frustum& frustum) { cull(std::span{&frustum, 1}, 1); }
+
+void CullingBvh::cull(std::span<const core::Frustum> views, view_mask_t mask) {
+    ZoneScoped;
+    if (structure_dirty_) {
+        rebuild();
+    } else {
+        refit();
+    }
+    std::ranges::fill(visible_, view_mask_t{0});
+    const auto view_count = std::min<std::size_t>(views.size(), MAX_VIEWS);
+    mask &= static_cast<view_mask_t>((1U << view_count) - 1U);
+    if (nodes_.empty() || mask == 0) {
+        return;
+    }
+
+    for (std::size_t view = 0; view < view_count; ++view) {
+        near_planes_[view] = views[view].planes()[core::Frustum::Near];
+    }
+    partial_leaves_.clear();
+    // 节点带着仍与其相交的视图入栈，某个视图完全包含或完全排除节点后就不再测试这个视图
+    std::array<std::pair<std::uint32_t, view_mask_t>, 64> stack{};
+    std::size_t top = 0;
+    stack[top++] = {0, mask};
+    while (top > 0) {
+        const auto [index, node_mask] = stack[--top];
+        const Node& node = nodes_[index];
+        view_mask_t inside = 0;
+        view_mask_t intersect = 0;
+        for (std::uint32_t view = 0; view < view_count; ++view) {
+            const auto bit = static_cast<view_mask_t>(1U << view);
+            if ((node_mask & bit) == 0) {
+                continue;
+            }
+            const auto containment = classify(views[view].planes(), node.bounds);
+            if (containment == Containment::Inside) {
+                inside |= bit;
+            } else if (containment == Containment::Intersect) {
+                intersect |= bit;
+            }
+        }
+        if (inside != 0) {
+            for (std::uint32_t slot = node.first; slot < node.first + node.count; ++slot) {
+                visible_[order_[slot]] |= inside;
+            }
+        }
+        if (intersect == 0) {
+            continue;
+        }
+        if (node.right == 0) {
+            partial_leaves_.emplace_back(index, intersect);
+        } else {
+            stack[top++] = {node.right, intersect};
+            stack[top++] = {index + 1, intersect};
+        }
+    }
+
+    // 不同叶子的 proxy 互不重叠，可以并行写 visible_
+    common::parallelFor(partial_leaves_.size(), PARALLEL_GRAIN,
+                        [this, views](std::size_t begin, std::size_t end) {
+                            for (std::size_t i = begin; i < end; ++i) {
+                                const auto [leaf, leaf_mask] = partial_leaves_[i];
+                                testLeaf(views, nodes_[leaf], leaf_mask);
+                            }
+                        });
+}
+
+void CullingBvh::cullOccluded(const OcclusionBuffer& occlusion) {
+    ZoneScoped;
+    common::parallelFor(world_.size(), OCCLUSION_GRAIN,
+                        [this, &occlusion](std::size_t begin, std::size_t end) {
+                            for (std::size_t proxy = begin; proxy < end; ++proxy) {
+                                if ((visible_[proxy] & 1U) != 0 &&
+                                    occlusion.occluded(world_[proxy])) {
+                                    visible_[proxy] &= static_cast<view_mask_t>(~1U);
+                                }
+                            }
+                        });
+}
+
+void CullingBvh::testLeaf(std::span<const core::Frustum> views, const Node& leaf,
+                          view_mask_t mask) {
+    for (std::uint32_t offset = 0; offset < leaf.count; offset += SIMD_WIDTH) {
+        const std::size_t slot = leaf.first + offset;
+        const BoxLanes boxes{.min = {&min_x_[slot], &min_y_[slot], &min_z_[slot]},
+                             .max = {&max_x_[slot], &max_y_[slot], &max_z_[slot]}};
+        const std::uint32_t lanes = std::min<std::uint32_t>(SIMD_WIDTH, leaf.count - offset);
+        for (std::uint32_t view = 0; view < views.size() && view < MAX_VIEWS; ++view) {
+            const auto bit = static_cast<view_mask_t>(1U << view);
+            if ((mask & bit) == 0) {
+                continue;
+            }
+            const std::uint32_t outside = outsideMask(views[view].planes(), boxes);
+            for (std::uint32_t lane = 0; lane < lanes; ++lane) {
+                if (((outside >> lane) & 1U) == 0) {
+                    visible_[order_[slot + lane]] |= bit;
+                }
+            }
+        }
+    }
+}
+
+void CullingBvh::rebuild() {
+    ZoneScoped;
+    order_.clear();
+    for (proxy_t proxy = 0; proxy < local_.size(); ++proxy) {
+        if (alive_[proxy] != 0) {
+            order_.push_back(proxy);
+        }
+    }
+    const auto count = static_cast<std::uint32_t>(order_.size());
+    nodes_.clear();
+    const std::size_t padded = count + SIMD_WIDTH - 1;
+    for (auto* soa : {&min_x_, &min_y_, &min_z_, &max_x_, &max_y_, &max_z_}) {
+        soa->assign(padded, 0.f);
+    }
+    built_area_ = 0.f;
+    if (count > 0) {
+        nodes_.reserve(((2 * count) / LEAF_SIZE) + 1);
+        buildNode(0, count);
+    }
+    for (std::uint32_t slot = 0; slot < count; ++slot) {
+        storeSoa(slot);
+    }
+    for (const auto& node : nodes_) {
+        built_area_ += surfaceArea(node.bounds);
+    }
+    std::ranges::fill(moved_, std::uint8_t{0});
+    structure_dirty_ = false;
+}
+
+// 按质心跨度最大的轴取中位数二分
+auto CullingBvh::buildNode(std::uint32_t first, std::uint32_t count) -> std::uint32_t {
+    const auto index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.push_back(Node{.bounds = slotBounds(first, count), .first = first, .count = count});
+    if (count <= LEAF_SIZE) {
+        return index;
+    }
+
+    constexpr float max = std::numeric_limits<float>::max();
+    glm::vec3 centroid_min{max};
+    glm::vec3 centroid_max{-max};
+    for (std::uint32_t slot = first; slot < first + count; ++slot) {
+        const glm::vec3 center = world_[order_[slot]].center();
+        centroid_min = glm::min(centroid_min, center);
+        centroid_max = glm::max(centroid_max, center);
+    }
+    const glm::vec3 spread = centroid_max - centroid_min;
+    int axis = spread.y > spread.x ? 1 : 0;
+    if (spread.z > spread[axis]) {
+        axis = 2;
+    }
+
+    const std::uint32_t half = count / 2;
+    const auto begin = order_.begin() + first;
+    std::nth_element(begin, begin + half, begin + count, [this, axis](proxy_t a, proxy_t b) {
+        return world_[a].center()[axis] < world_[b].center()[axis];
+    });
+    buildNode(first, half);
+    const std::uint32_t right = buildNode(first + half, count - half);
+    nodes_[index].right = right;
+    return index;
+}
+
+void CullingBvh::refit() {
+    bool any_moved = false;
+    for (std::uint32_t slot = 0; slot < order_.size(); ++slot) {
+        if (moved_[order_[slot]] != 0) {
+            storeSoa(slot);
+            any_moved = true;
+        }
+    }
+    if (!any_moved) {
+        return;
+    }
+    std::ranges::fill(moved_, std::uint8_t{0});
+
+    // 孩子的下标总是大于父节点，倒序遍历即可自底向上
+    float area = 0.f;
+    for (std::size_t i = nodes_.size(); i-- > 0;) {
+        auto& node = nodes_[i];
+        node.bounds = node.right == 0 ? slotBounds(node.first, node.count)
+                                      : merge(nodes_[i + 1].bounds, nodes_[node.right].bounds);
+        area += surfaceArea(node.bounds);
+    }
+    if (area > std::max(built_area_, std::numeric_limits<float>::min()) * REBUILD_RATIO) {
+        rebuild();
+    }
+}
+
+void CullingBvh::storeSoa(std::uint32_t slot) {
+    const auto& bounds = world_[order_[slot]];
+    min_x_[slot] = bounds.min.x;
+    min_y_[slot] = bounds.min.y;
+    min_z_[slot] = bounds.min.z;
+    max_x_[slot] = bounds.max.x;
+    max_y_[slot] = bounds.max.y;
+    max_z_[slot] = bounds.max.z;
+}
+
+auto CullingBvh::slotBounds(std::uint32_t first, std::uint32_t count) const -> core::AABB {
+    core::AABB bounds = world_[order_[first]];
+    for (std::uint32_t slot = first + 1; slot < first + count; ++slot) {
+        bounds = merge(bounds, world_[order_[slot]]);
+    }
+    return bounds;
+}
+
+}  // namespace graphics
@@ -0,0 +1,98 @@
+#pragma once
+#include "core/camera/frustum.hpp"
+#include "system/occlusion_buffer.hpp"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace graphics {
+
+// indices 引用到的顶点的局部包围盒
+auto computeBounds(std::span<const glm::vec3> vertices, std::span<const std::uint32_t> indices)
+    -> core::AABB;
+
+/// 子网格世界包围盒的动态 BVH，用于视锥剔除。新增 proxy 后重建，只有变换变化时自底向上 refit，
+/// refit 后节点面积之和膨胀到构建时的 REBUILD_RATIO 倍再重建。
+/// cull 自顶向下遍历：完全在视锥外的子树跳过，完全在内的子树整体标记可见，
+/// 只有与视锥边界相交的叶子逐个测试，叶子按 SoA 存放，4 个包围盒一组用 SSE/NEON 测试，叶子之间并行。
+/// 删除的 proxy 不再进入树，编号由之后 add 的 proxy 复用。
+/// 多个视图（主相机、画中画、缩略图等）在同一次遍历中剔除：节点只要还与某个视图相交就继续向下，
+/// 每个 proxy 的可见性是按视图的位掩码，视图 0 是主相机。
+class CullingBvh {
+    public:
+        using proxy_t = std::uint32_t;
+        using view_mask_t = std::uint8_t;
+        static constexpr std::uint32_t LEAF_SIZE = 8;
+        static constexpr std::uint32_t MAX_VIEWS = 8;
+        static constexpr view_mask_t ALL_VIEWS = 0xFF;
+
+        auto add(const core::AABB& local_bounds) -> proxy_t;
+        // 删除后 visible 总是返回 false
+        void remove(proxy_t proxy);
+        // 不同 proxy 可以在并行 update 中同时设置
+        void setTransform(proxy_t proxy, const glm::mat4& world);
+
+        // 只剔除视图 0
+        void cull(const core::Frustum& frustum);
+        // views[i] 是视图 i 的视锥，只处理 mask 中的视图，其余视图都不可见
+        void cull(std::span<const core::Frustum> views, view_mask_t mask = ALL_VIEWS);
+        // 在 cull 之后调用：视图 0 的视锥内的 proxy 再用遮挡缓冲测试一次，遮挡缓冲来自主相机
+        void cullOccluded(const OcclusionBuffer& occlusion);
+        void markAllVisible();
+
+        [[nodiscard]] auto visible(proxy_t proxy, std::uint32_t view = 0) const -> bool {
+            return (visible_[proxy] & (1U << view)) != 0;
+        }
+        [[nodiscard]] auto viewMask(proxy_t proxy) const -> view_mask_t { return visible_[proxy]; }
+        [[nodiscard]] auto worldBounds(proxy_t proxy) const -> const core::AABB& {
+            return world_[proxy];
+        }
+        [[nodiscard]] auto size() const -> std::size_t { return local_.size() - free_.size(); }
+        // 上一次 cull 时包围盒中心到视图近平面的距离，用于绘制排序
+        [[nodiscard]] auto viewDepth(proxy_t proxy, std::uint32_t view = 0) const -> float {
+            const glm::vec3 center = world_[proxy].center();
+            const glm::vec4& plane = near_planes_[view];
+            return glm::dot(glm::vec3(plane), center) + plane.w;
+        }
+
+    private:
+        static constexpr float REBUILD_RATIO = 2.f;
+        static constexpr std::size_t SIMD_WIDTH = 4;
+
+        // count > 0 为叶子，覆盖 order_[first, first + count)；内部节点的左孩子紧跟其后
+        struct Node {
+                core::AABB bounds;
+                std::uint32_t first{0};
+                std::uint32_t count{0};
+                std::uint32_t right{0};
+        };
+
+        void rebuild();
+        auto buildNode(std::uint32_t first, std::uint32_t count) -> std::uint32_t;
+        void refit();
+        void storeSoa(std::uint32_t slot);
+        [[nodiscard]] auto slotBounds(std::uint32_t first, std::uint32_t count) const -> core::AABB;
+        void testLeaf(std::span<const core::Frustum> views, const Node& leaf, view_mask_t mask);
+
+        std::vector<core::AABB> local_;
+        std::vector<core::AABB> world_;
+        std::vector<std::uint8_t> moved_;
+        std::vector<view_mask_t> visible_;
+        std::vector<std::uint8_t> alive_;
+        std::vector<proxy_t> free_;
+        // 叶子顺序，以下 SoA 数组按这个顺序存放，尾部补齐 SIMD_WIDTH - 1 个元素
+        std::vector<proxy_t> order_;
+        std::vector<float> min_x_, min_y_, min_z_;
+        std::vector<float> max_x_, max_y_, max_z_;
+        std::vector<Node> nodes_;
+        // 与视锥边界相交的叶子，以及仍需逐个测试的视图
+        std::vector<std::pair<std::uint32_t, view_mask_t>> partial_leaves_;
+        std::array<glm::vec4, MAX_VIEWS> near_planes_{};
+        float built_area_{0.f};
+        bool structure_dirty_{false};
+};
+
+}  // namespace graphics
@@ -7,6 +7,7 @@
 #include <limits>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "common/parallel.hpp"
 #include "system/pick_system.hpp"
 #include <pmmintrin.h>
 #include <tracy/Tracy.hpp>
@@ -72,21 +73,7 @@ void EmbreePicker::buildMesh(id_t id, id_t mesh, std::span<const glm::vec3> vert
         if (!rebuild) {
             return;
         }
-        rtcReleaseGeometry(geometries_.find(mesh)->second);
-        geometries_.erase(mesh);
-
-        // 释放实例（如果存在）
-        if (instances_.contains(mesh)) {
-            for (auto& [k, v] : embree_to_user) {
-                if (v == mesh) {
-                    rtcDetachGeometry(main_scene_, k);
-                    embree_to_user.erase(k);
-                    break;
-                }
-            }
-            rtcReleaseGeometry(instances_[mesh]);
-            instances_.erase(mesh);
-        }
+        removeMesh(mesh);
     }
 
     // 2. 创建三角形网格几何体
@@ -125,24 +112,59 @@ void EmbreePicker::buildMesh(id_t id, id_t mesh, std::span<const glm::vec3> vert
     // 5. 添加 instance 到主场景
     unsigned int instance_id = rtcAttachGeometry(main_scene_, instance);
     // 6. 将几何体添加到场景
-    rtcAttachGeometry(scene_, geometry_);
+    const unsigned int geometry_id = rtcAttachGeometry(scene_, geometry_);
     instances_[mesh] = instance;
 
     // 6. 映射拾取 ID
     embree_to_user[instance_id] = mesh;
     embree_to_model[instance_id] = id;
+
+    core::AABB bounds{.min = glm::vec3{std::numeric_limits<float>::max()},
+                      .max = glm::vec3{std::numeric_limits<float>::lowest()}};
+    for (const auto& vertex : vertices) {
+        bounds.min = glm::min(bounds.min, vertex);
+        bounds.max = glm::max(bounds.max, vertex);
+    }
+    instance_infos_[mesh] = {.mesh = mesh,
+                             .model = id,
+                             .geometry = geometry_,
+                             .triangle_count = indices.size() / 3,
+                             .local_bounds = bounds,
+                             .grid_item = grid_.insert(bounds, mesh),
+                             .geometry_id = geometry_id,
+                             .instance_id = instance_id};
+}
+
+void EmbreePicker::removeMesh(id_t mesh) {
+    const auto info = instance_infos_.find(mesh);
+    if (info == instance_infos_.end()) {
+        return;
+    }
+    rtcDetachGeometry(main_scene_, info->second.instance_id);
+    rtcDetachGeometry(scene_, info->second.geometry_id);
+    embree_to_user.erase(info->second.instance_id);
+    embree_to_model.erase(info->second.instance_id);
+    rtcReleaseGeometry(instances_[mesh]);
+    instances_.erase(mesh);
+    rtcReleaseGeometry(geometries_[mesh]);
+    geometries_.erase(mesh);
+    grid_.remove(info->second.grid_item);
+    instance_infos_.erase(info);
 }
 
 // 在每帧更新所有移动物体的 transform
-void EmbreePicker::updateTransform(id_t id, const ecs::TransformComponent& transform) {
+void EmbreePicker::updateTransform(id_t id, const glm::mat4& world) {
     if (!geometries_.contains(id)) {
         return;
     }
     auto* geometry = instances_.find(id)->second;
 
     rtcSetGeometryTransform(geometry, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR,
-                            glm::value_ptr(transform.mat4()));
+                            glm::value_ptr(world));
     rtcCommitGeometry(geometry);
+    auto& info = instance_infos_[id];
+    info.world = world;
+    grid_.update(info.grid_item, info.local_bounds.transform(world));
 }
 void EmbreePicker::commit() {
     ZoneScoped;
@@ -189,4 +211,73 @@ auto EmbreePicker::pick(const glm::vec3& rayOrigin, const glm::vec3& rayDirectio
     return std::nullopt;
 }
 
+auto EmbreePicker::pickFrustum(const core::Frustum& frustum, bool precise)
+    -> std::vector<PickResult> {
+    ZoneScoped;
+    // 网格粗筛出世界包围盒与视锥相交的实例
+    std::vector<std::uint32_t> candidates;
+    grid_.queryFrustum(frustum, candidates);
+    std::vector<const InstanceInfo*> infos;
+    infos.reserve(candidates.size());
+    for (const auto mesh : candidates) {
+        infos.push_back(&instance_infos_.at(mesh));
+    }
+
+    // 每个实例只写自己的槽位，结果顺序与 infos 一致，无需加锁
+    std::vector<std::uint8_t> hits(infos.size(), 0);
+    common::parallelFor(infos.size(), 16, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto& info = *infos[i];
+            if (!precise) {
+                hits[i] = 1;
+                continue;
+            }
+            const auto* vertices = static_cast<const glm::vec3*>(
+                rtcGetGeometryBufferData(info.geometry, RTC_BUFFER_TYPE_VERTEX, 0));
+            const auto* indices = static_cast<const uint32_t*>(
+                rtcGetGeometryBufferData(info.geometry, RTC_BUFFER_TYPE_INDEX, 0));
+            // 把平面变换到局部空间，避免逐顶点做矩阵乘法
+            const core::Frustum local{frustum, info.world};
+            for (std::size_t t = 0; t < info.triangle_count; ++t) {
+                if (local.intersectsTriangle(vertices[indices[t * 3]], vertices[indices[(t * 3) + 1]],
+                                             vertices[indices[(t * 3) + 2]])) {
+                    hits[i] = 1;
+                    break;
+                }
+            }
+        }
+    });
+
+    std::vector<PickResult> results;
+    for (std::size_t i = 0; i < infos.size(); ++i) {
+        if (hits[i] != 0) {
+            const auto center = glm::vec3(infos[i]->world * glm::vec4(infos[i]->local_bounds.center(), 1.F));
+            results.push_back(PickResult{.position = center,
+                                         .distance = 0.F,
+                                         .primitiveId = RTC_INVALID_GEOMETRY_ID,
+                                         .id = infos[i]->mesh,
+                                         .model_id = infos[i]->model});
+        }
+    }
+    return results;
+}
+
+auto EmbreePicker::queryRadius(const glm::vec3& center, float radius) -> std::vector<PickResult> {
+    ZoneScoped;
+    std::vector<std::uint32_t> meshes;
+    grid_.queryRadius(center, radius, meshes);
+    std::vector<PickResult> results;
+    results.reserve(meshes.size());
+    for (const auto mesh : meshes) {
+        const auto& info = instance_infos_.at(mesh);
+        const glm::vec3 position = grid_.bounds(info.grid_item).center();
+        results.push_back(PickResult{.position = position,
+                                     .distance = glm::distance(position, center),
+                                     .primitiveId = RTC_INVALID_GEOMETRY_ID,
+                                     .id = info.mesh,
+                                     .model_id = info.model});
+    }
+    return results;
+}
+
 }  // namespace graphics
@@ -5,6 +5,9 @@
 #include <optional>
 #include <span>
 #include <unordered_map>
+#include <vector>
+#include "core/camera/frustum.hpp"
+#include "system/spatial_grid.hpp"
 #include "resource/id.hpp"
 #include "ecs/components/transform_component.hpp"
 namespace graphics {
@@ -12,6 +15,19 @@ namespace graphics {
 struct PickResult;
 
 class EmbreePicker {
+        // 框选用的每个网格实例的数据
+        struct InstanceInfo {
+                id_t mesh;
+                id_t model;
+                RTCGeometry geometry;
+                std::size_t triangle_count;
+                core::AABB local_bounds;
+                glm::mat4 world{1.F};
+                SpatialGrid::item_t grid_item{SpatialGrid::INVALID_ITEM};
+                unsigned int geometry_id{RTC_INVALID_GEOMETRY_ID};  // 在 scene_ 中的编号
+                unsigned int instance_id{RTC_INVALID_GEOMETRY_ID};  // 在 main_scene_ 中的编号
+        };
+
     private:
         RTCDevice device_;
         RTCScene scene_;
@@ -20,6 +36,8 @@ class EmbreePicker {
         std::unordered_map<unsigned int, id_t> embree_to_user;   // Embree 回调用
         std::unordered_map<unsigned int, id_t> embree_to_model;  // Embree 回调用
         std::unordered_map<id_t, RTCGeometry> instances_;        // id → instance geom
+        std::unordered_map<id_t, InstanceInfo> instance_infos_;  // mesh → 包围盒与世界矩阵
+        SpatialGrid grid_;  // 实例的世界包围盒，框选和范围查询的粗筛
 
     public:
         EmbreePicker();
@@ -37,10 +55,17 @@ class EmbreePicker {
         // 构建三角形网格
         void buildMesh(id_t id, id_t mesh, std::span<const glm::vec3> vertices,
                        std::span<const uint32_t> indices, bool rebuild = false);
-        void updateTransform(id_t id, const ecs::TransformComponent& transform);
+        void updateTransform(id_t id, const glm::mat4& world);
+        // 从两个场景中移除并释放网格，之后需要 commit
+        void removeMesh(id_t mesh);
 
         auto pick(const glm::vec3& rayOrigin, const glm::vec3& rayDirection)
             -> std::optional<PickResult>;
+
+        // 返回与视锥相交的所有网格；precise 为 true 时在包围盒粗筛后逐三角形测试
+        auto pickFrustum(const core::Frustum& frustum, bool precise) -> std::vector<PickResult>;
+        // 世界包围盒与球相交的所有网格，position 是包围盒中心
+        auto queryRadius(const glm::vec3& center, float radius) -> std::vector<PickResult>;
 };
 
 }  // namespace graphics
@@ -0,0 +1,356 @@
+#include "system/occlusion_buffer.hpp"
+#include "common/parallel.hpp"
+#include "common/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <tracy/Tracy.hpp>
+
+namespace graphics {
+namespace {
+constexpr std::size_t OCCLUDER_GRAIN = 8;
+constexpr std::size_t TRIANGLE_GRAIN = 256;
+// 包围盒深度稍微往近处偏，避免遮挡体自身表面的舍入误差把自己剔除
+constexpr float DEPTH_BIAS = 1e-5f;
+
+auto toScreen(const glm::vec4& clip) -> glm::vec3 {
+    const float inv_w = 1.f / clip.w;
+    return {((clip.x * inv_w * 0.5f) + 0.5f) * static_cast<float>(OcclusionBuffer::WIDTH),
+            ((clip.y * inv_w * 0.5f) + 0.5f) * static_cast<float>(OcclusionBuffer::HEIGHT),
+            clip.z * inv_w};
+}
+
+auto outsideSameSide(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2) -> bool {
+    for (int axis = 0; axis < 2; ++axis) {
+        if ((v0[axis] > v0.w && v1[axis] > v1.w && v2[axis] > v2.w) ||
+            (v0[axis] < -v0.w && v1[axis] < -v1.w && v2[axis] < -v2.w)) {
+            return true;
+        }
+    }
+    return v0.z > v0.w && v1.z > v1.w && v2.z > v2.w;
+}
+
+// 一行中从 x 开始的 4 个像素：在三角形内的像素取较近的深度
+void rasterizeQuad(float* row, std::int32_t x, float py, const std::array<float, 3>& a,
+                   const std::array<float, 3>& row_edge, const glm::vec3& depth) {
+    const float px = static_cast<float>(x) + 0.5f;
+    const float row_depth = (depth.y * py) + depth.z;
+#if defined(GRAPHICS_SIMD_SSE)
+    const __m128 xs = _mm_add_ps(_mm_set1_ps(px), _mm_setr_ps(0.f, 1.f, 2.f, 3.f));
+    const __m128 zero = _mm_setzero_ps();
+    __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), xs),
+                                            _mm_set1_ps(row_edge[0])),
+                                 zero);
+    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[1]), xs),
+                                                        _mm_set1_ps(row_edge[1])),
+                                             zero));
+    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), xs),
+                                                        _mm_set1_ps(row_edge[2])),
+                                             zero));
+    const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depth.x), xs), _mm_set1_ps(row_depth));
+    const __m128 old = _mm_loadu_ps(row + x);
+    const __m128 nearer = _mm_min_ps(old, z);
+    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+#elif defined(GRAPHICS_SIMD_NEON)
+    const float32x4_t lane_offset{0.f, 1.f, 2.f, 3.f};
+    const float32x4_t xs = vaddq_f32(vdupq_n_f32(px), lane_offset);
+    const float32x4_t zero = vdupq_n_f32(0.f);
+    uint32x4_t inside = vcgeq_f32(vaddq_f32(vmulq_n_f32(xs, a[0]), vdupq_n_f32(row_edge[0])), zero);
+    inside = vandq_u32(
+        inside, vcgeq_f32(vaddq_f32(vmulq_n_f32(xs, a[1]), vdupq_n_f32(row_edge[1])), zero));
+    inside = vandq_u32(
+        inside, vcgeq_f32(vaddq_f32(vmulq_n_f32(xs, a[2]), vdupq_n_f32(row_edge[2])), zero));
+    const float32x4_t z = vaddq_f32(vmulq_n_f32(xs, depth.x), vdupq_n_f32(row_depth));
+    const float32x4_t old = vld1q_f32(row + x);
+    vst1q_f32(row + x, vbslq_f32(inside, vminq_f32(old, z), old));
+#else
+    for (std::int32_t lane = 0; lane < 4; ++lane) {
+        const float lane_x = px + static_cast<float>(lane);
+        if ((a[0] * lane_x) + row_edge[0] >= 0.f && (a[1] * lane_x) + row_edge[1] >= 0.f &&
+            (a[2] * lane_x) + row_edge[2] >= 0.f) {
+            float& pixel = row[x + lane];
+            pixel = std::min(pixel, (depth.x * lane_x) + row_depth);
+        }
+    }
+#endif
+}
+}  // namespace
+
+OcclusionBuffer::OcclusionBuffer()
+    : depth_(static_cast<std::size_t>(WIDTH) * HEIGHT, 1.f),
+      tile_max_(static_cast<std::size_t>(TILES_X) * TILES_Y, 1.f) {}
+
+auto OcclusionBuffer::addOccluder(std::span<const glm::vec3> vertices,
+                                  std::span<const std::uint32_t> indices) -> occluder_t {
+    if (indices.size() < 3 || indices.size() / 3 > MAX_OCCLUDER_TRIANGLES) {
+        return INVALID_OCCLUDER;
+    }
+    const std::size_t triangle_indices = indices.size() - (indices.size() % 3);
+    if (std::ranges::any_of(indices.first(triangle_indices),
+                            [&](std::uint32_t index) { return index >= vertices.size(); })) {
+        return INVALID_OCCLUDER;
+    }
+    Occluder occluder{.first_vertex = static_cast<std::uint32_t>(vertices_.size())};
+    // 子网格通常共享整个模型的顶点数组，只复制用到的顶点
+    std::unordered_map<std::uint32_t, std::uint32_t> remap;
+    for (std::size_t i = 0; i < triangle_indices; ++i) {
+        const std::uint32_t index = indices[i];
+        const auto [it, inserted] = remap.try_emplace(index, occluder.vertex_count);
+        if (inserted) {
+            vertices_.push_back(vertices[index]);
+            ++occluder.vertex_count;
+        }
+        indices_.push_back(it->second);
+    }
+    occluder.triangle_count = static_cast<std::uint32_t>(triangle_indices / 3);
+    occluder_t id = INVALID_OCCLUDER;
+    if (!free_.empty()) {
+        id = free_.back();
+        free_.pop_back();
+        occluders_[id] = occluder;
+    } else {
+        id = static_cast<occluder_t>(occluders_.size());
+        occluders_.push_back(occluder);
+    }
+    triangle_occluder_.insert(triangle_occluder_.end(), triangle_indices / 3, id);
+    clip_.resize(vertices_.size());
+    triangles_.resize(triangle_occluder_.size());
+    return id;
+}
+
+void OcclusionBuffer::removeOccluder(occluder_t occluder) {
+    auto& entry = occluders_[occluder];
+    entry.alive = false;
+    dead_triangles_ += entry.triangle_count;
+    released_.push_back(occluder);
+}
+
+void OcclusionBuffer::setTransform(occluder_t occluder, const glm::mat4& world) {
+    occluders_[occluder].world = world;
+}
+
+void OcclusionBuffer::compact() {
+    ZoneScoped;
+    std::vector<glm::vec3> vertices;
+    vertices.reserve(vertices_.size());
+    for (auto& occluder : occluders_) {
+        if (!occluder.alive) {
+            occluder.vertex_count = 0;
+            occluder.triangle_count = 0;
+            continue;
+        }
+        const auto first = vertices_.begin() + occluder.first_vertex;
+        occluder.first_vertex = static_cast<std::uint32_t>(vertices.size());
+        vertices.insert(vertices.end(), first, first + occluder.vertex_count);
+    }
+    // 三角形的下标相对所属遮挡体，搬动顶点后不需要修改
+    std::vector<std::uint32_t> indices;
+    std::vector<occluder_t> triangle_occluder;
+    indices.reserve(indices_.size());
+    triangle_occluder.reserve(triangle_occluder_.size());
+    for (std::size_t triangle = 0; triangle < triangle_occluder_.size(); ++triangle) {
+        if (occluders_[triangle_occluder_[triangle]].alive) {
+            const auto first = indices_.begin() + static_cast<std::ptrdiff_t>(triangle * 3);
+            indices.insert(indices.end(), first, first + 3);
+            triangle_occluder.push_back(triangle_occluder_[triangle]);
+        }
+    }
+    vertices_ = std::move(vertices);
+    indices_ = std::move(indices);
+    triangle_occluder_ = std::move(triangle_occluder);
+    clip_.resize(vertices_.size());
+    triangles_.resize(triangle_occluder_.size());
+    free_.insert(free_.end(), released_.begin(), released_.end());
+    released_.clear();
+    dead_triangles_ = 0;
+}
+
+void OcclusionBuffer::render(const glm::mat4& view_proj) {
+    ZoneScoped;
+    if (dead_triangles_ * 2 > triangle_occluder_.size()) {
+        compact();
+    }
+    view_proj_ = view_proj;
+    common::parallelFor(occluders_.size(), OCCLUDER_GRAIN,
+                        [this, &view_proj](std::size_t begin, std::size_t end) {
+                            for (std::size_t i = begin; i < end; ++i) {
+                                const auto& occluder = occluders_[i];
+                                if (!occluder.alive) {
+                                    continue;
+                                }
+                                const glm::mat4 mvp = view_proj * occluder.world;
+                                for (std::uint32_t v = occluder.first_vertex;
+                                     v < occluder.first_vertex + occluder.vertex_count; ++v) {
+                                    clip_[v] = mvp * glm::vec4(vertices_[v], 1.f);
+                                }
+                            }
+                        });
+    common::parallelFor(triangles_.size(), TRIANGLE_GRAIN,
+                        [this](std::size_t begin, std::size_t end) {
+                            for (std::size_t i = begin; i < end; ++i) {
+                                setupTriangle(i);
+                            }
+                        });
+    constexpr std::uint32_t bands = (HEIGHT + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    common::parallelFor(bands, 1, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t band = begin; band < end; ++band) {
+            rasterizeBand(static_cast<std::uint32_t>(band));
+        }
+    });
+}
+
+void OcclusionBuffer::setupTriangle(std::size_t triangle) {
+    auto& result = triangles_[triangle];
+    result.max_x = -1;  // 默认不覆盖任何像素
+    const auto& occluder = occluders_[triangle_occluder_[triangle]];
+    if (!occluder.alive) {
+        return;
+    }
+    const std::size_t base = (triangle * 3);
+    // triangles_ 与 indices_ 按相同顺序排列：第 i 个三角形对应 indices_[3i, 3i + 3)
+    const glm::vec4& c0 = clip_[occluder.first_vertex + indices_[base]];
+    const glm::vec4& c1 = clip_[occluder.first_vertex + indices_[base + 1]];
+    const glm::vec4& c2 = clip_[occluder.first_vertex + indices_[base + 2]];
+    if (c0.z < 0.f || c1.z < 0.f || c2.z < 0.f || outsideSameSide(c0, c1, c2)) {
+        return;
+    }
+    glm::vec3 p0 = toScreen(c0);
+    glm::vec3 p1 = toScreen(c1);
+    glm::vec3 p2 = toScreen(c2);
+    float area = ((p1.x - p0.x) * (p2.y - p0.y)) - ((p2.x - p0.x) * (p1.y - p0.y));
+    if (!(std::abs(area) > 1e-6f)) {
+        return;
+    }
+    // 遮挡只关心覆盖范围，背面同样写入，统一成逆时针
+    if (area < 0.f) {
+        std::swap(p1, p2);
+        area = -area;
+    }
+    const std::array<glm::vec3, 3> p{p0, p1, p2};
+    for (int edge = 0; edge < 3; ++edge) {
+        const glm::vec3& from = p[edge];
+        const glm::vec3& to = p[(edge + 1) % 3];
+        result.a[edge] = from.y - to.y;
+        result.b[edge] = to.x - from.x;
+        result.c[edge] = (from.x * to.y) - (from.y * to.x);
+    }
+    // 深度对屏幕坐标是线性的：用重心坐标求平面系数
+    const float inv_area = 1.f / area;
+    const glm::vec3 lambda_a{result.a[1], result.a[2], result.a[0]};
+    const glm::vec3 lambda_b{result.b[1], result.b[2], result.b[0]};
+    const glm::vec3 lambda_c{result.c[1], result.c[2], result.c[0]};
+    const glm::vec3 z{p0.z, p1.z, p2.z};
+    result.depth = glm::vec3{glm::dot(lambda_a, z), glm::dot(lambda_b, z), glm::dot(lambda_c, z)} *
+                   inv_area;
+
+    const float min_x = std::min({p0.x, p1.x, p2.x});
+    const float max_x = std::max({p0.x, p1.x, p2.x});
+    const float min_y = std::min({p0.y, p1.y, p2.y});
+    const float max_y = std::max({p0.y, p1.y, p2.y});
+    result.min_x = std::max(static_cast<std::int32_t>(std::floor(min_x)), 0);
+    result.max_x = std::min(static_cast<std::int32_t>(std::ceil(max_x)),
+                            static_cast<std::int32_t>(WIDTH) - 1);
+    result.min_y = std::max(static_cast<std::int32_t>(std::floor(min_y)), 0);
+    result.max_y = std::min(static_cast<std::int32_t>(std::ceil(max_y)),
+                            static_cast<std::int32_t>(HEIGHT) - 1);
+}
+
+void OcclusionBuffer::rasterizeBand(std::uint32_t band) {
+    const auto band_begin = static_cast<std::int32_t>(band * BAND_HEIGHT);
+    const auto band_end = std::min(band_begin + static_cast<std::int32_t>(BAND_HEIGHT),
+                                   static_cast<std::int32_t>(HEIGHT));
+    std::fill(depth_.begin() + (static_cast<std::ptrdiff_t>(band_begin) * WIDTH),
+              depth_.begin() + (static_cast<std::ptrdiff_t>(band_end) * WIDTH), 1.f);
+
+    for (const auto& triangle : triangles_) {
+        if (triangle.max_x < triangle.min_x || triangle.max_y < band_begin ||
+            triangle.min_y >= band_end) {
+            continue;
+        }
+        const std::int32_t y_begin = std::max(triangle.min_y, band_begin);
+        const std::int32_t y_end = std::min(triangle.max_y + 1, band_end);
+        // WIDTH 是 4 的倍数，按 4 对齐后最后一组也不会越界
+        const std::int32_t x_begin = triangle.min_x & ~3;
+        for (std::int32_t y = y_begin; y < y_end; ++y) {
+            const float py = static_cast<float>(y) + 0.5f;
+            const std::array<float, 3> row_edge{(triangle.b[0] * py) + triangle.c[0],
+                                                (triangle.b[1] * py) + triangle.c[1],
+                                                (triangle.b[2] * py) + triangle.c[2]};
+            float* row = depth_.data() + (static_cast<std::ptrdiff_t>(y) * WIDTH);
+            for (std::int32_t x = x_begin; x <= triangle.max_x; x += 4) {
+                rasterizeQuad(row, x, py, triangle.a, row_edge, triangle.depth);
+            }
+        }
+    }
+
+    // 条带高度是 tile 的整数倍，tile 不会跨条带
+    for (auto tile_y = static_cast<std::uint32_t>(band_begin) / TILE_SIZE;
+         tile_y * TILE_SIZE < static_cast<std::uint32_t>(band_end); ++tile_y) {
+        const std::uint32_t y_end = std::min((tile_y + 1) * TILE_SIZE, HEIGHT);
+        for (std::uint32_t tile_x = 0; tile_x < TILES_X; ++tile_x) {
+            float farthest = 0.f;
+            for (std::uint32_t y = tile_y * TILE_SIZE; y < y_end; ++y) {
+                const float* row = depth_.data() + (static_cast<std::size_t>(y) * WIDTH);
+                for (std::uint32_t x = tile_x * TILE_SIZE; x < (tile_x + 1) * TILE_SIZE; ++x) {
+                    farthest = std::max(farthest, row[x]);
+                }
+            }
+            tile_max_[(tile_y * TILES_X) + tile_x] = farthest;
+        }
+    }
+}
+
+auto OcclusionBuffer::occluded(const core::AABB& world_bounds) const -> bool {
+    glm::vec2 screen_min{std::numeric_limits<float>::max()};
+    glm::vec2 screen_max{std::numeric_limits<float>::lowest()};
+    float nearest = 1.f;
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::vec3 point{(corner & 1) != 0 ? world_bounds.max.x : world_bounds.min.x,
+                              (corner & 2) != 0 ? world_bounds.max.y : world_bounds.min.y,
+                              (corner & 4) != 0 ? world_bounds.max.z : world_bounds.min.z};
+        const glm::vec4 clip = view_proj_ * glm::vec4(point, 1.f);
+        if (clip.z < 0.f || clip.w <= 0.f) {
+            return false;
+        }
+        const glm::vec3 screen = toScreen(clip);
+        screen_min = glm::min(screen_min, glm::vec2(screen));
+        screen_max = glm::max(screen_max, glm::vec2(screen));
+        nearest = std::min(nearest, screen.z);
+    }
+    nearest -= DEPTH_BIAS;
+
+    const auto x0 = std::max(static_cast<std::int32_t>(std::floor(screen_min.x)), 0);
+    const auto x1 = std::min(static_cast<std::int32_t>(std::floor(screen_max.x)),
+                             static_cast<std::int32_t>(WIDTH) - 1);
+    const auto y0 = std::max(static_cast<std::int32_t>(std::floor(screen_min.y)), 0);
+    const auto y1 = std::min(static_cast<std::int32_t>(std::floor(screen_max.y)),
+                             static_cast<std::int32_t>(HEIGHT) - 1);
+    if (x1 < x0 || y1 < y0) {
+        return false;  // 不在屏幕上的交给视锥剔除
+    }
+
+    constexpr auto tile = static_cast<std::int32_t>(TILE_SIZE);
+    for (std::int32_t tile_y = y0 / tile; tile_y <= y1 / tile; ++tile_y) {
+        for (std::int32_t tile_x = x0 / tile; tile_x <= x1 / tile; ++tile_x) {
+            if (tile_max_[(static_cast<std::size_t>(tile_y) * TILES_X) + tile_x] < nearest) {
+                continue;  // 整个 tile 都被更近的遮挡体覆盖
+            }
+            const std::int32_t ty0 = std::max(y0, tile_y * tile);
+            const std::int32_t ty1 = std::min(y1, ((tile_y + 1) * tile) - 1);
+            const std::int32_t tx0 = std::max(x0, tile_x * tile);
+            const std::int32_t tx1 = std::min(x1, ((tile_x + 1) * tile) - 1);
+            for (std::int32_t y = ty0; y <= ty1; ++y) {
+                const float* row = depth_.data() + (static_cast<std::ptrdiff_t>(y) * WIDTH);
+                for (std::int32_t x = tx0; x <= tx1; ++x) {
+                    if (row[x] >= nearest) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace graphics
@@ -0,0 +1,88 @@
+#pragma once
+#include "core/camera/frustum.hpp"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace graphics {
+
+/// CPU 软件光栅化的低分辨率深度缓冲，用于遮挡剔除。每帧把遮挡体三角形按 NDC 深度（0 近 1 远）
+/// 光栅化，图像按行分成若干条带在线程池上并行，条带内一次处理 4 个像素（SSE/NEON）。
+/// 之后用包围盒最近的深度和盒子覆盖的像素比较：所有像素上都有更近的遮挡体时判定为被遮挡。
+/// 跨过近平面的三角形直接丢弃，跨过近平面的包围盒总是可见，结果偏保守。
+/// 删除的遮挡体先只做标记，失效的三角形超过一半时在 render 中压缩顶点和三角形数组，
+/// 压缩之后编号才会被新的遮挡体复用。
+class OcclusionBuffer {
+    public:
+        static constexpr std::uint32_t WIDTH = 320;
+        static constexpr std::uint32_t HEIGHT = 180;
+        static constexpr std::uint32_t TILE_SIZE = 8;
+        static constexpr std::uint32_t BAND_HEIGHT = 16;  // TILE_SIZE 的整数倍
+        // 超过这个三角形数的网格不适合作为遮挡体
+        static constexpr std::size_t MAX_OCCLUDER_TRIANGLES = 4096;
+
+        using occluder_t = std::uint32_t;
+        static constexpr occluder_t INVALID_OCCLUDER = std::numeric_limits<occluder_t>::max();
+
+        OcclusionBuffer();
+
+        // 复制 indices 引用的顶点作为遮挡体，三角形过多时返回 INVALID_OCCLUDER
+        auto addOccluder(std::span<const glm::vec3> vertices,
+                         std::span<const std::uint32_t> indices) -> occluder_t;
+        void removeOccluder(occluder_t occluder);
+        // 不同遮挡体可以在并行 update 中同时设置
+        void setTransform(occluder_t occluder, const glm::mat4& world);
+
+        void render(const glm::mat4& view_proj);
+        [[nodiscard]] auto occluded(const core::AABB& world_bounds) const -> bool;
+
+        [[nodiscard]] auto size() const -> std::size_t {
+            return occluders_.size() - free_.size() - released_.size();
+        }
+        [[nodiscard]] auto depth(std::uint32_t x, std::uint32_t y) const -> float {
+            return depth_[(y * WIDTH) + x];
+        }
+
+    private:
+        static constexpr std::uint32_t TILES_X = WIDTH / TILE_SIZE;
+        static constexpr std::uint32_t TILES_Y = (HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+
+        struct Occluder {
+                std::uint32_t first_vertex{0};
+                std::uint32_t vertex_count{0};
+                std::uint32_t triangle_count{0};
+                bool alive{true};
+                glm::mat4 world{1.f};
+        };
+
+        // 屏幕空间的边函数 e = a * x + b * y + c（内侧 >= 0）和深度平面
+        struct ScreenTriangle {
+                std::array<float, 3> a{};
+                std::array<float, 3> b{};
+                std::array<float, 3> c{};
+                glm::vec3 depth{};  // z = depth.x * x + depth.y * y + depth.z
+                std::int32_t min_x{0}, max_x{-1}, min_y{0}, max_y{-1};
+        };
+
+        void compact();
+        void setupTriangle(std::size_t triangle);
+        void rasterizeBand(std::uint32_t band);
+
+        std::vector<glm::vec3> vertices_;
+        std::vector<std::uint32_t> indices_;  // 相对所属遮挡体的 first_vertex
+        std::vector<Occluder> occluders_;
+        std::vector<glm::vec4> clip_;  // 与 vertices_ 一一对应
+        std::vector<std::uint32_t> triangle_occluder_;
+        std::vector<ScreenTriangle> triangles_;
+        glm::mat4 view_proj_{1.f};
+        std::vector<float> depth_;
+        std::vector<float> tile_max_;  // 每个 tile 内最远的深度
+        std::vector<occluder_t> free_;      // 可以复用的编号
+        std::vector<occluder_t> released_;  // 已删除、三角形还没有压缩掉的编号
+        std::size_t dead_triangles_{0};
+};
+
+}  // namespace graphics
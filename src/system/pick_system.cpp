@@ -1,6 +1,7 @@
 // picking_system.cpp
 #include "pick_system.hpp"
 #include <glm/gtx/norm.hpp>
+#include "core/camera/frustum.hpp"
 #include "system/embree_picker.hpp"
 #include <tracy/Tracy.hpp>
 
@@ -17,11 +18,13 @@ void PickingSystem::upload_vertex(id_t id, id_t mesh, std::span<const glm::vec3>
     picker->buildMesh(id, mesh, localVertices, indices);
 }
 
-void PickingSystem::update_transform(id_t id, const ecs::TransformComponent& transform) {
+void PickingSystem::update_transform(id_t id, const glm::mat4& world) {
     auto* picker = get_embree_picker();
-    picker->updateTransform(id, transform);
+    picker->updateTransform(id, world);
 }
 
+void PickingSystem::remove_mesh(id_t mesh) { get_embree_picker()->removeMesh(mesh); }
+
 void PickingSystem::commit() {
     ZoneScoped;
     auto* picker = get_embree_picker();
@@ -64,4 +67,22 @@ auto PickingSystem::pick(const core::Camera& camera, float mouseX, float mouseY,
     return picker->pick(rayOrigin, rayDirection);
 }
 
-}  // namespace graphics
\ No newline at end of file
+auto PickingSystem::pickRect(const core::Camera& camera, glm::vec2 corner0, glm::vec2 corner1,
+                             float windowWidth, float windowHeight, bool precise)
+    -> std::vector<PickResult> {
+    ZoneScoped;
+    const glm::vec2 window{windowWidth, windowHeight};
+    const glm::vec2 ndc0 = (2.0f * glm::min(corner0, corner1)) / window - 1.0f;
+    const glm::vec2 ndc1 = (2.0f * glm::max(corner0, corner1)) / window - 1.0f;
+
+    const glm::mat4 viewProj = camera.getProjection() * camera.getView();
+    const auto frustum = core::Frustum::fromNdcRect(viewProj, ndc0, ndc1);
+    return get_embree_picker()->pickFrustum(frustum, precise);
+}
+
+auto PickingSystem::queryRadius(const glm::vec3& center, float radius)
+    -> std::vector<PickResult> {
+    return get_embree_picker()->queryRadius(center, radius);
+}
+
+}  // namespace graphics
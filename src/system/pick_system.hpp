@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <optional>
 #include <span>
+#include <vector>
 #include "resource/id.hpp"
 
 namespace graphics {
@@ -21,12 +22,22 @@ class PickingSystem {
     public:
         static void upload_vertex(id_t id, id_t mesh, std::span<const glm::vec3> localVertices,
                                   std::span<const uint32_t> indices);
-        static void update_transform(id_t id, const ecs::TransformComponent& transform);
+        static void update_transform(id_t id, const glm::mat4& world);
+        // 模型删除时移除它的网格，之后需要 commit
+        static void remove_mesh(id_t mesh);
 
         static void commit();
 
         static auto pick(const core::Camera& camera, float mouseX, float mouseY, float windowWidth,
                          float windowHeight) -> std::optional<PickResult>;
+
+        // 框选：返回屏幕矩形 (x0, y0)-(x1, y1) 对应子视锥内的所有网格
+        static auto pickRect(const core::Camera& camera, glm::vec2 corner0, glm::vec2 corner1,
+                             float windowWidth, float windowHeight, bool precise = true)
+            -> std::vector<PickResult>;
+
+        // 世界包围盒与球相交的所有网格（只做包围盒测试）
+        static auto queryRadius(const glm::vec3& center, float radius) -> std::vector<PickResult>;
 };
 
 }  // namespace graphics
\ No newline at end of file
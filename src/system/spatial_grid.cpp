@@ -0,0 +1,240 @@
+#include "system/spatial_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <tracy/Tracy.hpp>
+
+namespace graphics {
+namespace {
+// 每个轴 21 位，坐标偏移后打包成 64 位键
+constexpr std::int32_t CELL_BITS = 21;
+constexpr std::int32_t CELL_LIMIT = (1 << (CELL_BITS - 1)) - 1;
+constexpr std::uint64_t CELL_MASK = (std::uint64_t{1} << CELL_BITS) - 1;
+
+auto overlaps(const core::AABB& a, const core::AABB& b) -> bool {
+    return glm::all(glm::lessThanEqual(a.min, b.max)) &&
+           glm::all(glm::lessThanEqual(b.min, a.max));
+}
+
+auto sphereOverlaps(const core::AABB& box, const glm::vec3& center, float radius) -> bool {
+    const glm::vec3 closest = glm::clamp(center, box.min, box.max);
+    const glm::vec3 delta = closest - center;
+    return glm::dot(delta, delta) <= radius * radius;
+}
+
+auto toCell(float value) -> std::int32_t {
+    return static_cast<std::int32_t>(
+        std::clamp(std::floor(value), static_cast<float>(-CELL_LIMIT),
+                   static_cast<float>(CELL_LIMIT)));
+}
+}  // namespace
+
+auto SpatialGrid::CellRange::count() const -> std::uint64_t {
+    std::uint64_t result = 1;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (max[axis] < min[axis]) {
+            return 0;
+        }
+        result *= static_cast<std::uint64_t>(max[axis] - min[axis]) + 1;
+    }
+    return result;
+}
+
+SpatialGrid::SpatialGrid(float cell_size)
+    : cell_size_(cell_size), inv_cell_size_(1.f / cell_size) {}
+
+auto SpatialGrid::cellRange(const core::AABB& bounds) const -> CellRange {
+    const glm::vec3 min = bounds.min * inv_cell_size_;
+    const glm::vec3 max = bounds.max * inv_cell_size_;
+    return {.min = {toCell(min.x), toCell(min.y), toCell(min.z)},
+            .max = {toCell(max.x), toCell(max.y), toCell(max.z)}};
+}
+
+auto SpatialGrid::cellBounds(const glm::ivec3& cell) const -> core::AABB {
+    const glm::vec3 min = glm::vec3(cell) * cell_size_;
+    return {.min = min, .max = min + glm::vec3(cell_size_)};
+}
+
+auto SpatialGrid::cellKey(const glm::ivec3& cell) -> std::uint64_t {
+    const auto pack = [](std::int32_t value) {
+        return static_cast<std::uint64_t>(value + CELL_LIMIT) & CELL_MASK;
+    };
+    return pack(cell.x) | (pack(cell.y) << CELL_BITS) | (pack(cell.z) << (2 * CELL_BITS));
+}
+
+auto SpatialGrid::cellOf(std::uint64_t key) -> glm::ivec3 {
+    const auto unpack = [key](std::int32_t shift) {
+        return static_cast<std::int32_t>((key >> shift) & CELL_MASK) - CELL_LIMIT;
+    };
+    return {unpack(0), unpack(CELL_BITS), unpack(2 * CELL_BITS)};
+}
+
+auto SpatialGrid::insert(const core::AABB& bounds, std::uint32_t value) -> item_t {
+    item_t item = INVALID_ITEM;
+    if (!free_.empty()) {
+        item = free_.back();
+        free_.pop_back();
+    } else {
+        item = static_cast<item_t>(items_.size());
+        items_.emplace_back();
+    }
+    items_[item] = {.bounds = bounds, .cells = {}, .value = value};
+    link(item);
+    return item;
+}
+
+void SpatialGrid::update(item_t item, const core::AABB& bounds) {
+    auto& entry = items_[item];
+    const CellRange range = cellRange(bounds);
+    entry.bounds = bounds;
+    if (range == entry.cells) {
+        return;
+    }
+    unlink(item);
+    link(item);
+}
+
+void SpatialGrid::remove(item_t item) {
+    unlink(item);
+    items_[item] = {};
+    free_.push_back(item);
+}
+
+void SpatialGrid::clear() {
+    items_.clear();
+    free_.clear();
+    cells_.clear();
+    oversized_.clear();
+}
+
+void SpatialGrid::link(item_t item) {
+    auto& entry = items_[item];
+    entry.cells = cellRange(entry.bounds);
+    entry.oversized = entry.cells.count() > MAX_ITEM_CELLS;
+    if (entry.oversized) {
+        oversized_.push_back(item);
+        return;
+    }
+    for (std::int32_t z = entry.cells.min.z; z <= entry.cells.max.z; ++z) {
+        for (std::int32_t y = entry.cells.min.y; y <= entry.cells.max.y; ++y) {
+            for (std::int32_t x = entry.cells.min.x; x <= entry.cells.max.x; ++x) {
+                cells_[cellKey({x, y, z})].push_back(item);
+            }
+        }
+    }
+}
+
+void SpatialGrid::unlink(item_t item) {
+    const auto swapRemove = [item](std::vector<item_t>& list) {
+        const auto it = std::ranges::find(list, item);
+        if (it != list.end()) {
+            *it = list.back();
+            list.pop_back();
+        }
+    };
+    const auto& entry = items_[item];
+    if (entry.oversized) {
+        swapRemove(oversized_);
+        return;
+    }
+    for (std::int32_t z = entry.cells.min.z; z <= entry.cells.max.z; ++z) {
+        for (std::int32_t y = entry.cells.min.y; y <= entry.cells.max.y; ++y) {
+            for (std::int32_t x = entry.cells.min.x; x <= entry.cells.max.x; ++x) {
+                const auto cell = cells_.find(cellKey({x, y, z}));
+                if (cell == cells_.end()) {
+                    continue;
+                }
+                swapRemove(cell->second);
+                // 空格子不保留，已占用格子数决定查询走哪条路径
+                if (cell->second.empty()) {
+                    cells_.erase(cell);
+                }
+            }
+        }
+    }
+}
+
+template <typename Func>
+void SpatialGrid::forEachInRange(const CellRange& range, Func&& func) const {
+    const auto visit = [&](const glm::ivec3& cell, const std::vector<item_t>& items) {
+        for (const item_t item : items) {
+            // 跨多个格子的物体只在它与查询范围重叠部分的最小角格子上报告一次
+            if (glm::max(items_[item].cells.min, range.min) == cell) {
+                func(item);
+            }
+        }
+    };
+    if (range.count() <= cells_.size()) {
+        for (std::int32_t z = range.min.z; z <= range.max.z; ++z) {
+            for (std::int32_t y = range.min.y; y <= range.max.y; ++y) {
+                for (std::int32_t x = range.min.x; x <= range.max.x; ++x) {
+                    const auto cell = cells_.find(cellKey({x, y, z}));
+                    if (cell != cells_.end()) {
+                        visit({x, y, z}, cell->second);
+                    }
+                }
+            }
+        }
+        return;
+    }
+    for (const auto& [key, items] : cells_) {
+        const glm::ivec3 cell = cellOf(key);
+        if (glm::all(glm::greaterThanEqual(cell, range.min)) &&
+            glm::all(glm::lessThanEqual(cell, range.max))) {
+            visit(cell, items);
+        }
+    }
+}
+
+void SpatialGrid::queryAabb(const core::AABB& bounds, std::vector<std::uint32_t>& out) const {
+    ZoneScoped;
+    forEachInRange(cellRange(bounds), [&](item_t item) {
+        if (overlaps(items_[item].bounds, bounds)) {
+            out.push_back(items_[item].value);
+        }
+    });
+    for (const item_t item : oversized_) {
+        if (overlaps(items_[item].bounds, bounds)) {
+            out.push_back(items_[item].value);
+        }
+    }
+}
+
+void SpatialGrid::queryRadius(const glm::vec3& center, float radius,
+                              std::vector<std::uint32_t>& out) const {
+    ZoneScoped;
+    const core::AABB bounds{.min = center - glm::vec3(radius), .max = center + glm::vec3(radius)};
+    forEachInRange(cellRange(bounds), [&](item_t item) {
+        if (sphereOverlaps(items_[item].bounds, center, radius)) {
+            out.push_back(items_[item].value);
+        }
+    });
+    for (const item_t item : oversized_) {
+        if (sphereOverlaps(items_[item].bounds, center, radius)) {
+            out.push_back(items_[item].value);
+        }
+    }
+}
+
+void SpatialGrid::queryFrustum(const core::Frustum& frustum,
+                               std::vector<std::uint32_t>& out) const {
+    ZoneScoped;
+    // 视锥没有有限的格子范围：先用格子包围盒粗筛已占用的格子，跨格子的物体排序去重
+    std::vector<item_t> candidates;
+    for (const auto& [key, items] : cells_) {
+        if (frustum.intersects(cellBounds(cellOf(key)))) {
+            candidates.insert(candidates.end(), items.begin(), items.end());
+        }
+    }
+    std::ranges::sort(candidates);
+    const auto duplicates = std::ranges::unique(candidates);
+    candidates.erase(duplicates.begin(), duplicates.end());
+    candidates.insert(candidates.end(), oversized_.begin(), oversized_.end());
+    for (const item_t item : candidates) {
+        if (frustum.intersects(items_[item].bounds)) {
+            out.push_back(items_[item].value);
+        }
+    }
+}
+
+}  // namespace graphics
@@ -0,0 +1,74 @@
+#pragma once
+#include "core/camera/frustum.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace graphics {
+
+/// 世界空间的均匀哈希网格，回答"某个位置附近有哪些物体"。每个物体登记在包围盒覆盖的所有格子里，
+/// 覆盖格子数超过 MAX_ITEM_CELLS 的大物体单独存放，每次查询都测试。
+/// update 只在覆盖的格子范围变化时重新登记，移动但不跨格的物体只改包围盒。
+/// 范围查询只访问与查询区域重叠的格子，查询区域覆盖的格子比已占用的格子多时改为遍历已占用的格子。
+/// 查询是只读的，可以在多个线程中同时进行，但不能与修改同时进行。
+class SpatialGrid {
+    public:
+        using item_t = std::uint32_t;
+        static constexpr item_t INVALID_ITEM = std::numeric_limits<item_t>::max();
+        static constexpr std::uint32_t MAX_ITEM_CELLS = 64;
+
+        explicit SpatialGrid(float cell_size = 4.f);
+
+        // value 是调用方的键，查询结果返回它
+        auto insert(const core::AABB& bounds, std::uint32_t value) -> item_t;
+        void update(item_t item, const core::AABB& bounds);
+        void remove(item_t item);
+        void clear();
+
+        // 结果追加到 out，每个物体最多出现一次，顺序不固定
+        void queryAabb(const core::AABB& bounds, std::vector<std::uint32_t>& out) const;
+        void queryRadius(const glm::vec3& center, float radius,
+                         std::vector<std::uint32_t>& out) const;
+        void queryFrustum(const core::Frustum& frustum, std::vector<std::uint32_t>& out) const;
+
+        [[nodiscard]] auto bounds(item_t item) const -> const core::AABB& {
+            return items_[item].bounds;
+        }
+        [[nodiscard]] auto size() const -> std::size_t { return items_.size() - free_.size(); }
+        [[nodiscard]] auto cellSize() const -> float { return cell_size_; }
+
+    private:
+        struct CellRange {
+                glm::ivec3 min{0};
+                glm::ivec3 max{-1};
+                [[nodiscard]] auto count() const -> std::uint64_t;
+                auto operator==(const CellRange&) const -> bool = default;
+        };
+        struct Item {
+                core::AABB bounds;
+                CellRange cells;
+                std::uint32_t value{0};
+                bool oversized{false};
+        };
+
+        [[nodiscard]] auto cellRange(const core::AABB& bounds) const -> CellRange;
+        [[nodiscard]] auto cellBounds(const glm::ivec3& cell) const -> core::AABB;
+        static auto cellKey(const glm::ivec3& cell) -> std::uint64_t;
+        static auto cellOf(std::uint64_t key) -> glm::ivec3;
+        void link(item_t item);
+        void unlink(item_t item);
+        // 对 range 内（或与之重叠的已占用格子）的每个物体调用 func(item, cell)
+        template <typename Func>
+        void forEachInRange(const CellRange& range, Func&& func) const;
+
+        float cell_size_;
+        float inv_cell_size_;
+        std::vector<Item> items_;
+        std::vector<item_t> free_;
+        std::unordered_map<std::uint64_t, std::vector<item_t>> cells_;
+        std::vector<item_t> oversized_;
+};
+
+}  // namespace graphics
@@ -0,0 +1,167 @@
+#include "system/transform_hierarchy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <tracy/Tracy.hpp>
+
+namespace graphics {
+
+auto TransformHierarchy::add(const ecs::TransformComponent* local,
+                             ecs::WorldTransformComponent* world, node_t parent) -> node_t {
+    if (parent == NO_PARENT && !free_.empty()) {
+        const node_t node = free_.back();
+        free_.pop_back();
+        parent_[node] = NO_PARENT;
+        source_[node] = local;
+        output_[node] = world;
+        tx_[node] = local->translation.x;
+        ty_[node] = local->translation.y;
+        tz_[node] = local->translation.z;
+        rx_[node] = local->rotation.x;
+        ry_[node] = local->rotation.y;
+        rz_[node] = local->rotation.z;
+        sx_[node] = local->scale.x;
+        sy_[node] = local->scale.y;
+        sz_[node] = local->scale.z;
+        local_dirty_[node] = 1;
+        world_dirty_[node] = 1;
+        return node;
+    }
+    const auto node = static_cast<node_t>(parent_.size());
+    parent_.push_back(parent < node ? parent : NO_PARENT);
+    source_.push_back(local);
+    output_.push_back(world);
+    tx_.push_back(local->translation.x);
+    ty_.push_back(local->translation.y);
+    tz_.push_back(local->translation.z);
+    rx_.push_back(local->rotation.x);
+    ry_.push_back(local->rotation.y);
+    rz_.push_back(local->rotation.z);
+    sx_.push_back(local->scale.x);
+    sy_.push_back(local->scale.y);
+    sz_.push_back(local->scale.z);
+    local_.emplace_back(1.f);
+    world_.emplace_back(1.f);
+    // 新节点在下一次 update 时计算
+    local_dirty_.push_back(1);
+    world_dirty_.push_back(1);
+    return node;
+}
+
+void TransformHierarchy::remove(node_t node) {
+    // 空位没有来源，不参与比较和传播
+    parent_[node] = NO_PARENT;
+    source_[node] = nullptr;
+    output_[node] = nullptr;
+    local_dirty_[node] = 0;
+    world_dirty_[node] = 0;
+    free_.push_back(node);
+}
+
+auto TransformHierarchy::update() -> std::size_t {
+    ZoneScoped;
+    const std::size_t count = parent_.size();
+
+    // 1. 与快照比较，找出局部变换发生变化的节点
+    for (std::size_t i = 0; i < count; ++i) {
+        if (source_[i] == nullptr) {
+            continue;
+        }
+        const auto& source = *source_[i];
+        const bool changed = source.translation.x != tx_[i] || source.translation.y != ty_[i] ||
+                             source.translation.z != tz_[i] || source.rotation.x != rx_[i] ||
+                             source.rotation.y != ry_[i] || source.rotation.z != rz_[i] ||
+                             source.scale.x != sx_[i] || source.scale.y != sy_[i] ||
+                             source.scale.z != sz_[i];
+        if (changed) {
+            tx_[i] = source.translation.x;
+            ty_[i] = source.translation.y;
+            tz_[i] = source.translation.z;
+            rx_[i] = source.rotation.x;
+            ry_[i] = source.rotation.y;
+            rz_[i] = source.rotation.z;
+            sx_[i] = source.scale.x;
+            sy_[i] = source.scale.y;
+            sz_[i] = source.scale.z;
+            local_dirty_[i] = 1;
+        }
+    }
+
+    // 2. 重算局部矩阵，并把脏标记传播到子节点（父节点下标总是更小）
+    buildLocalMatrices();
+    std::size_t updated = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const node_t parent = parent_[i];
+        const bool parent_dirty = parent != NO_PARENT && world_dirty_[parent] != 0;
+        if (local_dirty_[i] == 0 && world_dirty_[i] == 0 && !parent_dirty) {
+            continue;
+        }
+        world_dirty_[i] = 1;
+        world_[i] = parent == NO_PARENT ? local_[i] : world_[parent] * local_[i];
+        if (auto* output = output_[i]) {
+            output->world = world_[i];
+            output->normal = glm::mat4(glm::inverseTranspose(glm::mat3(world_[i])));
+            ++output->version;
+        }
+        ++updated;
+    }
+
+    std::ranges::fill(local_dirty_, std::uint8_t{0});
+    std::ranges::fill(world_dirty_, std::uint8_t{0});
+    return updated;
+}
+
+// 与 TransformComponent::mat4() 相同：T * Ry * Rx * Rz * S，按 BATCH 个节点一组展开计算
+void TransformHierarchy::buildLocalMatrices() {
+    local_dirty_nodes_.clear();
+    for (std::size_t i = 0; i < local_dirty_.size(); ++i) {
+        if (local_dirty_[i] != 0) {
+            local_dirty_nodes_.push_back(static_cast<node_t>(i));
+        }
+    }
+
+    for (std::size_t first = 0; first < local_dirty_nodes_.size(); first += BATCH) {
+        const std::size_t lanes = std::min(BATCH, local_dirty_nodes_.size() - first);
+        std::array<float, BATCH> cx{}, sx{}, cy{}, sy{}, cz{}, sz{};
+        std::array<float, BATCH> scale_x{}, scale_y{}, scale_z{};
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            const node_t node = local_dirty_nodes_[first + lane];
+            cx[lane] = std::cos(rx_[node]);
+            sx[lane] = std::sin(rx_[node]);
+            cy[lane] = std::cos(ry_[node]);
+            sy[lane] = std::sin(ry_[node]);
+            cz[lane] = std::cos(rz_[node]);
+            sz[lane] = std::sin(rz_[node]);
+            scale_x[lane] = sx_[node];
+            scale_y[lane] = sy_[node];
+            scale_z[lane] = sz_[node];
+        }
+
+        // 旋转矩阵 R = Ry * Rx * Rz 的各元素（行, 列），各 lane 之间没有依赖
+        std::array<float, BATCH> r00{}, r01{}, r02{}, r10{}, r11{}, r12{}, r20{}, r21{}, r22{};
+        for (std::size_t lane = 0; lane < BATCH; ++lane) {
+            r00[lane] = (cy[lane] * cz[lane]) + (sy[lane] * sx[lane] * sz[lane]);
+            r01[lane] = (sy[lane] * sx[lane] * cz[lane]) - (cy[lane] * sz[lane]);
+            r02[lane] = sy[lane] * cx[lane];
+            r10[lane] = cx[lane] * sz[lane];
+            r11[lane] = cx[lane] * cz[lane];
+            r12[lane] = -sx[lane];
+            r20[lane] = (cy[lane] * sx[lane] * sz[lane]) - (sy[lane] * cz[lane]);
+            r21[lane] = (sy[lane] * sz[lane]) + (cy[lane] * sx[lane] * cz[lane]);
+            r22[lane] = cy[lane] * cx[lane];
+        }
+
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            const node_t node = local_dirty_nodes_[first + lane];
+            auto& m = local_[node];
+            m[0] = glm::vec4{r00[lane], r10[lane], r20[lane], 0.f} * scale_x[lane];
+            m[1] = glm::vec4{r01[lane], r11[lane], r21[lane], 0.f} * scale_y[lane];
+            m[2] = glm::vec4{r02[lane], r12[lane], r22[lane], 0.f} * scale_z[lane];
+            m[3] = glm::vec4{tx_[node], ty_[node], tz_[node], 1.f};
+        }
+    }
+}
+
+}  // namespace graphics
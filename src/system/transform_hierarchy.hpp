@@ -0,0 +1,51 @@
+#pragma once
+#include "ecs/components/transform_component.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace graphics {
+
+/// 按 SoA 保存的变换层级。每帧对比局部 TRS 的快照找出变化的节点，沿父节点向下传播脏标记，
+/// 只重算变化的子树：局部矩阵按批 SoA 计算，世界矩阵和法线矩阵写回 WorldTransformComponent。
+/// 父节点必须先于子节点加入，保证一次正序遍历即可完成传播。
+/// 删除的节点留下空位，之后加入的根节点复用空位（根节点没有先后顺序的要求）。
+class TransformHierarchy {
+    public:
+        using node_t = std::uint32_t;
+        static constexpr node_t NO_PARENT = std::numeric_limits<node_t>::max();
+
+        auto add(const ecs::TransformComponent* local, ecs::WorldTransformComponent* world,
+                 node_t parent = NO_PARENT) -> node_t;
+        // 之后不再读写 local/world 指向的组件。子节点需要先删除
+        void remove(node_t node);
+
+        // 返回本次重新计算世界矩阵的节点数量
+        auto update() -> std::size_t;
+
+        [[nodiscard]] auto size() const -> std::size_t { return parent_.size() - free_.size(); }
+        [[nodiscard]] auto worldMatrix(node_t node) const -> const glm::mat4& {
+            return world_[node];
+        }
+
+    private:
+        static constexpr std::size_t BATCH = 8;
+        void buildLocalMatrices();
+
+        std::vector<node_t> parent_;
+        std::vector<const ecs::TransformComponent*> source_;
+        std::vector<ecs::WorldTransformComponent*> output_;
+        // 上一次看到的局部 TRS
+        std::vector<float> tx_, ty_, tz_;
+        std::vector<float> rx_, ry_, rz_;
+        std::vector<float> sx_, sy_, sz_;
+        std::vector<glm::mat4> local_;
+        std::vector<glm::mat4> world_;
+        std::vector<std::uint8_t> local_dirty_;
+        std::vector<std::uint8_t> world_dirty_;
+        std::vector<node_t> local_dirty_nodes_;
+        std::vector<node_t> free_;  // 已删除的节点
+};
+
+}  // namespace graphics
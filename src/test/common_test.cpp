@@ -1,7 +1,19 @@
 #include <gtest/gtest.h>
 #include "common/bit_field.hpp"
+#include "common/deferred_release.hpp"
+#include "common/handle_pool.hpp"
+#include "common/radix_sort.hpp"
+#include <algorithm>
 #include <format>
+#include <memory>
 #include <print>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 TEST(BitFieldTest, CommonBitField) {
     struct MyStruct {
             union {
@@ -23,4 +35,117 @@ TEST(BitFieldTest, CommonBitField) {
     std::println("2 {}", bool(s.bit1));
     std::println("4 {}", bool(s.bit4));
     std::println("u {}", static_cast<int>(s.u));
-}
\ No newline at end of file
+}
+TEST(RadixSort, MatchesStableSort) {
+    std::mt19937_64 rng(7);
+    std::vector<common::SortPair> items(20000);
+    for (std::uint32_t i = 0; i < items.size(); ++i) {
+        // 高位只取少量取值，既覆盖跳过的字节也产生大量相同 key
+        items[i] = {.key = (rng() & 0xff00'0000'00ffULL) | (std::uint64_t{i % 7} << 32), .value = i};
+    }
+    auto expected = items;
+    std::ranges::stable_sort(expected, {}, &common::SortPair::key);
+
+    std::vector<common::SortPair> scratch;
+    common::radixSort(items, scratch);
+    ASSERT_EQ(items.size(), expected.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        EXPECT_EQ(items[i].key, expected[i].key);
+        EXPECT_EQ(items[i].value, expected[i].value);
+    }
+}
+
+TEST(HandlePool, DetectsStaleHandles) {
+    common::HandlePool<std::string> pool;
+    const auto first = pool.allocate("first");
+    const auto second = pool.allocate("second");
+    ASSERT_NE(pool.get(first), nullptr);
+    EXPECT_EQ(*pool.get(first), "first");
+
+    pool.release(first);
+    EXPECT_EQ(pool.get(first), nullptr);
+    EXPECT_FALSE(pool.valid(first));
+    pool.release(first);  // 重复释放不影响其他句柄
+
+    // 槽位被复用后旧句柄仍然无效
+    const auto reused = pool.allocate("reused");
+    EXPECT_EQ(reused.index, first.index);
+    EXPECT_NE(reused.generation, first.generation);
+    EXPECT_EQ(pool.get(first), nullptr);
+    EXPECT_EQ(*pool.get(reused), "reused");
+    EXPECT_EQ(*pool.get(second), "second");
+    EXPECT_EQ(pool.size(), 2U);
+    EXPECT_FALSE(pool.valid(common::Handle<std::string>{}));
+}
+
+TEST(HandlePool, ThrowsWhenFull) {
+    using Pool = common::HandlePool<std::uint8_t>;
+    constexpr auto CAPACITY = Pool::MAX_CHUNKS * Pool::CHUNK_SIZE;
+    auto pool = std::make_unique<Pool>();
+    for (std::uint32_t i = 0; i < CAPACITY; ++i) {
+        std::ignore = pool->allocate(std::uint8_t{0});
+    }
+    EXPECT_THROW(std::ignore = pool->allocate(std::uint8_t{0}), std::length_error);
+    EXPECT_EQ(pool->size(), CAPACITY);
+}
+
+TEST(HandlePool, ConcurrentAllocate) {
+    constexpr int THREADS = 8;
+    constexpr int PER_THREAD = 4000;
+    common::HandlePool<int> pool;
+    std::vector<std::vector<common::Handle<int>>> kept(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&pool, &kept, t] {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                const auto handle = pool.allocate(i);
+                if (i % 2 == 0) {
+                    kept[t].push_back(handle);
+                } else {
+                    pool.release(handle);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::set<std::uint32_t> indices;
+    for (const auto& handles : kept) {
+        for (std::size_t i = 0; i < handles.size(); ++i) {
+            ASSERT_NE(pool.get(handles[i]), nullptr);
+            EXPECT_EQ(*pool.get(handles[i]), static_cast<int>(i * 2));
+            indices.insert(handles[i].index);
+        }
+    }
+    EXPECT_EQ(indices.size(), static_cast<std::size_t>(THREADS * PER_THREAD / 2));
+    EXPECT_EQ(pool.size(), indices.size());
+}
+
+TEST(DeferredReleaseQueue, ReleasesOnlyCompletedTicksInOrder) {
+    common::DeferredReleaseQueue<int> queue;
+    queue.push(1, 10);
+    queue.push(2, 20);
+    queue.push(2, 21);
+    queue.push(4, 40);
+    std::vector<int> released;
+    const auto release = [&](int value) { released.push_back(value); };
+
+    u64 gpu_tick = 0;
+    const auto is_free = [&](u64 tick) { return gpu_tick >= tick; };
+    EXPECT_EQ(queue.collect(is_free, release), 0U);
+    EXPECT_TRUE(released.empty());
+
+    gpu_tick = 2;
+    EXPECT_EQ(queue.collect(is_free, release), 3U);
+    EXPECT_EQ(released, (std::vector<int>{10, 20, 21}));
+    EXPECT_EQ(queue.size(), 1U);
+
+    // GPU 还没执行到 tick 4
+    gpu_tick = 3;
+    EXPECT_EQ(queue.collect(is_free, release), 0U);
+    gpu_tick = 5;
+    EXPECT_EQ(queue.collect(is_free, release), 1U);
+    EXPECT_EQ(released.back(), 40);
+    EXPECT_TRUE(queue.empty());
+}
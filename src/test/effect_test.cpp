@@ -1,5 +1,11 @@
 #include <gtest/gtest.h>
 #include "effects/effect.hpp"
+#include "effects/model/model.hpp"
+#include "effects/scene_snapshot.hpp"
+#include "effects/stress_scene.hpp"
+#include <filesystem>
+#include <string>
+#include <tuple>
 TEST(EffectTest, EffectTestTest) {
     int count = 0;  // 👈 改成局部变量，不污染
 
@@ -26,4 +32,146 @@ TEST(EffectTest, EffectTestTest) {
 
     // 最终 count = 4
     ASSERT_EQ(count, 4);
-}
\ No newline at end of file
+}
+
+TEST(EffectTest, BudgetDefersByPriority) {
+    using graphics::effects::EffectPriority;
+    std::vector<std::string> order;
+    auto steps = [&](std::string name, int count) -> std::generator<std::monostate> {
+        co_yield {};
+        for (int i = 0; i < count; ++i) {
+            order.push_back(name);
+            co_yield {};
+        }
+    };
+
+    graphics::effects::EffectManager manager;
+    manager.add(graphics::effects::Effect(steps("low", 1), EffectPriority::Low));
+    manager.add(graphics::effects::Effect(steps("normal", 2), EffectPriority::Normal));
+    manager.add(graphics::effects::Effect(steps("high", 1), EffectPriority::High));
+
+    // 预算为 0 时每帧只执行一步，其余推迟
+    manager.run(graphics::effects::EffectManager::Duration::zero());
+    EXPECT_EQ(manager.frameStats().resumed, 1U);
+    EXPECT_EQ(manager.frameStats().deferred, 2U);
+    while (manager.size() > 0) {
+        manager.run(graphics::effects::EffectManager::Duration::zero());
+    }
+    EXPECT_EQ(order, (std::vector<std::string>{"high", "normal", "normal", "low"}));
+
+    // 不限预算时每个 effect 每帧都执行一步
+    order.clear();
+    manager.add(graphics::effects::Effect(steps("a", 1), EffectPriority::Low));
+    manager.add(graphics::effects::Effect(steps("b", 1), EffectPriority::Low));
+    const auto overruns = manager.overrunFrames();
+    manager.run();
+    EXPECT_EQ(order, (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(manager.frameStats().deferred, 0U);
+    EXPECT_EQ(manager.overrunFrames(), overruns);
+}
+
+TEST(SceneSnapshot, RoundTrip) {
+    using graphics::effects::SceneSnapshot;
+    SceneSnapshot snapshot;
+    for (int i = 0; i < 3; ++i) {
+        SceneSnapshot::ModelRecord record;
+        std::tie(record.model_name_offset, record.model_name_size) =
+            snapshot.addString("model" + std::to_string(i));
+        std::tie(record.shader_name_offset, record.shader_name_size) = snapshot.addString("model");
+        record.first_bounds = static_cast<std::uint32_t>(snapshot.bounds.size());
+        record.bounds_count = 2;
+        record.split_mesh = static_cast<std::uint32_t>(i % 2);
+        record.translation = glm::vec3(static_cast<float>(i));
+        snapshot.bounds.push_back(
+            {.min = glm::vec3(-1.f), .max = glm::vec3(static_cast<float>(i))});
+        snapshot.bounds.push_back({.min = glm::vec3(0.f), .max = glm::vec3(2.f)});
+        snapshot.models.push_back(record);
+    }
+    snapshot.lights.push_back({.light = {}, .translation = {1.f, 2.f, 3.f}, .visible = 0});
+    snapshot.asset_hash = 0x0123456789abcdefULL;
+
+    const auto path = std::filesystem::temp_directory_path() / "scene_snapshot_test.snapshot";
+    ASSERT_TRUE(graphics::effects::save_scene_snapshot(snapshot, path));
+    auto loaded = graphics::effects::load_scene_snapshot(path);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->asset_hash, snapshot.asset_hash);
+    ASSERT_EQ(loaded->models.size(), 3U);
+    ASSERT_EQ(loaded->bounds.size(), 6U);
+    for (std::size_t i = 0; i < loaded->models.size(); ++i) {
+        const auto& record = loaded->models[i];
+        EXPECT_EQ(loaded->string(record.model_name_offset, record.model_name_size),
+                  "model" + std::to_string(i));
+        EXPECT_EQ(loaded->string(record.shader_name_offset, record.shader_name_size), "model");
+        EXPECT_EQ(record.split_mesh, i % 2);
+        EXPECT_EQ(record.translation, glm::vec3(static_cast<float>(i)));
+        EXPECT_EQ(loaded->modelBounds(record)[0].max, glm::vec3(static_cast<float>(i)));
+    }
+    ASSERT_EQ(loaded->lights.size(), 1U);
+    EXPECT_EQ(loaded->lights[0].translation, glm::vec3(1.f, 2.f, 3.f));
+    EXPECT_EQ(loaded->lights[0].visible, 0U);
+
+    // 截断的文件不能被加载
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    EXPECT_FALSE(graphics::effects::load_scene_snapshot(path).has_value());
+    std::filesystem::remove(path);
+}
+
+TEST(StressScene, LayoutIsDeterministic) {
+    graphics::effects::StressSceneSettings settings{
+        .seed = 42, .models = 64, .lights = 8, .hierarchy_depth = 3};
+    const auto first = graphics::effects::make_stress_layout(settings);
+    const auto second = graphics::effects::make_stress_layout(settings);
+    ASSERT_EQ(first.models.size(), 64U);
+    ASSERT_EQ(first.lights.size(), 8U);
+    ASSERT_EQ(first.mesh_extents, second.mesh_extents);
+    for (std::size_t i = 0; i < first.models.size(); ++i) {
+        EXPECT_EQ(first.models[i].mesh, second.models[i].mesh);
+        EXPECT_EQ(first.models[i].translation, second.models[i].translation);
+        EXPECT_EQ(first.models[i].rotation, second.models[i].rotation);
+    }
+    for (std::size_t i = 0; i < first.lights.size(); ++i) {
+        EXPECT_EQ(first.lights[i].position, second.lights[i].position);
+        EXPECT_EQ(first.lights[i].range, second.lights[i].range);
+    }
+
+    settings.seed = 43;
+    const auto other = graphics::effects::make_stress_layout(settings);
+    EXPECT_NE(first.mesh_extents, other.mesh_extents);
+}
+
+TEST(StressScene, ParentsPrecedeChildren) {
+    using graphics::effects::StressLayout;
+    const auto layout = graphics::effects::make_stress_layout(
+        {.models = 100, .lights = 0, .hierarchy_depth = 4, .mesh_variants = 3});
+    std::size_t roots = 0;
+    for (std::uint32_t i = 0; i < layout.models.size(); ++i) {
+        const auto& node = layout.models[i];
+        EXPECT_LT(node.mesh, 3U);
+        if (node.parent == StressLayout::NO_PARENT) {
+            ++roots;
+            continue;
+        }
+        EXPECT_LT(node.parent, i);
+        // 链的长度不超过 hierarchy_depth
+        std::uint32_t depth = 1;
+        for (auto parent = node.parent; parent != StressLayout::NO_PARENT;
+             parent = layout.models[parent].parent) {
+            ++depth;
+        }
+        EXPECT_LE(depth, 4U);
+    }
+    EXPECT_EQ(roots, 25U);
+}
+
+TEST(ModelPushConstant, RejectsUnencodableObjectId) {
+    graphics::effects::ModelPushConstantData push;
+    EXPECT_TRUE(push.setObjectId(render::MAX_ENCODABLE_OBJECT_ID - 1, 5));
+    EXPECT_EQ(push.normalMatrix[3].x, render::encodeObjectId(render::MAX_ENCODABLE_OBJECT_ID - 1));
+    EXPECT_EQ(push.normalMatrix[3].y, 5.f);
+    EXPECT_EQ(push.normalMatrix[3].z, 1.f);
+
+    // 2^24 + 1 转成 float 会变成 2^24，必须拒绝而不是写入错误的 ID
+    EXPECT_FALSE(push.setObjectId(render::MAX_ENCODABLE_OBJECT_ID + 1, 5));
+    EXPECT_FALSE(push.setObjectId(1, render::MAX_ENCODABLE_OBJECT_ID));
+    EXPECT_EQ(push.normalMatrix[3].z, 0.f);
+}
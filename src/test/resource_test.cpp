@@ -1,8 +1,19 @@
 #include "resource/texture/ktx_image.hpp"
+#include "resource/obj/ao_baker.hpp"
+#include "resource/obj/animation_compression.hpp"
+#include "resource/obj/animator.hpp"
+#include "resource/resource.hpp"
+#include "render_core/null_graphic.hpp"
 #include <gtest/gtest.h>
 #include <spdlog/spdlog.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 #include <array>
 #include <filesystem>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
 #ifndef IMAGE_RESOURCE_PATH
 #define IMAGE_RESOURCE_PATH std::string(".")
 #endif
@@ -44,3 +55,410 @@ TEST(Resource, createKtxCubeMap) {
     ASSERT_EQ(6, ktx->numFaces);
     ASSERT_EQ(true, ktx->isCubemap);
 }
+
+namespace {
+// 只提供 id，NullGraphic 不读取顶点数据
+class EmptyMeshData : public render::IMeshData {
+    public:
+        [[nodiscard]] auto getMesh() const -> std::span<const float> override { return {}; }
+        [[nodiscard]] auto getVertexCount() const -> std::size_t override { return 0; }
+        [[nodiscard]] auto getIndices() const -> std::span<const std::byte> override { return {}; }
+        [[nodiscard]] auto getIndicesSize() const -> std::uint64_t override { return 0; }
+        [[nodiscard]] auto getVertexAttribute() const
+            -> std::vector<render::VertexAttribute> override {
+            return {};
+        }
+        [[nodiscard]] auto getVertexBinding() const -> std::vector<render::VertexBinding> override {
+            return {};
+        }
+};
+}  // namespace
+
+// 同一个模型的两份拷贝共用一个 MeshId，只有最后一次 release 才调用 Graphic::releaseModel
+TEST(Resource, MeshRefCount) {
+    render::NullGraphic graphic;
+    graphics::ResourceManager manager(&graphic);
+    const auto mesh = manager.addMesh("shared_mesh", EmptyMeshData{});
+    EXPECT_EQ(graphic.stats().live_meshes, 1U);
+
+    // 第二份拷贝按名字找到同一个网格
+    const auto copy = manager.getMesh(manager.findMesh("shared_mesh"));
+    EXPECT_EQ(copy, mesh);
+    manager.acquireMesh(mesh);
+    manager.acquireMesh(copy);
+
+    manager.releaseMesh(mesh);
+    EXPECT_EQ(graphic.stats().live_meshes, 1U);
+    EXPECT_TRUE(manager.hasMesh("shared_mesh"));
+
+    manager.releaseMesh(copy);
+    EXPECT_EQ(graphic.stats().live_meshes, 0U);
+    EXPECT_FALSE(manager.hasMesh("shared_mesh"));
+    EXPECT_FALSE(manager.findMesh("shared_mesh"));
+
+    // 多余的 release 不会再次释放
+    manager.releaseMesh(copy);
+    EXPECT_EQ(graphic.stats().live_meshes, 0U);
+}
+
+TEST(Resource, TextureRefCount) {
+    render::NullGraphic graphic;
+    graphics::ResourceManager manager(&graphic);
+    // 默认白色纹理
+    EXPECT_EQ(graphic.stats().live_textures, 1U);
+    const auto path = std::string(IMAGE_RESOURCE_PATH) + "/test/image/test/test.jpg";
+    const auto texture = manager.addTexture(path);
+    EXPECT_EQ(manager.addTexture(path), texture);
+    EXPECT_EQ(graphic.stats().live_textures, 2U);
+    manager.acquireTexture(texture);
+    manager.acquireTexture(texture);
+
+    manager.releaseTexture(texture);
+    EXPECT_EQ(graphic.stats().live_textures, 2U);
+    manager.releaseTexture(texture);
+    EXPECT_EQ(graphic.stats().live_textures, 1U);
+    EXPECT_FALSE(manager.findTexture(path));
+
+    // 默认纹理多持有一次引用，模型释放后仍然存在
+    const auto white = manager.getDefaultTexture();
+    manager.acquireTexture(white);
+    manager.releaseTexture(white);
+    EXPECT_EQ(graphic.stats().live_textures, 1U);
+    EXPECT_EQ(manager.getDefaultTexture(), white);
+}
+
+namespace {
+auto makeVertex(glm::vec3 position, glm::vec3 normal) -> graphics::Vertex {
+    return {.position = position, .color = glm::vec3{1.f}, .normal = normal, .texCoord = {}};
+}
+}  // namespace
+
+// 地面中心上方 0.5 处有一块 2x2 的遮挡板：中心约 80% 的余弦加权方向被挡住，角点完全不受影响
+TEST(Resource, bakeVertexAo) {
+    const glm::vec3 up{0.f, 1.f, 0.f};
+    const glm::vec3 down{0.f, -1.f, 0.f};
+    std::vector<graphics::Vertex> ground{
+        makeVertex({0.f, 0.f, 0.f}, up),    makeVertex({-10.f, 0.f, -10.f}, up),
+        makeVertex({10.f, 0.f, -10.f}, up), makeVertex({10.f, 0.f, 10.f}, up),
+        makeVertex({-10.f, 0.f, 10.f}, up)};
+    const std::vector<uint32_t> ground_indices{0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 1};
+    std::vector<graphics::Vertex> occluder{
+        makeVertex({-1.f, 0.5f, -1.f}, down), makeVertex({1.f, 0.5f, -1.f}, down),
+        makeVertex({1.f, 0.5f, 1.f}, down), makeVertex({-1.f, 0.5f, 1.f}, down)};
+    const std::vector<uint32_t> occluder_indices{0, 1, 2, 0, 2, 3};
+    const std::array targets{
+        graphics::AoBakeTarget{.vertices = ground, .indices = ground_indices},
+        graphics::AoBakeTarget{.vertices = occluder, .indices = occluder_indices}};
+    const graphics::AoBakeConfig config{.sample_count = 256, .max_distance = 5.f};
+    graphics::bakeVertexAo(targets, config);
+
+    EXPECT_NEAR(ground[0].ao, 0.2f, 0.08f);
+    for (std::size_t i = 1; i < ground.size(); ++i) {
+        EXPECT_FLOAT_EQ(ground[i].ao, 1.f);
+    }
+
+    // 同样的输入和种子得到同样的结果
+    const float center_ao = ground[0].ao;
+    graphics::bakeVertexAo(targets, config);
+    EXPECT_FLOAT_EQ(ground[0].ao, center_ao);
+}
+
+namespace {
+void expectMatrixNear(const glm::mat4& actual, const glm::mat4& expected) {
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            EXPECT_NEAR(actual[column][row], expected[column][row], 1e-4f)
+                << "column " << column << " row " << row;
+        }
+    }
+}
+
+auto trs(const glm::vec3& t, const glm::quat& r, const glm::vec3& s) -> glm::mat4 {
+    return glm::translate(glm::mat4{1.f}, t) * glm::mat4_cast(r) * glm::scale(glm::mat4{1.f}, s);
+}
+
+// 两个旋转之间的夹角，角度很小时也准确
+auto rotationAngle(const glm::quat& a, const glm::quat& b) -> float {
+    const float distance = std::min(glm::length(a - b), glm::length(a + b));
+    return 4.f * std::asin(std::min(distance * .5f, 1.f));
+}
+
+// 根关节下有两条分支，关节 3 没有轨道，使用静止姿势
+struct TestRig {
+        graphics::animation::Skeleton skeleton;
+        graphics::animation::AnimationClip clip;
+
+        TestRig() {
+            using graphics::animation::Skeleton;
+            const glm::mat4 bind = glm::translate(glm::mat4{1.f}, glm::vec3{0.f, -1.f, 0.f});
+            skeleton.addJoint(Skeleton::NO_PARENT, glm::mat4{1.f});
+            skeleton.addJoint(0, bind);
+            skeleton.addJoint(1, bind * bind);
+            skeleton.addJoint(0, glm::mat4{1.f}, {1.f, 0.f, 0.f},
+                              glm::angleAxis(0.3f, glm::vec3{0.f, 0.f, 1.f}), glm::vec3{2.f});
+            skeleton.addJoint(1, glm::mat4{1.f});
+
+            clip.duration = 10.f;
+            clip.ticks_per_second = 10.f;
+            const std::array<float, 3> times{0.f, 4.f, 10.f};
+            for (std::size_t joint = 0; joint < 5; ++joint) {
+                if (joint == 3) {
+                    continue;
+                }
+                const auto f = static_cast<float>(joint);
+                const std::array<glm::vec3, 3> positions{
+                    glm::vec3{0.f, 1.f, 0.f}, glm::vec3{f, 1.f, 0.5f}, glm::vec3{0.f, 2.f, f}};
+                const std::array<glm::quat, 3> rotations{
+                    glm::angleAxis(0.f, glm::vec3{0.f, 1.f, 0.f}),
+                    glm::angleAxis(0.5f + f, glm::vec3{0.f, 1.f, 0.f}),
+                    glm::angleAxis(1.f, glm::normalize(glm::vec3{1.f, 1.f, f}))};
+                const std::array<glm::vec3, 3> scales{glm::vec3{1.f}, glm::vec3{1.f + f},
+                                                      glm::vec3{0.5f}};
+                clip.translations.set(joint, times, positions);
+                clip.rotations.set(joint, times, rotations);
+                // 关节 4 的缩放只有一个键
+                const std::size_t scale_keys = joint == 4 ? 1 : 3;
+                clip.scales.set(joint, std::span{times}.first(scale_keys),
+                                std::span{scales}.first(scale_keys));
+            }
+        }
+};
+}  // namespace
+
+TEST(Animation, PaletteMatchesReferenceMatrices) {
+    const TestRig rig;
+    graphics::animation::LocalPose pose;
+    graphics::animation::samplePose(rig.skeleton, rig.clip, 2.f, pose);
+    ASSERT_EQ(pose.jointCount(), 5U);
+    // 关节 1 在第 0、1 个键之间的一半
+    const glm::vec3 expected_translation = glm::mix(glm::vec3{0.f, 1.f, 0.f},
+                                                    glm::vec3{1.f, 1.f, 0.5f}, 0.5f);
+    EXPECT_NEAR(glm::length(pose.translation(1) - expected_translation), 0.f, 1e-5f);
+    EXPECT_NEAR(glm::length(pose.scale(3) - glm::vec3{2.f}), 0.f, 1e-6f);
+
+    std::vector<glm::mat4> model;
+    std::vector<glm::mat4> palette;
+    graphics::animation::buildPalette(rig.skeleton, pose, model, palette);
+    std::vector<glm::mat4> expected(rig.skeleton.jointCount());
+    for (std::size_t joint = 0; joint < expected.size(); ++joint) {
+        const glm::mat4 local = trs(pose.translation(joint), pose.rotation(joint),
+                                    pose.scale(joint));
+        const auto parent = rig.skeleton.parents[joint];
+        expected[joint] = parent < 0 ? local : expected[static_cast<std::size_t>(parent)] * local;
+        expectMatrixNear(model[joint], expected[joint]);
+        expectMatrixNear(palette[joint], expected[joint] * rig.skeleton.inverse_bind[joint]);
+    }
+}
+
+TEST(Animation, BlendTakesShortestPath) {
+    graphics::animation::LocalPose from;
+    graphics::animation::LocalPose to;
+    from.resize(5);
+    to.resize(5);
+    const glm::quat rotation = glm::angleAxis(1.2f, glm::normalize(glm::vec3{1.f, 2.f, 3.f}));
+    for (std::size_t joint = 0; joint < 5; ++joint) {
+        from.set(joint, glm::vec3{0.f}, rotation, glm::vec3{1.f});
+        // -q 和 q 表示同一个旋转
+        to.set(joint, glm::vec3{2.f, 4.f, 6.f}, -rotation, glm::vec3{3.f});
+    }
+    graphics::animation::LocalPose out;
+    graphics::animation::blendPoses(from, to, 0.25f, out);
+    for (std::size_t joint = 0; joint < 5; ++joint) {
+        EXPECT_NEAR(std::abs(glm::dot(out.rotation(joint), rotation)), 1.f, 1e-5f);
+        EXPECT_NEAR(glm::length(out.translation(joint) - glm::vec3{0.5f, 1.f, 1.5f}), 0.f, 1e-5f);
+        EXPECT_NEAR(glm::length(out.scale(joint) - glm::vec3{1.5f}), 0.f, 1e-5f);
+    }
+}
+
+TEST(Animation, ParallelUpdateMatchesSingleInstance) {
+    const TestRig rig;
+    graphics::animation::Animator reference(rig.skeleton);
+    reference.play(rig.clip);
+    std::vector<graphics::animation::Animator> animators(64, reference);
+    for (int frame = 0; frame < 5; ++frame) {
+        reference.update(0.13f);
+        graphics::animation::updateAnimators(animators, 0.13f);
+    }
+    // 切换片段时两个姿势淡入淡出
+    reference.crossFade(rig.clip, 0.5f, 2.f);
+    reference.update(0.1f);
+    for (auto& animator : animators) {
+        animator.crossFade(rig.clip, 0.5f, 2.f);
+    }
+    graphics::animation::updateAnimators(animators, 0.1f);
+    for (const auto& animator : animators) {
+        ASSERT_EQ(animator.palette().size(), reference.palette().size());
+        for (std::size_t joint = 0; joint < reference.palette().size(); ++joint) {
+            expectMatrixNear(animator.palette()[joint], reference.palette()[joint]);
+        }
+    }
+}
+
+TEST(Animation, CursorLookupMatchesBinarySearch) {
+    // 间距不均的键
+    std::vector<float> times;
+    float time = 0.f;
+    for (int key = 0; key < 40; ++key) {
+        times.push_back(time);
+        time += 0.25f + static_cast<float>((key * 7) % 5);
+    }
+    const auto count = static_cast<std::uint32_t>(times.size());
+    const auto expected = [&](float t) -> std::uint32_t {
+        const auto upper =
+            static_cast<std::uint32_t>(std::ranges::upper_bound(times, t) - times.begin());
+        return std::clamp(upper, 1U, count - 1) - 1;
+    };
+    const auto time_at = [&](std::uint32_t i) -> float { return times[i]; };
+    std::uint32_t cursor = 0;
+    // 顺序播放、循环回到开头、倒放和随机跳转
+    std::vector<float> queries;
+    for (float t = -1.f; t < time + 2.f; t += 0.4f) {
+        queries.push_back(t);
+    }
+    for (float t = time; t > -1.f; t -= 1.7f) {
+        queries.push_back(t);
+    }
+    for (int i = 0; i < 50; ++i) {
+        queries.push_back(static_cast<float>((i * 37) % 101) * time / 100.f);
+    }
+    queries.push_back(times[10]);
+    for (const float t : queries) {
+        EXPECT_EQ(graphics::animation::findKey(count, t, cursor, time_at), expected(t))
+            << "time " << t;
+    }
+}
+
+TEST(Animation, CursorAndUniformSamplingMatchReference) {
+    using namespace graphics::animation;
+    const TestRig rig;
+    const auto uniform = resampleUniform(rig.clip, 400.f);
+    EXPECT_GT(uniform.translations.track(0).inv_step, 0.f);
+    // 关节 4 的缩放只有一个键，保持原样
+    EXPECT_EQ(uniform.scales.track(4).count, 1U);
+    EXPECT_EQ(uniform.translations.track(3).count, 0U);
+
+    LocalPose reference;
+    LocalPose cached;
+    LocalPose resampled;
+    SampleCursor cursor;
+    for (float time = -0.5f; time < 11.f; time += 0.35f) {
+        samplePose(rig.skeleton, rig.clip, time, reference);
+        samplePose(rig.skeleton, rig.clip, time, cached, &cursor);
+        samplePose(rig.skeleton, uniform, time, resampled);
+        for (std::size_t joint = 0; joint < rig.skeleton.jointCount(); ++joint) {
+            EXPECT_EQ(cached.translation(joint), reference.translation(joint));
+            EXPECT_EQ(cached.rotation(joint), reference.rotation(joint));
+            EXPECT_EQ(cached.scale(joint), reference.scale(joint));
+            // 原来的键时间都落在重新采样的网格上
+            EXPECT_NEAR(glm::length(resampled.translation(joint) - reference.translation(joint)),
+                        0.f, 1e-4f);
+            EXPECT_NEAR(std::abs(glm::dot(resampled.rotation(joint), reference.rotation(joint))),
+                        1.f, 1e-4f);
+            EXPECT_NEAR(glm::length(resampled.scale(joint) - reference.scale(joint)), 0.f, 1e-4f);
+        }
+    }
+}
+
+TEST(Animation, FlattenedHierarchyMatchesRecursiveWalk) {
+    using graphics::animation::Skeleton;
+    struct Node {
+            std::string name;
+            glm::vec3 offset;
+            std::vector<const Node*> children;
+    };
+    const Node hand{.name = "hand", .offset = {0.f, 0.f, 1.f}, .children = {}};
+    const Node head{.name = "head", .offset = {0.f, 2.f, 0.f}, .children = {}};
+    const Node arm{.name = "arm", .offset = {1.f, 0.f, 0.f}, .children = {&hand}};
+    const Node spine{.name = "spine", .offset = {0.f, 1.f, 0.f}, .children = {&arm, &head}};
+    const Node root{.name = "root", .offset = {0.f, 0.f, 0.f}, .children = {&spine}};
+
+    Skeleton skeleton;
+    std::vector<std::string> names;
+    graphics::animation::flattenHierarchy(
+        &root, [](const Node* node) -> const std::vector<const Node*>& { return node->children; },
+        [&](const Node* node, std::int32_t parent) -> std::int32_t {
+            names.push_back(node->name);
+            return skeleton.addJoint(parent, glm::mat4{1.f}, node->offset);
+        });
+    EXPECT_EQ(names, (std::vector<std::string>{"root", "spine", "arm", "hand", "head"}));
+    EXPECT_EQ(skeleton.parents, (std::vector<std::int32_t>{Skeleton::NO_PARENT, 0, 1, 2, 1}));
+
+    // 一次线性遍历得到的模型矩阵与递归遍历节点树的结果相同
+    std::map<std::string, glm::mat4> expected;
+    const auto walk = [&](const auto& self, const Node& node, const glm::mat4& parent) -> void {
+        const glm::mat4 global = parent * glm::translate(glm::mat4{1.f}, node.offset);
+        expected[node.name] = global;
+        for (const auto* child : node.children) {
+            self(self, *child, global);
+        }
+    };
+    walk(walk, root, glm::mat4{1.f});
+    graphics::animation::LocalPose pose;
+    graphics::animation::samplePose(skeleton, {}, 0.f, pose);
+    std::vector<glm::mat4> model;
+    std::vector<glm::mat4> palette;
+    graphics::animation::buildPalette(skeleton, pose, model, palette);
+    for (std::size_t joint = 0; joint < names.size(); ++joint) {
+        expectMatrixNear(model[joint], expected[names[joint]]);
+    }
+}
+
+TEST(Animation, RotationQuantizationError) {
+    for (int i = 0; i < 200; ++i) {
+        const auto f = static_cast<float>(i);
+        const glm::vec3 axis{std::sin(f * 1.3f), std::cos(f * 0.7f), std::sin(f * 2.1f) + 0.1f};
+        const glm::quat rotation = glm::angleAxis(f * 0.37f, glm::normalize(axis));
+        const glm::quat decoded =
+            graphics::animation::decodeRotation(graphics::animation::encodeRotation(rotation));
+        // 15 位分量的角度误差在 1e-4 弧度量级
+        EXPECT_LT(rotationAngle(decoded, rotation), 5e-4f) << "sample " << i;
+    }
+}
+
+TEST(Animation, CompressedClipRoundTrip) {
+    using namespace graphics::animation;
+    TestRig rig;
+    // 关节 3 加一条匀速平移和一条常量旋转，中间的键都是多余的
+    std::vector<float> times;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::quat> rotations;
+    for (int key = 0; key <= 50; ++key) {
+        times.push_back(static_cast<float>(key) * 0.2f);
+        positions.push_back(glm::vec3{1.f, 0.f, 0.f} +
+                            (glm::vec3{0.f, 0.1f, -0.3f} * times.back()));
+        rotations.push_back(glm::angleAxis(0.3f, glm::vec3{0.f, 0.f, 1.f}));
+    }
+    rig.clip.translations.set(3, times, positions);
+    rig.clip.rotations.set(3, times, rotations);
+
+    const auto compressed = compressClip(rig.clip);
+    EXPECT_EQ(compressed.translations.tracks[3].count, 2U);
+    EXPECT_EQ(compressed.rotations.tracks[3].count, 1U);
+    // 其他轨道的键都不在一条直线上
+    EXPECT_EQ(compressed.translations.tracks[1].count, 3U);
+
+    std::stringstream stream;
+    writeCompressedClip(stream, compressed);
+    const auto loaded = readCompressedClip(stream);
+    ASSERT_TRUE(loaded.has_value());
+    const auto clip = decompressClip(*loaded);
+    EXPECT_EQ(clip.translations.values, decompressClip(compressed).translations.values);
+
+    LocalPose reference;
+    LocalPose pose;
+    for (float time = 0.f; time <= 10.f; time += 0.25f) {
+        samplePose(rig.skeleton, rig.clip, time, reference);
+        samplePose(rig.skeleton, clip, time, pose);
+        for (std::size_t joint = 0; joint < rig.skeleton.jointCount(); ++joint) {
+            EXPECT_NEAR(glm::length(pose.translation(joint) - reference.translation(joint)), 0.f,
+                        1e-3f);
+            EXPECT_LT(rotationAngle(pose.rotation(joint), reference.rotation(joint)), 1e-3f);
+            EXPECT_NEAR(glm::length(pose.scale(joint) - reference.scale(joint)), 0.f, 1e-3f);
+        }
+    }
+
+    // 截断的数据读取失败
+    const std::string bytes = stream.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+    EXPECT_FALSE(readCompressedClip(truncated).has_value());
+}
@@ -0,0 +1,483 @@
+#include <gtest/gtest.h>
+#include "system/transform_hierarchy.hpp"
+#include "system/culling_bvh.hpp"
+#include "system/embree_picker.hpp"
+#include "system/pick_system.hpp"
+#include "system/occlusion_buffer.hpp"
+#include "system/spatial_grid.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+namespace {
+void expectMatrixNear(const glm::mat4& actual, const glm::mat4& expected) {
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            EXPECT_NEAR(actual[column][row], expected[column][row], 1e-5f)
+                << "column " << column << " row " << row;
+        }
+    }
+}
+
+// 与 core::Camera::setPerspectiveProjection 相同（+z 朝前，深度 0..1）
+auto perspective(float fovy, float aspect, float near, float far) -> glm::mat4 {
+    const float tan_half_fovy = std::tan(fovy / 2.f);
+    glm::mat4 projection{0.f};
+    projection[0][0] = 1.f / (aspect * tan_half_fovy);
+    projection[1][1] = 1.f / tan_half_fovy;
+    projection[2][2] = far / (far - near);
+    projection[2][3] = 1.f;
+    projection[3][2] = -(far * near) / (far - near);
+    return projection;
+}
+
+// 浮点运算顺序不同，只允许 p 顶点刚好落在某个平面上的包围盒有差异
+auto onBoundary(const core::Frustum& frustum, const core::AABB& box) -> bool {
+    for (const auto& plane : frustum.planes()) {
+        const glm::vec3 normal{plane};
+        const float distance = glm::dot(normal, box.center()) + plane.w +
+                               glm::dot(box.extent(), glm::abs(normal));
+        if (std::abs(distance) < 1e-3f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void expectMatchesFrustum(const graphics::CullingBvh& bvh, const core::Frustum& frustum) {
+    std::size_t visible = 0;
+    for (graphics::CullingBvh::proxy_t proxy = 0; proxy < bvh.size(); ++proxy) {
+        const auto& bounds = bvh.worldBounds(proxy);
+        if (!onBoundary(frustum, bounds)) {
+            EXPECT_EQ(bvh.visible(proxy), frustum.intersects(bounds)) << "proxy " << proxy;
+        }
+        visible += bvh.visible(proxy) ? 1 : 0;
+    }
+    // 场景同时包含视锥内外的物体，确认两条路径都被覆盖
+    EXPECT_GT(visible, 0U);
+    EXPECT_LT(visible, bvh.size());
+}
+}  // namespace
+
+TEST(TransformHierarchy, MatchesTransformComponent) {
+    // 超过一个批次，覆盖不满 8 个的尾部
+    constexpr std::size_t count = 11;
+    std::vector<ecs::TransformComponent> locals;
+    std::vector<ecs::WorldTransformComponent> worlds(count);
+    locals.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto f = static_cast<float>(i);
+        locals.emplace_back(glm::vec3{f, -2.f * f, 0.5f}, glm::vec3{1.f + (0.1f * f), 2.f, 0.5f},
+                            glm::vec3{0.3f * f, -0.7f + f, 1.1f * f});
+    }
+    graphics::TransformHierarchy hierarchy;
+    for (std::size_t i = 0; i < count; ++i) {
+        hierarchy.add(&locals[i], &worlds[i]);
+    }
+    EXPECT_EQ(hierarchy.update(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        expectMatrixNear(worlds[i].world, locals[i].mat4());
+        expectMatrixNear(worlds[i].normal, glm::mat4(locals[i].normalMatrix()));
+        EXPECT_EQ(worlds[i].version, 1U);
+    }
+}
+
+TEST(TransformHierarchy, PropagatesOnlyDirtySubtrees) {
+    ecs::TransformComponent root_local{glm::vec3{1.f, 2.f, 3.f}};
+    ecs::TransformComponent child_local{glm::vec3{0.f, 1.f, 0.f}, glm::vec3{2.f},
+                                        glm::vec3{0.f, 0.5f, 0.f}};
+    ecs::TransformComponent other_local{glm::vec3{-4.f, 0.f, 0.f}};
+    ecs::WorldTransformComponent root;
+    ecs::WorldTransformComponent child;
+    ecs::WorldTransformComponent other;
+
+    graphics::TransformHierarchy hierarchy;
+    const auto root_node = hierarchy.add(&root_local, &root);
+    hierarchy.add(&child_local, &child, root_node);
+    hierarchy.add(&other_local, &other);
+    EXPECT_EQ(hierarchy.update(), 3U);
+    expectMatrixNear(child.world, root_local.mat4() * child_local.mat4());
+
+    // 没有变化时不重算，version 保持不变
+    EXPECT_EQ(hierarchy.update(), 0U);
+    EXPECT_EQ(root.version, 1U);
+    EXPECT_EQ(child.version, 1U);
+
+    // 父节点变化时子节点跟着重算，无关节点不动
+    root_local.rotation.y = 1.f;
+    EXPECT_EQ(hierarchy.update(), 2U);
+    EXPECT_EQ(child.version, 2U);
+    EXPECT_EQ(other.version, 1U);
+    expectMatrixNear(child.world, root_local.mat4() * child_local.mat4());
+}
+
+TEST(TransformHierarchy, ReusesRemovedRootSlots) {
+    ecs::TransformComponent first_local{glm::vec3{1.f, 0.f, 0.f}};
+    ecs::TransformComponent second_local{glm::vec3{0.f, 2.f, 0.f}};
+    ecs::TransformComponent third_local{glm::vec3{0.f, 0.f, 3.f}, glm::vec3{2.f}};
+    ecs::WorldTransformComponent first;
+    ecs::WorldTransformComponent second;
+    ecs::WorldTransformComponent third;
+
+    graphics::TransformHierarchy hierarchy;
+    const auto first_node = hierarchy.add(&first_local, &first);
+    hierarchy.add(&second_local, &second);
+    hierarchy.remove(first_node);
+    // 删除的节点不再读写组件
+    first_local.translation.x = 5.f;
+    EXPECT_EQ(hierarchy.update(), 1U);
+    EXPECT_EQ(first.version, 0U);
+    EXPECT_EQ(hierarchy.size(), 1U);
+
+    EXPECT_EQ(hierarchy.add(&third_local, &third), first_node);
+    EXPECT_EQ(hierarchy.size(), 2U);
+    EXPECT_EQ(hierarchy.update(), 1U);
+    expectMatrixNear(third.world, third_local.mat4());
+    EXPECT_EQ(second.version, 1U);
+}
+
+TEST(Frustum, FromNdcRectKeepsPointsInsideRect) {
+    const glm::mat4 view_proj = perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 50.f) *
+                                glm::translate(glm::mat4{1.f}, glm::vec3{0.f, 0.f, 30.f});
+    // 整个 NDC 范围得到原来的视锥
+    const auto full = core::Frustum::fromNdcRect(view_proj, glm::vec2{-1.f}, glm::vec2{1.f});
+    const core::Frustum reference{view_proj};
+    for (std::size_t plane = 0; plane < core::Frustum::Count; ++plane) {
+        EXPECT_NEAR(glm::length(full.planes()[plane] - reference.planes()[plane]), 0.f, 1e-5f);
+    }
+
+    const glm::vec2 ndc_min{-0.5f, 0.1f};
+    const glm::vec2 ndc_max{0.2f, 0.8f};
+    const auto sub = core::Frustum::fromNdcRect(view_proj, ndc_min, ndc_max);
+    const glm::mat4 inverse = glm::inverse(view_proj);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> ndc(-1.f, 1.f);
+    std::uniform_real_distribution<float> depth(0.05f, 0.95f);
+    std::size_t inside = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const glm::vec2 point{ndc(rng), ndc(rng)};
+        const glm::vec2 distance = glm::min(glm::abs(point - ndc_min), glm::abs(point - ndc_max));
+        if (std::min(distance.x, distance.y) < 1e-3f) {
+            continue;
+        }
+        const glm::vec4 world = inverse * glm::vec4{point, depth(rng), 1.f};
+        const bool expected = glm::all(glm::greaterThanEqual(point, ndc_min)) &&
+                              glm::all(glm::lessThanEqual(point, ndc_max));
+        EXPECT_EQ(sub.contains(glm::vec3{world} / world.w), expected) << "sample " << i;
+        inside += expected ? 1 : 0;
+    }
+    EXPECT_GT(inside, 0U);
+}
+
+TEST(EmbreePicker, PickFrustumReturnsMeshesInsideRect) {
+    const glm::mat4 view_proj = perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 50.f) *
+                                glm::translate(glm::mat4{1.f}, glm::vec3{0.f, 0.f, 30.f});
+    // 一个直角三角形，分别放在视野左侧、右侧和相机后面
+    const std::array<glm::vec3, 3> triangle{glm::vec3{-1.f, -1.f, 0.f}, glm::vec3{1.f, -1.f, 0.f},
+                                            glm::vec3{-1.f, 1.f, 0.f}};
+    const std::array<std::uint32_t, 3> indices{0, 1, 2};
+    const std::array<glm::vec3, 3> positions{glm::vec3{-6.f, 0.f, 0.f}, glm::vec3{6.f, 0.f, 0.f},
+                                             glm::vec3{0.f, 0.f, -40.f}};
+    constexpr id_t MODEL = 100;
+    graphics::EmbreePicker picker;
+    for (id_t mesh = 0; mesh < positions.size(); ++mesh) {
+        picker.buildMesh(MODEL, mesh, triangle, indices);
+        picker.updateTransform(mesh, glm::translate(glm::mat4{1.f}, positions[mesh]));
+    }
+    picker.commit();
+
+    const auto left = core::Frustum::fromNdcRect(view_proj, glm::vec2{-1.f}, {0.f, 1.f});
+    for (const bool precise : {false, true}) {
+        const auto results = picker.pickFrustum(left, precise);
+        ASSERT_EQ(results.size(), 1U);
+        EXPECT_EQ(results[0].id, 0U);
+        EXPECT_EQ(results[0].model_id, MODEL);
+    }
+
+    // 斜放在深度方向上的三角形：包围盒与窄视锥相交，三个顶点都在它的左平面外侧
+    const std::array<glm::vec3, 3> oblique{glm::vec3{-1.f, 0.f, -20.f}, glm::vec3{-4.f, 0.f, 0.f},
+                                           glm::vec3{-4.f, 0.f, -20.f}};
+    picker.buildMesh(MODEL, 3, oblique, indices);
+    picker.updateTransform(3, glm::mat4{1.f});
+    picker.commit();
+    const auto toNdc = [&](const glm::vec3& point) {
+        const glm::vec4 clip = view_proj * glm::vec4{point, 1.f};
+        return glm::vec2{clip} / clip.w;
+    };
+    const auto narrow = core::Frustum::fromNdcRect(
+        view_proj, {toNdc({-1.5f, 0.f, 0.f}).x, -.1f}, {0.f, .1f});
+    const auto coarse = picker.pickFrustum(narrow, false);
+    ASSERT_EQ(coarse.size(), 1U);
+    EXPECT_EQ(coarse[0].id, 3U);
+    EXPECT_TRUE(picker.pickFrustum(narrow, true).empty());
+}
+
+TEST(CullingBvh, MatchesFrustumTest) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-60.f, 60.f);
+    std::uniform_real_distribution<float> size(0.1f, 4.f);
+    const glm::mat4 view = glm::translate(glm::mat4{1.f}, glm::vec3{0.f, 0.f, 30.f});
+    const core::Frustum frustum{perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 50.f) * view};
+
+    // 数量不是叶子大小和 SIMD 宽度的整数倍，覆盖不满的叶子
+    constexpr std::size_t count = 1003;
+    graphics::CullingBvh bvh;
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec3 extent{size(rng), size(rng), size(rng)};
+        bvh.add(core::AABB{.min = -extent, .max = extent});
+    }
+    std::vector<glm::mat4> transforms(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        transforms[i] =
+            glm::translate(glm::mat4{1.f}, glm::vec3{position(rng), position(rng), position(rng)});
+        bvh.setTransform(static_cast<graphics::CullingBvh::proxy_t>(i), transforms[i]);
+    }
+    bvh.cull(frustum);
+    expectMatchesFrustum(bvh, frustum);
+
+    // 只有部分物体移动时走 refit，结果仍然一致
+    for (std::size_t i = 0; i < count; i += 3) {
+        transforms[i] = glm::rotate(transforms[i], 0.7f, glm::vec3{0.f, 1.f, 0.f});
+        transforms[i][3] += glm::vec4{5.f, -3.f, 8.f, 0.f};
+        bvh.setTransform(static_cast<graphics::CullingBvh::proxy_t>(i), transforms[i]);
+    }
+    bvh.cull(frustum);
+    expectMatchesFrustum(bvh, frustum);
+
+    bvh.markAllVisible();
+    for (graphics::CullingBvh::proxy_t proxy = 0; proxy < count; ++proxy) {
+        EXPECT_TRUE(bvh.visible(proxy));
+    }
+}
+
+TEST(CullingBvh, RemovedProxiesAreNeverVisible) {
+    const glm::mat4 view = glm::translate(glm::mat4{1.f}, glm::vec3{0.f, 0.f, 10.f});
+    const core::Frustum frustum{perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 50.f) * view};
+    const core::AABB box{.min = glm::vec3{-1.f}, .max = glm::vec3{1.f}};
+    graphics::CullingBvh bvh;
+    for (int i = 0; i < 3; ++i) {
+        bvh.add(box);
+    }
+    bvh.remove(1);
+    EXPECT_EQ(bvh.size(), 2U);
+    bvh.cull(frustum);
+    EXPECT_TRUE(bvh.visible(0));
+    EXPECT_FALSE(bvh.visible(1));
+    EXPECT_TRUE(bvh.visible(2));
+    bvh.markAllVisible();
+    EXPECT_FALSE(bvh.visible(1));
+
+    // 编号被复用，重新进入树
+    EXPECT_EQ(bvh.add(box), 1U);
+    bvh.cull(frustum);
+    EXPECT_TRUE(bvh.visible(1));
+}
+
+TEST(CullingBvh, MultiViewMatchesSeparateCulls) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> position(-60.f, 60.f);
+    std::uniform_real_distribution<float> size(0.1f, 4.f);
+    const glm::mat4 projection = perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 50.f);
+    // 主视图、转向侧面的视图、远处的窄视图，第四个视图不启用
+    const std::array<core::Frustum, 4> views{
+        core::Frustum{projection * glm::translate(glm::mat4{1.f}, glm::vec3{0.f, 0.f, 30.f})},
+        core::Frustum{projection * glm::rotate(glm::mat4{1.f}, 1.5f, glm::vec3{0.f, 1.f, 0.f})},
+        core::Frustum{perspective(glm::radians(20.f), 1.f, 0.1f, 120.f) *
+                      glm::translate(glm::mat4{1.f}, glm::vec3{10.f, 0.f, 70.f})},
+        core::Frustum{projection}};
+    constexpr graphics::CullingBvh::view_mask_t mask = 0b0111;
+
+    constexpr std::size_t count = 1003;
+    graphics::CullingBvh bvh;
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec3 extent{size(rng), size(rng), size(rng)};
+        bvh.add(core::AABB{.min = -extent, .max = extent});
+        bvh.setTransform(
+            static_cast<graphics::CullingBvh::proxy_t>(i),
+            glm::translate(glm::mat4{1.f}, glm::vec3{position(rng), position(rng), position(rng)}));
+    }
+    bvh.cull(views, mask);
+    std::vector<graphics::CullingBvh::view_mask_t> combined(count);
+    for (graphics::CullingBvh::proxy_t proxy = 0; proxy < count; ++proxy) {
+        combined[proxy] = bvh.viewMask(proxy);
+        EXPECT_FALSE(bvh.visible(proxy, 3));
+    }
+    for (std::uint32_t view = 0; view < 3; ++view) {
+        bvh.cull(views[view]);
+        expectMatchesFrustum(bvh, views[view]);
+        for (graphics::CullingBvh::proxy_t proxy = 0; proxy < count; ++proxy) {
+            EXPECT_EQ((combined[proxy] >> view) & 1U, bvh.visible(proxy) ? 1U : 0U)
+                << "view " << view << " proxy " << proxy;
+        }
+    }
+}
+
+TEST(CullingBvh, ComputeBoundsUsesIndexedVertices) {
+    const std::vector<glm::vec3> vertices{
+        {0.f, 0.f, 0.f}, {1.f, 2.f, 3.f}, {-1.f, 5.f, 0.5f}, {100.f, 100.f, 100.f}};
+    const std::vector<std::uint32_t> indices{0, 1, 2};
+    const auto bounds = graphics::computeBounds(vertices, indices);
+    EXPECT_EQ(bounds.min, glm::vec3(-1.f, 0.f, 0.f));
+    EXPECT_EQ(bounds.max, glm::vec3(1.f, 5.f, 3.f));
+}
+
+TEST(OcclusionBuffer, HidesBoxesBehindOccluder) {
+    // 相机在原点朝 +z，z = 10 处有一面 10 x 10 的墙
+    const std::vector<glm::vec3> wall{
+        {-5.f, -5.f, 10.f}, {5.f, -5.f, 10.f}, {5.f, 5.f, 10.f}, {-5.f, 5.f, 10.f}};
+    const std::vector<std::uint32_t> indices{0, 1, 2, 0, 2, 3};
+    graphics::OcclusionBuffer occlusion;
+    const auto occluder = occlusion.addOccluder(wall, indices);
+    ASSERT_NE(occluder, graphics::OcclusionBuffer::INVALID_OCCLUDER);
+    occlusion.render(perspective(glm::radians(90.f), 16.f / 9.f, 0.1f, 100.f));
+
+    EXPECT_LT(occlusion.depth(graphics::OcclusionBuffer::WIDTH / 2,
+                              graphics::OcclusionBuffer::HEIGHT / 2),
+              1.f);
+    const core::AABB behind{.min = {-1.f, -1.f, 19.f}, .max = {1.f, 1.f, 21.f}};
+    const core::AABB in_front{.min = {-1.f, -1.f, 4.f}, .max = {1.f, 1.f, 6.f}};
+    const core::AABB beside{.min = {12.f, -1.f, 19.f}, .max = {14.f, 1.f, 21.f}};
+    const core::AABB crossing_near{.min = {-1.f, -1.f, -1.f}, .max = {1.f, 1.f, 2.f}};
+    const core::AABB wall_bounds{.min = {-5.f, -5.f, 10.f}, .max = {5.f, 5.f, 10.f}};
+    EXPECT_TRUE(occlusion.occluded(behind));
+    EXPECT_FALSE(occlusion.occluded(in_front));
+    EXPECT_FALSE(occlusion.occluded(beside));
+    EXPECT_FALSE(occlusion.occluded(crossing_near));
+    // 遮挡体不会把自己剔除
+    EXPECT_FALSE(occlusion.occluded(wall_bounds));
+
+    // 墙移开后不再遮挡
+    occlusion.setTransform(occluder, glm::translate(glm::mat4{1.f}, glm::vec3{30.f, 0.f, 0.f}));
+    occlusion.render(perspective(glm::radians(90.f), 16.f / 9.f, 0.1f, 100.f));
+    EXPECT_FALSE(occlusion.occluded(behind));
+}
+
+TEST(OcclusionBuffer, RemovedOccluderStopsHiding) {
+    const std::vector<glm::vec3> wall{
+        {-5.f, -5.f, 10.f}, {5.f, -5.f, 10.f}, {5.f, 5.f, 10.f}, {-5.f, 5.f, 10.f}};
+    const std::vector<std::uint32_t> indices{0, 1, 2, 0, 2, 3};
+    const glm::mat4 view_proj = perspective(glm::radians(90.f), 16.f / 9.f, 0.1f, 100.f);
+    const core::AABB behind{.min = {-1.f, -1.f, 19.f}, .max = {1.f, 1.f, 21.f}};
+    graphics::OcclusionBuffer occlusion;
+    const auto occluder = occlusion.addOccluder(wall, indices);
+    occlusion.removeOccluder(occluder);
+    EXPECT_EQ(occlusion.size(), 0U);
+    occlusion.render(view_proj);
+    EXPECT_FALSE(occlusion.occluded(behind));
+
+    // render 中压缩掉失效的三角形之后，编号才会复用
+    EXPECT_EQ(occlusion.addOccluder(wall, indices), occluder);
+    EXPECT_EQ(occlusion.size(), 1U);
+    occlusion.render(view_proj);
+    EXPECT_TRUE(occlusion.occluded(behind));
+}
+
+TEST(OcclusionBuffer, RejectsDenseMeshes) {
+    const std::vector<glm::vec3> vertices{{0.f, 0.f, 1.f}, {1.f, 0.f, 1.f}, {0.f, 1.f, 1.f}};
+    std::vector<std::uint32_t> indices;
+    for (std::size_t i = 0; i <= graphics::OcclusionBuffer::MAX_OCCLUDER_TRIANGLES; ++i) {
+        indices.insert(indices.end(), {0, 1, 2});
+    }
+    graphics::OcclusionBuffer occlusion;
+    EXPECT_EQ(occlusion.addOccluder(vertices, indices),
+              graphics::OcclusionBuffer::INVALID_OCCLUDER);
+    EXPECT_EQ(occlusion.size(), 0U);
+}
+
+namespace {
+auto sortedQuery(const std::vector<std::uint32_t>& values) -> std::vector<std::uint32_t> {
+    auto result = values;
+    std::ranges::sort(result);
+    return result;
+}
+
+auto sphereOverlaps(const core::AABB& box, const glm::vec3& center, float radius) -> bool {
+    const glm::vec3 delta = glm::clamp(center, box.min, box.max) - center;
+    return glm::dot(delta, delta) <= radius * radius;
+}
+
+auto randomBoxes(std::size_t count, float range, float max_size, unsigned seed)
+    -> std::vector<core::AABB> {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(-range, range);
+    std::uniform_real_distribution<float> size(0.1f, max_size);
+    std::vector<core::AABB> boxes(count);
+    for (auto& box : boxes) {
+        const glm::vec3 min{position(rng), position(rng), position(rng)};
+        box = {.min = min, .max = min + glm::vec3{size(rng), size(rng), size(rng)}};
+    }
+    return boxes;
+}
+}  // namespace
+
+TEST(SpatialGrid, MatchesBruteForce) {
+    // 尺寸上限大于格子，覆盖跨格子的物体；最后一个物体超过 MAX_ITEM_CELLS 走单独的列表
+    auto boxes = randomBoxes(500, 40.f, 6.f, 11);
+    boxes.push_back({.min = glm::vec3{-50.f}, .max = glm::vec3{50.f}});
+    graphics::SpatialGrid grid{2.f};
+    std::vector<graphics::SpatialGrid::item_t> items;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        items.push_back(grid.insert(boxes[i], static_cast<std::uint32_t>(i)));
+    }
+    std::vector<bool> alive(boxes.size(), true);
+
+    const auto check = [&](const glm::vec3& center, float radius) {
+        std::vector<std::uint32_t> expected;
+        std::vector<std::uint32_t> expected_box;
+        const core::AABB query{.min = center - glm::vec3{radius},
+                               .max = center + glm::vec3{radius}};
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            if (!alive[i]) {
+                continue;
+            }
+            if (sphereOverlaps(boxes[i], center, radius)) {
+                expected.push_back(static_cast<std::uint32_t>(i));
+            }
+            if (glm::all(glm::lessThanEqual(boxes[i].min, query.max)) &&
+                glm::all(glm::lessThanEqual(query.min, boxes[i].max))) {
+                expected_box.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+        std::vector<std::uint32_t> actual;
+        grid.queryRadius(center, radius, actual);
+        EXPECT_EQ(sortedQuery(actual), expected) << "radius " << radius;
+        actual.clear();
+        grid.queryAabb(query, actual);
+        EXPECT_EQ(sortedQuery(actual), expected_box) << "aabb " << radius;
+    };
+    // 小半径走逐格子查找，大半径走遍历已占用格子
+    for (const float radius : {0.5f, 3.f, 12.f, 200.f}) {
+        check(glm::vec3{1.f, -2.f, 3.f}, radius);
+    }
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> offset(-3.f, 3.f);
+    for (std::size_t i = 0; i < boxes.size(); i += 2) {
+        const glm::vec3 delta{offset(rng), offset(rng), offset(rng)};
+        boxes[i] = {.min = boxes[i].min + delta, .max = boxes[i].max + delta};
+        grid.update(items[i], boxes[i]);
+    }
+    for (std::size_t i = 1; i < boxes.size(); i += 5) {
+        grid.remove(items[i]);
+        alive[i] = false;
+    }
+    EXPECT_EQ(grid.size(), static_cast<std::size_t>(std::ranges::count(alive, true)));
+    for (const float radius : {0.5f, 3.f, 12.f, 200.f}) {
+        check(glm::vec3{-4.f, 5.f, 0.f}, radius);
+    }
+
+    const glm::mat4 view = glm::translate(glm::mat4{1.f}, glm::vec3{0.f, 0.f, 30.f});
+    const core::Frustum frustum{perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 50.f) * view};
+    std::vector<std::uint32_t> expected;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        if (alive[i] && frustum.intersects(boxes[i])) {
+            expected.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    std::vector<std::uint32_t> actual;
+    grid.queryFrustum(frustum, actual);
+    EXPECT_EQ(sortedQuery(actual), expected);
+}
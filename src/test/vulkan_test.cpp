@@ -1,9 +1,17 @@
 #include "render_core/vulkan_common/vk_instance.hpp"
 #include "render_core/vulkan_common/device.hpp"
+#include "render_core/vulkan_common/memory_allocator.hpp"
 #include "shader_tools/shader_compile.hpp"
+#include "render_core/object_id.hpp"
+#include "render_core/draw_list.hpp"
+#include "render_core/null_graphic.hpp"
 #include "model_vert_spv.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <optional>
 #include <print>
+#include <vector>
 // Demonstrate some basic assertions.
 
 TEST(VulkanInstance, CreateInstance) {
@@ -20,4 +28,390 @@ TEST(Shader, ShaderCompile) {
     shader::Info vertex_info = shader::compile::getShaderInfo(MODEL_VERT_SPV);
     std::println("vertex into {}", vertex_info.image_buffer_descriptors.size());
     // shaderCompile.compile("./shaders", "./shaders/build");
-}
\ No newline at end of file
+}
+namespace {
+// 模拟 ID 渲染目标：两个已知 ID 的矩形，其余像素 coverage 为 0
+auto makeIdTarget(std::uint32_t width, std::uint32_t height) -> std::vector<render::ObjectId> {
+    std::vector<render::ObjectId> target(static_cast<size_t>(width) * height);
+    auto fill = [&](std::uint32_t x0, std::uint32_t y0, std::uint32_t x1, std::uint32_t y1,
+                    render::ObjectId id) {
+        for (auto y = y0; y < y1; ++y) {
+            for (auto x = x0; x < x1; ++x) {
+                target[(static_cast<size_t>(y) * width) + x] = id;
+            }
+        }
+    };
+    fill(8, 8, 24, 24, {.model_id = 3, .mesh_id = 7, .primitive_id = 1, .coverage = 1});
+    fill(40, 8, 56, 24, {.model_id = 4, .mesh_id = 9, .primitive_id = 0, .coverage = 1});
+    return target;
+}
+
+// 与 GPU 的 copyImageToBuffer 一样按区域拷贝
+auto readRegion(const std::vector<render::ObjectId>& target, std::uint32_t width,
+                render::ObjectIdReadback readback) -> render::ObjectIdReadback {
+    const auto& region = readback.region;
+    for (std::uint32_t row = 0; row < region.height; ++row) {
+        for (std::uint32_t col = 0; col < region.width; ++col) {
+            readback.ids.push_back(
+                target[(static_cast<size_t>(region.y + row) * width) + region.x + col]);
+        }
+    }
+    return readback;
+}
+}  // namespace
+
+TEST(ObjectId, ResolveKnownGeometry) {
+    constexpr std::uint32_t width = 64;
+    constexpr std::uint32_t height = 32;
+    const auto target = makeIdTarget(width, height);
+
+    auto first = readRegion(
+        target, width,
+        render::makeObjectIdReadback({.u = 16.5f / width, .v = 16.5f / height}, width, height));
+    auto id = render::resolveObjectId(first);
+    ASSERT_TRUE(id.has_value());
+    EXPECT_EQ(id->model_id, 3U);
+    EXPECT_EQ(id->mesh_id, 7U);
+
+    auto second = readRegion(
+        target, width,
+        render::makeObjectIdReadback({.u = 48.5f / width, .v = 8.5f / height}, width, height));
+    id = render::resolveObjectId(second);
+    ASSERT_TRUE(id.has_value());
+    EXPECT_EQ(id->model_id, 4U);
+    EXPECT_EQ(id->mesh_id, 9U);
+
+    // 中心落在空白处但半径内有覆盖像素，取最近的那个
+    auto edge = readRegion(
+        target, width,
+        render::makeObjectIdReadback({.u = 25.5f / width, .v = 16.5f / height}, width, height));
+    id = render::resolveObjectId(edge);
+    ASSERT_TRUE(id.has_value());
+    EXPECT_EQ(id->model_id, 3U);
+
+    auto empty = readRegion(
+        target, width,
+        render::makeObjectIdReadback({.u = 32.5f / width, .v = 28.5f / height}, width, height));
+    EXPECT_FALSE(render::resolveObjectId(empty).has_value());
+}
+
+TEST(ObjectId, ReadbackRegionClamp) {
+    auto readback = render::makeObjectIdReadback({.u = 0.f, .v = 1.f, .radius = 2}, 64, 32);
+    EXPECT_EQ(readback.region.x, 0);
+    EXPECT_EQ(readback.region.y, 29);
+    EXPECT_EQ(readback.region.width, 3U);
+    EXPECT_EQ(readback.region.height, 3U);
+    EXPECT_EQ(readback.center_x, 0U);
+    EXPECT_EQ(readback.center_y, 31U);
+
+    auto none = render::makeObjectIdReadback({.u = 0.5f, .v = 0.5f}, 0, 0);
+    EXPECT_EQ(none.region.width, 0U);
+    EXPECT_FALSE(render::resolveObjectId(none).has_value());
+}
+
+TEST(ObjectId, EncodeRoundTrip) {
+    for (std::uint32_t id : {0U, 1U, 12345U, render::MAX_ENCODABLE_OBJECT_ID - 1,
+                             render::MAX_ENCODABLE_OBJECT_ID}) {
+        EXPECT_EQ(static_cast<std::uint32_t>(render::encodeObjectId(id)), id);
+    }
+}
+
+// 在真实的 R32G32B32A32_UINT 附件上写入两个物体的 ID，再按 recordObjectIdReadback
+// 的方式拷贝区域回读，检查 GPU 路径上的格式、行序和坐标与 CPU 解析一致
+TEST(ObjectId, OffscreenReadback) {
+    // 没有可用的 Vulkan 驱动时跳过，CI 上一般是 lavapipe
+    std::optional<render::vulkan::Instance> instance;
+    std::optional<render::vulkan::Device> vulkan_device;
+    try {
+        instance.emplace(render::vulkan::createInstance(VK_API_VERSION_1_3));
+        const auto physicals = instance->EnumeratePhysicalDevices();
+        if (physicals.empty()) {
+            GTEST_SKIP() << "no vulkan device";
+        }
+        vulkan_device.emplace(**instance, physicals.front(), vk::SurfaceKHR{});
+    } catch (const std::exception& e) {
+        GTEST_SKIP() << "no vulkan device: " << e.what();
+    }
+    const auto& device = *vulkan_device;
+    render::vulkan::MemoryAllocator allocator(device);
+    constexpr std::uint32_t width = 64;
+    constexpr std::uint32_t height = 32;
+    constexpr auto format = vk::Format::eR32G32B32A32Uint;
+
+    const VkImageCreateInfo image_ci{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = static_cast<VkFormat>(format),
+        .extent = {.width = width, .height = height, .depth = 1},
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices = nullptr,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    auto image = allocator.createImage(image_ci);
+    auto image_view = device.logical().CreateImageView(vk::ImageViewCreateInfo{
+        {},
+        *image,
+        vk::ImageViewType::e2D,
+        format,
+        {},
+        vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}});
+
+    const auto requests = std::array{
+        render::ObjectIdRequest{.u = 16.5f / width, .v = 16.5f / height},
+        render::ObjectIdRequest{.u = 48.5f / width, .v = 8.5f / height},
+        render::ObjectIdRequest{.u = 25.5f / width, .v = 16.5f / height},
+        render::ObjectIdRequest{.u = 32.5f / width, .v = 28.5f / height},
+    };
+    std::vector<render::ObjectIdReadback> readbacks;
+    std::vector<render::vulkan::Buffer> buffers;
+    for (const auto& request : requests) {
+        auto& readback =
+            readbacks.emplace_back(render::makeObjectIdReadback(request, width, height));
+        const VkBufferCreateInfo buffer_ci{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .size = static_cast<VkDeviceSize>(readback.region.width) * readback.region.height *
+                    sizeof(render::ObjectId),
+            .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr,
+        };
+        buffers.push_back(
+            allocator.createBuffer(buffer_ci, render::vulkan::MemoryUsage::Download));
+    }
+
+    auto pool = device.logical().createCommandPool(
+        vk::CommandPoolCreateInfo().setQueueFamilyIndex(device.getGraphicsFamily()));
+    auto cmdbufs = pool.Allocate(1);
+    vk::CommandBuffer cmdbuf{cmdbufs[0]};
+    cmdbuf.begin(vk::CommandBufferBeginInfo().setFlags(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+    const auto range = vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+    const auto to_attachment = vk::ImageMemoryBarrier()
+                                   .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
+                                   .setOldLayout(vk::ImageLayout::eUndefined)
+                                   .setNewLayout(vk::ImageLayout::eColorAttachmentOptimal)
+                                   .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                                   .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                                   .setImage(*image)
+                                   .setSubresourceRange(range);
+    cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                           vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {}, {},
+                           to_attachment);
+    // 背景 coverage 为 0，两个物体在渲染过程中写入附件，与 makeIdTarget 的布局相同
+    const auto attachment =
+        vk::RenderingAttachmentInfo()
+            .setImageView(*image_view)
+            .setImageLayout(vk::ImageLayout::eColorAttachmentOptimal)
+            .setLoadOp(vk::AttachmentLoadOp::eClear)
+            .setStoreOp(vk::AttachmentStoreOp::eStore)
+            .setClearValue(vk::ClearValue().setColor(
+                vk::ClearColorValue(std::array<std::uint32_t, 4>{0, 0, 0, 0})));
+    const auto rendering_info =
+        vk::RenderingInfo()
+            .setLayerCount(1)
+            .setRenderArea(vk::Rect2D().setExtent({width, height}))
+            .setColorAttachments(attachment);
+    cmdbuf.beginRendering(rendering_info);
+    auto fill = [&](std::int32_t x0, std::int32_t y0, std::uint32_t w, std::uint32_t h,
+                    std::array<std::uint32_t, 4> id) {
+        const auto clear = vk::ClearAttachment()
+                               .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                               .setColorAttachment(0)
+                               .setClearValue(vk::ClearValue().setColor(vk::ClearColorValue(id)));
+        const auto rect = vk::ClearRect(vk::Rect2D({x0, y0}, {w, h}), 0, 1);
+        cmdbuf.clearAttachments(clear, rect);
+    };
+    fill(8, 8, 16, 16, {3, 7, 1, 1});
+    fill(40, 8, 16, 16, {4, 9, 0, 1});
+    cmdbuf.endRendering();
+
+    const auto to_transfer = vk::ImageMemoryBarrier()
+                                 .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
+                                 .setDstAccessMask(vk::AccessFlagBits::eTransferRead)
+                                 .setOldLayout(vk::ImageLayout::eColorAttachmentOptimal)
+                                 .setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
+                                 .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                                 .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                                 .setImage(*image)
+                                 .setSubresourceRange(range);
+    cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                           vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, to_transfer);
+    for (std::size_t i = 0; i < readbacks.size(); ++i) {
+        const auto& region = readbacks[i].region;
+        const auto copy =
+            vk::BufferImageCopy()
+                .setImageSubresource({vk::ImageAspectFlagBits::eColor, 0, 0, 1})
+                .setImageOffset(vk::Offset3D{region.x, region.y, 0})
+                .setImageExtent(vk::Extent3D{region.width, region.height, 1});
+        cmdbuf.copyImageToBuffer(*image, vk::ImageLayout::eTransferSrcOptimal, *buffers[i],
+                                 copy);
+    }
+    const auto host_read = vk::MemoryBarrier()
+                               .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                               .setDstAccessMask(vk::AccessFlagBits::eHostRead);
+    cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                           vk::PipelineStageFlagBits::eHost, {}, host_read, {}, {});
+    cmdbuf.end();
+
+    auto fence = device.logical().createFence(vk::FenceCreateInfo{});
+    device.getGraphicsQueue().submit(vk::SubmitInfo().setCommandBuffers(cmdbuf), *fence);
+    ASSERT_EQ(fence.Wait(), vk::Result::eSuccess);
+
+    for (std::size_t i = 0; i < readbacks.size(); ++i) {
+        auto& ids = readbacks[i].ids;
+        ids.resize(static_cast<size_t>(readbacks[i].region.width) * readbacks[i].region.height);
+        buffers[i].Invalidate();
+        std::memcpy(ids.data(), buffers[i].Mapped().data(), ids.size() * sizeof(render::ObjectId));
+    }
+
+    auto id = render::resolveObjectId(readbacks[0]);
+    ASSERT_TRUE(id.has_value());
+    EXPECT_EQ(id->model_id, 3U);
+    EXPECT_EQ(id->mesh_id, 7U);
+    EXPECT_EQ(id->primitive_id, 1U);
+    id = render::resolveObjectId(readbacks[1]);
+    ASSERT_TRUE(id.has_value());
+    EXPECT_EQ(id->model_id, 4U);
+    EXPECT_EQ(id->mesh_id, 9U);
+    id = render::resolveObjectId(readbacks[2]);
+    ASSERT_TRUE(id.has_value());
+    EXPECT_EQ(id->model_id, 3U);
+    EXPECT_FALSE(render::resolveObjectId(readbacks[3]).has_value());
+}
+
+TEST(DrawList, SortKeyOrder) {
+    // 不透明先按状态分组，组内由近到远；透明物体在所有不透明物体之后，由远到近
+    EXPECT_LT(render::makeDrawSortKey(render::DrawPass::Opaque, 1, 0, 0, 100.f),
+              render::makeDrawSortKey(render::DrawPass::Opaque, 2, 0, 0, 1.f));
+    EXPECT_LT(render::makeDrawSortKey(render::DrawPass::Opaque, 1, 5, 3, 1.f),
+              render::makeDrawSortKey(render::DrawPass::Opaque, 1, 5, 3, 2.f));
+    EXPECT_LT(render::makeDrawSortKey(render::DrawPass::Opaque, 0xffff, 0xffff, 0x3fff, 1e9f),
+              render::makeDrawSortKey(render::DrawPass::Transparent, 0, 0, 0, 0.f));
+    EXPECT_LT(render::makeDrawSortKey(render::DrawPass::Transparent, 9, 0, 0, 50.f),
+              render::makeDrawSortKey(render::DrawPass::Transparent, 1, 0, 0, 10.f));
+    EXPECT_LT(render::quantizeSortDepth(1.f), render::quantizeSortDepth(1.5f));
+    EXPECT_EQ(render::quantizeSortDepth(-3.f), 0U);
+}
+
+TEST(DrawList, GroupsDrawsByState) {
+    const std::array textures{render::TextureId{7}};
+    const std::array<std::byte, 4> material{std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+    std::array<std::span<const std::byte>, 1> ubos{std::span<const std::byte>(material)};
+
+    render::DrawList list;
+    for (std::uint32_t i = 0; i < 6; ++i) {
+        render::DrawIndexCommand command;
+        command.shaders[0] = (i % 2) + 1;
+        command.textures = textures;
+        command.ubos = ubos;
+        command.mesh = render::MeshId{i % 2};
+        command.index_count = i;
+        command.sort_depth = static_cast<float>(10 - i);
+        if (i == 5) {
+            command.pipelineState.depthWriteEnable = 0;
+        }
+        list.push(command, 0, true);
+    }
+    list.sort();
+    ASSERT_EQ(list.size(), 6U);
+    EXPECT_EQ(list.item(5).index_count, 5U);
+    // 前 5 个不透明绘制中相同管线的相邻，且组内由近到远
+    for (std::size_t i = 1; i < 5; ++i) {
+        const auto& prev = list.item(i - 1);
+        const auto& item = list.item(i);
+        if (prev.shaders == item.shaders) {
+            EXPECT_LT(item.index_count, prev.index_count);
+        }
+        EXPECT_TRUE(list.sameMaterial(prev, item));
+    }
+    std::size_t switches = 0;
+    for (std::size_t i = 1; i < 5; ++i) {
+        switches += list.item(i - 1).shaders != list.item(i).shaders ? 1 : 0;
+    }
+    EXPECT_EQ(switches, 1U);
+    EXPECT_EQ(list.textures(list.item(0)).front(), render::TextureId{7});
+}
+
+TEST(DrawList, MergesRepeatedDrawsIntoInstances) {
+    const std::array textures{render::TextureId{3}};
+    std::array<std::array<std::byte, 8>, 4> push{};
+    render::DrawList list;
+    for (std::uint32_t i = 0; i < push.size(); ++i) {
+        push[i].fill(static_cast<std::byte>(i + 1));
+        render::DrawIndexCommand command;
+        command.shaders[0] = 1;
+        command.textures = textures;
+        command.push_constants = push[i];
+        command.mesh = render::MeshId{0};
+        command.index_count = 36;
+        command.sort_depth = static_cast<float>(i + 1);
+        // 最后一个没有实例化变体，不能合并
+        command.instanced_vertex_shader = i < 3 ? 9 : 0;
+        list.push(command, 0, true);
+    }
+    const std::array<std::byte, 16> explicit_instances{};
+    render::DrawInstanceCommand instanced;
+    instanced.shaders[0] = 2;
+    instanced.mesh = render::MeshId{1};
+    instanced.instanceCount = 2;
+    instanced.instance_data = explicit_instances;
+    instanced.index_count = 6;
+    list.push(instanced);
+    list.sort();
+
+    const auto batches = list.batches();
+    ASSERT_EQ(batches.size(), 3U);
+    const auto merged = std::ranges::find_if(batches, [](const auto& b) { return b.count == 3; });
+    ASSERT_NE(merged, batches.end());
+    EXPECT_TRUE(merged->instanced);
+    EXPECT_EQ(merged->vertex_shader, 9U);
+    EXPECT_EQ(merged->instance_count, 3U);
+    // 实例数据按排序后的顺序排列（由近到远），起点按 stride 对齐
+    const auto data = list.instanceData().subspan(merged->first_instance * 8, 24);
+    EXPECT_EQ(data[0], std::byte{1});
+    EXPECT_EQ(data[8], std::byte{2});
+    EXPECT_EQ(data[16], std::byte{3});
+
+    const auto explicit_batch =
+        std::ranges::find_if(batches, [](const auto& b) { return b.vertex_shader == 2; });
+    ASSERT_NE(explicit_batch, batches.end());
+    EXPECT_TRUE(explicit_batch->instanced);
+    EXPECT_EQ(explicit_batch->instance_count, 2U);
+    EXPECT_EQ(std::ranges::count_if(batches, [](const auto& b) { return !b.instanced; }), 1);
+}
+
+// NullGraphic 和 VulkanGraphics 一样在 flush 时排序合批，性能测试的 submit 阶段包含这部分开销
+TEST(DrawList, NullGraphicSortsOnFlush) {
+    std::array<std::array<std::byte, 8>, 3> push{};
+    render::NullGraphic graphic;
+    for (std::uint32_t i = 0; i < push.size(); ++i) {
+        push[i].fill(static_cast<std::byte>(i + 1));
+        render::DrawIndexCommand command;
+        command.shaders[0] = 1;
+        command.push_constants = push[i];
+        command.mesh = render::MeshId{0};
+        command.index_count = 36;
+        command.instanced_vertex_shader = 9;
+        graphic.draw(command);
+    }
+    graphic.flushDraws();
+    EXPECT_EQ(graphic.stats().draws, 3U);
+    EXPECT_EQ(graphic.stats().batches, 1U);
+
+    // flush 后清空，下一帧重新记录
+    graphic.flushDraws();
+    EXPECT_EQ(graphic.stats().flushes, 2U);
+    EXPECT_EQ(graphic.stats().batches, 1U);
+}
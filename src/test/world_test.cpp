@@ -0,0 +1,353 @@
+#include <gtest/gtest.h>
+#include "world/cell_streamer.hpp"
+#include "world/light_clusters.hpp"
+#include "world/outliner_model.hpp"
+#include "world/render_registry.hpp"
+#include "world/scene_lights.hpp"
+#include "core/camera/camera.hpp"
+#include "ecs/components/transform_component.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+namespace {
+// 与 core::Camera::setPerspectiveProjection 相同（+z 朝前，深度 0..1）
+auto perspective(float fovy, float aspect, float near, float far) -> glm::mat4 {
+    const float tan_half_fovy = std::tan(fovy / 2.f);
+    glm::mat4 projection{0.f};
+    projection[0][0] = 1.f / (aspect * tan_half_fovy);
+    projection[1][1] = 1.f / tan_half_fovy;
+    projection[2][2] = far / (far - near);
+    projection[2][3] = 1.f;
+    projection[3][2] = -(far * near) / (far - near);
+    return projection;
+}
+
+// 与分簇结果比较的参考实现：每个簇和每个灯光逐一求交
+auto bruteForce(const world::LightClusterGrid& grid, std::uint32_t x, std::uint32_t y,
+                std::uint32_t z) -> std::vector<std::uint32_t> {
+    std::vector<std::uint32_t> result;
+    const auto bounds = grid.clusterBounds(x, y, z);
+    const auto spheres = grid.viewSpheres();
+    for (std::uint32_t light = 0; light < spheres.size(); ++light) {
+        if (world::LightClusterGrid::intersects(bounds, spheres[light])) {
+            result.push_back(light);
+        }
+    }
+    return result;
+}
+
+// 浮点运算顺序可能不同，只允许刚好落在边界上的灯光有差异
+auto onBoundary(const world::ClusterAabb& aabb, const glm::vec4& sphere) -> bool {
+    const glm::vec3 center{sphere};
+    const glm::vec3 closest = glm::clamp(center, aabb.min, aabb.max);
+    const glm::vec3 delta = center - closest;
+    const float distance2 = glm::dot(delta, delta);
+    return std::abs(distance2 - (sphere.w * sphere.w)) <= 1e-4f * (sphere.w * sphere.w);
+}
+}  // namespace
+
+TEST(LightClusterGrid, MatchesBruteForce) {
+    const glm::mat4 projection = perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f);
+    // 相机绕 y 轴转一点并抬高，观察矩阵不是单位阵
+    glm::mat4 view = glm::rotate(glm::mat4(1.f), 0.2f, glm::vec3{0.f, 1.f, 0.f});
+    view = glm::translate(view, glm::vec3{0.f, -1.f, 5.f});
+
+    std::mt19937 random{7};
+    std::uniform_real_distribution<float> position{-40.f, 40.f};
+    std::uniform_real_distribution<float> radius{0.1f, 8.f};
+    std::vector<glm::vec4> spheres(2000);
+    for (auto& sphere : spheres) {
+        sphere = {position(random), position(random) * 0.25f, position(random) + 40.f,
+                  radius(random)};
+    }
+
+    world::LightClusterGrid grid;
+    grid.build(projection, view, spheres);
+    const glm::uvec3 size = grid.gridSize();
+    ASSERT_EQ(size, glm::uvec3(world::LightClusterGrid::TILES_X,
+                               world::LightClusterGrid::TILES_Y,
+                               world::LightClusterGrid::SLICES));
+    EXPECT_NEAR(grid.depthParams().x, 0.1f, 1e-5f);
+    EXPECT_NEAR(grid.depthParams().y, 100.f, 1e-2f);
+
+    std::size_t assigned = 0;
+    for (std::uint32_t z = 0; z < size.z; ++z) {
+        for (std::uint32_t y = 0; y < size.y; ++y) {
+            for (std::uint32_t x = 0; x < size.x; ++x) {
+                const auto range = grid.ranges()[x + (size.x * (y + (size.y * z)))];
+                const auto actual = grid.indices().subspan(range.x, range.y);
+                const auto expected = bruteForce(grid, x, y, z);
+                ASSERT_TRUE(std::ranges::is_sorted(actual));
+                std::vector<std::uint32_t> difference;
+                std::ranges::set_symmetric_difference(actual, expected,
+                                                      std::back_inserter(difference));
+                for (auto light : difference) {
+                    EXPECT_TRUE(onBoundary(grid.clusterBounds(x, y, z), grid.viewSpheres()[light]))
+                        << "cluster (" << x << ", " << y << ", " << z << ") light " << light;
+                }
+                assigned += actual.size();
+            }
+        }
+    }
+    EXPECT_EQ(assigned, grid.indices().size());
+    // 每个簇平均只包含一小部分灯光
+    EXPECT_LT(assigned, spheres.size() * size.x * size.y * size.z / 10);
+}
+
+TEST(LightClusterGrid, OrthographicFallsBackToSingleCluster) {
+    // 与 core::Camera::setOrthographicProjection(-1, 1, -1, 1, 0.1, 10) 相同
+    glm::mat4 projection{1.f};
+    projection[2][2] = 1.f / 9.9f;
+    projection[3][2] = -0.1f / 9.9f;
+    std::vector<glm::vec4> spheres{{0.f, 0.f, 1.f, 1.f}, {5.f, 0.f, 1.f, 0.5f}};
+    world::LightClusterGrid grid;
+    grid.build(projection, glm::mat4(1.f), spheres);
+    EXPECT_EQ(grid.gridSize(), glm::uvec3(1));
+    ASSERT_EQ(grid.ranges().size(), 1U);
+    EXPECT_EQ(grid.ranges()[0], glm::uvec2(0, 2));
+}
+
+TEST(SceneLightBuffer, PacksClusterTablePerView) {
+    core::Camera main_camera;
+    main_camera.setPerspectiveProjection(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+    main_camera.setViewTarget({0.f, 0.f, -10.f}, {0.f, 0.f, 0.f}, {0.f, 1.f, 0.f});
+    core::Camera side_camera;
+    side_camera.setPerspectiveProjection(glm::radians(60.f), 1.f, 0.1f, 50.f);
+    side_camera.setViewTarget({10.f, 0.f, 0.f}, {0.f, 0.f, 0.f}, {0.f, 1.f, 0.f});
+
+    ecs::LightComponent light{};
+    light.type = ecs::LightType::Point;
+    light.intensity = 1.f;
+    ecs::TransformComponent transform{};
+    const std::array lights{world::LightInfo{.id = 1, .light = &light, .transform = &transform}};
+    // 视图 1 没有启用，不占用簇表
+    const std::array<const core::Camera*, 3> cameras{&main_camera, nullptr, &side_camera};
+    world::SceneLightBuffer buffer;
+    buffer.pack(cameras, lights);
+
+    const auto& header = buffer.header();
+    EXPECT_EQ(header.light_count.x, 1);
+    EXPECT_EQ(header.views[0].view, main_camera.getView());
+    EXPECT_EQ(header.views[2].projection, side_camera.getProjection());
+    // 一个点光源占 2 项，之后依次是主视图和视图 2 的簇表、灯光索引
+    constexpr std::uint32_t WORD = sizeof(glm::uvec4);
+    const auto words = [](std::size_t bytes) -> std::uint32_t {
+        return static_cast<std::uint32_t>((bytes + WORD - 1) / WORD);
+    };
+    const auto& main_clusters = buffer.clusters(0);
+    const auto& side_clusters = buffer.clusters(2);
+    EXPECT_EQ(header.views[0].cluster_words.x, 2U);
+    EXPECT_EQ(header.views[0].cluster_words.y, 2U + words(main_clusters.ranges().size_bytes()));
+    EXPECT_EQ(header.views[2].cluster_words.x,
+              header.views[0].cluster_words.y + words(main_clusters.indices().size_bytes()));
+    EXPECT_EQ(header.views[2].cluster_grid, glm::uvec4(side_clusters.gridSize(), 0U));
+
+    const auto bytes = buffer.bytes();
+    const auto* tail = bytes.data() + sizeof(world::SceneDataHeader);
+    const auto side_ranges = side_clusters.ranges();
+    ASSERT_GE(bytes.size(), sizeof(world::SceneDataHeader) +
+                                (header.views[2].cluster_words.x * WORD) +
+                                side_ranges.size_bytes());
+    EXPECT_TRUE(std::equal(side_ranges.begin(), side_ranges.end(),
+                           reinterpret_cast<const glm::uvec2*>(
+                               tail + (header.views[2].cluster_words.x * WORD))));
+}
+
+namespace {
+// 行列表中 (node, entry) 对应的名字，节点行加 "/" 前缀便于区分
+auto rowNames(world::OutlinerModel& outliner,
+              const std::vector<std::vector<std::string>>& names) -> std::vector<std::string> {
+    std::vector<std::string> result;
+    for (const auto& row : outliner.rows()) {
+        result.push_back((row.entry == 0 ? "/" : "") + names[row.node][row.entry]);
+    }
+    return result;
+}
+
+void addNode(world::OutlinerModel& outliner, id_t id, const std::vector<std::string>& names) {
+    std::vector<world::OutlinerModel::Item> children;
+    for (std::size_t i = 1; i < names.size(); ++i) {
+        children.push_back({.entity = {}, .name = names[i]});
+    }
+    outliner.add(id, {.entity = {}, .name = names[0]}, children);
+}
+}  // namespace
+
+TEST(OutlinerModel, ExpandAndFilter) {
+    // 节点按添加顺序占用槽位 0..2
+    std::vector<std::vector<std::string>> names{
+        {"Engine", "Bolt_M8", "Piston", "bolt_m10"}, {"Frame", "Beam"}, {"BoltBox"}};
+    world::OutlinerModel outliner;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        addNode(outliner, static_cast<id_t>(i + 1), names[i]);
+    }
+    using names_t = std::vector<std::string>;
+    EXPECT_EQ(rowNames(outliner, names), (names_t{"/Engine", "/Frame", "/BoltBox"}));
+
+    outliner.setOpen(1, true);
+    EXPECT_EQ(rowNames(outliner, names), (names_t{"/Engine", "/Frame", "Beam", "/BoltBox"}));
+
+    // 子实体匹配时节点自动展开，只显示匹配的子实体；节点本身匹配时按展开状态显示
+    outliner.setFilter("BOLT");
+    EXPECT_EQ(rowNames(outliner, names),
+              (names_t{"/Engine", "Bolt_M8", "bolt_m10", "/BoltBox"}));
+    outliner.setFilter("fr");
+    EXPECT_EQ(rowNames(outliner, names), (names_t{"/Frame", "Beam"}));
+    outliner.setFilter("nothing");
+    EXPECT_TRUE(outliner.rows().empty());
+
+    outliner.setFilter("piston");
+    names[0][2] = "Rod";
+    outliner.rename(1, 2, names[0][2]);
+    EXPECT_TRUE(outliner.rows().empty());
+    outliner.setFilter("rod");
+    EXPECT_EQ(rowNames(outliner, names), (names_t{"/Engine", "Rod"}));
+
+    outliner.remove(1);
+    outliner.setFilter("");
+    EXPECT_EQ(outliner.size(), 2U);
+    EXPECT_EQ(rowNames(outliner, names), (names_t{"/Frame", "Beam", "/BoltBox"}));
+    outliner.setFilter("bolt_m");
+    EXPECT_TRUE(outliner.rows().empty());
+}
+
+TEST(OutlinerModel, IndexMatchesSubstringSearch) {
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> letter(0, 3);
+    std::uniform_int_distribution<std::size_t> length(1, 8);
+    const auto randomName = [&] {
+        std::string name(length(rng), 'a');
+        for (auto& c : name) {
+            c = static_cast<char>('a' + letter(rng));
+        }
+        return name;
+    };
+    std::vector<std::vector<std::string>> names(200);
+    world::OutlinerModel outliner;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        names[i].resize(1 + (i % 5));
+        std::ranges::generate(names[i], randomName);
+        addNode(outliner, static_cast<id_t>(i + 1), names[i]);
+    }
+    // 删除一部分再改名，确认倒排表同步更新
+    for (std::size_t i = 0; i < names.size(); i += 7) {
+        outliner.remove(static_cast<id_t>(i + 1));
+        names[i].clear();
+    }
+    for (std::size_t i = 1; i < names.size(); i += 3) {
+        if (!names[i].empty()) {
+            names[i][0] = randomName();
+            outliner.rename(static_cast<id_t>(i + 1), 0, names[i][0]);
+        }
+    }
+
+    for (const std::string filter : {"a", "ab", "abc", "dcba", "bbb"}) {
+        outliner.setFilter(filter);
+        std::vector<std::string> expected;
+        for (const auto& node : names) {
+            std::vector<std::string> children;
+            for (std::size_t entry = 1; entry < node.size(); ++entry) {
+                if (node[entry].contains(filter)) {
+                    children.push_back(node[entry]);
+                }
+            }
+            const bool self = !node.empty() && node[0].contains(filter);
+            if (self || !children.empty()) {
+                expected.push_back("/" + node[0]);
+                // 节点都没有展开，只有节点本身匹配时不显示子实体
+                if (!children.empty()) {
+                    expected.insert(expected.end(), children.begin(), children.end());
+                }
+            }
+        }
+        EXPECT_EQ(rowNames(outliner, names), expected) << filter;
+    }
+}
+
+namespace {
+// 每个物体是 x 方向上的一个 1x1 的盒子，开销都是 100 字节内存
+auto streamer(float load_radius, float unload_radius, std::uint64_t host_budget,
+              std::initializer_list<float> xs) -> world::CellStreamer {
+    world::CellStreamer streamer({.cell_size = 10.f,
+                                  .load_radius = load_radius,
+                                  .unload_radius = unload_radius,
+                                  .budget = {.host_bytes = host_budget, .device_bytes = 1000}});
+    for (const float x : xs) {
+        streamer.addItem({.min = {x, 0.f, 0.f}, .max = {x + 1.f, 1.f, 1.f}}, {.host_bytes = 100});
+    }
+    return streamer;
+}
+
+void loadAll(world::CellStreamer& streamer, std::span<const world::CellStreamer::cell_t> cells) {
+    for (const auto cell : cells) {
+        streamer.markLoaded(cell, {.host_bytes = 100});
+    }
+}
+}  // namespace
+
+TEST(CellStreamer, LoadsNearestFirstWithinBudget) {
+    using cells_t = std::vector<world::CellStreamer::cell_t>;
+    // 格子按添加顺序编号 0..4，相机在格子 2 里
+    auto cells = streamer(100.f, 200.f, 250, {5.f, 15.f, 25.f, 35.f, 45.f});
+    const auto& actions = cells.update({25.f, 0.f, 5.f});
+    EXPECT_EQ(actions.load, (cells_t{2, 1}));
+    EXPECT_TRUE(actions.unload.empty());
+    EXPECT_EQ(cells.committed().host_bytes, 200U);
+    EXPECT_EQ(cells.state(3), world::CellStreamer::CellState::Unloaded);
+
+    // 还在加载中的格子不会重复请求，预算仍然不够加载第三个
+    EXPECT_TRUE(cells.update({25.f, 0.f, 5.f}).load.empty());
+    // 实际开销比估计小，预算够了
+    cells.markLoaded(2, {.host_bytes = 40});
+    cells.markLoaded(1, {.host_bytes = 100});
+    EXPECT_EQ(cells.update({25.f, 0.f, 5.f}).load, (cells_t{3}));
+    EXPECT_EQ(cells.committed().host_bytes, 240U);
+
+    // 失败的格子回到未加载，之后重新请求
+    cells.markFailed(3);
+    EXPECT_EQ(cells.committed().host_bytes, 140U);
+    EXPECT_EQ(cells.update({25.f, 0.f, 5.f}).load, (cells_t{3}));
+}
+
+TEST(CellStreamer, EvictsLeastRecentlyUsedBeforeFarthest) {
+    using cells_t = std::vector<world::CellStreamer::cell_t>;
+    // 格子 0、1、2 分别在 x = 0、100、200 附近，预算只够两个
+    auto cells = streamer(5.f, 1000.f, 200, {5.f, 205.f, 105.f});
+    loadAll(cells, cells.update({5.f, 0.f, 5.f}).load);
+    loadAll(cells, cells.update({205.f, 0.f, 5.f}).load);
+    EXPECT_EQ(cells.state(0), world::CellStreamer::CellState::Resident);
+    EXPECT_EQ(cells.state(1), world::CellStreamer::CellState::Resident);
+
+    // 格子 0 比格子 1 近，但更久没有用过
+    const auto& actions = cells.update({102.f, 0.f, 5.f});
+    EXPECT_EQ(actions.unload, (cells_t{0}));
+    EXPECT_EQ(actions.load, (cells_t{2}));
+    loadAll(cells, actions.load);
+
+    // 加载范围内的格子不会被淘汰，放不下时什么都不做
+    auto crowded = streamer(50.f, 1000.f, 200, {5.f, 15.f, 25.f});
+    loadAll(crowded, crowded.update({15.f, 0.f, 5.f}).load);
+    const auto& none = crowded.update({15.f, 0.f, 5.f});
+    EXPECT_TRUE(none.load.empty());
+    EXPECT_TRUE(none.unload.empty());
+}
+
+TEST(CellStreamer, UnloadsBeyondRadiusRegardlessOfBudget) {
+    using cells_t = std::vector<world::CellStreamer::cell_t>;
+    auto cells = streamer(10.f, 50.f, 1000, {5.f, 65.f});
+    loadAll(cells, cells.update({5.f, 0.f, 5.f}).load);
+    // 在两个半径之间时保持已加载
+    EXPECT_TRUE(cells.update({40.f, 0.f, 5.f}).unload.empty());
+    const auto& actions = cells.update({70.f, 0.f, 5.f});
+    EXPECT_EQ(actions.unload, (cells_t{0}));
+    EXPECT_EQ(actions.load, (cells_t{1}));
+    EXPECT_EQ(cells.committed().host_bytes, 100U);
+
+    // 单个格子超出预算时，没有其它格子占用才加载
+    auto large = streamer(10.f, 50.f, 50, {5.f});
+    EXPECT_EQ(large.update({5.f, 0.f, 5.f}).load, (cells_t{0}));
+}
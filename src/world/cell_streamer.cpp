@@ -0,0 +1,160 @@
+#include "world/cell_streamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <tracy/Tracy.hpp>
+
+namespace world {
+namespace {
+auto cellKey(const glm::ivec2& coord) -> std::uint64_t {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(coord.x)) << 32U) |
+           static_cast<std::uint32_t>(coord.y);
+}
+}  // namespace
+
+CellStreamer::CellStreamer(const Settings& settings) : settings_(settings) {}
+
+auto CellStreamer::addItem(const core::AABB& bounds, const StreamingCost& cost) -> item_t {
+    const glm::vec3 center = bounds.center() / settings_.cell_size;
+    const glm::ivec2 coord{static_cast<int>(std::floor(center.x)),
+                           static_cast<int>(std::floor(center.z))};
+    const auto [it, is_new] =
+        cell_index_.try_emplace(cellKey(coord), static_cast<cell_t>(cells_.size()));
+    if (is_new) {
+        cells_.emplace_back().coord = coord;
+    }
+    const auto item = static_cast<item_t>(item_cells_.size());
+    auto& cell = cells_[it->second];
+    cell.items.push_back(item);
+    cell.cost += cost;
+    item_cells_.push_back(it->second);
+    return item;
+}
+
+auto CellStreamer::distanceTo(const Cell& cell, const glm::vec3& camera) const -> float {
+    const glm::vec2 min = glm::vec2(cell.coord) * settings_.cell_size;
+    const glm::vec2 max = min + glm::vec2(settings_.cell_size);
+    const glm::vec2 position{camera.x, camera.z};
+    const glm::vec2 delta = glm::max(glm::max(min - position, position - max), glm::vec2(0.f));
+    return glm::length(delta);
+}
+
+auto CellStreamer::fits(const StreamingCost& cost) const -> bool {
+    return committed_.host_bytes + cost.host_bytes <= settings_.budget.host_bytes &&
+           committed_.device_bytes + cost.device_bytes <= settings_.budget.device_bytes;
+}
+
+void CellStreamer::unload(cell_t cell) {
+    committed_ -= cells_[cell].cost;
+    cells_[cell].state = CellState::Unloaded;
+    actions_.unload.push_back(cell);
+}
+
+auto CellStreamer::evictFor(const StreamingCost& cost) -> bool {
+    std::vector<cell_t> candidates;
+    StreamingCost reclaimable;
+    for (cell_t i = 0; i < cells_.size(); ++i) {
+        if (cells_[i].state == CellState::Resident &&
+            cells_[i].distance > settings_.load_radius) {
+            candidates.push_back(i);
+            reclaimable += cells_[i].cost;
+        }
+    }
+    // 全部淘汰也放不下时一个都不卸载
+    const StreamingCost remaining{
+        .host_bytes = committed_.host_bytes - reclaimable.host_bytes + cost.host_bytes,
+        .device_bytes = committed_.device_bytes - reclaimable.device_bytes + cost.device_bytes};
+    if (remaining.host_bytes > settings_.budget.host_bytes ||
+        remaining.device_bytes > settings_.budget.device_bytes) {
+        return false;
+    }
+    std::ranges::sort(candidates, [&](cell_t a, cell_t b) {
+        if (cells_[a].last_used != cells_[b].last_used) {
+            return cells_[a].last_used < cells_[b].last_used;
+        }
+        return cells_[a].distance > cells_[b].distance;
+    });
+    for (const cell_t cell : candidates) {
+        if (fits(cost)) {
+            break;
+        }
+        unload(cell);
+    }
+    return true;
+}
+
+auto CellStreamer::update(const glm::vec3& camera) -> const Actions& {
+    ZoneScoped;
+    ++frame_;
+    actions_.load.clear();
+    actions_.unload.clear();
+    for (auto& cell : cells_) {
+        cell.distance = distanceTo(cell, camera);
+        if (cell.state != CellState::Unloaded && cell.distance <= settings_.load_radius) {
+            cell.last_used = frame_;
+        }
+    }
+    for (cell_t i = 0; i < cells_.size(); ++i) {
+        if (cells_[i].state == CellState::Resident &&
+            cells_[i].distance > settings_.unload_radius) {
+            unload(i);
+        }
+    }
+    // 加载完成后的实际开销可能超出估计
+    if (!fits({})) {
+        evictFor({});
+    }
+
+    std::vector<cell_t> wanted;
+    for (cell_t i = 0; i < cells_.size(); ++i) {
+        if (cells_[i].state == CellState::Unloaded &&
+            cells_[i].distance <= settings_.load_radius) {
+            wanted.push_back(i);
+        }
+    }
+    std::ranges::sort(wanted, [&](cell_t a, cell_t b) {
+        return cells_[a].distance < cells_[b].distance ||
+               (cells_[a].distance == cells_[b].distance && a < b);
+    });
+    for (const cell_t i : wanted) {
+        if (loading_ >= settings_.max_loading) {
+            break;
+        }
+        auto& cell = cells_[i];
+        const bool nothing_loaded = committed_.host_bytes == 0 && committed_.device_bytes == 0;
+        if (!fits(cell.cost) && !evictFor(cell.cost) && !nothing_loaded) {
+            // 更远的格子不能抢在近的格子前面
+            break;
+        }
+        cell.state = CellState::Loading;
+        cell.last_used = frame_;
+        committed_ += cell.cost;
+        ++loading_;
+        actions_.load.push_back(i);
+    }
+    return actions_;
+}
+
+void CellStreamer::markLoaded(cell_t cell, const StreamingCost& actual) {
+    auto& entry = cells_[cell];
+    if (entry.state != CellState::Loading) {
+        return;
+    }
+    committed_ -= entry.cost;
+    entry.cost = actual;
+    committed_ += actual;
+    entry.state = CellState::Resident;
+    --loading_;
+}
+
+void CellStreamer::markFailed(cell_t cell) {
+    auto& entry = cells_[cell];
+    if (entry.state != CellState::Loading) {
+        return;
+    }
+    committed_ -= entry.cost;
+    entry.state = CellState::Unloaded;
+    --loading_;
+}
+
+}  // namespace world
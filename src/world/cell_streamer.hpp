@@ -0,0 +1,101 @@
+#pragma once
+#include "core/camera/frustum.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace world {
+
+struct StreamingCost {
+        std::uint64_t host_bytes{0};
+        std::uint64_t device_bytes{0};
+
+        auto operator+=(const StreamingCost& other) -> StreamingCost& {
+            host_bytes += other.host_bytes;
+            device_bytes += other.device_bytes;
+            return *this;
+        }
+        auto operator-=(const StreamingCost& other) -> StreamingCost& {
+            host_bytes -= other.host_bytes;
+            device_bytes -= other.device_bytes;
+            return *this;
+        }
+};
+
+/// 场景流式加载的调度策略，不涉及资源本身。场景在 XZ 平面上按 cell_size 划分成方格，
+/// 物体按包围盒中心归入格子。update 根据相机位置决定加载和卸载哪些格子：
+/// 与相机距离不超过 load_radius 的格子按距离从近到远加载，超过 unload_radius 的格子总是卸载；
+/// 两个半径之间的格子保持现状，避免在边界附近来回加载。
+/// 已加载和正在加载的格子的开销之和不超过内存和显存预算，装不下时先卸载不在加载范围内的格子，
+/// 按最后一次在加载范围内的帧从早到晚、同一帧按距离从远到近的顺序淘汰。
+/// 一个格子单独超出预算时只在没有其它已加载格子时加载，保证总能看到最近的格子。
+class CellStreamer {
+    public:
+        using item_t = std::uint32_t;
+        using cell_t = std::uint32_t;
+
+        enum class CellState : std::uint8_t { Unloaded, Loading, Resident };
+
+        struct Settings {
+                float cell_size{32.f};
+                float load_radius{96.f};
+                float unload_radius{128.f};
+                StreamingCost budget{.host_bytes = 1ULL << 30U, .device_bytes = 1ULL << 30U};
+                std::uint32_t max_loading{4};  // 同时在加载中的格子数上限
+        };
+
+        struct Actions {
+                std::vector<cell_t> load;
+                std::vector<cell_t> unload;
+        };
+
+        explicit CellStreamer(const Settings& settings);
+
+        // 在第一次 update 之前添加。cost 是加载前的估计，格子加载完成后由 markLoaded 换成实际开销
+        auto addItem(const core::AABB& bounds, const StreamingCost& cost) -> item_t;
+
+        // 返回的格子立即变为 Loading（加载）或 Unloaded（卸载），调用方按列表执行
+        auto update(const glm::vec3& camera) -> const Actions&;
+        void markLoaded(cell_t cell, const StreamingCost& actual);
+        // 加载失败的格子回到 Unloaded，之后的 update 会重新请求
+        void markFailed(cell_t cell);
+
+        [[nodiscard]] auto items(cell_t cell) const -> std::span<const item_t> {
+            return cells_[cell].items;
+        }
+        [[nodiscard]] auto cellOf(item_t item) const -> cell_t { return item_cells_[item]; }
+        [[nodiscard]] auto state(cell_t cell) const -> CellState { return cells_[cell].state; }
+        [[nodiscard]] auto cellCount() const -> std::size_t { return cells_.size(); }
+        // 已加载和正在加载的格子的开销之和
+        [[nodiscard]] auto committed() const -> const StreamingCost& { return committed_; }
+        [[nodiscard]] auto settings() const -> const Settings& { return settings_; }
+
+    private:
+        struct Cell {
+                glm::ivec2 coord{0};
+                std::vector<item_t> items;
+                StreamingCost cost;
+                CellState state{CellState::Unloaded};
+                std::uint64_t last_used{0};
+                float distance{0.f};  // 最近一次 update 时到相机的水平距离
+        };
+
+        [[nodiscard]] auto distanceTo(const Cell& cell, const glm::vec3& camera) const -> float;
+        [[nodiscard]] auto fits(const StreamingCost& cost) const -> bool;
+        void unload(cell_t cell);
+        // 按淘汰顺序卸载不在加载范围内的格子，直到 cost 能放进预算；放不下时返回 false
+        auto evictFor(const StreamingCost& cost) -> bool;
+
+        Settings settings_;
+        std::vector<Cell> cells_;
+        std::unordered_map<std::uint64_t, cell_t> cell_index_;
+        std::vector<cell_t> item_cells_;
+        StreamingCost committed_;
+        std::uint32_t loading_{0};
+        std::uint64_t frame_{0};
+        Actions actions_;
+};
+
+}  // namespace world
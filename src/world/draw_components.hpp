@@ -0,0 +1,78 @@
+#pragma once
+#include "common/assert.hpp"
+#include "common/common_funcs.hpp"
+#include "render_core/object_id.hpp"
+#include "render_core/pipeline_state.h"
+#include "render_core/render_command.hpp"
+#include "render_core/types.hpp"
+#include "resource/id.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace world {
+
+// 子网格的绘制数据，每个子网格是 RenderRegistry 中的一个实体，四个组件在 storage 中按相同顺序排列，
+// 剔除和绘制列表的生成直接遍历它们，不经过 drawable 对象
+
+/// 世界变换，布局与模型着色器的 push constant 相同
+struct DrawTransform {
+        glm::mat4 modelMatrix{1.f};
+        glm::mat4 normalMatrix{1.f};
+        // shader 只使用 normalMatrix 的 mat3 部分，第四列的 xy 存放物体 ID 供 ID 缓冲使用，
+        // z 为 coverage，w 在 drawMeshes 中写入视图编号。
+        // float 无法精确表示的 ID 不写入，像素当作未覆盖，拾取时被忽略
+        auto setObjectId(id_t model_id, id_t mesh_id) -> bool {
+            const bool encodable = model_id < render::MAX_ENCODABLE_OBJECT_ID &&
+                                   mesh_id < render::MAX_ENCODABLE_OBJECT_ID;
+            normalMatrix[3] = encodable ? glm::vec4{render::encodeObjectId(model_id),
+                                                    render::encodeObjectId(mesh_id), 1.f, 1.f}
+                                        : glm::vec4{0.f, 0.f, 0.f, 1.f};
+            return encodable;
+        }
+        AS_BYTE_SPAN
+};
+
+/// 网格引用：MeshId 和子网格的索引范围
+struct DrawMesh {
+        render::MeshId mesh;
+        std::uint32_t index_offset{};
+        std::uint32_t index_count{};
+};
+
+/// 材质：着色器、纹理和材质 UBO 的内容。管线状态可以在界面中逐网格修改，只保存指针
+struct DrawMaterial {
+        static constexpr std::size_t MAX_UNIFORM_BYTES = 64;
+        static constexpr std::size_t TEXTURE_COUNT = 4;
+
+        std::array<render::ShaderHash, render::MAX_DRAW_SHADER_STAGE> shaders{};
+        render::ShaderHash instanced_vertex_shader{};
+        render::PrimitiveTopology topology{render::PrimitiveTopology::Triangles};
+        const render::DynamicPipelineState* pipeline_state{nullptr};
+        std::array<render::TextureId, TEXTURE_COUNT> textures{};
+        std::array<std::byte, MAX_UNIFORM_BYTES> uniform{};
+        std::uint32_t uniform_size{0};
+
+        void setUniform(std::span<const std::byte> data) {
+            ASSERT_MSG(data.size() <= MAX_UNIFORM_BYTES, "material uniform too large");
+            std::ranges::copy(data, uniform.begin());
+            uniform_size = static_cast<std::uint32_t>(data.size());
+        }
+        [[nodiscard]] auto uniformBytes() const -> std::span<const std::byte> {
+            return std::span(uniform).first(uniform_size);
+        }
+};
+
+/// 可见性：视锥剔除的 proxy 和大纲面板中的显示开关（模型和子网格的开关都打开时才可见）
+struct DrawVisibility {
+        static constexpr std::uint32_t NO_PROXY = std::numeric_limits<std::uint32_t>::max();
+
+        std::uint32_t proxy{NO_PROXY};  // CullingBvh::proxy_t，没有注册剔除时总是可见
+        bool visible{true};
+};
+
+}  // namespace world
@@ -0,0 +1,169 @@
+#include "world/light_clusters.hpp"
+#include "common/parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace world {
+namespace {
+constexpr std::uint32_t TILES_PER_SLICE =
+    LightClusterGrid::TILES_X * LightClusterGrid::TILES_Y;
+
+auto axisDistance(float lo, float hi, float center) -> float {
+    if (center < lo) {
+        return lo - center;
+    }
+    if (center > hi) {
+        return center - hi;
+    }
+    return 0.f;
+}
+
+// 第 tile 列（行）在深度 [d0, d1] 之间的观察空间范围
+auto tileExtent(std::uint32_t tile, std::uint32_t count, float focal, float d0, float d1)
+    -> glm::vec2 {
+    const float step = 2.f / static_cast<float>(count);
+    const float a0 = -1.f + (step * static_cast<float>(tile));
+    const float a1 = -1.f + (step * static_cast<float>(tile + 1));
+    const std::array corners{a0 * d0 / focal, a0 * d1 / focal, a1 * d0 / focal, a1 * d1 / focal};
+    const auto [min, max] = std::ranges::minmax(corners);
+    return {min, max};
+}
+}  // namespace
+
+void LightClusterGrid::build(const glm::mat4& projection, const glm::mat4& view,
+                             std::span<const glm::vec4> spheres) {
+    view_spheres_.resize(spheres.size());
+    for (std::size_t i = 0; i < spheres.size(); ++i) {
+        const glm::vec4 center = view * glm::vec4(glm::vec3(spheres[i]), 1.f);
+        view_spheres_[i] = glm::vec4(glm::vec3(center), spheres[i].w);
+    }
+
+    // Camera::setPerspectiveProjection: [2][2] = f / (f - n), [3][2] = -f * n / (f - n)
+    const bool perspective = projection[2][3] == 1.f && projection[3][3] == 0.f;
+    const float near = perspective ? -projection[3][2] / projection[2][2] : 0.f;
+    const float far = perspective ? near * projection[2][2] / (projection[2][2] - 1.f) : 0.f;
+    if (!perspective || !(near > 0.f) || !(far > near) || projection[0][0] == 0.f ||
+        projection[1][1] == 0.f) {
+        buildFallback(spheres.size());
+        return;
+    }
+
+    grid_ = {TILES_X, TILES_Y, SLICES};
+    const float scale = static_cast<float>(SLICES) / std::log(far / near);
+    depth_ = {near, far, scale, -std::log(near) * scale};
+    focal_ = {projection[0][0], projection[1][1]};
+    for (std::uint32_t slice = 0; slice <= SLICES; ++slice) {
+        slice_depth_[slice] = std::exp((static_cast<float>(slice) - depth_.w) / scale);
+    }
+    slice_depth_.front() = near;
+    slice_depth_.back() = far;
+
+    common::parallelFor(SLICES, 1, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t slice = begin; slice < end; ++slice) {
+            assignSlice(static_cast<std::uint32_t>(slice));
+        }
+    });
+
+    ranges_.assign(static_cast<std::size_t>(TILES_PER_SLICE) * SLICES, glm::uvec2{0});
+    for (std::uint32_t slice = 0; slice < SLICES; ++slice) {
+        for (const auto& pair : slice_pairs_[slice]) {
+            ++ranges_[(slice * TILES_PER_SLICE) + pair.x].y;
+        }
+    }
+    std::uint32_t offset = 0;
+    for (auto& range : ranges_) {
+        range.x = offset;
+        offset += range.y;
+    }
+    indices_.resize(offset);
+    common::parallelFor(SLICES, 1, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t slice = begin; slice < end; ++slice) {
+            std::array<std::uint32_t, TILES_PER_SLICE> cursor{};
+            for (std::uint32_t tile = 0; tile < TILES_PER_SLICE; ++tile) {
+                cursor[tile] = ranges_[(slice * TILES_PER_SLICE) + tile].x;
+            }
+            for (const auto& pair : slice_pairs_[slice]) {
+                indices_[cursor[pair.x]++] = pair.y;
+            }
+        }
+    });
+}
+
+void LightClusterGrid::assignSlice(std::uint32_t slice) {
+    auto& pairs = slice_pairs_[slice];
+    pairs.clear();
+    const float z0 = slice_depth_[slice];
+    const float z1 = slice_depth_[slice + 1];
+    std::array<glm::vec2, TILES_X> x_extent{};
+    std::array<glm::vec2, TILES_Y> y_extent{};
+    for (std::uint32_t x = 0; x < TILES_X; ++x) {
+        x_extent[x] = tileExtent(x, TILES_X, focal_.x, z0, z1);
+    }
+    for (std::uint32_t y = 0; y < TILES_Y; ++y) {
+        y_extent[y] = tileExtent(y, TILES_Y, focal_.y, z0, z1);
+    }
+
+    // 距离平方按轴分开：列只依赖 x，行只依赖 y，组合时相加即可
+    std::array<float, TILES_X> dx2{};
+    std::array<float, TILES_Y> dy2{};
+    for (std::uint32_t light = 0; light < view_spheres_.size(); ++light) {
+        const auto& sphere = view_spheres_[light];
+        const float radius2 = sphere.w * sphere.w;
+        const float dz = axisDistance(z0, z1, sphere.z);
+        const float dz2 = dz * dz;
+        if (dz2 > radius2) {
+            continue;
+        }
+        for (std::uint32_t x = 0; x < TILES_X; ++x) {
+            const float d = axisDistance(x_extent[x].x, x_extent[x].y, sphere.x);
+            dx2[x] = d * d;
+        }
+        for (std::uint32_t y = 0; y < TILES_Y; ++y) {
+            const float d = axisDistance(y_extent[y].x, y_extent[y].y, sphere.y);
+            dy2[y] = d * d;
+        }
+        for (std::uint32_t y = 0; y < TILES_Y; ++y) {
+            if (dy2[y] + dz2 > radius2) {
+                continue;
+            }
+            for (std::uint32_t x = 0; x < TILES_X; ++x) {
+                if (dx2[x] + dy2[y] + dz2 <= radius2) {
+                    pairs.emplace_back(x + (TILES_X * y), light);
+                }
+            }
+        }
+    }
+}
+
+void LightClusterGrid::buildFallback(std::size_t light_count) {
+    grid_ = {1, 1, 1};
+    depth_ = {};
+    ranges_.assign(1, glm::uvec2{0, static_cast<std::uint32_t>(light_count)});
+    indices_.resize(light_count);
+    std::iota(indices_.begin(), indices_.end(), 0U);
+}
+
+auto LightClusterGrid::clusterBounds(std::uint32_t x, std::uint32_t y, std::uint32_t z) const
+    -> ClusterAabb {
+    if (grid_.z == 1) {
+        constexpr float max = std::numeric_limits<float>::max();
+        return {.min = glm::vec3{-max}, .max = glm::vec3{max}};
+    }
+    const float z0 = slice_depth_[z];
+    const float z1 = slice_depth_[z + 1];
+    const glm::vec2 x_extent = tileExtent(x, TILES_X, focal_.x, z0, z1);
+    const glm::vec2 y_extent = tileExtent(y, TILES_Y, focal_.y, z0, z1);
+    return {.min = {x_extent.x, y_extent.x, z0}, .max = {x_extent.y, y_extent.y, z1}};
+}
+
+auto LightClusterGrid::intersects(const ClusterAabb& aabb, const glm::vec4& view_sphere) -> bool {
+    const float dx = axisDistance(aabb.min.x, aabb.max.x, view_sphere.x);
+    const float dy = axisDistance(aabb.min.y, aabb.max.y, view_sphere.y);
+    const float dz = axisDistance(aabb.min.z, aabb.max.z, view_sphere.z);
+    return (dx * dx) + (dy * dy) + (dz * dz) <= view_sphere.w * view_sphere.w;
+}
+
+}  // namespace world
@@ -0,0 +1,60 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace world {
+
+struct ClusterAabb {
+        glm::vec3 min{};
+        glm::vec3 max{};
+};
+
+/// 分簇前向渲染的灯光分配（CPU 实现）。视锥在屏幕上分成 TILES_X × TILES_Y 块，深度按指数分成
+/// SLICES 片，每个点光源按影响半径写入与之相交的簇，片元着色器只计算所在簇中的灯光。
+/// 每个深度切片独立处理，在线程池上并行；切片内按列/行分别求距离，内层循环可以向量化。
+class LightClusterGrid {
+    public:
+        static constexpr std::uint32_t TILES_X = 16;
+        static constexpr std::uint32_t TILES_Y = 9;
+        static constexpr std::uint32_t SLICES = 24;
+
+        // spheres: 世界空间的灯光位置（xyz）和影响半径（w）。
+        // 不是透视投影时退化为一个包含全部灯光的簇
+        void build(const glm::mat4& projection, const glm::mat4& view,
+                   std::span<const glm::vec4> spheres);
+
+        // 簇在观察空间（+z 朝前）中的包围盒
+        [[nodiscard]] auto clusterBounds(std::uint32_t x, std::uint32_t y, std::uint32_t z) const
+            -> ClusterAabb;
+        [[nodiscard]] static auto intersects(const ClusterAabb& aabb, const glm::vec4& view_sphere)
+            -> bool;
+
+        [[nodiscard]] auto gridSize() const -> glm::uvec3 { return grid_; }
+        // x: near, y: far, z/w: 切片 = log(depth) * z + w
+        [[nodiscard]] auto depthParams() const -> glm::vec4 { return depth_; }
+        // 下标为 x + X * (y + Y * z)，内容为 (灯光索引的起始, 数量)
+        [[nodiscard]] auto ranges() const -> std::span<const glm::uvec2> { return ranges_; }
+        [[nodiscard]] auto indices() const -> std::span<const std::uint32_t> { return indices_; }
+        [[nodiscard]] auto viewSpheres() const -> std::span<const glm::vec4> {
+            return view_spheres_;
+        }
+
+    private:
+        void buildFallback(std::size_t light_count);
+        void assignSlice(std::uint32_t slice);
+
+        glm::uvec3 grid_{1, 1, 1};
+        glm::vec4 depth_{};
+        glm::vec2 focal_{1.f};  // projection[0][0], projection[1][1]
+        std::array<float, SLICES + 1> slice_depth_{};
+        std::vector<glm::vec4> view_spheres_;
+        // 每个切片的 (簇在切片内的下标, 灯光) 对，按灯光顺序排列
+        std::array<std::vector<glm::uvec2>, SLICES> slice_pairs_;
+        std::vector<glm::uvec2> ranges_;
+        std::vector<std::uint32_t> indices_;
+};
+
+}  // namespace world
@@ -0,0 +1,261 @@
+#include "world/outliner_model.hpp"
+#include "ecs/components/tag_component.hpp"
+#include <algorithm>
+#include <tracy/Tracy.hpp>
+
+namespace world {
+namespace {
+constexpr std::size_t TRIGRAM = 3;
+
+auto toLower(std::string_view str) -> std::string {
+    std::string result(str);
+    for (auto& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+// 去重后的三字节组，不足三个字节的字符串没有
+auto trigramsOf(std::string_view key) -> std::vector<std::uint32_t> {
+    std::vector<std::uint32_t> result;
+    if (key.size() < TRIGRAM) {
+        return result;
+    }
+    const auto byte = [key](std::size_t i) {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(key[i]));
+    };
+    result.reserve(key.size() - TRIGRAM + 1);
+    for (std::size_t i = 0; i + TRIGRAM <= key.size(); ++i) {
+        result.push_back(byte(i) | (byte(i + 1) << 8U) | (byte(i + 2) << 16U));
+    }
+    std::ranges::sort(result);
+    const auto duplicates = std::ranges::unique(result);
+    result.erase(duplicates.begin(), duplicates.end());
+    return result;
+}
+}  // namespace
+
+auto OutlinerModel::item(const ecs::Entity& entity) -> Item {
+    if (!entity || !entity.hasComponent<ecs::TagComponent>()) {
+        return {.entity = entity, .name = {}};
+    }
+    return {.entity = entity, .name = entity.getComponent<ecs::TagComponent>().tag};
+}
+
+void OutlinerModel::add(id_t id, Item node, std::span<const Item> children) {
+    if (id_to_node_.contains(id)) {
+        return;
+    }
+    std::uint32_t slot = 0;
+    if (!free_.empty()) {
+        slot = free_.back();
+        free_.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    auto& entries = nodes_[slot].entries;
+    nodes_[slot].id = id;
+    entries.reserve(children.size() + 1);
+    entries.push_back({.entity = node.entity, .key = toLower(node.name)});
+    for (const auto& child : children) {
+        entries.push_back({.entity = child.entity, .key = toLower(child.name)});
+    }
+    for (std::uint32_t entry = 0; entry < entries.size(); ++entry) {
+        indexEntry({.node = slot, .entry = entry});
+    }
+    order_.push_back(slot);
+    id_to_node_[id] = slot;
+    dirty_ = true;
+}
+
+void OutlinerModel::remove(id_t id) {
+    const auto it = id_to_node_.find(id);
+    if (it == id_to_node_.end()) {
+        return;
+    }
+    const std::uint32_t slot = it->second;
+    for (std::uint32_t entry = 0; entry < nodes_[slot].entries.size(); ++entry) {
+        unindexEntry({.node = slot, .entry = entry});
+    }
+    nodes_[slot] = {};
+    free_.push_back(slot);
+    std::erase(order_, slot);
+    id_to_node_.erase(it);
+    dirty_ = true;
+}
+
+void OutlinerModel::rename(id_t id, std::uint32_t entry, std::string_view name) {
+    const auto it = id_to_node_.find(id);
+    if (it == id_to_node_.end() || entry >= nodes_[it->second].entries.size()) {
+        return;
+    }
+    const EntryRef ref{.node = it->second, .entry = entry};
+    unindexEntry(ref);
+    nodes_[ref.node].entries[entry].key = toLower(name);
+    indexEntry(ref);
+    // 没有过滤时行列表与名字无关
+    dirty_ = dirty_ || !filter_.empty();
+}
+
+void OutlinerModel::clear() {
+    nodes_.clear();
+    free_.clear();
+    order_.clear();
+    id_to_node_.clear();
+    trigrams_.clear();
+    rows_.clear();
+    dirty_ = true;
+}
+
+void OutlinerModel::setOpen(std::uint32_t node, bool open) {
+    if (nodes_[node].open != open) {
+        nodes_[node].open = open;
+        dirty_ = true;
+    }
+}
+
+void OutlinerModel::setFilter(std::string_view filter) {
+    auto key = toLower(filter);
+    if (key != filter_) {
+        filter_ = std::move(key);
+        dirty_ = true;
+    }
+}
+
+auto OutlinerModel::rows() -> std::span<const Row> {
+    if (dirty_) {
+        rebuildRows();
+        dirty_ = false;
+    }
+    return rows_;
+}
+
+auto OutlinerModel::entity(const Row& row) const -> const ecs::Entity& {
+    return nodes_[row.node].entries[row.entry].entity;
+}
+
+auto OutlinerModel::find(id_t id, std::uint32_t entry) -> ecs::Entity* {
+    const auto it = id_to_node_.find(id);
+    if (it == id_to_node_.end() || entry >= nodes_[it->second].entries.size()) {
+        return nullptr;
+    }
+    return &nodes_[it->second].entries[entry].entity;
+}
+
+auto OutlinerModel::isChild(std::uint32_t node, const ecs::Entity& entity) const -> bool {
+    const auto& entries = nodes_[node].entries;
+    return std::ranges::any_of(entries.begin() + 1, entries.end(),
+                               [&](const Entry& entry) { return entry.entity == entity; });
+}
+
+void OutlinerModel::indexEntry(EntryRef ref) {
+    for (const auto trigram : trigramsOf(nodes_[ref.node].entries[ref.entry].key)) {
+        trigrams_[trigram].push_back(ref);
+    }
+}
+
+void OutlinerModel::unindexEntry(EntryRef ref) {
+    for (const auto trigram : trigramsOf(nodes_[ref.node].entries[ref.entry].key)) {
+        const auto list = trigrams_.find(trigram);
+        if (list == trigrams_.end()) {
+            continue;
+        }
+        // 倒排表内部无序，交换到末尾删除
+        auto& refs = list->second;
+        if (const auto it = std::ranges::find(refs, ref); it != refs.end()) {
+            *it = refs.back();
+            refs.pop_back();
+        }
+        if (refs.empty()) {
+            trigrams_.erase(list);
+        }
+    }
+}
+
+auto OutlinerModel::match() const -> std::vector<EntryRef> {
+    std::vector<EntryRef> result;
+    const auto matches = [&](EntryRef ref) {
+        return nodes_[ref.node].entries[ref.entry].key.find(filter_) != std::string::npos;
+    };
+    if (filter_.size() < TRIGRAM) {
+        // 过滤串太短，没有可用的三字节组，逐个比较
+        for (const auto slot : order_) {
+            for (std::uint32_t entry = 0; entry < nodes_[slot].entries.size(); ++entry) {
+                if (matches({.node = slot, .entry = entry})) {
+                    result.push_back({.node = slot, .entry = entry});
+                }
+            }
+        }
+    } else {
+        const std::vector<EntryRef>* shortest = nullptr;
+        for (const auto trigram : trigramsOf(filter_)) {
+            const auto list = trigrams_.find(trigram);
+            if (list == trigrams_.end()) {
+                return result;
+            }
+            if (shortest == nullptr || list->second.size() < shortest->size()) {
+                shortest = &list->second;
+            }
+        }
+        for (const auto ref : *shortest) {
+            if (matches(ref)) {
+                result.push_back(ref);
+            }
+        }
+    }
+    std::ranges::sort(result);
+    return result;
+}
+
+void OutlinerModel::rebuildRows() {
+    ZoneScoped;
+    rows_.clear();
+    if (filter_.empty()) {
+        for (const auto slot : order_) {
+            const auto& node = nodes_[slot];
+            rows_.push_back({.node = slot, .entry = 0, .expanded = node.open});
+            if (!node.open) {
+                continue;
+            }
+            for (std::uint32_t entry = 1; entry < node.entries.size(); ++entry) {
+                rows_.push_back({.node = slot, .entry = entry});
+            }
+        }
+        return;
+    }
+
+    // 每个节点匹配的条目在排好序的结果中连续存放
+    const auto matched = match();
+    std::unordered_map<std::uint32_t, std::pair<std::size_t, std::size_t>> node_ranges;
+    for (std::size_t i = 0; i < matched.size(); ++i) {
+        node_ranges.try_emplace(matched[i].node, i, i + 1).first->second.second = i + 1;
+    }
+    for (const auto slot : order_) {
+        const auto range = node_ranges.find(slot);
+        if (range == node_ranges.end()) {
+            continue;
+        }
+        const auto& node = nodes_[slot];
+        const auto [begin, end] = range->second;
+        const bool self_matched = matched[begin].entry == 0;
+        if (self_matched && end - begin == 1) {
+            // 只有节点本身匹配，子实体按展开状态显示
+            rows_.push_back({.node = slot, .entry = 0, .expanded = node.open});
+            if (node.open) {
+                for (std::uint32_t entry = 1; entry < node.entries.size(); ++entry) {
+                    rows_.push_back({.node = slot, .entry = entry});
+                }
+            }
+            continue;
+        }
+        rows_.push_back({.node = slot, .entry = 0, .expanded = true});
+        for (std::size_t i = self_matched ? begin + 1 : begin; i < end; ++i) {
+            rows_.push_back({.node = slot, .entry = matched[i].entry});
+        }
+    }
+}
+
+}  // namespace world
@@ -0,0 +1,87 @@
+#pragma once
+#include "ecs/scene/entity.hpp"
+#include "resource/id.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace world {
+
+/// 大纲视图的数据。随 drawable 的添加、删除和改名增量维护，不再每帧遍历 registry 复制子实体列表。
+/// rows() 返回当前展开状态和过滤条件下要显示的扁平行列表，只在内容、展开状态或过滤条件变化后重建，
+/// 界面配合 ImGuiListClipper 只绘制可见的行。
+/// 名字（小写）按三字节组建倒排索引，过滤时取最短的倒排表作为候选，再逐个确认子串。
+class OutlinerModel {
+    public:
+        struct Item {
+                ecs::Entity entity;
+                std::string name;
+        };
+
+        // entry 为 0 时是节点本身，k 是它的第 k 个子实体
+        struct Row {
+                std::uint32_t node{0};
+                std::uint32_t entry{0};
+                bool expanded{false};  // 节点行：子实体是否显示在下面
+        };
+
+        // 从实体的 TagComponent 取名字
+        static auto item(const ecs::Entity& entity) -> Item;
+
+        // 子实体只在添加时读取一次
+        void add(id_t id, Item node, std::span<const Item> children);
+        void remove(id_t id);
+        void rename(id_t id, std::uint32_t entry, std::string_view name);
+        void clear();
+
+        // 只修改状态，下次 rows() 时重建，绘制过程中可以安全调用
+        void setOpen(std::uint32_t node, bool open);
+        // 不区分大小写（仅 ASCII）的子串过滤，空字符串表示不过滤。
+        // 子实体匹配时它的节点也显示并展开
+        void setFilter(std::string_view filter);
+
+        [[nodiscard]] auto rows() -> std::span<const Row>;
+        [[nodiscard]] auto entity(const Row& row) const -> const ecs::Entity&;
+        [[nodiscard]] auto find(id_t id, std::uint32_t entry) -> ecs::Entity*;
+        [[nodiscard]] auto childCount(std::uint32_t node) const -> std::size_t {
+            return nodes_[node].entries.size() - 1;
+        }
+        [[nodiscard]] auto isChild(std::uint32_t node, const ecs::Entity& entity) const -> bool;
+        [[nodiscard]] auto size() const -> std::size_t { return order_.size(); }
+
+    private:
+        struct Entry {
+                ecs::Entity entity;
+                std::string key;  // 小写的名字
+        };
+        struct Node {
+                id_t id{};
+                std::vector<Entry> entries;  // [0] 是节点本身，之后是子实体
+                bool open{false};
+        };
+        struct EntryRef {
+                std::uint32_t node{0};
+                std::uint32_t entry{0};
+                auto operator<=>(const EntryRef&) const = default;
+        };
+
+        void indexEntry(EntryRef ref);
+        void unindexEntry(EntryRef ref);
+        // 匹配过滤条件的全部条目，按 (node, entry) 排序
+        [[nodiscard]] auto match() const -> std::vector<EntryRef>;
+        void rebuildRows();
+
+        std::vector<Node> nodes_;  // 按槽位存放，删除后槽位复用
+        std::vector<std::uint32_t> free_;
+        std::vector<std::uint32_t> order_;  // 显示顺序，即添加顺序
+        std::unordered_map<id_t, std::uint32_t> id_to_node_;
+        std::unordered_map<std::uint32_t, std::vector<EntryRef>> trigrams_;
+        std::string filter_;
+        std::vector<Row> rows_;
+        bool dirty_{true};
+};
+
+}  // namespace world
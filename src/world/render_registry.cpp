@@ -0,0 +1,71 @@
+#include "world/render_registry.hpp"
+#include "render_core/graphic.hpp"
+#include "system/culling_bvh.hpp"
+#include <tracy/Tracy.hpp>
+
+namespace world {
+
+auto RenderRegistry::addMeshDraw(id_t owner, const DrawTransform& transform,
+                                 const DrawMesh& mesh, const DrawMaterial& material,
+                                 const DrawVisibility& visibility) -> entt::entity {
+    const auto entity = registry_.create();
+    registry_.emplace<DrawVisibility>(entity, visibility);
+    registry_.emplace<DrawTransform>(entity, transform);
+    registry_.emplace<DrawMesh>(entity, mesh);
+    registry_.emplace<DrawMaterial>(entity, material);
+    mesh_draws_[owner].push_back(entity);
+    return entity;
+}
+
+void RenderRegistry::drawMeshes(render::Graphic* gfx, const graphics::CullingBvh& culling,
+                                std::uint32_t view, const render::CleanValue* target) {
+    ZoneScoped;
+    // 四个组件由 group 持有，按相同顺序紧密排列
+    auto group = registry_.group<DrawVisibility, DrawTransform, DrawMesh, DrawMaterial>();
+    for (auto [entity, visibility, transform, mesh, material] : group.each()) {
+        if (!visibility.visible) {
+            continue;
+        }
+        const bool culled = visibility.proxy != DrawVisibility::NO_PROXY;
+        if (culled && !culling.visible(visibility.proxy, view)) {
+            continue;
+        }
+        render::DrawIndexCommand command;
+        command.shaders = material.shaders;
+        command.topology = material.topology;
+        if (material.pipeline_state != nullptr) {
+            command.pipelineState = *material.pipeline_state;
+        }
+        if (target != nullptr) {
+            command.pipelineState.viewport = {
+                .x = static_cast<float>(target->offset_x),
+                .y = static_cast<float>(target->offset_y),
+                .width = static_cast<float>(target->width),
+                .height = static_cast<float>(target->hight),
+            };
+            command.pipelineState.scissors = {.x = target->offset_x,
+                                              .y = target->offset_y,
+                                              .width = static_cast<int32_t>(target->width),
+                                              .height = static_cast<int32_t>(target->hight)};
+        }
+        std::array<std::span<const std::byte>, 1> uniforms{material.uniformBytes()};
+        if (material.uniform_size > 0) {
+            command.ubos = uniforms;
+        }
+        // 变换组件所有视图共用，normalMatrix[3].w 写入视图编号，shader 据此选择相机
+        auto push = transform;
+        push.normalMatrix[3].w = static_cast<float>(view);
+        command.push_constants = push.as_byte_span();
+        command.textures = material.textures;
+        command.mesh = mesh.mesh;
+        command.index_offset = mesh.index_offset;
+        command.index_count = mesh.index_count;
+        command.instanced_vertex_shader = material.instanced_vertex_shader;
+        if (culled) {
+            command.sort_depth = culling.viewDepth(visibility.proxy, view);
+        }
+        gfx->draw(command);
+    }
+}
+
+}  // namespace world
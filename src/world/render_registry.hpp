@@ -1,10 +1,16 @@
 #pragma once
 #include "resource/id.hpp"
+#include <entt/entt.hpp>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <span>
 #include <utility>
 #include <unordered_map>
 #include "ecs/component.hpp"
+#include "world/outliner_model.hpp"
+#include "world/draw_components.hpp"
+#include "common/parallel.hpp"
 
 // 前向声明
 namespace core {
@@ -13,21 +19,28 @@ struct FrameInfo;
 }
 namespace render {
 class Graphic;
+struct CleanValue;
+}
+namespace graphics {
+class CullingBvh;
 }
 
 namespace world {
 class World;
 
-// 概念约束
+// 概念约束。按子网格组件绘制的 drawable 没有 draw，由 RenderRegistry::drawMeshes 统一绘制
 template <typename T>
-concept DrawableLike =
-    requires(T t, const core::FrameInfo& info, world::World& world, render::Graphic* gfx) {
-        { t->update(info, world) } -> std::same_as<void>;
-        { t->draw(gfx) } -> std::same_as<void>;
-        { t->getId() } -> std::same_as<id_t>;
-        { t->entity_ } -> std::same_as<ecs::Entity&>;
-        { t->getChildEntitys() } -> std::same_as<std::vector<ecs::Entity>>;
-    };
+concept DrawableLike = requires(T t, const core::FrameInfo& info, world::World& world) {
+    { t->update(info, world) } -> std::same_as<void>;
+    { t->getId() } -> std::same_as<id_t>;
+    { t->entity_ } -> std::same_as<ecs::Entity&>;
+    { t->getChildEntitys() } -> std::same_as<std::vector<ecs::Entity>>;
+};
+
+template <typename T>
+concept HasDraw = requires(T t, render::Graphic* gfx) {
+    { t->draw(gfx) } -> std::same_as<void>;
+};
 
 template <typename T>
 concept HasValueECSInterface = requires(T t) {
@@ -35,48 +48,78 @@ concept HasValueECSInterface = requires(T t) {
     { t.getChildEntitys() } -> std::same_as<std::vector<ecs::Entity>>;
 };
 
+struct LightInfo {
+        id_t id;
+        ecs::LightComponent* light;
+        ecs::TransformComponent* transform;
+};
+
+// 并行 update 期间对共享状态（灯光列表、拾取场景）的写入。每个任务块各自记录，
+// update 结束后由 World 按块顺序回放，结果与串行执行时的顺序一致
+struct UpdateWrites {
+        std::vector<LightInfo> lights;
+        std::vector<std::pair<id_t, glm::mat4>> pick_transforms;
+        void clear() {
+            lights.clear();
+            pick_transforms.clear();
+        }
+};
+
+// 每个 drawable 对应 registry 中的一个实体。每帧访问的数据按具体类型放在各自的 EnTT storage 里
+// 连续遍历，拾取/大纲视图这类低频访问的数据放在 DrawableNode 中。
+// 模型的每个子网格另有一个实体，变换、网格、材质和可见性放在 draw_components.hpp 的组件中
 class RenderRegistry {
-    private:
-        struct Drawable {
-                std::function<void(const core::FrameInfo&, world::World&)> update;
-                std::function<void(render::Graphic*)> draw;
-                std::function<id_t()> getId;
-                std::function<ecs::Entity&()> getEntity;
-                std::function<std::vector<ecs::Entity>()> getChildren;
-
-                // 构造函数：接受任何满足 DrawableLike 的类型
-                template <DrawableLike T>
-                explicit Drawable(T&& obj)
-                    : update([o = std::forward<T>(obj)](const core::FrameInfo& info,
-                                                        world::World& world) mutable -> auto {
-                          o->update(info, world);
-                      }),
-                      draw([o = std::forward<T>(obj)](render::Graphic* gfx) mutable -> auto {
-                          o->draw(gfx);
-                      }),
-                      getId([o = obj]() { return o->getId(); }),
-                      getEntity([o = obj]() -> ecs::Entity& { return o->entity_; }),
-                      getChildren([o = obj]() { return o->getChildEntitys(); }) {}
-
-                // 如果需要支持拷贝/移动，确保 std::function 的行为符合预期
-                Drawable(const Drawable&) = default;
-                Drawable(Drawable&&) = default;
-                ~Drawable() = default;
-                auto operator=(const Drawable&) -> Drawable& = default;
-                auto operator=(Drawable&&) -> Drawable& = default;
+    public:
+        // 热数据：具体类型的对象以及可见性，同一类型在 storage 中紧密排列
+        template <typename T>
+        struct DrawableHandle {
+                T object;
+                const ecs::RenderStateComponent* render_state{nullptr};
         };
 
-        std::vector<Drawable> objects_;
-        std::unordered_map<id_t, size_t> id_to_index_;
+        using children_func = std::vector<ecs::Entity> (*)(void*);
+
+        // 冷数据：按 id 查询、拾取和大纲视图使用
+        struct DrawableNode {
+                id_t id{};
+                ecs::Entity* entity{nullptr};
+                void* object{nullptr};
+                children_func children{nullptr};
+
+                [[nodiscard]] auto getEntity() const -> ecs::Entity& { return *entity; }
+                [[nodiscard]] auto getChildren() const -> std::vector<ecs::Entity> {
+                    return children(object);
+                }
+        };
 
-    public:
         RenderRegistry() = default;
 
         template <DrawableLike T>
         void add(T obj) {
-            objects_.push_back(Drawable{obj});
-
-            id_to_index_[obj->getId()] = objects_.size() - 1;
+            using Handle = DrawableHandle<T>;
+            const id_t id = obj->getId();
+            if (id_to_entity_.contains(id)) {
+                return;
+            }
+            registerPool<T>();
+            const auto entity = registry_.create();
+            auto& object_entity = obj->entity_;
+            const ecs::RenderStateComponent* render_state = nullptr;
+            if (object_entity.template hasComponent<ecs::RenderStateComponent>()) {
+                render_state = &object_entity.template getComponent<ecs::RenderStateComponent>();
+            }
+            registry_.emplace<DrawableNode>(entity, DrawableNode{.id = id,
+                                                                 .entity = &object_entity,
+                                                                 .object = &*obj,
+                                                                 .children = &childrenOf<T>});
+            std::vector<OutlinerModel::Item> children;
+            for (const auto& child : obj->getChildEntitys()) {
+                children.push_back(OutlinerModel::item(child));
+            }
+            outliner_.add(id, OutlinerModel::item(object_entity), children);
+            registry_.emplace<Handle>(entity, Handle{.object = std::move(obj),
+                                                     .render_state = render_state});
+            id_to_entity_[id] = entity;
         }
         // 批量添加
         template <DrawableLike T, typename... Args>
@@ -87,41 +130,174 @@ class RenderRegistry {
             }
         }
 
-        // 统一更新和绘制
-        void updateAll(const core::FrameInfo& info, world::World& world) {
-            for (auto& obj : objects_) {
-                obj.update(info, world);
+        // 释放 registry 持有的对象和它的子网格。同一类型中最后添加的对象移到被删除的位置，
+        // 之后的 update/draw 顺序随之改变
+        void remove(id_t id) {
+            const auto it = id_to_entity_.find(id);
+            if (it == id_to_entity_.end()) {
+                return;
+            }
+            registry_.destroy(it->second);
+            id_to_entity_.erase(it);
+            outliner_.remove(id);
+            if (const auto draws = mesh_draws_.find(id); draws != mesh_draws_.end()) {
+                registry_.destroy(draws->second.begin(), draws->second.end());
+                mesh_draws_.erase(draws);
+            }
+        }
+
+        // 子网格的绘制实体，owner 删除时一起删除。在 add(owner) 之前或之后调用都可以
+        auto addMeshDraw(id_t owner, const DrawTransform& transform, const DrawMesh& mesh,
+                         const DrawMaterial& material, const DrawVisibility& visibility)
+            -> entt::entity;
+        // 并行 update 中每个 drawable 只写自己的子网格，storage 在 addMeshDraw 时已经创建
+        template <typename Component>
+        auto meshDraw(entt::entity entity) -> Component& {
+            return registry_.get<Component>(entity);
+        }
+        // 遍历子网格组件，把 view 中可见的记录到 gfx，排序深度取自剔除结果。
+        // target 不为空时 viewport 和 scissor 改为其中的区域，否则使用网格自己的
+        void drawMeshes(render::Graphic* gfx, const graphics::CullingBvh& culling,
+                        std::uint32_t view, const render::CleanValue* target = nullptr);
+
+        // 统一更新和绘制：每种类型一次间接调用，类型内部静态分派。
+        // 同一类型的对象相互独立，按块并行 update；不同类型之间仍按注册顺序依次执行。
+        // 返回本次 update 中记录的共享状态写入，由调用方按顺序应用
+        auto updateAll(const core::FrameInfo& info, world::World& world)
+            -> std::span<UpdateWrites> {
+            used_writes_ = 0;
+            for (const auto& pool : pools_) {
+                pool.update(*this, info, world);
             }
+            return std::span(writes_).first(used_writes_);
         }
 
+        // 当前线程正在执行的 update 块的写入缓冲，不在并行 update 中时为 nullptr
+        static auto currentWrites() -> UpdateWrites* { return current_writes_; }
+
         void drawAll(render::Graphic* gfx) {
-            for (auto& obj : objects_) {
-                obj.draw(gfx);
+            for (const auto& pool : pools_) {
+                if (pool.draw != nullptr) {
+                    pool.draw(registry_, gfx);
+                }
             }
         }
 
-        auto getDrawableById(id_t id) -> Drawable* {
-            auto it = id_to_index_.find(id);
-            if (it != id_to_index_.end()) {
-                return &objects_[it->second];
+        // 按添加顺序访问某一类型的全部对象
+        template <DrawableLike T, typename Func>
+        void each(Func&& func) {
+            auto& handles = registry_.storage<DrawableHandle<T>>();
+            for (auto it = handles.rbegin(); it != handles.rend(); ++it) {
+                func(it->object);
             }
-            return nullptr;
         }
 
-        void processOutlineres(const std::function<void(ecs::Outliner&&)>& func) {
-            for (auto& obj : objects_) {
-                ecs::Outliner outliner;
-                outliner.entity = obj.getEntity();
-                outliner.children = obj.getChildren();
-                func(std::move(outliner));
+        auto getDrawableById(id_t id) -> DrawableNode* {
+            auto it = id_to_entity_.find(id);
+            if (it != id_to_entity_.end()) {
+                return registry_.try_get<DrawableNode>(it->second);
             }
+            return nullptr;
         }
 
+        // 随 add/remove/clear 增量维护的大纲视图数据
+        auto outliner() -> OutlinerModel& { return outliner_; }
+
         // 控制
-        void clear() { objects_.clear(); }
-        void reserve(size_t n) { objects_.reserve(n); }
-        auto getOutliner(this auto&& self) -> decltype(auto) { return (self.outliner_entities_); };
-        [[nodiscard]] auto size() const -> size_t { return objects_.size(); }
-        [[nodiscard]] auto empty() const -> bool { return objects_.empty(); }
+        void clear() {
+            registry_.clear();
+            pools_.clear();
+            id_to_entity_.clear();
+            mesh_draws_.clear();
+            outliner_.clear();
+        }
+        void reserve(size_t n) {
+            registry_.storage<DrawableNode>().reserve(n);
+            id_to_entity_.reserve(n);
+        }
+        [[nodiscard]] auto size() const -> size_t { return id_to_entity_.size(); }
+        [[nodiscard]] auto empty() const -> bool { return id_to_entity_.empty(); }
+
+    private:
+        static constexpr std::size_t UPDATE_GRAIN = 32;
+
+        struct TypePool {
+                entt::id_type type{};
+                void (*update)(RenderRegistry&, const core::FrameInfo&, world::World&){nullptr};
+                void (*draw)(entt::registry&, render::Graphic*){nullptr};
+        };
+
+        auto acquireWrites(std::size_t count) -> std::span<UpdateWrites> {
+            if (writes_.size() < used_writes_ + count) {
+                writes_.resize(used_writes_ + count);
+            }
+            auto writes = std::span(writes_).subspan(used_writes_, count);
+            for (auto& write : writes) {
+                write.clear();
+            }
+            used_writes_ += count;
+            return writes;
+        }
+
+        // storage 的 rbegin 到 rend 是插入顺序，保持与添加时一致的更新/绘制顺序
+        template <typename T>
+        static void updatePool(RenderRegistry& self, const core::FrameInfo& info,
+                               world::World& world) {
+            auto& handles = self.registry_.storage<DrawableHandle<T>>();
+            const std::size_t count = handles.size();
+            if (count == 0) {
+                return;
+            }
+            auto writes = self.acquireWrites((count + UPDATE_GRAIN - 1) / UPDATE_GRAIN);
+            const auto first = handles.rbegin();
+            common::parallelFor(count, UPDATE_GRAIN, [&](std::size_t begin, std::size_t end) {
+                current_writes_ = &writes[begin / UPDATE_GRAIN];
+                for (std::size_t i = begin; i < end; ++i) {
+                    first[static_cast<std::ptrdiff_t>(i)].object->update(info, world);
+                }
+                current_writes_ = nullptr;
+            });
+        }
+
+        template <typename T>
+        static void drawPool(entt::registry& registry, render::Graphic* gfx) {
+            if constexpr (HasDraw<T>) {
+                auto& handles = registry.storage<DrawableHandle<T>>();
+                for (auto it = handles.rbegin(); it != handles.rend(); ++it) {
+                    if (it->render_state && !it->render_state->visible) {
+                        continue;
+                    }
+                    it->object->draw(gfx);
+                }
+            }
+        }
+
+        template <typename T>
+        static auto childrenOf(void* object) -> std::vector<ecs::Entity> {
+            using Object = std::remove_cvref_t<decltype(*std::declval<T&>())>;
+            return static_cast<Object*>(object)->getChildEntitys();
+        }
+
+        template <typename T>
+        void registerPool() {
+            const auto type = entt::type_hash<DrawableHandle<T>>::value();
+            for (const auto& pool : pools_) {
+                if (pool.type == type) {
+                    return;
+                }
+            }
+            pools_.push_back(TypePool{.type = type,
+                                      .update = &updatePool<T>,
+                                      .draw = HasDraw<T> ? &drawPool<T> : nullptr});
+        }
+
+        entt::registry registry_;
+        std::vector<TypePool> pools_;  // 按类型首次注册的顺序
+        std::vector<UpdateWrites> writes_;
+        std::size_t used_writes_{0};
+        static inline thread_local UpdateWrites* current_writes_{nullptr};  // NOLINT
+        std::unordered_map<id_t, entt::entity> id_to_entity_;
+        std::unordered_map<id_t, std::vector<entt::entity>> mesh_draws_;  // owner 的子网格
+        OutlinerModel outliner_;
 };
-}  // namespace world
\ No newline at end of file
+}  // namespace world
@@ -0,0 +1,102 @@
+#include "world/scene_lights.hpp"
+#include "world/render_registry.hpp"
+#include "core/camera/camera.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace world {
+namespace {
+constexpr std::size_t WORD_SIZE = sizeof(glm::uvec4);
+
+auto wordCount(std::size_t bytes) -> std::size_t { return (bytes + WORD_SIZE - 1) / WORD_SIZE; }
+}  // namespace
+
+auto pointLightRadius(const ecs::LightComponent& light) -> float {
+    const float peak = light.intensity * std::max({light.color.r, light.color.g, light.color.b});
+    return std::sqrt(std::max(peak, 0.f) / LIGHT_ATTENUATION_CUTOFF);
+}
+
+void SceneLightBuffer::pack(std::span<const core::Camera* const> cameras,
+                            std::span<const LightInfo> lights) {
+    point_lights_.clear();
+    light_spheres_.clear();
+    // 没有聚光灯时 position.w 为 0，shader 跳过
+    header_.spotLight = {};
+    bool has_spot_light = false;
+    for (const auto& light : lights) {
+        if (light.light->type == ecs::LightType::Point) {
+            // 强度为 0 的灯光半径为 0，不参与分簇
+            const float radius = pointLightRadius(*light.light);
+            if (radius <= 0.f) {
+                continue;
+            }
+            point_lights_.push_back(PointLight{
+                .position = {light.transform->translation, radius},
+                .color = {light.light->color, light.light->intensity},
+            });
+            light_spheres_.push_back(point_lights_.back().position);
+        } else if (light.light->type == ecs::LightType::Directional) {
+            header_.dirLight.direction = glm::vec4(glm::normalize(light.light->direction), 0.f);
+            header_.dirLight.color = glm::vec4(light.light->color, light.light->intensity);
+        } else if (light.light->type == ecs::LightType::Spot && light.transform &&
+                   !has_spot_light) {
+            // shader 只有一个聚光灯槽位，取第一个；w 分别存外锥角和内锥角的 cos
+            has_spot_light = true;
+            header_.spotLight.position =
+                glm::vec4(light.transform->translation, light.light->outerCone);
+            header_.spotLight.direction =
+                glm::vec4(glm::normalize(light.light->direction), light.light->innerCone);
+            header_.spotLight.color = glm::vec4(light.light->color, light.light->intensity);
+        }
+    }
+    const std::size_t lights_bytes = point_lights_.size() * sizeof(PointLight);
+    header_.light_count = {static_cast<int>(point_lights_.size()), 0, 0, 0};
+
+    // 点光源之后依次是每个视图的簇表和灯光索引
+    std::size_t words = wordCount(lights_bytes);
+    const std::size_t view_count = std::min(cameras.size(), MAX_SCENE_VIEWS);
+    for (std::size_t i = 0; i < view_count; ++i) {
+        if (cameras[i] == nullptr) {
+            continue;
+        }
+        auto& view = header_.views[i];
+        view.projection = cameras[i]->getProjection();
+        view.view = cameras[i]->getView();
+        view.inverseView = cameras[i]->getInverseView();
+        auto& clusters = clusters_[i];
+        clusters.build(view.projection, view.view, light_spheres_);
+        const std::size_t ranges_word = words;
+        const std::size_t indices_word = ranges_word + wordCount(clusters.ranges().size_bytes());
+        words = indices_word + wordCount(clusters.indices().size_bytes());
+        view.cluster_grid = glm::uvec4(clusters.gridSize(), 0U);
+        view.cluster_depth = clusters.depthParams();
+        view.cluster_words = {static_cast<std::uint32_t>(ranges_word),
+                              static_cast<std::uint32_t>(indices_word), 0U, 0U};
+    }
+
+    // 空列表时保留一项，shader 中的运行时数组不能为空
+    bytes_.assign(sizeof(SceneDataHeader) + (std::max<std::size_t>(words, 1) * WORD_SIZE),
+                  std::byte{0});
+    auto* tail = bytes_.data() + sizeof(SceneDataHeader);
+    std::memcpy(bytes_.data(), &header_, sizeof(SceneDataHeader));
+    if (lights_bytes > 0) {
+        std::memcpy(tail, point_lights_.data(), lights_bytes);
+    }
+    for (std::size_t i = 0; i < view_count; ++i) {
+        if (cameras[i] == nullptr) {
+            continue;
+        }
+        const auto& view = header_.views[i];
+        const auto ranges = clusters_[i].ranges();
+        const auto indices = clusters_[i].indices();
+        std::memcpy(tail + (view.cluster_words.x * WORD_SIZE), ranges.data(),
+                    ranges.size_bytes());
+        if (!indices.empty()) {
+            std::memcpy(tail + (view.cluster_words.y * WORD_SIZE), indices.data(),
+                        indices.size_bytes());
+        }
+    }
+}
+
+}  // namespace world
@@ -0,0 +1,85 @@
+#pragma once
+#include "world/light_clusters.hpp"
+#include "ecs/components/light_component.hpp"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace core {
+class Camera;
+}
+
+namespace world {
+struct LightInfo;
+
+struct PointLight {
+        glm::vec4 position{};  // w 是影响半径
+        glm::vec4 color{};     // w is intensity
+};
+
+struct DirLight {
+        glm::vec4 direction{-0.2f, -1.0f, -0.3f, 0.f};  // ignore w
+        glm::vec4 color{1.f, 1.0f, 1.f, 0.2f};          // w is intensity
+};
+struct SpotLight {
+        glm::vec4 position{};   // w used as type
+        glm::vec4 color{};      // w is intensity
+        glm::vec4 direction{};  // w constant
+};
+
+// 一份场景数据中的视图数量，与 World::MAX_VIEWS 相同
+constexpr std::size_t MAX_SCENE_VIEWS = 8;
+
+// 每个视图的相机和簇表位置。簇按视图的投影划分，每个视图各有一份簇表和灯光索引
+struct SceneView {
+        glm::mat4 projection{1.f};
+        glm::mat4 view{1.f};
+        glm::mat4 inverseView{1.f};
+        glm::uvec4 cluster_grid{1U, 1U, 1U, 0U};  // xyz: 簇的数量
+        glm::vec4 cluster_depth{};                // LightClusterGrid::depthParams
+        glm::uvec4 cluster_words{};  // x: 簇表起始, y: 灯光索引起始（uvec4 为单位）
+};
+
+// storage buffer 的头部，布局与 shader 中的 SceneData 一致（std430）。
+// 绘制通过 push constant 中 normalMatrix[3].w 选择视图。
+// 后面是 uvec4 数组：点光源（每个占 2 项），然后是各视图的簇表（每项 2 个簇）和灯光索引（每项 4 个）
+struct SceneDataHeader {
+        glm::vec4 ambientLightColor{1.f, 1.f, 1.f, .04f};  // w is intensity
+        DirLight dirLight{};
+        SpotLight spotLight{};
+        glm::ivec4 light_count{};  // x: 点光源数量
+        std::array<SceneView, MAX_SCENE_VIEWS> views{};
+};
+
+// 光照衰减低于这个值时视为没有贡献，由此得到点光源的影响半径
+constexpr float LIGHT_ATTENUATION_CUTOFF = 1.f / 256.f;
+
+auto pointLightRadius(const ecs::LightComponent& light) -> float;
+
+/// 每帧打包一次的相机和灯光数据，整帧所有视图的绘制共享同一份 storage buffer，
+/// 每个 draw 只需要提供自己的变换和材质。点光源按簇分配，片元只计算所在簇中的灯光。
+class SceneLightBuffer {
+    public:
+        // cameras 按视图编号排列，nullptr 的视图不打包
+        void pack(std::span<const core::Camera* const> cameras,
+                  std::span<const LightInfo> lights);
+
+        [[nodiscard]] auto bytes() const -> std::span<const std::byte> { return bytes_; }
+        [[nodiscard]] auto header() const -> const SceneDataHeader& { return header_; }
+        [[nodiscard]] auto pointLights() const -> std::span<const PointLight> {
+            return point_lights_;
+        }
+        [[nodiscard]] auto clusters(std::size_t view) const -> const LightClusterGrid& {
+            return clusters_[view];
+        }
+
+    private:
+        SceneDataHeader header_;
+        std::vector<PointLight> point_lights_;
+        std::vector<glm::vec4> light_spheres_;
+        std::array<LightClusterGrid, MAX_SCENE_VIEWS> clusters_;
+        std::vector<std::byte> bytes_;
+};
+}  // namespace world
@@ -1,8 +1,11 @@
 #include "world.hpp"
+#include "common/settings.hpp"
 #include "core/frame_info.hpp"
 #include "ecs/components/render_state_component.hpp"
 #include "ecs/component.hpp"
+#include "ecs/components/tag_component.hpp"
 #include "input/input.hpp"
+#include "input/keyboard.hpp"
 #include "input/mouse.h"
 #include "core/frontend/window.hpp"
 #include "resource/id.hpp"
@@ -11,14 +14,33 @@
 #include "system/camera_system.hpp"
 #include "system/pick_system.hpp"
 #include "system/transform_system.hpp"
+#include <array>
+#include <chrono>
+#include <limits>
 
 namespace world {
+namespace {
+// 每次调用返回距上一次调用的毫秒数
+class PhaseClock {
+    public:
+        auto lap() -> double {
+            const auto now = std::chrono::steady_clock::now();
+            const std::chrono::duration<double, std::milli> elapsed = now - last_;
+            last_ = now;
+            return elapsed.count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point last_{std::chrono::steady_clock::now()};
+};
+}  // namespace
 
 World::World() : id_(graphics::getCurrentId()), frame_time_(std::make_unique<core::FrameTime>()) {
     cameraEntity_ = scene_.createEntity("camera");
     cameraEntity_.addComponent<ecs::CameraComponent>();
     cameraEntity_.addComponent<ecs::RenderStateComponent>(graphics::getCurrentId());
     cameraComponent_ = &cameraEntity_.getComponent<ecs::CameraComponent>();  // NOLINT
+    views_[MAIN_VIEW] = {.camera = cameraEntity_, .used = true, .enabled = true};
     dirLightEntity_ = scene_.createEntity("dir_light");
     entity_ = scene_.createEntity("world: " + std::to_string(id_));
     entity_.addComponent<ecs::RenderStateComponent>(id_);
@@ -32,6 +54,9 @@ World::World() : id_(graphics::getCurrentId()), frame_time_(std::make_unique<cor
     dir_light = &dirLightEntity_.getComponent<ecs::LightComponent>();  // NOLINT
     lights_.push_back({.light = dir_light, .transform = nullptr});
     child_entitys_ = {cameraEntity_, dirLightEntity_};
+    const std::array children{OutlinerModel::item(cameraEntity_),
+                              OutlinerModel::item(dirLightEntity_)};
+    render_registry_.outliner().add(id_, OutlinerModel::item(entity_), children);
 }
 
 [[nodiscard]] auto World::getEntity(WorldEntityType entityType) const -> ecs::Entity {
@@ -43,6 +68,60 @@ World::World() : id_(graphics::getCurrentId()), frame_time_(std::make_unique<cor
     }
 }
 
+auto World::addView(const std::string& name) -> std::optional<view_t> {
+    for (view_t view = MAIN_VIEW + 1; view < MAX_VIEWS; ++view) {
+        auto& slot = views_[view];
+        if (slot.used) {
+            continue;
+        }
+        if (!slot.camera) {
+            slot.camera = scene_.createEntity(name);
+            slot.camera.addComponent<ecs::CameraComponent>();
+        } else {
+            slot.camera.getComponent<ecs::CameraComponent>() = ecs::CameraComponent{};
+        }
+        slot.target.reset();
+        slot.used = true;
+        slot.enabled = true;
+        return view;
+    }
+    return std::nullopt;
+}
+
+void World::removeView(view_t view) {
+    if (view != MAIN_VIEW && view < MAX_VIEWS) {
+        views_[view].used = false;
+        if (input_view_ == view) {
+            input_view_ = MAIN_VIEW;
+        }
+    }
+}
+
+void World::setViewEnabled(view_t view, bool enabled) {
+    if (view < MAX_VIEWS) {
+        views_[view].enabled = enabled;
+    }
+}
+
+void World::setViewTarget(view_t view, const render::CleanValue& target) {
+    if (view != MAIN_VIEW && view < MAX_VIEWS && views_[view].used) {
+        views_[view].target = target;
+    }
+}
+
+void World::setInputView(view_t view) {
+    if (view < MAX_VIEWS && views_[view].used) {
+        input_view_ = view;
+    }
+}
+
+auto World::getView(view_t view) const -> ecs::Entity {
+    if (view >= MAX_VIEWS || !views_[view].used) {
+        throw std::runtime_error("Unknown view " + std::to_string(view));
+    }
+    return views_[view].camera;
+}
+
 [[nodiscard]] auto World::getScene() -> ecs::Scene& { return scene_; }
 auto World::get_module_count() -> size_t{
     return render_registry_.size();
@@ -51,35 +130,134 @@ World::~World() = default;
 
 void World::update(core::frontend::BaseWindow& window, graphics::ResourceManager& resourceManager,
                    graphics::input::InputSystem& input_system) {
+    PhaseClock clock;
     cameraComponent_->setAspect(window.getAspectRatio());
+    for (view_t view = MAIN_VIEW + 1; view < MAX_VIEWS; ++view) {
+        const auto& slot = views_[view];
+        if (!slot.used) {
+            continue;
+        }
+        auto& view_camera = slot.camera.getComponent<ecs::CameraComponent>();
+        if (slot.target && slot.target->width > 0 && slot.target->hight > 0) {
+            view_camera.setAspect(static_cast<float>(slot.target->width) /
+                                  static_cast<float>(slot.target->hight));
+        } else if (view_camera.aspect() <= 0.f) {
+            view_camera.setAspect(window.getAspectRatio());
+        }
+    }
     core::FrameInfo frameInfo;
     frameInfo.frame_layout = window.getFramebufferLayout();
     frameInfo.frame_time = frame_time_->get();
     frameInfo.resource_manager = &resourceManager;
     auto& camera = cameraComponent_->getCamera();
     frameInfo.camera = &camera;
-    graphics::CameraSystem::update(*cameraComponent_, &input_system,
-                                   static_cast<float>(frameInfo.frame_time.frame));
-    process_mouse_input(frameInfo, input_system.GetMouse());
+    graphics::CameraSystem::update(
+        views_[input_view_].camera.getComponent<ecs::CameraComponent>(), &input_system,
+        static_cast<float>(frameInfo.frame_time.frame));
+    process_mouse_input(frameInfo, input_system);
+    timings_.camera_input = clock.lap();
+    // 在 drawable update 之前算好世界矩阵，静态物体不会触发任何重写
+    transforms_.update();
+    timings_.transforms = clock.lap();
+
+    auto writes = render_registry_.updateAll(frameInfo, *this);
+    for (const auto& write : writes) {
+        for (const auto& light : write.lights) {
+            addLight(light);
+        }
+        for (const auto& [id, transform] : write.pick_transforms) {
+            graphics::PickingSystem::update_transform(id, transform);
+        }
+    }
+    timings_.drawables = clock.lap();
+    // 所有启用视图的相机打包进同一份场景数据，主视图总是打包
+    std::array<const core::Camera*, MAX_VIEWS> cameras{};
+    cameras[MAIN_VIEW] = &camera;
+    for (view_t view = MAIN_VIEW + 1; view < MAX_VIEWS; ++view) {
+        const auto& slot = views_[view];
+        if (slot.used && slot.enabled) {
+            cameras[view] = &slot.camera.getComponent<ecs::CameraComponent>().getCamera();
+        }
+    }
+    scene_lights_.pack(cameras, lights_);
+    timings_.lights = clock.lap();
+}
+
+auto World::lightBounds(const LightInfo& info) -> core::AABB {
+    if (info.transform == nullptr || info.light->type == ecs::LightType::Directional) {
+        constexpr float max = std::numeric_limits<float>::max();
+        return {.min = glm::vec3{-max}, .max = glm::vec3{max}};
+    }
+    const float radius = pointLightRadius(*info.light);
+    return {.min = info.transform->translation - glm::vec3{radius},
+            .max = info.transform->translation + glm::vec3{radius}};
+}
+
+void World::queryLights(const glm::vec3& center, float radius,
+                        std::vector<LightInfo>& out) const {
+    std::vector<std::uint32_t> ids;
+    light_grid_.queryRadius(center, radius, ids);
+    for (const auto id : ids) {
+        out.push_back(lights_[light_index.at(id).index]);
+    }
+}
 
-    render_registry_.updateAll(frameInfo, *this);
+auto World::queryDrawables(const glm::vec3& center, float radius)
+    -> std::vector<graphics::PickResult> {
+    return graphics::PickingSystem::queryRadius(center, radius);
+}
+
+void World::rename(id_t id, std::uint32_t entry, std::string name) {
+    auto& outliner = render_registry_.outliner();
+    auto* entity = outliner.find(id, entry);
+    if (entity == nullptr || !entity->hasComponent<ecs::TagComponent>()) {
+        return;
+    }
+    outliner.rename(id, entry, name);
+    entity->getComponent<ecs::TagComponent>().tag = std::move(name);
+}
+
+void World::updatePickTransform(id_t id, const glm::mat4& world) {
+    if (auto* writes = RenderRegistry::currentWrites()) {
+        writes->pick_transforms.emplace_back(id, world);
+        return;
+    }
+    graphics::PickingSystem::update_transform(id, world);
 }
 
-void World::process_mouse_input(core::FrameInfo& frameInfo, graphics::input::Mouse* mouse) {
+void World::process_mouse_input(core::FrameInfo& frameInfo,
+                                graphics::input::InputSystem& input_system) {
+    auto* mouse = input_system.GetMouse();
     if(mouse->isCapture()){
         return;
     }
+    const auto width = static_cast<float>(frameInfo.frame_layout.screen.GetWidth());
+    const auto height = static_cast<float>(frameInfo.frame_layout.screen.GetHeight());
     if (mouse->IsPressed(graphics::input::MouseButton::Left)) {
         if (!is_pick) {
-            auto origin = mouse->GetMouseOrigin();
-            auto pick_result = graphics::PickingSystem::pick(
-                *frameInfo.camera, origin.x, origin.y,
-                static_cast<float>(frameInfo.frame_layout.screen.GetWidth()),
-                static_cast<float>(frameInfo.frame_layout.screen.GetHeight()));
-            if (pick_result) {
-                this->pick(pick_result->model_id, pick_result->id);
+            cancelMultiPick();
+            auto* keyboard = input_system.GetKeyboard();
+            is_box_select =
+                keyboard->HasModifiers(graphics::input::NativeKeyboard::Modifiers::LeftShift) ||
+                keyboard->HasModifiers(graphics::input::NativeKeyboard::Modifiers::RightShift);
+            box_select_end_ = mouse->GetMouseOrigin();
+            if (!is_box_select) {
+                auto origin = mouse->GetMouseOrigin();
+                if (settings::values.use_object_id_buffer.GetValue()) {
+                    object_id_request_ =
+                        render::ObjectIdRequest{.u = origin.x / width, .v = origin.y / height};
+                } else {
+                    auto pick_result = graphics::PickingSystem::pick(*frameInfo.camera, origin.x,
+                                                                     origin.y, width, height);
+                    if (pick_result) {
+                        this->pick(pick_result->model_id, pick_result->id);
+                    }
+                }
             }
             is_pick = true;
+        } else if (is_box_select) {
+            const auto axis = mouse->GetAxis();
+            box_select_end_ = glm::vec2{axis.x, axis.y};
         } else {
             auto* draw_able = render_registry_.getDrawableById(pick_id);
             if (draw_able && draw_able->getEntity().hasComponent<ecs::TransformComponent>()) {
@@ -89,12 +267,87 @@ void World::process_mouse_input(core::FrameInfo& frameInfo, graphics::input::Mou
         }
 
     } else {
+        if (is_box_select) {
+            // 松开左键时按拖动矩形一次性框选
+            auto results = graphics::PickingSystem::pickRect(
+                *frameInfo.camera, mouse->GetMouseOrigin(), box_select_end_, width, height);
+            std::vector<id_t> model_ids;
+            model_ids.reserve(results.size());
+            for (const auto& result : results) {
+                model_ids.push_back(result.model_id);
+            }
+            pickMany(model_ids);
+            is_box_select = false;
+        }
         this->cancelPick();
 
         is_pick = false;
     }
 }
 
-void World::draw(render::Graphic* gfx) { render_registry_.drawAll(gfx); }
+void World::draw(render::Graphic* gfx) {
+    if (wait_object_id_readback_) {
+        if (auto readback = gfx->tryGetObjectIdReadback()) {
+            wait_object_id_readback_ = false;
+            // 快速点击时结果返回前鼠标已经松开，仍然应用一次，大纲面板据此记录选中；
+            // 在途期间又有新的点击则以新的为准
+            auto object_id = render::resolveObjectId(*readback);
+            if (object_id && !object_id_request_ && !is_box_select) {
+                this->pick(object_id->model_id, object_id->mesh_id);
+            }
+        }
+    }
+    // 同一时间只有一个在途的回读，新的点击等上一个返回后再提交
+    if (object_id_request_ && !wait_object_id_readback_) {
+        gfx->requestObjectIdReadback(*object_id_request_);
+        object_id_request_.reset();
+        wait_object_id_readback_ = true;
+    }
+    PhaseClock clock;
+    if (settings::values.use_frustum_culling.GetValue()) {
+        graphics::CullingBvh::view_mask_t mask = 0;
+        glm::mat4 view_proj{1.f};
+        for (view_t view = 0; view < MAX_VIEWS; ++view) {
+            const auto& slot = views_[view];
+            if (!slot.used || !slot.enabled) {
+                continue;
+            }
+            const auto& camera = slot.camera.getComponent<ecs::CameraComponent>().getCamera();
+            const glm::mat4 matrix = camera.getProjection() * camera.getView();
+            view_frustums_[view] = core::Frustum(matrix);
+            mask |= static_cast<graphics::CullingBvh::view_mask_t>(1U << view);
+            if (view == MAIN_VIEW) {
+                view_proj = matrix;
+            }
+        }
+        culling_.cull(view_frustums_, mask);
+        // 遮挡体在 update 中已经同步了本帧的变换，遮挡缓冲只从主相机渲染
+        if (settings::values.use_occlusion_culling.GetValue() && occlusion_.size() > 0 &&
+            (mask & 1U) != 0) {
+            occlusion_.render(view_proj);
+            culling_.cullOccluded(occlusion_);
+        }
+    } else {
+        culling_.markAllVisible();
+    }
+    timings_.culling = clock.lap();
+    gfx->uploadSceneStorageBuffer(scene_lights_.bytes());
+    if (views_[MAIN_VIEW].enabled) {
+        render_registry_.drawAll(gfx);
+        render_registry_.drawMeshes(gfx, culling_, MAIN_VIEW);
+    }
+    gfx->flushDraws();
+    // 额外视图画在主视图之上，各自清除目标区域后绘制。场景数据和变换组件与主视图共用
+    for (view_t view = MAIN_VIEW + 1; view < MAX_VIEWS; ++view) {
+        const auto& slot = views_[view];
+        if (!slot.used || !slot.enabled || !slot.target) {
+            continue;
+        }
+        gfx->clean(*slot.target);
+        render_registry_.drawMeshes(gfx, culling_, view, &*slot.target);
+        gfx->flushDraws();
+    }
+    timings_.submit = clock.lap();
+}
 
 }  // namespace world
\ No newline at end of file
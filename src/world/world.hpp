@@ -1,10 +1,24 @@
 #pragma once
 #include "world/render_registry.hpp"
+#include "world/scene_lights.hpp"
 #include "resource/id.hpp"
+#include "render_core/object_id.hpp"
+#include "render_core/graphic.hpp"
+#include "system/transform_hierarchy.hpp"
+#include "system/culling_bvh.hpp"
+#include "system/pick_system.hpp"
+#include "system/spatial_grid.hpp"
 #include "ecs/scene/scene.hpp"
 #include "ecs/component.hpp"
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
 #include <vector>
 #include <functional>
+#include <limits>
 #include <unordered_map>
 
 namespace core {
@@ -27,31 +41,120 @@ namespace world {
 enum class WorldEntityType : std::uint8_t { CAMERA };
 
 class World {
-        struct LightInfo {
-                id_t id;
-                ecs::LightComponent* light;
-                ecs::TransformComponent* transform;
+    public:
+        static constexpr id_t NO_PARENT = std::numeric_limits<id_t>::max();
+
+        // 最近一帧 update 和 draw 各阶段的 CPU 耗时（毫秒）
+        struct PhaseTimings {
+                double camera_input{0};  // 相机和鼠标拾取
+                double transforms{0};    // TransformHierarchy
+                double drawables{0};     // drawable update 和共享写入的回放
+                double lights{0};        // 场景灯光打包
+                double culling{0};       // 视锥和遮挡剔除
+                double submit{0};        // drawable draw 和 flushDraws
         };
 
-    public:
+        using view_t = std::uint32_t;
+        static constexpr view_t MAIN_VIEW = 0;
+        static constexpr view_t MAX_VIEWS = graphics::CullingBvh::MAX_VIEWS;
+        static_assert(MAX_VIEWS == MAX_SCENE_VIEWS, "scene data holds one camera per view");
+
         World();
         [[nodiscard]] auto getEntity(WorldEntityType entityType) const -> ecs::Entity;
+        // 额外的视图（画中画、缩略图），所有视图在 draw 时一次遍历 BVH 完成剔除，
+        // 变换、灯光和场景数据每帧只计算和上传一次，每个视图用自己的相机绘制到自己的目标。
+        // 视图用完时返回 std::nullopt
+        auto addView(const std::string& name) -> std::optional<view_t>;
+        void removeView(view_t view);
+        void setViewEnabled(view_t view, bool enabled);
+        // 额外视图的绘制目标：帧图像中的一块区域，绘制前按其中的颜色和深度清除，相机的宽高比
+        // 随区域设置。没有目标的视图只参与剔除。主视图的目标是整个帧图像，由调用方清除
+        void setViewTarget(view_t view, const render::CleanValue& target);
+        // 接收键盘和鼠标输入的视图，默认是主视图
+        void setInputView(view_t view);
+        // 视图的相机实体，带 CameraComponent；MAIN_VIEW 即 WorldEntityType::CAMERA
+        [[nodiscard]] auto getView(view_t view) const -> ecs::Entity;
+        [[nodiscard]] auto viewCount() const -> std::size_t {
+            return static_cast<std::size_t>(std::ranges::count_if(
+                views_, [](const ViewSlot& slot) -> bool { return slot.used; }));
+        }
+        // 并行 update 中调用时先记录，update 结束后按实体顺序生效
         void addLight(const LightInfo& info) {
+            if (auto* writes = RenderRegistry::currentWrites()) {
+                writes->lights.push_back(info);
+                return;
+            }
             const auto& [pair, is_new] = light_index.try_emplace(info.id);
             if (is_new) {
                 lights_.push_back(info);
-                pair->second = static_cast<uint32_t>(lights_.size()) - 1;
+                pair->second = {.index = static_cast<uint32_t>(lights_.size()) - 1,
+                                .grid_item = light_grid_.insert(lightBounds(info), info.id)};
             } else {
-                lights_[pair->second] = info;
+                lights_[pair->second.index] = info;
+                light_grid_.update(pair->second.grid_item, lightBounds(info));
             }
         }
+        // 影响范围与球 (center, radius) 相交的灯光，结果追加到 out。
+        // 只包含通过 addLight 加入的灯光，平行光影响所有位置，不在索引中
+        void queryLights(const glm::vec3& center, float radius, std::vector<LightInfo>& out) const;
+        // 包围盒与球相交的网格，PickResult::id 是 mesh id，model_id 是所属模型
+        [[nodiscard]] static auto queryDrawables(const glm::vec3& center, float radius)
+            -> std::vector<graphics::PickResult>;
         void update(core::frontend::BaseWindow& window, graphics::ResourceManager& resourceManager,
                     graphics::input::InputSystem& input_system);
+        // 同步拾取场景中的变换，drawable 的 update 里使用，规则同 addLight
+        void updatePickTransform(id_t id, const glm::mat4& world);
         void draw(render::Graphic* gfx);
+        // parent 是已经加入的 drawable，变换相对于它的世界矩阵；删除时要先删除子节点
         template <DrawableLike T>
-        void addDrawable(T obj) {
+        void addDrawable(T obj, id_t parent = NO_PARENT) {
+            auto& entity = obj->entity_;
+            if (entity.template hasComponent<ecs::TransformComponent>() &&
+                entity.template hasComponent<ecs::WorldTransformComponent>()) {
+                const auto parent_node = transform_nodes_.find(parent);
+                transform_nodes_[obj->getId()] = transforms_.add(
+                    &entity.template getComponent<ecs::TransformComponent>(),
+                    &entity.template getComponent<ecs::WorldTransformComponent>(),
+                    parent_node == transform_nodes_.end()
+                        ? graphics::TransformHierarchy::NO_PARENT
+                        : parent_node->second);
+            }
+            // 按子网格注册视锥剔除的包围盒和遮挡体
+            if constexpr (requires { obj->registerCulling(culling_, occlusion_); }) {
+                obj->registerCulling(culling_, occlusion_);
+            }
+            // 子网格的变换、网格、材质和可见性放入 registry 的组件，由 drawMeshes 遍历
+            if constexpr (requires { obj->registerDraws(render_registry_); }) {
+                obj->registerDraws(render_registry_);
+            }
             render_registry_.add(std::forward<T>(obj));
         }
+        // 与 addDrawable 对应：注销变换节点、剔除、拾取和灯光后从 registry 中删除。
+        // 不能在 update 期间调用，拾取场景需要之后 PickingSystem::commit
+        template <DrawableLike T>
+        void removeDrawable(const T& obj) {
+            const id_t id = obj->getId();
+            if (const auto node = transform_nodes_.find(id); node != transform_nodes_.end()) {
+                transforms_.remove(node->second);
+                transform_nodes_.erase(node);
+            }
+            if constexpr (requires { obj->unregisterCulling(); }) {
+                obj->unregisterCulling();
+            }
+            if constexpr (requires { obj->releasePicking(); }) {
+                obj->releasePicking();
+            }
+            remove_light(id);
+            if (pick_id == id) {
+                cancelPick();
+            }
+            std::erase(multi_pick_ids_, id);
+            render_registry_.remove(id);
+        }
+        template <DrawableLike T, typename Func>
+        void eachDrawable(Func&& func) {
+            render_registry_.each<T>(std::forward<Func>(func));
+        }
         [[nodiscard]] auto getLightEntities(this auto&& self) -> decltype(auto) {
             {
                 return (std::span(self.lights_));
@@ -91,6 +194,39 @@ class World {
             pick_id = id_t{};
         };
 
+        // 框选结果：同一模型的多个子网格只记录一次
+        void pickMany(std::span<const id_t> model_ids) {
+            cancelMultiPick();
+            for (auto model_id : model_ids) {
+                auto* draw_able = render_registry_.getDrawableById(model_id);
+                if (!draw_able || std::ranges::contains(multi_pick_ids_, model_id)) {
+                    continue;
+                }
+                auto& render_state =
+                    draw_able->getEntity().getComponent<ecs::RenderStateComponent>();
+                render_state.mouse_select = true;
+                render_state.select_id = model_id;
+                multi_pick_ids_.push_back(model_id);
+            }
+        }
+
+        void cancelMultiPick() {
+            for (auto model_id : multi_pick_ids_) {
+                auto* draw_able = render_registry_.getDrawableById(model_id);
+                if (draw_able) {
+                    draw_able->getEntity().getComponent<ecs::RenderStateComponent>().mouse_select =
+                        false;
+                }
+            }
+            multi_pick_ids_.clear();
+        }
+
+        [[nodiscard]] auto getMultiPickIds() const -> std::span<const id_t> {
+            return multi_pick_ids_;
+        }
+
+        [[nodiscard]] auto phaseTimings() const -> const PhaseTimings& { return timings_; }
+
         [[nodiscard]] auto getScene() -> ecs::Scene&;
         auto get_module_count() -> size_t;
         ~World();
@@ -102,26 +238,52 @@ class World {
         void remove_light(id_t id) {
             auto light_iterator = light_index.find(id);
             if (light_iterator != light_index.end()) {
-                lights_.erase(lights_.begin() + light_iterator->second);
+                const auto [index, grid_item] = light_iterator->second;
+                light_grid_.remove(grid_item);
+                lights_.erase(lights_.begin() + index);
                 light_index.erase(light_iterator);
+                // 后面的灯光前移了一位
+                for (auto& slot : light_index | std::views::values) {
+                    if (slot.index > index) {
+                        --slot.index;
+                    }
+                }
             }
         }
 
-        void processOutlineres(const std::function<void(ecs::Outliner&&)>& func) {
-            ecs::Outliner outliner;
-            outliner.entity = entity_;
-            outliner.children = child_entitys_;
-            func(std::move(outliner));
-            render_registry_.processOutlineres(func);
-        }
+        // 第一个节点是 World 自身（相机、平行光），之后按添加顺序是各个 drawable
+        auto outliner() -> OutlinerModel& { return render_registry_.outliner(); }
+        // 修改实体的名字并更新大纲视图的过滤索引，entry 的含义同 OutlinerModel::Row
+        void rename(id_t id, std::uint32_t entry, std::string name);
 
         ecs::Entity entity_;
 
     private:
-        void process_mouse_input(core::FrameInfo& frameInfo, graphics::input::Mouse* mouse);
+        struct LightSlot {
+                uint32_t index{0};  // lights_ 中的位置
+                graphics::SpatialGrid::item_t grid_item{graphics::SpatialGrid::INVALID_ITEM};
+        };
+        struct ViewSlot {
+                ecs::Entity camera;  // 删除后保留，之后 addView 复用
+                std::optional<render::CleanValue> target;
+                bool used{false};
+                bool enabled{true};
+        };
+        static constexpr float LIGHT_GRID_CELL_SIZE = 4.f;
+
+        static auto lightBounds(const LightInfo& info) -> core::AABB;
+        void process_mouse_input(core::FrameInfo& frameInfo,
+                                 graphics::input::InputSystem& input_system);
         id_t id_;
         id_t pick_id{0};
         bool is_pick{false};
+        bool is_box_select{false};  // Shift + 左键拖动
+        // 按住时每帧记录光标位置，松开时 Mouse 已经把 axis 清零
+        glm::vec2 box_select_end_{0.f};
+        // use_object_id_buffer 开启时点击拾取走 GPU ID 缓冲，结果延迟若干帧返回
+        std::optional<render::ObjectIdRequest> object_id_request_;
+        bool wait_object_id_readback_{false};
+        std::vector<id_t> multi_pick_ids_;
         ecs::CameraComponent* cameraComponent_{nullptr};
         ecs::Scene scene_;
         ecs::Entity cameraEntity_;
@@ -130,7 +292,17 @@ class World {
         std::vector<LightInfo> lights_;
         std::vector<ecs::Entity> child_entitys_;
         RenderRegistry render_registry_;
+        graphics::TransformHierarchy transforms_;
+        graphics::CullingBvh culling_;
+        graphics::OcclusionBuffer occlusion_;
+        SceneLightBuffer scene_lights_;  // 每帧打包一次，所有绘制共享
         std::unique_ptr<core::FrameTime> frame_time_;
-        std::unordered_map<id_t, uint32_t> light_index;
+        std::unordered_map<id_t, LightSlot> light_index;
+        std::unordered_map<id_t, graphics::TransformHierarchy::node_t> transform_nodes_;
+        graphics::SpatialGrid light_grid_{LIGHT_GRID_CELL_SIZE};
+        PhaseTimings timings_;
+        std::array<ViewSlot, MAX_VIEWS> views_{};  // views_[0] 是主相机
+        view_t input_view_{MAIN_VIEW};
+        std::array<core::Frustum, MAX_VIEWS> view_frustums_{};
 };
 }  // namespace world
\ No newline at end of file